@@ -73,11 +73,13 @@ typedef uint32_t RgBool32;
 RG_DEFINE_NON_DISPATCHABLE_HANDLE(RgInstance)
 typedef uint32_t RgMaterial;
 typedef uint32_t RgCubemap;
+typedef uint32_t RgMesh;
 typedef uint32_t RgFlags;
 
 #define RG_NULL_HANDLE      0
 #define RG_NO_MATERIAL      0
 #define RG_EMPTY_CUBEMAP    0
+#define RG_NO_MESH          0
 #define RG_FALSE            0
 #define RG_TRUE             1
 
@@ -107,6 +109,10 @@ typedef void (*PFN_rgPrint)(const char *pMessage, void *pUserData);
 typedef void (*PFN_rgOpenFile)(const char *pFilePath, void *pUserData, const void **ppOutData, uint32_t *pOutDataSize, void **ppOutFileUserHandle);
 typedef void (*PFN_rgCloseFile)(void *pFileUserHandle, void *pUserData);
 typedef RgBool32 (*PFN_rgIsLightVisibleFromSector)(uint32_t sectorID, void *pUserData);
+typedef void (*PFN_rgTask)(void *pTaskData, uint32_t taskIndex);
+// Must call pfnTask(pTaskData, i) for each i in [0, taskCount), possibly in parallel,
+// and return only when all calls are finished.
+typedef void (*PFN_rgParallelFor)(PFN_rgTask pfnTask, void *pTaskData, uint32_t taskCount, void *pUserData);
 
 typedef struct RgWin32SurfaceCreateInfo RgWin32SurfaceCreateInfo;
 typedef struct RgMetalSurfaceCreateInfo RgMetalSurfaceCreateInfo;
@@ -153,6 +159,16 @@ typedef struct RgXlibSurfaceCreateInfo
 } RgXlibSurfaceCreateInfo;
 #endif // RG_USE_SURFACE_XLIB
 
+typedef enum RgTextureCompression
+{
+    // Texture data is uploaded as is.
+    RG_TEXTURE_COMPRESSION_NONE,
+    // BC1 (or BC3, if there is transparency) for albedo-alpha, BC5 for normal textures.
+    RG_TEXTURE_COMPRESSION_FAST,
+    // BC7 for albedo-alpha and roughness-metallic-emission, BC5 for normal textures.
+    RG_TEXTURE_COMPRESSION_QUALITY,
+} RgTextureCompression;
+
 typedef struct RgInstanceCreateInfo
 {
     // Application name.
@@ -235,6 +251,23 @@ typedef struct RgInstanceCreateInfo
     // Path to normal texture path. Ignores pOverridenTexturesFolderPath and pOverridenNormalTexturePostfix
     const char                  *pWaterNormalTexturePath;
 
+    // Block compression of static material textures, that weren't overriden,
+    // i.e. RGBA8 data from RgStaticMaterialCreateInfo is used. Textures are compressed
+    // on creation using worker threads. Textures with size that is not a multiple of 4
+    // are not compressed.
+    RgTextureCompression        staticTextureCompression;
+    // Optional folder to store compressed textures in, so the same textures are not compressed
+    // again on the next launch. Must contain '/' at the end. If null, compressed textures are not stored.
+    const char                  *pCompressedTexturesCachePath;
+    // Max size in bytes of the device memory that material textures can occupy.
+    // If exceeded, the most detailed mip levels of the least recently used overriden textures
+    // are unloaded; and they're loaded back from the files, when the textures are used again.
+    // Only overriding files with pregenerated mip levels can be unloaded. If 0, there's no limit.
+    uint64_t                    textureMemoryBudget;
+    // If true, textures are also limited by the device memory budget, that is reported
+    // by the driver through VK_EXT_memory_budget or estimated, if it's not supported.
+    RgBool32                    textureMemoryBudgetUseDeviceBudget;
+
     // Vertex data strides in bytes. Must be 4-byte aligned.
     uint32_t                    vertexPositionStride;
     uint32_t                    vertexNormalStride;
@@ -253,6 +286,20 @@ typedef struct RgInstanceCreateInfo
     // screen space coords and NDC depth.
     RgBool32                    lensFlarePointToCheckIsInScreenSpace;
 
+    // How many frames can be recorded on CPU while previous ones are processed on GPU.
+    // 1 gives the lowest latency, 3 allows more overlap of CPU and GPU work.
+    // If 0, then 2 will be used. Must be not greater than 3.
+    uint32_t                    framesInFlight;
+
+    // Count of worker threads that the library creates for internal parallel work.
+    // If 0, then hardware concurrency minus one will be used. Ignored, if pfnParallelFor is not null.
+    uint32_t                    workerThreadCount;
+    // Optional function to execute library's parallel work on host's job system,
+    // so the library doesn't create its own worker threads.
+    PFN_rgParallelFor           pfnParallelFor;
+    // Custom user data that is passed to pfnParallelFor.
+    void                        *pUserParallelForData;
+
 } RgInstanceCreateInfo;
 
 RGAPI RgResult RGCONV rgCreateInstance(
@@ -439,6 +486,66 @@ RGAPI RgResult RGCONV rgUpdateGeometryTexCoords(
     const RgUpdateTexCoordsInfo             *pUpdateInfo);
 
 
+// Mesh vertex data is uploaded to device-local memory once, so its
+// instances don't require copying vertex data from the CPU each frame.
+// If the mesh has normals, its acceleration structure is built once too.
+// Strides are set in RgInstanceUploadInfo.
+typedef struct RgMeshCreateInfo
+{
+    uint32_t                        vertexCount;
+    // 3 first floats will be used
+    const void                      *pVertexData;
+    // If null, then the normals will be generated for each instance,
+    // so its instances will be copied as dynamic geometry each frame.
+    const void                      *pNormalData;
+    // Can be null. 2 first floats will be used.
+    const void                      *pTexCoordData;
+    // Can be null, if indices are not used.
+    uint32_t                        indexCount;
+    const void                      *pIndexData;
+    // Can be null, if the mesh is not skinned.
+    // 4 joint indices per vertex. Weights of each vertex should sum up to 1.
+    const uint8_t                   *pJointIndexData;
+    const float                     *pJointWeightData;
+} RgMeshCreateInfo;
+
+typedef struct RgMeshSkinningInfo
+{
+    // Transforms of the joints from the bind pose to the current pose, in mesh space.
+    // Joint indices of the mesh must be less than jointCount.
+    uint32_t                        jointCount;
+    const RgTransform               *pJointTransforms;
+} RgMeshSkinningInfo;
+
+RGAPI RgResult RGCONV rgCreateMesh(
+    RgInstance                              rgInstance,
+    const RgMeshCreateInfo                  *pCreateInfo,
+    RgMesh                                  *pResult);
+
+RGAPI RgResult RGCONV rgDestroyMesh(
+    RgInstance                              rgInstance,
+    RgMesh                                  mesh);
+
+// Upload an instance of the mesh as dynamic geometry, i.e. only for the current frame.
+// Vertex and index data are taken from the mesh, so vertexCount, pVertexData,
+// pNormalData, pTexCoordLayerData, indexCount and pIndexData are ignored.
+// geomType must be RG_GEOMETRY_TYPE_DYNAMIC.
+// If the mesh has normals, the instance references the mesh's acceleration
+// structure with uploadInfo's transform, without copying or rebuilding anything.
+RGAPI RgResult RGCONV rgUploadMeshInstance(
+    RgInstance                              rgInstance,
+    RgMesh                                  mesh,
+    const RgGeometryUploadInfo              *pUploadInfo);
+
+// Same as rgUploadMeshInstance, but vertices are skinned on GPU
+// with the specified joint transforms. The mesh must have joint data.
+RGAPI RgResult RGCONV rgUploadSkinnedMeshInstance(
+    RgInstance                              rgInstance,
+    RgMesh                                  mesh,
+    const RgGeometryUploadInfo              *pUploadInfo,
+    const RgMeshSkinningInfo                *pSkinningInfo);
+
+
 
 // Clear current scene from all static geometries and make it available for recording new geometries.
 // New scene can be visible only after the submission using rgSubmitStaticGeometries.
@@ -631,6 +738,30 @@ RGAPI RgResult RGCONV rgUploadDecal(
     RgInstance                              rgInstance,
     const RgDecalUploadInfo                 *pUploadInfo);
 
+typedef struct RgStaticDecalUploadInfo
+{
+    // Used to remove the decal with rgRemoveStaticDecal.
+    uint64_t        uniqueID;
+    // Transformation from [-0.5, 0.5] cube to a scaled oriented box.
+    // Orientation should transform (0,0,1) to decal's normal.
+    RgTransform     transform;
+    RgMaterial      material;
+    // If RgDrawFrameInfo::pCameraSectorID is not null, the decal is drawn
+    // only if this sector is potentially visible from the camera's sector.
+    uint32_t        sectorID;
+} RgStaticDecalUploadInfo;
+
+// Unlike rgUploadDecal, static decal must be uploaded only once,
+// and it stays in the scene until rgRemoveStaticDecal is called.
+// Decals are culled by the view frustum before drawing.
+RGAPI RgResult RGCONV rgUploadStaticDecal(
+    RgInstance                              rgInstance,
+    const RgStaticDecalUploadInfo           *pUploadInfo);
+
+RGAPI RgResult RGCONV rgRemoveStaticDecal(
+    RgInstance                              rgInstance,
+    uint64_t                                uniqueID);
+
 
 
 typedef struct RgDirectionalLightUploadInfo
@@ -705,6 +836,18 @@ RGAPI RgResult RGCONV rgUploadPolygonalLight(
     RgInstance                          rgInstance,
     const RgPolygonalLightUploadInfo    *pLightInfo);
 
+// Same as calling rgUploadSphericalLight / rgUploadPolygonalLight
+// for each element, but cheaper when there are a lot of lights.
+RGAPI RgResult RGCONV rgUploadSphericalLights(
+    RgInstance                          rgInstance,
+    const RgSphericalLightUploadInfo    *pLightInfos,
+    uint32_t                            lightCount);
+
+RGAPI RgResult RGCONV rgUploadPolygonalLights(
+    RgInstance                          rgInstance,
+    const RgPolygonalLightUploadInfo    *pLightInfos,
+    uint32_t                            lightCount);
+
 
 
 typedef enum RgSamplerAddressMode
@@ -1115,6 +1258,8 @@ typedef enum RgRenderResolutionMode
     RG_RENDER_RESOLUTION_MODE_BALANCED,
     RG_RENDER_RESOLUTION_MODE_QUALITY,
     RG_RENDER_RESOLUTION_MODE_ULTRA_QUALITY,
+    // Render size is chosen by the library to achieve the target GPU time.
+    RG_RENDER_RESOLUTION_MODE_DYNAMIC,
 } RgRenderResolutionMode;
 
 typedef struct RgDrawFrameRenderResolutionParams
@@ -1124,6 +1269,13 @@ typedef struct RgDrawFrameRenderResolutionParams
     RgRenderResolutionMode      resolutionMode;
     // Used, if resolutionMode is CUSTOM
     RgExtent2D                  renderSize;
+    // Used, if resolutionMode is DYNAMIC. Target GPU time of path tracing
+    // and denoising, in milliseconds. Must be positive.
+    float                       dynamicTargetTimeMs;
+    // Used, if resolutionMode is DYNAMIC. Render size bounds, relative to the surface size.
+    // If both are 0.0, then [0.33, 1.0] is used.
+    float                       dynamicMinScale;
+    float                       dynamicMaxScale;
 } RgDrawFrameRenderResolutionParams;
 
 typedef struct RgDrawFrameLensFlareParams
@@ -1132,6 +1284,18 @@ typedef struct RgDrawFrameLensFlareParams
     RgBlendFactor               lensFlareBlendFuncDst;
 } RgDrawFrameLensFlareParams;
 
+typedef enum RgIndirectIlluminationMode
+{
+    // Indirect illumination is traced for each pixel.
+    RG_INDIRECT_ILLUMINATION_MODE_FULL,
+    // Indirect illumination is traced for every second pixel in a checkerboard pattern,
+    // other pixels are reconstructed from their neighbors.
+    RG_INDIRECT_ILLUMINATION_MODE_CHECKERBOARD,
+    // Indirect illumination is traced for one pixel in each 2x2 block,
+    // other pixels are reconstructed from their neighbors.
+    RG_INDIRECT_ILLUMINATION_MODE_HALF,
+} RgIndirectIlluminationMode;
+
 typedef enum RgDrawFrameRayCullFlagBits
 {
     RG_DRAW_FRAME_RAY_CULL_WORLD_0_BIT  = 1,    // RG_GEOMETRY_VISIBILITY_TYPE_WORLD_0
@@ -1175,6 +1339,15 @@ typedef struct RgDrawFrameInfo
     const RgDrawFrameDebugParams                *pDebugParams;
     const RgDrawFramePostEffectsParams          postEffectParams;
 
+    // Sector where the camera is. If not null, static decals
+    // from sectors that are not potentially visible from it are culled.
+    const uint32_t                              *pCameraSectorID;
+
+    // Lower modes trace less indirect rays per frame, the pattern
+    // is changed each frame, so temporal accumulation covers all pixels.
+    // Default: RG_INDIRECT_ILLUMINATION_MODE_FULL
+    RgIndirectIlluminationMode                  indirectIlluminationMode;
+
 } RgDrawFrameInfo;
 
 RGAPI RgResult RGCONV rgDrawFrame(
@@ -1188,6 +1361,72 @@ RGAPI RgResult RGCONV rgIsRenderUpscaleTechniqueAvailable(
     RgRenderUpscaleTechnique            technique,
     RgBool32                            *pOutResult);
 
+
+// Geometry buffers are sized from the uploaded data: static ones exactly
+// on rgSubmitStaticGeometries, dynamic ones grow when it's needed.
+// All sizes are in bytes.
+typedef struct RgGeometryBuffersStats
+{
+    uint64_t    staticDeviceLocalSize;
+    uint64_t    staticDeviceLocalPeakSize;
+    uint64_t    dynamicDeviceLocalSize;
+    uint64_t    dynamicDeviceLocalPeakSize;
+    // Host visible buffers that are used for uploading.
+    uint64_t    stagingSize;
+    uint64_t    stagingPeakSize;
+    // Scratch memory for acceleration structure builds.
+    uint64_t    scratchSize;
+    // Maximum scratch memory that was used by one frame.
+    uint64_t    scratchPeakUsage;
+} RgGeometryBuffersStats;
+
+RGAPI RgResult RGCONV rgGetGeometryBuffersStats(
+    RgInstance                          rgInstance,
+    RgGeometryBuffersStats              *pResult);
+
+// Framebuffers that are not needed between frames and that are used
+// in non-intersecting ranges of a frame are placed in the same memory.
+// All sizes are in bytes.
+typedef struct RgFramebuffersStats
+{
+    // Device memory that is allocated for all framebuffers.
+    uint64_t    allocatedSize;
+    // Sum of sizes of framebuffers that share memory with others.
+    uint64_t    aliasedSize;
+    // How much more memory would be allocated without sharing.
+    uint64_t    savedSize;
+} RgFramebuffersStats;
+
+RGAPI RgResult RGCONV rgGetFramebuffersStats(
+    RgInstance                          rgInstance,
+    RgFramebuffersStats                 *pResult);
+
+// Buffers are suballocated from the memory pools of their usage class.
+// All sizes are in bytes.
+typedef struct RgBufferMemoryClassStats
+{
+    uint32_t    bufferCount;
+    // Count of VkDeviceMemory objects that are allocated for the class.
+    uint32_t    deviceMemoryCount;
+    // Sum of buffer sizes.
+    uint64_t    usedSize;
+    // Device memory that is allocated for the class.
+    uint64_t    allocatedSize;
+} RgBufferMemoryClassStats;
+
+typedef struct RgBufferMemoryStats
+{
+    // Geometry, storage and indirect buffers, scratch memory.
+    RgBufferMemoryClassStats    deviceLocal;
+    RgBufferMemoryClassStats    accelerationStructure;
+    // Host visible buffers that are used for uploading.
+    RgBufferMemoryClassStats    staging;
+} RgBufferMemoryStats;
+
+RGAPI RgResult RGCONV rgGetBufferMemoryStats(
+    RgInstance                          rgInstance,
+    RgBufferMemoryStats                 *pResult);
+
 #ifdef __cplusplus
 }
 #endif
@@ -114,13 +114,13 @@ void ASBuilder::AddBLAS(
         VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
     buildInfo.srcAccelerationStructure = update ? as : VK_NULL_HANDLE;
     buildInfo.dstAccelerationStructure = as;
-    buildInfo.scratchData.deviceAddress = scratchBuffer->GetScratchAddress(scratchSize);
     buildInfo.geometryCount = geometryCount;
     buildInfo.pGeometries = pGeometries;
     buildInfo.ppGeometries = nullptr;
 
     bottomLBuildInfo.geomInfos.push_back(buildInfo);
     bottomLBuildInfo.rangeInfos.push_back(pRangeInfos);
+    bottomLBuildInfo.scratchSizes.push_back(scratchSize);
 }
 
 void ASBuilder::BuildBottomLevel(VkCommandBuffer cmd)
@@ -128,12 +128,15 @@ void ASBuilder::BuildBottomLevel(VkCommandBuffer cmd)
     assert(bottomLBuildInfo.geomInfos.size() == bottomLBuildInfo.rangeInfos.size());
     assert(!bottomLBuildInfo.geomInfos.empty());
 
+    SetScratchAddresses(bottomLBuildInfo);
+
     // build bottom level
     svkCmdBuildAccelerationStructuresKHR(cmd, bottomLBuildInfo.geomInfos.size(), 
                                         bottomLBuildInfo.geomInfos.data(), bottomLBuildInfo.rangeInfos.data());
 
     bottomLBuildInfo.geomInfos.clear();
     bottomLBuildInfo.rangeInfos.clear();
+    bottomLBuildInfo.scratchSizes.clear();
 }
 
 void ASBuilder::AddTLAS(
@@ -159,13 +162,13 @@ void ASBuilder::AddTLAS(
         VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
     buildInfo.srcAccelerationStructure = update ? as : VK_NULL_HANDLE;
     buildInfo.dstAccelerationStructure = as;
-    buildInfo.scratchData.deviceAddress = scratchBuffer->GetScratchAddress(scratchSize);
     buildInfo.geometryCount = 1;
     buildInfo.pGeometries = pGeometry;
     buildInfo.ppGeometries = nullptr;
 
     topLBuildInfo.geomInfos.push_back(buildInfo);
     topLBuildInfo.rangeInfos.push_back(pRangeInfo);
+    topLBuildInfo.scratchSizes.push_back(scratchSize);
 }
 
 void ASBuilder::BuildTopLevel(VkCommandBuffer cmd)
@@ -173,12 +176,36 @@ void ASBuilder::BuildTopLevel(VkCommandBuffer cmd)
     assert(topLBuildInfo.geomInfos.size() == topLBuildInfo.rangeInfos.size());
     assert(!topLBuildInfo.geomInfos.empty());
 
-    // build bottom level
+    SetScratchAddresses(topLBuildInfo);
+
+    // build top level
     svkCmdBuildAccelerationStructuresKHR(cmd, topLBuildInfo.geomInfos.size(),
                                         topLBuildInfo.geomInfos.data(), topLBuildInfo.rangeInfos.data());
 
     topLBuildInfo.geomInfos.clear();
     topLBuildInfo.rangeInfos.clear();
+    topLBuildInfo.scratchSizes.clear();
+}
+
+void ASBuilder::SetScratchAddresses(BuildInfo &buildInfo)
+{
+    assert(buildInfo.geomInfos.size() == buildInfo.scratchSizes.size());
+
+    // all builds in one call are executed in parallel,
+    // so their scratch ranges must not overlap
+    VkDeviceSize total = 0;
+
+    for (VkDeviceSize s : buildInfo.scratchSizes)
+    {
+        total += scratchBuffer->GetAlignedSize(s);
+    }
+
+    scratchBuffer->Reserve(total);
+
+    for (size_t i = 0; i < buildInfo.geomInfos.size(); i++)
+    {
+        buildInfo.geomInfos[i].scratchData.deviceAddress = scratchBuffer->GetScratchAddress(buildInfo.scratchSizes[i]);
+    }
 }
 
 bool ASBuilder::IsEmpty() const
@@ -91,8 +91,12 @@ private:
     {
         std::vector<VkAccelerationStructureBuildGeometryInfoKHR> geomInfos;
         std::vector<const VkAccelerationStructureBuildRangeInfoKHR *> rangeInfos;
+        // scratch addresses are set on build, when the total size is known
+        std::vector<VkDeviceSize> scratchSizes;
     };
 
+    void SetScratchAddresses(BuildInfo &buildInfo);
+
     BuildInfo bottomLBuildInfo;
     BuildInfo topLBuildInfo;
 };
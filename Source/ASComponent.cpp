@@ -34,6 +34,13 @@ RTGL1::BLASComponent::BLASComponent(VkDevice _device, VertexCollectorFilterTypeF
     geomCount(0)
 {}
 
+RTGL1::BLASComponent::BLASComponent(VkDevice _device, const char *_debugName)
+:
+    ASComponent(_device, _debugName),
+    filter(0),
+    geomCount(0)
+{}
+
 RTGL1::TLASComponent::TLASComponent(VkDevice _device, const char *_debugName)
 : 
     ASComponent(_device, _debugName)
@@ -76,6 +76,8 @@ struct BLASComponent : public ASComponent
 {
 public:
     explicit BLASComponent(VkDevice device, VertexCollectorFilterTypeFlags filter);
+    // BLAS that doesn't belong to any filter, e.g. of a resident mesh
+    explicit BLASComponent(VkDevice device, const char *debugName);
     VertexCollectorFilterTypeFlags GetFilter() const;
 
     void SetGeometryCount(uint32_t geomCount);
@@ -20,6 +20,7 @@
 
 #include "ASManager.h"
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 
@@ -32,20 +33,28 @@ using namespace RTGL1;
 ASManager::ASManager(
     VkDevice _device,
     std::shared_ptr<MemoryAllocator> _allocator,
+    const std::shared_ptr<PhysicalDevice> &_physDevice,
+    std::shared_ptr<FrameAllocator> _frameAllocator,
     std::shared_ptr<CommandBufferManager> _cmdManager,
     std::shared_ptr<TextureManager> _textureManager,
     std::shared_ptr<GeomInfoManager> _geomInfoManager,
     std::shared_ptr<TriangleInfoManager> _triangleInfoMgr,
     std::shared_ptr<SectorVisibility> &_sectorVisibility,
+    std::shared_ptr<MeshManager> _meshManager,
     const VertexBufferProperties &_properties)
 :
     device(_device),
     allocator(std::move(_allocator)),
+    frameCount(allocator->GetFrameCount()),
     staticCopyFence(VK_NULL_HANDLE),
+    previousDynamicGeneration(0),
+    boundBuffersGeneration{},
+    buffersStats{},
     cmdManager(std::move(_cmdManager)),
     textureMgr(std::move(_textureManager)),
     geomInfoMgr(std::move(_geomInfoManager)),
     triangleInfoMgr(std::move(_triangleInfoMgr)),
+    meshManager(std::move(_meshManager)),
     descPool(VK_NULL_HANDLE),
     buffersDescSetLayout(VK_NULL_HANDLE),
     asDescSetLayout(VK_NULL_HANDLE),
@@ -60,7 +69,7 @@ ASManager::ASManager(
     {
         if (filter & FT::CF_DYNAMIC)
         {
-            for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+            for (uint32_t i = 0; i < frameCount; i++)
             {
                 allDynamicBlas[i].emplace_back(std::make_unique<BLASComponent>(device, filter));
             }
@@ -71,20 +80,20 @@ ASManager::ASManager(
         }
     });
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         tlas[i] = std::make_unique<TLASComponent>(device, "TLAS main");
     }
 
 
-    scratchBuffer = std::make_shared<ScratchBuffer>(allocator);
+    scratchBuffer = std::make_shared<ScratchBuffer>(allocator, _physDevice, frameCount);
     asBuilder = std::make_shared<ASBuilder>(device, scratchBuffer);
 
 
     // static and movable static vertices share the same buffer as their data won't be changing
     collectorStatic = std::make_shared<VertexCollector>(
-        device, allocator, geomInfoMgr, triangleInfoMgr, _sectorVisibility,
-        sizeof(ShVertexBufferStatic), properties,
+        device, allocator, _frameAllocator, geomInfoMgr, triangleInfoMgr, _sectorVisibility,
+        properties,
         FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE | 
         FT::MASK_PASS_THROUGH_GROUP | 
         FT::MASK_PRIMARY_VISIBILITY_GROUP);
@@ -97,26 +106,25 @@ ASManager::ASManager(
 
     // dynamic vertices
     collectorDynamic[0] = std::make_shared<VertexCollector>(
-        device, allocator, geomInfoMgr, triangleInfoMgr, _sectorVisibility,
-        sizeof(ShVertexBufferDynamic), properties,
+        device, allocator, _frameAllocator, geomInfoMgr, triangleInfoMgr, _sectorVisibility,
+        properties,
         FT::CF_DYNAMIC | 
         FT::MASK_PASS_THROUGH_GROUP | 
         FT::MASK_PRIMARY_VISIBILITY_GROUP);
 
     // other dynamic vertex collectors should share the same device local buffers as the first one
-    for (uint32_t i = 1; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 1; i < frameCount; i++)
     {
         collectorDynamic[i] = std::make_shared<VertexCollector>(collectorDynamic[0], allocator);
     }
 
-    previousDynamicPositions.Init(
-        allocator, sizeof(ShVertexBufferDynamic::positions),
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Previous frame's vertex data");
-    previousDynamicIndices.Init(
-        allocator, sizeof(ShVertexBufferDynamic::positions),
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Previous frame's index data");
+    {
+        uint32_t initialCapacity = collectorDynamic[0]->GetVertexBufferLayout().capacity;
+
+        ReservePreviousDynamicBuffers(0,
+                                      (VkDeviceSize)initialCapacity * properties.positionStride,
+                                      (VkDeviceSize)initialCapacity * sizeof(uint32_t));
+    }
 
 
     // instance buffer for TLAS
@@ -128,12 +136,14 @@ ASManager::ASManager(
 
     CreateDescriptors();
 
-    // buffers won't be changing, update once
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    // buffers are updated again only if they're reallocated
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         UpdateBufferDescriptors(i);
     }
 
+    UpdateBuffersStats();
+
 
     VkFenceCreateInfo fenceInfo = {};
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
@@ -151,7 +161,7 @@ void ASManager::CreateDescriptors()
     VkResult r;
 
     {
-        std::array<VkDescriptorSetLayoutBinding, 9> bindings{};
+        std::array<VkDescriptorSetLayoutBinding, 11> bindings{};
 
         // static vertex data
         bindings[0].binding = BINDING_VERTEX_BUFFER_STATIC;
@@ -200,7 +210,17 @@ void ASManager::CreateDescriptors()
         bindings[8].descriptorCount = 1;
         bindings[8].stageFlags = VK_SHADER_STAGE_ALL;
 
-        static_assert(bindings.size() == 9, "");
+        bindings[9].binding = BINDING_MESH_VERTEX_BUFFER;
+        bindings[9].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[9].descriptorCount = 1;
+        bindings[9].stageFlags = VK_SHADER_STAGE_ALL;
+
+        bindings[10].binding = BINDING_MESH_INDEX_BUFFER;
+        bindings[10].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[10].descriptorCount = 1;
+        bindings[10].stageFlags = VK_SHADER_STAGE_ALL;
+
+        static_assert(bindings.size() == 11, "");
 
         VkDescriptorSetLayoutCreateInfo layoutInfo = {};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -230,16 +250,16 @@ void ASManager::CreateDescriptors()
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
 
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT * 8;
+    poolSizes[0].descriptorCount = frameCount * 11;
 
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-    poolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+    poolSizes[1].descriptorCount = frameCount;
 
     VkDescriptorPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = poolSizes.size();
     poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT * 2;
+    poolInfo.maxSets = frameCount * 2;
 
     r = vkCreateDescriptorPool(device, &poolInfo, nullptr, &descPool);
     VK_CHECKERROR(r);
@@ -254,7 +274,7 @@ void ASManager::CreateDescriptors()
     SET_DEBUG_NAME(device, buffersDescSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Vertex data Desc set layout");
     SET_DEBUG_NAME(device, asDescSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "TLAS Desc set layout");
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         descSetInfo.pSetLayouts = &buffersDescSetLayout;
         r = vkAllocateDescriptorSets(device, &descSetInfo, &buffersDescSets[i]);
@@ -271,7 +291,7 @@ void ASManager::CreateDescriptors()
 
 void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
 {
-    constexpr  uint32_t bindingCount = 9;
+    constexpr  uint32_t bindingCount = 11;
 
     std::array<VkDescriptorBufferInfo, bindingCount> bufferInfos{};
     std::array<VkWriteDescriptorSet, bindingCount> writes{};
@@ -308,12 +328,12 @@ void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
     gpBufInfo.range = VK_WHOLE_SIZE;
 
     VkDescriptorBufferInfo &ppBufInfo = bufferInfos[BINDING_PREV_POSITIONS_BUFFER_DYNAMIC];
-    ppBufInfo.buffer = previousDynamicPositions.GetBuffer();
+    ppBufInfo.buffer = previousDynamicPositions->GetBuffer();
     ppBufInfo.offset = 0;
     ppBufInfo.range = VK_WHOLE_SIZE;
 
     VkDescriptorBufferInfo &piBufInfo = bufferInfos[BINDING_PREV_INDEX_BUFFER_DYNAMIC];
-    piBufInfo.buffer = previousDynamicIndices.GetBuffer();
+    piBufInfo.buffer = previousDynamicIndices->GetBuffer();
     piBufInfo.offset = 0;
     piBufInfo.range = VK_WHOLE_SIZE;
 
@@ -322,6 +342,16 @@ void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
     trBufInfo.offset = 0;
     trBufInfo.range = VK_WHOLE_SIZE;
 
+    VkDescriptorBufferInfo &mvBufInfo = bufferInfos[BINDING_MESH_VERTEX_BUFFER];
+    mvBufInfo.buffer = meshManager->GetVertexBuffer();
+    mvBufInfo.offset = 0;
+    mvBufInfo.range = VK_WHOLE_SIZE;
+
+    VkDescriptorBufferInfo &miBufInfo = bufferInfos[BINDING_MESH_INDEX_BUFFER];
+    miBufInfo.buffer = meshManager->GetIndexBuffer();
+    miBufInfo.offset = 0;
+    miBufInfo.range = VK_WHOLE_SIZE;
+
 
     // writes
     VkWriteDescriptorSet &stVertWrt = writes[BINDING_VERTEX_BUFFER_STATIC];
@@ -405,7 +435,116 @@ void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
     trWrt.descriptorCount = 1;
     trWrt.pBufferInfo = &trBufInfo;
 
+    VkWriteDescriptorSet &mvWrt = writes[BINDING_MESH_VERTEX_BUFFER];
+    mvWrt.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    mvWrt.dstSet = buffersDescSets[frameIndex];
+    mvWrt.dstBinding = BINDING_MESH_VERTEX_BUFFER;
+    mvWrt.dstArrayElement = 0;
+    mvWrt.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    mvWrt.descriptorCount = 1;
+    mvWrt.pBufferInfo = &mvBufInfo;
+
+    VkWriteDescriptorSet &miWrt = writes[BINDING_MESH_INDEX_BUFFER];
+    miWrt.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    miWrt.dstSet = buffersDescSets[frameIndex];
+    miWrt.dstBinding = BINDING_MESH_INDEX_BUFFER;
+    miWrt.dstArrayElement = 0;
+    miWrt.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    miWrt.descriptorCount = 1;
+    miWrt.pBufferInfo = &miBufInfo;
+
     vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+
+    boundBuffersGeneration[frameIndex] = GetBuffersGeneration();
+}
+
+uint32_t ASManager::GetBuffersGeneration() const
+{
+    // all dynamic collectors share the same device local buffers
+    return 
+        collectorStatic->GetDeviceLocalGeneration() +
+        collectorDynamic[0]->GetDeviceLocalGeneration() +
+        previousDynamicGeneration;
+}
+
+void ASManager::UpdateBufferDescriptorsIfChanged(uint32_t frameIndex)
+{
+    if (boundBuffersGeneration[frameIndex] != GetBuffersGeneration())
+    {
+        UpdateBufferDescriptors(frameIndex);
+    }
+}
+
+void ASManager::ReservePreviousDynamicBuffers(uint32_t frameIndex, VkDeviceSize positionsSize, VkDeviceSize indicesSize)
+{
+    // geometric growth, old buffers can be still in use by the previous frame
+    if (!previousDynamicPositions || previousDynamicPositions->GetSize() < positionsSize)
+    {
+        VkDeviceSize newSize = positionsSize;
+
+        if (previousDynamicPositions)
+        {
+            newSize = std::max(newSize, previousDynamicPositions->GetSize() * 2);
+            buffersToDestroy[frameIndex].push_back(std::move(previousDynamicPositions));
+        }
+
+        previousDynamicPositions = std::make_shared<Buffer>();
+        previousDynamicPositions->Init(
+            allocator, newSize,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Previous frame's vertex data");
+
+        previousDynamicGeneration++;
+    }
+
+    if (!previousDynamicIndices || previousDynamicIndices->GetSize() < indicesSize)
+    {
+        VkDeviceSize newSize = indicesSize;
+
+        if (previousDynamicIndices)
+        {
+            newSize = std::max(newSize, previousDynamicIndices->GetSize() * 2);
+            buffersToDestroy[frameIndex].push_back(std::move(previousDynamicIndices));
+        }
+
+        previousDynamicIndices = std::make_shared<Buffer>();
+        previousDynamicIndices->Init(
+            allocator, newSize,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Previous frame's index data");
+
+        previousDynamicGeneration++;
+    }
+}
+
+void ASManager::UpdateBuffersStats()
+{
+    auto &s = buffersStats;
+
+    s.staticDeviceLocalSize = collectorStatic->GetDeviceLocalSize();
+    s.dynamicDeviceLocalSize = 
+        collectorDynamic[0]->GetDeviceLocalSize() + 
+        previousDynamicPositions->GetSize() + 
+        previousDynamicIndices->GetSize();
+
+    s.stagingSize = collectorStatic->GetStagingSize();
+
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        s.stagingSize += collectorDynamic[i]->GetStagingSize();
+    }
+
+    s.staticDeviceLocalPeakSize = std::max(s.staticDeviceLocalPeakSize, s.staticDeviceLocalSize);
+    s.dynamicDeviceLocalPeakSize = std::max(s.dynamicDeviceLocalPeakSize, s.dynamicDeviceLocalSize);
+    s.stagingPeakSize = std::max(s.stagingPeakSize, s.stagingSize);
+}
+
+void ASManager::GetBuffersStats(RgGeometryBuffersStats *pResult) const
+{
+    *pResult = buffersStats;
+
+    pResult->scratchSize = scratchBuffer->GetAllocatedSize();
+    pResult->scratchPeakUsage = scratchBuffer->GetPeakUsage();
 }
 
 void ASManager::UpdateASDescriptors(uint32_t frameIndex)
@@ -439,7 +578,7 @@ ASManager::~ASManager()
         as->Destroy();
     }
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         for (auto &as : allDynamicBlas[i])
         {
@@ -529,11 +668,16 @@ uint32_t ASManager::AddStaticGeometry(uint32_t frameIndex, const RgGeometryUploa
 {
     if (info.geomType == RG_GEOMETRY_TYPE_STATIC || info.geomType == RG_GEOMETRY_TYPE_STATIC_MOVABLE)
     {
+        for (uint32_t m : info.geomMaterial.layerMaterials)
+        {
+            textureMgr->MarkUsedByStaticGeometry(m);
+        }
+
         MaterialTextures materials[3] =
         {
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[0]),
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[1]),
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[0]),
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[1]),
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[2])
         };
 
         return collectorStatic->AddGeometry(frameIndex, info, materials);
@@ -543,29 +687,55 @@ uint32_t ASManager::AddStaticGeometry(uint32_t frameIndex, const RgGeometryUploa
     return UINT32_MAX;
 }
 
-uint32_t ASManager::AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info)
+uint32_t ASManager::AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, const ResidentMeshData *pMesh)
 {
     if (info.geomType == RG_GEOMETRY_TYPE_DYNAMIC)
     {
         MaterialTextures materials[3] =
         {
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[0]),
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[1]),
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[0]),
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[1]),
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[2])
         };
 
-        return collectorDynamic[frameIndex]->AddGeometry(frameIndex, info, materials);
+        return collectorDynamic[frameIndex]->AddGeometry(frameIndex, info, materials, pMesh);
     }
 
     assert(0);
     return UINT32_MAX;
 }
 
+bool ASManager::AddMeshInstance(uint32_t frameIndex, const RgGeometryUploadInfo &info, RgMesh mesh, const ResidentMeshData &meshData)
+{
+    assert(info.geomType == RG_GEOMETRY_TYPE_DYNAMIC);
+
+    // each instance is a separate TLAS instance
+    const size_t tlasInstanceCount = 
+        allStaticBlas.size() + 
+        allDynamicBlas[frameIndex].size() + 
+        collectorDynamic[frameIndex]->GetMeshInstances().size();
+
+    if (tlasInstanceCount + 1 > MAX_TOP_LEVEL_INSTANCE_COUNT)
+    {
+        return false;
+    }
+
+    MaterialTextures materials[3] =
+    {
+        textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[0]),
+        textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[1]),
+        textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[2])
+    };
+
+    return collectorDynamic[frameIndex]->AddMeshInstance(frameIndex, info, materials, mesh, meshData);
+}
+
 void ASManager::ResetStaticGeometry()
 {
     collectorStatic->Reset();
     geomInfoMgr->ResetWithStatic();
     triangleInfoMgr->Reset();
+    textureMgr->ResetStaticGeometryUsage();
 }
 
 void ASManager::BeginStaticGeometry()
@@ -574,17 +744,29 @@ void ASManager::BeginStaticGeometry()
     collectorStatic->Reset();
     geomInfoMgr->ResetWithStatic();
     triangleInfoMgr->Reset();
+    textureMgr->ResetStaticGeometryUsage();
 
     collectorStatic->BeginCollecting(true);
 }
 
-void ASManager::SubmitStaticGeometry()
+void ASManager::SubmitStaticGeometry(uint32_t frameIndex)
 {
-    collectorStatic->EndCollecting();
-
     // static geometry submission happens very infrequently, e.g. on level load
     vkDeviceWaitIdle(device);
 
+    // device local buffers are recreated to fit collected data exactly
+    collectorStatic->EndCollecting(frameIndex);
+
+    // device is idle, so replaced buffers can be destroyed,
+    // and descriptor sets for all frames can be updated
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        collectorStatic->PrepareForFrame(i);
+        UpdateBufferDescriptorsIfChanged(i);
+    }
+
+    UpdateBuffersStats();
+
     typedef VertexCollectorFilterTypeFlagBits FT;
 
     auto staticFlags = FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE;
@@ -610,6 +792,10 @@ void ASManager::SubmitStaticGeometry()
         return;
     }
 
+    // static BLAS are built in a separate submission,
+    // its scratch must not overlap with the frames in flight
+    scratchBuffer->BeginImmediate();
+
     VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
 
     // copy from staging with barrier
@@ -637,14 +823,24 @@ void ASManager::SubmitStaticGeometry()
     // submit and wait
     cmdManager->Submit(cmd, staticCopyFence);
     Utils::WaitAndResetFence(device, staticCopyFence);
+
+    scratchBuffer->EndImmediate();
 }
 
 void ASManager::BeginDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
 {
-    scratchBuffer->Reset();
+    scratchBuffer->BeginFrame(frameIndex);
 
-    static_assert(MAX_FRAMES_IN_FLIGHT == 2, "");
-    uint32_t prevFrameIndex = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+    uint32_t prevFrameIndex = GetPrevFrameIndex(frameIndex, frameCount);
+
+    // frame's fence was waited, so replaced buffers are not in use anymore
+    buffersToDestroy[frameIndex].clear();
+    collectorStatic->PrepareForFrame(frameIndex);
+    collectorDynamic[frameIndex]->PrepareForFrame(frameIndex);
+
+    ReservePreviousDynamicBuffers(frameIndex,
+                                  (VkDeviceSize)collectorDynamic[prevFrameIndex]->GetCurrentVertexCount() * properties.positionStride,
+                                  (VkDeviceSize)collectorDynamic[prevFrameIndex]->GetCurrentIndexCount() * sizeof(uint32_t));
 
     // store data of current frame to use it in the next one
     CopyDynamicDataToPrevBuffers(cmd, prevFrameIndex);
@@ -654,6 +850,20 @@ void ASManager::BeginDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
     collectorDynamic[frameIndex]->BeginCollecting(false);
 }
 
+void ASManager::CopyDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    CmdLabel label(cmd, "Copying dynamic geometry");
+
+    const auto &colDyn = collectorDynamic[frameIndex];
+
+    colDyn->EndCollecting(frameIndex);
+    colDyn->CopyFromStaging(cmd, false);
+
+    // dynamic buffers could grow while collecting
+    UpdateBufferDescriptorsIfChanged(frameIndex);
+    UpdateBuffersStats();
+}
+
 void ASManager::SubmitDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
 {
     typedef VertexCollectorFilterTypeFlagBits FT;
@@ -662,9 +872,6 @@ void ASManager::SubmitDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
 
     const auto &colDyn = collectorDynamic[frameIndex];
 
-    colDyn->EndCollecting();
-    colDyn->CopyFromStaging(cmd, false);
-
     assert(asBuilder->IsEmpty());
 
     bool toBuild = false;
@@ -690,6 +897,107 @@ void ASManager::SubmitDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
     Utils::ASBuildMemoryBarrier(cmd);
 }
 
+void ASManager::SubmitMeshes(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    meshManager->UploadPending(cmd, frameIndex);
+
+    const std::vector<RgMesh> &toBuild = meshManager->GetMeshesToBuild();
+
+    if (toBuild.empty())
+    {
+        return;
+    }
+
+    CmdLabel label(cmd, "Building mesh BLAS");
+
+    assert(asBuilder->IsEmpty());
+
+    const VkDeviceAddress vertexPoolAddress = meshManager->GetVertexBufferAddress();
+    const VkDeviceAddress indexPoolAddress = meshManager->GetIndexBufferAddress();
+
+    // all passed arrays must be alive until BuildBottomLevel(), so no reallocations
+    std::vector<VkAccelerationStructureGeometryKHR> geoms;
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges;
+    geoms.reserve(toBuild.size());
+    ranges.reserve(toBuild.size());
+
+    for (RgMesh mesh : toBuild)
+    {
+        const ResidentMeshData *pMesh = meshManager->GetMesh(mesh);
+
+        // could be destroyed right after creation
+        if (pMesh == nullptr)
+        {
+            continue;
+        }
+
+        assert(pMesh->blas != nullptr);
+
+        const bool useIndices = pMesh->indexCount != 0;
+        uint32_t primitiveCount = useIndices ? pMesh->indexCount / 3 : pMesh->vertexCount / 3;
+
+        // mesh space, transforms are set per TLAS instance
+        VkAccelerationStructureGeometryKHR geom = {};
+        geom.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+        geom.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+        // opaqueness is forced by the instances
+        geom.flags = VK_GEOMETRY_NO_DUPLICATE_ANY_HIT_INVOCATION_BIT_KHR;
+
+        VkAccelerationStructureGeometryTrianglesDataKHR &trData = geom.geometry.triangles;
+        trData.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+        trData.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+        trData.maxVertex = pMesh->vertexCount;
+        trData.vertexData.deviceAddress = vertexPoolAddress + pMesh->positions;
+        trData.vertexStride = properties.positionStride;
+        trData.transformData = {};
+
+        if (useIndices)
+        {
+            trData.indexType = VK_INDEX_TYPE_UINT32;
+            trData.indexData.deviceAddress = indexPoolAddress + pMesh->indices;
+        }
+        else
+        {
+            trData.indexType = VK_INDEX_TYPE_NONE_KHR;
+            trData.indexData = {};
+        }
+
+        VkAccelerationStructureBuildRangeInfoKHR rangeInfo = {};
+        rangeInfo.primitiveCount = primitiveCount;
+
+        geoms.push_back(geom);
+        ranges.push_back(rangeInfo);
+
+        // meshes are built once, so prefer trace performance
+        const bool fastTrace = true;
+        const bool update = false;
+
+        const auto buildSizes = asBuilder->GetBottomBuildSizes(1, &geoms.back(), &primitiveCount, fastTrace);
+
+        pMesh->blas->RecreateIfNotValid(buildSizes, allocator);
+        pMesh->blas->SetGeometryCount(1);
+
+        assert(pMesh->blas->GetAS() != VK_NULL_HANDLE);
+
+        asBuilder->AddBLAS(pMesh->blas->GetAS(), 1,
+                           &geoms.back(), &ranges.back(),
+                           buildSizes,
+                           fastTrace, update, false);
+    }
+
+    meshManager->OnMeshesBuilt();
+
+    if (geoms.empty())
+    {
+        return;
+    }
+
+    asBuilder->BuildBottomLevel(cmd);
+
+    // sync AS access
+    Utils::ASBuildMemoryBarrier(cmd);
+}
+
 void ASManager::UpdateStaticMovableTransform(uint32_t simpleIndex, const RgUpdateTransformInfo &updateInfo)
 {
     collectorStatic->UpdateTransform(simpleIndex, updateInfo);
@@ -746,14 +1054,15 @@ void ASManager::ResubmitStaticMovable(VkCommandBuffer cmd)
 
 bool ASManager::SetupTLASInstanceFromBLAS(const BLASComponent &blas, uint32_t rayCullMaskWorld, bool allowGeometryWithSkyFlag, bool isReflRefrAlphaTested, VkAccelerationStructureInstanceKHR &instance)
 {
-    typedef VertexCollectorFilterTypeFlagBits FT;
-
     if (blas.GetAS() == VK_NULL_HANDLE || blas.IsEmpty())
     {
         return false;
     }
 
-    auto filter = blas.GetFilter();
+    if (!SetupTLASInstanceFilter(blas.GetFilter(), rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, instance))
+    {
+        return false;
+    }
 
     instance.accelerationStructureReference = blas.GetASAddress();
 
@@ -764,6 +1073,13 @@ bool ASManager::SetupTLASInstanceFromBLAS(const BLASComponent &blas, uint32_t ra
         0.0f, 0.0f, 1.0f, 0.0f
     };
 
+    return true;
+}
+
+bool ASManager::SetupTLASInstanceFilter(VertexCollectorFilterTypeFlags filter, uint32_t rayCullMaskWorld, bool allowGeometryWithSkyFlag, bool isReflRefrAlphaTested, VkAccelerationStructureInstanceKHR &instance)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
     instance.instanceCustomIndex = 0;
 
 
@@ -896,7 +1212,7 @@ bool ASManager::SetupTLASInstanceFromBLAS(const BLASComponent &blas, uint32_t ra
     return true;
 }
 
-static void WriteInstanceGeomInfo(int32_t *instanceGeomInfoOffset, int32_t *instanceGeomCount, uint32_t index, const BLASComponent &blas)
+static void WriteInstanceGeomInfo(int32_t *instanceGeomInfoOffset, uint32_t index, const BLASComponent &blas)
 {
     assert(index < MAX_TOP_LEVEL_INSTANCE_COUNT);
 
@@ -907,7 +1223,6 @@ static void WriteInstanceGeomInfo(int32_t *instanceGeomInfoOffset, int32_t *inst
     assert(geomCount > 0 && geomCount < MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT);
 
     instanceGeomInfoOffset[index] = arrayOffset;
-    instanceGeomCount[index] = geomCount;
 }
 
 void ASManager::PrepareForBuildingTLAS(
@@ -916,16 +1231,12 @@ void ASManager::PrepareForBuildingTLAS(
     uint32_t uniformData_rayCullMaskWorld,
     bool allowGeometryWithSkyFlag,
     bool isReflRefrAlphaTested,
-    ShVertPreprocessing *outPush,
     TLASPrepareResult *outResult) const
 {
-    typedef VertexCollectorFilterTypeFlagBits FT;
-
     static_assert(sizeof(TLASPrepareResult::instances) / sizeof(TLASPrepareResult::instances[0]) == MAX_TOP_LEVEL_INSTANCE_COUNT, "Change TLASPrepareResult sizes");
 
 
     *outResult = {};
-    *outPush = {};
 
 
     auto &r = *outResult;
@@ -936,8 +1247,18 @@ void ASManager::PrepareForBuildingTLAS(
     // Note: std140 requires elements to be aligned by sizeof(vec4)
     int32_t *instanceGeomInfoOffset = uniformData.instanceGeomInfoOffset;
 
-    // write geometry counts of each BLAS for iterating in vertex preprocessing 
-    int32_t *instanceGeomCount = uniformData.instanceGeomCount;
+    // vertex buffers' capacities are set at runtime, so shaders need offsets (in floats) of attribute arrays
+    {
+        const VertexBufferLayout &st = collectorStatic->GetVertexBufferLayout();
+        const VertexBufferLayout &dn = collectorDynamic[frameIndex]->GetVertexBufferLayout();
+
+        uniformData.staticNormalsOffset         = (uint32_t)(st.normals      / sizeof(float));
+        uniformData.staticTexCoordsOffset       = (uint32_t)(st.texCoords[0] / sizeof(float));
+        uniformData.staticTexCoordsLayer1Offset = (uint32_t)(st.texCoords[1] / sizeof(float));
+        uniformData.staticTexCoordsLayer2Offset = (uint32_t)(st.texCoords[2] / sizeof(float));
+        uniformData.dynamicNormalsOffset        = (uint32_t)(dn.normals      / sizeof(float));
+        uniformData.dynamicTexCoordsOffset      = (uint32_t)(dn.texCoords[0] / sizeof(float));
+    }
 
     const std::vector<std::unique_ptr<BLASComponent>> *blasArrays[] =
     {
@@ -949,26 +1270,45 @@ void ASManager::PrepareForBuildingTLAS(
     {
         for (const auto &blas : *blasArr)
         {
-            bool isDynamic = blas->GetFilter() & FT::CF_DYNAMIC;
-
             // add to TLAS instances array
             bool isAdded = ASManager::SetupTLASInstanceFromBLAS(*blas, uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, r.instances[r.instanceCount]);
 
             if (isAdded)
             {
-                // mark bit if dynamic
-                if (isDynamic)
-                {
-                    outPush->tlasInstanceIsDynamicBits[r.instanceCount / MAX_TOP_LEVEL_INSTANCE_COUNT] |= 1 << (r.instanceCount % MAX_TOP_LEVEL_INSTANCE_COUNT);
-                }
-
-                WriteInstanceGeomInfo(instanceGeomInfoOffset, instanceGeomCount, r.instanceCount, *blas);
+                WriteInstanceGeomInfo(instanceGeomInfoOffset, r.instanceCount, *blas);
                 r.instanceCount++;
             }
         }
     }
 
-    outPush->tlasInstanceCount = r.instanceCount;
+    // rigid mesh instances reference the mesh's BLAS, it has only one geometry,
+    // so the offset is the instance's geom info index itself
+    for (const MeshInstanceInfo &inst : collectorDynamic[frameIndex]->GetMeshInstances())
+    {
+        const ResidentMeshData *pMesh = meshManager->GetMesh(inst.mesh);
+
+        // mesh could be destroyed after its instance was uploaded
+        if (pMesh == nullptr || !pMesh->isBlasBuilt)
+        {
+            continue;
+        }
+
+        assert(r.instanceCount < MAX_TOP_LEVEL_INSTANCE_COUNT);
+        assert(inst.globalGeomIndex != UINT32_MAX);
+
+        VkAccelerationStructureInstanceKHR &instance = r.instances[r.instanceCount];
+
+        bool isAdded = ASManager::SetupTLASInstanceFilter(inst.geomFlags, uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, instance);
+
+        if (isAdded)
+        {
+            instance.accelerationStructureReference = pMesh->blas->GetASAddress();
+            instance.transform = inst.transform;
+
+            instanceGeomInfoOffset[r.instanceCount] = (int32_t)inst.globalGeomIndex;
+            r.instanceCount++;
+        }
+    }
 }
 
 void ASManager::BuildTLAS(VkCommandBuffer cmd, uint32_t frameIndex, const TLASPrepareResult &r)
@@ -1046,7 +1386,7 @@ void ASManager::CopyDynamicDataToPrevBuffers(VkCommandBuffer cmd, uint32_t frame
         vkCmdCopyBuffer(
             cmd, 
             collectorDynamic[frameIndex]->GetVertexBuffer(), 
-            previousDynamicPositions.GetBuffer(),
+            previousDynamicPositions->GetBuffer(),
             1, &vertRegion);
     }
 
@@ -1060,7 +1400,7 @@ void ASManager::CopyDynamicDataToPrevBuffers(VkCommandBuffer cmd, uint32_t frame
         vkCmdCopyBuffer(
             cmd, 
             collectorDynamic[frameIndex]->GetIndexBuffer(), 
-            previousDynamicIndices.GetBuffer(),
+            previousDynamicIndices->GetBuffer(),
             1, &indexRegion);
     }
 }
@@ -1100,6 +1440,11 @@ VkDescriptorSet ASManager::GetBuffersDescSet(uint32_t frameIndex) const
     return buffersDescSets[frameIndex];
 }
 
+const VertexBufferLayout &ASManager::GetDynamicVertexBufferLayout(uint32_t frameIndex) const
+{
+    return collectorDynamic[frameIndex]->GetVertexBufferLayout();
+}
+
 VkDescriptorSet ASManager::GetTLASDescSet(uint32_t frameIndex) const
 {
     // if TLAS wasn't built, return null
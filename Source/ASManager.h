@@ -23,6 +23,7 @@
 #include "ASBuilder.h"
 #include "CommandBufferManager.h"
 #include "GlobalUniform.h"
+#include "MeshManager.h"
 #include "ScratchBuffer.h"
 #include "TextureManager.h"
 #include "VertexBufferProperties.h"
@@ -32,14 +33,14 @@
 namespace RTGL1
 {
 
-struct ShVertPreprocessing;
 
 class ASManager
 {
 public:
     struct TLASPrepareResult
     {
-        VkAccelerationStructureInstanceKHR instances[45];
+        // static and dynamic filter groups, and rigid mesh instances
+        VkAccelerationStructureInstanceKHR instances[255];
         uint32_t instanceCount;
 
         bool IsEmpty() const
@@ -51,11 +52,14 @@ public:
 public:
     ASManager(VkDevice device, 
               std::shared_ptr<MemoryAllocator> allocator,
+              const std::shared_ptr<PhysicalDevice> &physDevice,
+              std::shared_ptr<FrameAllocator> frameAllocator,
               std::shared_ptr<CommandBufferManager> cmdManager,
               std::shared_ptr<TextureManager> textureManager,
               std::shared_ptr<GeomInfoManager> geomInfoManager,
               std::shared_ptr<TriangleInfoManager> triangleInfoMgr,
               std::shared_ptr<SectorVisibility> &_sectorVisibility,
+              std::shared_ptr<MeshManager> meshManager,
               const VertexBufferProperties &properties);
     ~ASManager();
 
@@ -69,15 +73,27 @@ public:
     uint32_t AddStaticGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info);
     // Submitting static geometry to the building is a heavy operation
     // with waiting for it to complete.
-    void SubmitStaticGeometry();
+    void SubmitStaticGeometry(uint32_t frameIndex);
     // If all the added geometries must be removed, call this function before submitting
     void ResetStaticGeometry();
 
     void BeginDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex);
-    uint32_t AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info);
+    // If pMesh is not null, vertex data is copied from it instead of the upload info
+    uint32_t AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, const ResidentMeshData *pMesh = nullptr);
+    // Copy collected dynamic geometry to device-local buffers,
+    // after that, vertices can be modified on GPU before SubmitDynamicGeometry
+    void CopyDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex);
     void SubmitDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex);
 
 
+    // Upload data of the created meshes and build their BLAS,
+    // must be called before copying dynamic geometry
+    void SubmitMeshes(VkCommandBuffer cmd, uint32_t frameIndex);
+    // Add a rigid instance of the mesh, that is traced through the mesh's BLAS with the instance's transform.
+    // Returns false, if there's no space for it in TLAS, then the instance should be copied as dynamic geometry.
+    bool AddMeshInstance(uint32_t frameIndex, const RgGeometryUploadInfo &info, RgMesh mesh, const ResidentMeshData &meshData);
+
+
     // Update transform for static movable geometry
     void UpdateStaticMovableTransform(uint32_t simpleIndex, const RgUpdateTransformInfo &updateInfo);
     // After updating transforms, acceleration structures should be rebuilt
@@ -97,7 +113,6 @@ public:
         uint32_t uniformData_rayCullMaskWorld,
         bool allowGeometryWithSkyFlag,
         bool isReflRefrAlphaTested,
-        ShVertPreprocessing *outPush,
         TLASPrepareResult *outResult) const;
     void BuildTLAS(
         VkCommandBuffer cmd, uint32_t frameIndex, 
@@ -114,16 +129,27 @@ public:
 
 
     VkDescriptorSet GetBuffersDescSet(uint32_t frameIndex) const;
+    const VertexBufferLayout &GetDynamicVertexBufferLayout(uint32_t frameIndex) const;
     VkDescriptorSet GetTLASDescSet(uint32_t frameIndex) const;
 
     VkDescriptorSetLayout GetBuffersDescSetLayout() const;
     VkDescriptorSetLayout GetTLASDescSetLayout() const;
 
+    // Current and peak sizes of geometry buffers
+    void GetBuffersStats(RgGeometryBuffersStats *pResult) const;
+
 private:
     void CreateDescriptors();
     void UpdateBufferDescriptors(uint32_t frameIndex);
     void UpdateASDescriptors(uint32_t frameIndex);
 
+    // Geometry buffers can be reallocated, so descriptors must be updated, if generation is changed
+    uint32_t GetBuffersGeneration() const;
+    void UpdateBufferDescriptorsIfChanged(uint32_t frameIndex);
+    void UpdateBuffersStats();
+
+    void ReservePreviousDynamicBuffers(uint32_t frameIndex, VkDeviceSize positionsSize, VkDeviceSize indicesSize);
+
     bool SetupBLAS(
         BLASComponent &as,
         const std::shared_ptr<VertexCollector> &vertCollector);
@@ -139,11 +165,20 @@ private:
         bool isReflRefrAlphaTested,
         VkAccelerationStructureInstanceKHR &instance);
 
+    // Set mask, custom index and hit group of an instance with geometries of the filter group
+    static bool SetupTLASInstanceFilter(
+        VertexCollectorFilterTypeFlags filter,
+        uint32_t rayCullMaskWorld, 
+        bool allowGeometryWithSkyFlag,
+        bool isReflRefrAlphaTested,
+        VkAccelerationStructureInstanceKHR &instance);
+
     static bool IsFastBuild(VertexCollectorFilterTypeFlags filter);
 
 private:
     VkDevice device;
     std::shared_ptr<MemoryAllocator> allocator;
+    uint32_t frameCount;
 
     VkFence staticCopyFence;
 
@@ -151,8 +186,14 @@ private:
     std::shared_ptr<VertexCollector> collectorStatic;
     std::shared_ptr<VertexCollector> collectorDynamic[MAX_FRAMES_IN_FLIGHT];
     // device-local buffer for storing previous info
-    Buffer previousDynamicPositions;
-    Buffer previousDynamicIndices;
+    std::shared_ptr<Buffer> previousDynamicPositions;
+    std::shared_ptr<Buffer> previousDynamicIndices;
+    uint32_t previousDynamicGeneration;
+    // replaced buffers that can be still in use by the frame with that index
+    std::vector<std::shared_ptr<Buffer>> buffersToDestroy[MAX_FRAMES_IN_FLIGHT];
+
+    uint32_t boundBuffersGeneration[MAX_FRAMES_IN_FLIGHT];
+    RgGeometryBuffersStats buffersStats;
 
     // building
     std::shared_ptr<ScratchBuffer> scratchBuffer;
@@ -162,6 +203,7 @@ private:
     std::shared_ptr<TextureManager> textureMgr;
     std::shared_ptr<GeomInfoManager> geomInfoMgr;
     std::shared_ptr<TriangleInfoManager> triangleInfoMgr;
+    std::shared_ptr<MeshManager> meshManager;
 
     std::vector<std::unique_ptr<BLASComponent>> allStaticBlas;
     std::vector<std::unique_ptr<BLASComponent>> allDynamicBlas[MAX_FRAMES_IN_FLIGHT];
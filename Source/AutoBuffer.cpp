@@ -37,6 +37,11 @@ RTGL1::AutoBuffer::~AutoBuffer()
 
 void RTGL1::AutoBuffer::Create(VkDeviceSize size, VkBufferUsageFlags usage, const std::string &debugName, uint32_t frameCount)
 {
+    if (frameCount == 0)
+    {
+        frameCount = allocator->GetFrameCount();
+    }
+
     assert(frameCount > 0 && frameCount <= MAX_FRAMES_IN_FLIGHT);
 
     const std::string debugNameStaging = debugName + " - staging";
@@ -74,6 +79,7 @@ void RTGL1::AutoBuffer::Destroy()
         }
 
         mapped[i] = nullptr;
+        dirty[i].Clear();
     }
 
     if (deviceLocal.IsInitted());
@@ -131,6 +137,46 @@ void RTGL1::AutoBuffer::CopyFromStaging(
         copyInfosCount, copyInfos);
 }
 
+void RTGL1::AutoBuffer::MarkDirty(uint32_t frameIndex, VkDeviceSize offset, VkDeviceSize size)
+{
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+    assert(offset + size <= deviceLocal.GetSize());
+
+    dirty[frameIndex].Add(offset, size);
+}
+
+bool RTGL1::AutoBuffer::CopyDirtyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, VkBufferMemoryBarrier *pOutBarrier)
+{
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    DirtyRegions &d = dirty[frameIndex];
+
+    if (d.IsEmpty())
+    {
+        return false;
+    }
+
+    const std::vector<VkBufferCopy> &copyInfos = d.GetCopyInfos();
+    CopyFromStaging(cmd, frameIndex, copyInfos.data(), static_cast<uint32_t>(copyInfos.size()));
+
+    if (pOutBarrier != nullptr)
+    {
+        VkBufferMemoryBarrier &b = *pOutBarrier;
+
+        b = {};
+        b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        b.buffer = deviceLocal.GetBuffer();
+        b.offset = d.GetLowerBound();
+        b.size = d.GetUpperBound() - d.GetLowerBound();
+    }
+
+    d.Clear();
+    return true;
+}
+
 void *RTGL1::AutoBuffer::GetMapped(uint32_t frameIndex)
 {
     assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
@@ -160,7 +206,7 @@ VkDeviceSize RTGL1::AutoBuffer::GetSize() const
 {
     for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        assert(deviceLocal.GetSize() == staging[i].GetSize());
+        assert(!staging[i].IsInitted() || deviceLocal.GetSize() == staging[i].GetSize());
     }
 
     return deviceLocal.GetSize();
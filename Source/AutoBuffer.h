@@ -21,6 +21,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "DirtyRegions.h"
 #include "MemoryAllocator.h"
 
 namespace RTGL1
@@ -40,14 +41,23 @@ public:
     AutoBuffer &operator=(const AutoBuffer &other) = delete;
     AutoBuffer &operator=(AutoBuffer &&other) noexcept = delete;
 
+    // If frameCount is 0, a staging buffer is created for each frame index.
     void Create(VkDeviceSize size, VkBufferUsageFlags usage,
                 const std::string &debugName,
-                uint32_t frameCount = MAX_FRAMES_IN_FLIGHT);
+                uint32_t frameCount = 0);
     void Destroy();
 
     void CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
     void CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, const VkBufferCopy *copyInfos, uint32_t copyInfosCount);
 
+    // Mark a region of the frame's staging buffer to be copied by CopyDirtyFromStaging
+    void MarkDirty(uint32_t frameIndex, VkDeviceSize offset, VkDeviceSize size);
+    // Copy only marked regions, close ones are merged. Marked regions are cleared.
+    // If pOutBarrier is not null, it's filled with a transfer-write barrier for the range
+    // that encloses all copied regions; dst access mask must be set by the caller.
+    // Returns false, if nothing was copied.
+    bool CopyDirtyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, VkBufferMemoryBarrier *pOutBarrier = nullptr);
+
     VkBuffer GetStaging(uint32_t frameIndex);
     void *GetMapped(uint32_t frameIndex);
 
@@ -63,6 +73,8 @@ private:
     Buffer deviceLocal;
 
     void *mapped[MAX_FRAMES_IN_FLIGHT];
+
+    DirtyRegions dirty[MAX_FRAMES_IN_FLIGHT];
 };
 
 }
\ No newline at end of file
@@ -189,7 +189,21 @@ RTGL1::FramebufferImageIndex RTGL1::Bloom::Apply(VkCommandBuffer cmd, uint32_t f
 
 void RTGL1::Bloom::OnShaderReload(const ShaderManager * shaderManager)
 {
-    DestroyPipelines();
+    for (VkPipeline &p : downsamplePipelines)
+    {
+        shaderManager->DestroyWhenUnused(p);
+    }
+
+    for (VkPipeline &p : upsamplePipelines)
+    {
+        shaderManager->DestroyWhenUnused(p);
+    }
+
+    for (VkPipeline &t : applyPipelines)
+    {
+        shaderManager->DestroyWhenUnused(t);
+    }
+
     CreatePipelines(shaderManager);
 }
 
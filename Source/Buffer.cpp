@@ -20,15 +20,17 @@
 
 #include "Buffer.h"
 
+#include "RgException.h"
+
 using namespace RTGL1;
 
 Buffer::Buffer()
     :
-    device(VK_NULL_HANDLE),
     buffer(VK_NULL_HANDLE),
-    memory(VK_NULL_HANDLE),
+    allocation(VK_NULL_HANDLE),
     address(0),
     size(0),
+    mappedData(nullptr),
     isMapped(false)
 {}
 
@@ -38,7 +40,7 @@ Buffer::~Buffer()
 }
 
 void Buffer::Init(
-    const std::shared_ptr<MemoryAllocator> &allocator,
+    const std::shared_ptr<MemoryAllocator> &_allocator,
     VkDeviceSize bsize, VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties, const char *debugName)
 {
@@ -48,9 +50,7 @@ void Buffer::Init(
         return;
     }
 
-    device = allocator->GetDevice();
-
-    VkResult r;
+    allocator = _allocator;
 
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -58,27 +58,21 @@ void Buffer::Init(
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    r = vkCreateBuffer(device, &bufferInfo, nullptr, &buffer);
-    VK_CHECKERROR(r);
-
-    VkMemoryRequirements memReq = {};
-    vkGetBufferMemoryRequirements(device, buffer, &memReq);
-
-    memory = allocator->AllocDedicated(memReq, properties, MemoryAllocator::AllocType::WITH_ADDRESS_QUERY, debugName);
+    buffer = allocator->CreateBuffer(&bufferInfo, properties, debugName, &allocation, &mappedData);
 
-    r = vkBindBufferMemory(device, buffer, memory, 0);
-    VK_CHECKERROR(r);
+    if (buffer == VK_NULL_HANDLE)
+    {
+        throw RgException(RG_GRAPHICS_API_ERROR, "Can't allocate memory for a buffer");
+    }
 
     if (bufferInfo.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
     {
         VkBufferDeviceAddressInfoKHR addrInfo = {};
         addrInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
         addrInfo.buffer = buffer;
-        address = vkGetBufferDeviceAddress(device, &addrInfo);
+        address = vkGetBufferDeviceAddress(allocator->GetDevice(), &addrInfo);
     }
 
-    SET_DEBUG_NAME(device, buffer, VK_OBJECT_TYPE_BUFFER, debugName);
-
     size = bsize;
 }
 
@@ -86,54 +80,46 @@ void Buffer::Destroy()
 {
     assert(!isMapped);
 
-    if (device == VK_NULL_HANDLE)
+    if (allocator == nullptr)
     {
         return;
     }
 
-    // memory is guaranteed to be dedicated
-    if (memory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, memory, nullptr);
-        memory = VK_NULL_HANDLE;
-    }
-
     if (buffer != VK_NULL_HANDLE)
     {
-        vkDestroyBuffer(device, buffer, nullptr);
+        allocator->DestroyBuffer(buffer, allocation);
         buffer = VK_NULL_HANDLE;
+        allocation = VK_NULL_HANDLE;
     }
 
+    mappedData = nullptr;
     address = 0;
     size = 0;
 }
 
 void *Buffer::Map()
 {
-    assert(device != VK_NULL_HANDLE);
+    assert(allocator != nullptr);
     assert(!isMapped);
-    assert(memory != VK_NULL_HANDLE && size > 0);
+    assert(allocation != VK_NULL_HANDLE && size > 0);
 
-    isMapped = true;
-    void *mapped;
-
-    VkResult r = vkMapMemory(device, memory, 0, size, 0, &mapped);
-    VK_CHECKERROR(r);
+    // only host visible buffers can be mapped
+    assert(mappedData != nullptr);
 
-    return mapped;
+    isMapped = true;
+    return mappedData;
 }
 
 void Buffer::Unmap()
 {
-    assert(device != VK_NULL_HANDLE);
+    assert(allocator != nullptr);
     assert(isMapped);
     isMapped = false;
-    vkUnmapMemory(device, memory);
 }
 
 bool Buffer::TryUnmap()
 {
-    assert(device != VK_NULL_HANDLE);
+    assert(allocator != nullptr);
 
     if (isMapped)
     {
@@ -152,8 +138,8 @@ VkBuffer Buffer::GetBuffer() const
 
 VkDeviceMemory Buffer::GetMemory() const
 {
-    assert(memory != VK_NULL_HANDLE);
-    return memory;
+    assert(allocation != VK_NULL_HANDLE);
+    return allocator->GetBufferMemory(allocation);
 }
 
 VkDeviceAddress Buffer::GetAddress() const
@@ -175,5 +161,5 @@ bool Buffer::IsMapped() const
 
 bool Buffer::IsInitted() const
 {
-    return buffer != VK_NULL_HANDLE && memory !=VK_NULL_HANDLE;
+    return buffer != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE;
 }
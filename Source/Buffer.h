@@ -32,7 +32,7 @@ public:
     Buffer();
     ~Buffer();
 
-    // Create VkBuffer, allocate memory and bind it
+    // Create VkBuffer and suballocate memory for it
     void Init(const std::shared_ptr<MemoryAllocator> &allocator,
               VkDeviceSize size, VkBufferUsageFlags usage,
               VkMemoryPropertyFlags properties, const char *debugName = nullptr);
@@ -44,6 +44,7 @@ public:
 
 
     VkBuffer GetBuffer() const;
+    // Memory is shared with other buffers, the buffer is bound at some offset
     VkDeviceMemory GetMemory() const;
     // To get address usage flags must contain VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
     VkDeviceAddress GetAddress() const;
@@ -52,13 +53,15 @@ public:
     bool IsInitted() const;
 
 protected:
-    VkDevice device;
+    std::shared_ptr<MemoryAllocator> allocator;
     VkBuffer buffer;
-    VkDeviceMemory memory;
+    VmaAllocation allocation;
     VkDeviceAddress address;
     VkDeviceSize size;
 
 private:
+    // host visible buffers are persistently mapped by the allocator
+    void *mappedData;
     bool isMapped;
 };
 
@@ -19,13 +19,20 @@
 // SOFTWARE.
 
 #include "CommandBufferManager.h"
+
+#include <algorithm>
+#include <thread>
+
 #include "Utils.h"
 
 using namespace RTGL1;
 
-CommandBufferManager::CommandBufferManager(VkDevice device, std::shared_ptr<Queues> queues) :
-    currentFrameIndex(MAX_FRAMES_IN_FLIGHT - 1)
+CommandBufferManager::CommandBufferManager(VkDevice device, std::shared_ptr<Queues> queues, uint32_t frameCount) :
+    currentFrameIndex(frameCount - 1),
+    secondaryThreadCount(std::clamp(std::thread::hardware_concurrency(), 1u, MAX_SECONDARY_THREAD_COUNT))
 {
+    assert(frameCount > 0 && frameCount <= MAX_FRAMES_IN_FLIGHT);
+
     this->device = device;
     this->queues = queues;
 
@@ -33,7 +40,7 @@ CommandBufferManager::CommandBufferManager(VkDevice device, std::shared_ptr<Queu
     cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     cmdPoolInfo.flags = 0;
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         VkResult r;
 
@@ -48,6 +55,13 @@ CommandBufferManager::CommandBufferManager(VkDevice device, std::shared_ptr<Queu
         cmdPoolInfo.queueFamilyIndex = queues->GetIndexTransfer();
         r = vkCreateCommandPool(device, &cmdPoolInfo, nullptr, &transferCmds[i].pool);
         VK_CHECKERROR(r);
+
+        for (uint32_t t = 0; t < secondaryThreadCount; t++)
+        {
+            cmdPoolInfo.queueFamilyIndex = queues->GetIndexGraphics();
+            r = vkCreateCommandPool(device, &cmdPoolInfo, nullptr, &secondaryGraphicsCmds[i][t].pool);
+            VK_CHECKERROR(r);
+        }
     }
 }
 
@@ -60,6 +74,11 @@ CommandBufferManager::~CommandBufferManager()
         vkDestroyCommandPool(device, graphicsCmds[i].pool, nullptr);
         vkDestroyCommandPool(device, computeCmds[i].pool, nullptr);
         vkDestroyCommandPool(device, transferCmds[i].pool, nullptr);
+
+        for (uint32_t t = 0; t < secondaryThreadCount; t++)
+        {
+            vkDestroyCommandPool(device, secondaryGraphicsCmds[i][t].pool, nullptr);
+        }
     }
 }
 
@@ -75,13 +94,17 @@ void CommandBufferManager::PrepareForFrame(uint32_t frameIndex)
     computeCmds[frameIndex].curCount = 0;
     transferCmds[frameIndex].curCount = 0;
 
+    for (uint32_t t = 0; t < secondaryThreadCount; t++)
+    {
+        vkResetCommandPool(device, secondaryGraphicsCmds[frameIndex][t].pool, 0);
+        secondaryGraphicsCmds[frameIndex][t].curCount = 0;
+    }
+
     currentFrameIndex = frameIndex;
 }
 
-VkCommandBuffer CommandBufferManager::StartCmd(uint32_t frameIndex, AllocatedCmds &allocated, VkQueue queue)
+VkCommandBuffer CommandBufferManager::AllocateCmd(AllocatedCmds &allocated, VkCommandBufferLevel level)
 {
-    VkResult r;
-
     uint32_t oldCount = allocated.cmds.size();
 
     // if not enough, allocate new buffers
@@ -92,21 +115,28 @@ VkCommandBuffer CommandBufferManager::StartCmd(uint32_t frameIndex, AllocatedCmd
         VkCommandBufferAllocateInfo allocInfo = {};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         allocInfo.commandPool = allocated.pool;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.level = level;
         allocInfo.commandBufferCount = cmdAllocStep;
 
-        r = vkAllocateCommandBuffers(device, &allocInfo, &allocated.cmds[oldCount]);
+        VkResult r = vkAllocateCommandBuffers(device, &allocInfo, &allocated.cmds[oldCount]);
         VK_CHECKERROR(r);
     }
 
     VkCommandBuffer cmd = allocated.cmds[allocated.curCount];
     allocated.curCount++;
 
+    return cmd;
+}
+
+VkCommandBuffer CommandBufferManager::StartCmd(uint32_t frameIndex, AllocatedCmds &allocated, VkQueue queue)
+{
+    VkCommandBuffer cmd = AllocateCmd(allocated, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    r = vkBeginCommandBuffer(cmd, &beginInfo);
+    VkResult r = vkBeginCommandBuffer(cmd, &beginInfo);
     VK_CHECKERROR(r);
 
     cmdQueues[frameIndex][cmd] = queue;
@@ -144,6 +174,41 @@ VkCommandBuffer CommandBufferManager::StartTransferCmd()
     return StartCmd(currentFrameIndex, transferCmds[currentFrameIndex], queues.lock()->GetTransfer());
 }
 
+VkCommandBuffer CommandBufferManager::StartSecondaryGraphicsCmd(uint32_t threadIndex, VkRenderPass renderPass, VkFramebuffer framebuffer)
+{
+    assert(threadIndex < secondaryThreadCount);
+
+    // only the pool of this thread index is accessed, so no synchronization is required
+    VkCommandBuffer cmd = AllocateCmd(secondaryGraphicsCmds[currentFrameIndex][threadIndex], VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = renderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = framebuffer;
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    VkResult r = vkBeginCommandBuffer(cmd, &beginInfo);
+    VK_CHECKERROR(r);
+
+    return cmd;
+}
+
+void CommandBufferManager::EndSecondaryCmd(VkCommandBuffer cmd)
+{
+    VkResult r = vkEndCommandBuffer(cmd);
+    VK_CHECKERROR(r);
+}
+
+uint32_t CommandBufferManager::GetSecondaryThreadCount() const
+{
+    return secondaryThreadCount;
+}
+
 void CommandBufferManager::Submit(VkCommandBuffer cmd, VkFence fence)
 {
     VkResult r = vkEndCommandBuffer(cmd);
@@ -32,7 +32,10 @@ namespace RTGL1
 class CommandBufferManager
 {
 public:
-    explicit CommandBufferManager(VkDevice device, std::shared_ptr<Queues> queues);
+    static constexpr uint32_t MAX_SECONDARY_THREAD_COUNT = 8;
+
+public:
+    explicit CommandBufferManager(VkDevice device, std::shared_ptr<Queues> queues, uint32_t frameCount);
     ~CommandBufferManager();
 
     CommandBufferManager(const CommandBufferManager& other) = delete;
@@ -49,6 +52,14 @@ public:
     // Start transfer command buffer for current frame index
     VkCommandBuffer StartTransferCmd();
 
+    // Start secondary graphics command buffer for current frame index that continues
+    // the given render pass. Each thread index has its own command pool, so calls
+    // from different threads are allowed, if their thread indices are different.
+    VkCommandBuffer StartSecondaryGraphicsCmd(uint32_t threadIndex, VkRenderPass renderPass, VkFramebuffer framebuffer);
+    void EndSecondaryCmd(VkCommandBuffer cmd);
+    // Count of thread indices that can be used for recording secondary command buffers
+    uint32_t GetSecondaryThreadCount() const;
+
     void Submit(VkCommandBuffer cmd, VkFence fence = VK_NULL_HANDLE);
     void Submit(VkCommandBuffer cmd, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStages, VkSemaphore signalSemaphore, VkFence fence);
 
@@ -68,6 +79,7 @@ private:
 
 private:
     VkCommandBuffer StartCmd(uint32_t frameIndex, AllocatedCmds &cmds, VkQueue queue);
+    VkCommandBuffer AllocateCmd(AllocatedCmds &cmds, VkCommandBufferLevel level);
 
 private:
     VkDevice device;
@@ -80,6 +92,9 @@ private:
     AllocatedCmds graphicsCmds[MAX_FRAMES_IN_FLIGHT];
     AllocatedCmds computeCmds[MAX_FRAMES_IN_FLIGHT];
     AllocatedCmds transferCmds[MAX_FRAMES_IN_FLIGHT];
+    // per-thread pools for secondary cmds
+    AllocatedCmds secondaryGraphicsCmds[MAX_FRAMES_IN_FLIGHT][MAX_SECONDARY_THREAD_COUNT];
+    uint32_t secondaryThreadCount;
 
     std::weak_ptr<Queues> queues;
     rgl::unordered_map<VkCommandBuffer, VkQueue> cmdQueues[MAX_FRAMES_IN_FLIGHT];
@@ -28,7 +28,16 @@
 namespace RTGL1
 {
 
-constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+// Upper bound for the count of frame indices, per-frame arrays have this size.
+// The actual count is chosen on instance creation, see MemoryAllocator::GetFrameCount.
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+// Frame indices are in [0, frameCount) and are used in a cyclic order
+inline uint32_t GetPrevFrameIndex(uint32_t frameIndex, uint32_t frameCount)
+{
+    assert(frameIndex < frameCount && frameCount <= MAX_FRAMES_IN_FLIGHT);
+    return (frameIndex + frameCount - 1) % frameCount;
+}
 
 #pragma region extension functions
 
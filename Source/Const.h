@@ -25,6 +25,9 @@ namespace RTGL1
 
 constexpr uint32_t      ALLOCATOR_BLOCK_SIZE_STAGING_TEXTURES   = 64 * 512 * 512 * 4;
 constexpr uint32_t      ALLOCATOR_BLOCK_SIZE_TEXTURES           = 64 * 512 * 512 * 4;
+constexpr uint32_t      ALLOCATOR_BLOCK_SIZE_BUFFERS            = 64 * 1024 * 1024;
+constexpr uint32_t      ALLOCATOR_BLOCK_SIZE_STAGING_BUFFERS    = 32 * 1024 * 1024;
+constexpr uint32_t      ALLOCATOR_BLOCK_SIZE_AS                 = 64 * 1024 * 1024;
 
 constexpr uint32_t      TEXTURE_FILE_PATH_MAX_LENGTH            = 512;
 constexpr uint32_t      TEXTURE_FILE_NAME_MAX_LENGTH            = 256;
@@ -35,6 +38,7 @@ constexpr uint32_t      TEXTURE_COUNT_MAX                       = 4096;
 constexpr uint32_t      EMPTY_TEXTURE_INDEX                     = 0;
 constexpr uint32_t      MATERIALS_MAX_LAYER_COUNT               = 3;
 constexpr uint32_t      TEXTURES_PER_MATERIAL_COUNT             = 3;
+constexpr uint32_t      NO_ANIMATED_MATERIAL_SLOT               = 0xFFFFFFFF;
 
 constexpr const char    *DEFAULT_TEXTURES_PATH                  = "";
 constexpr const char    *DEFAULT_TEXTURES_POSTFIXES[TEXTURES_PER_MATERIAL_COUNT] = { "", "_rme", "_n" };
@@ -20,6 +20,9 @@
 
 #pragma once
 
+#include <vector>
+
+#include "FrameAllocator.h"
 #include "Hashmap/robin_hood.h"
 
 namespace rgl
@@ -31,4 +34,8 @@ using unordered_map = robin_hood::unordered_map<Key, T>;
 template <typename Key>
 using unordered_set = robin_hood::unordered_set<Key>;
 
+// Must be constructed with a FrameStlAllocator and must not outlive the current frame
+template <typename T>
+using frame_vector = std::vector<T, RTGL1::FrameStlAllocator<T>>;
+
 }
\ No newline at end of file
@@ -49,7 +49,7 @@ RTGL1::CubemapManager::CubemapManager(
     overridenTexturePostfix = _overridenTexturePostfix != nullptr ? _overridenTexturePostfix : DEFAULT_TEXTURES_POSTFIXES[MATERIAL_COLOR_TEXTURE_INDEX];
 
     imageLoader = std::make_shared<ImageLoader>(std::move(_userFileLoad));
-    cubemapDesc = std::make_shared<TextureDescriptors>(device, samplerManager, MAX_CUBEMAP_COUNT, BINDING_CUBEMAPS);
+    cubemapDesc = std::make_shared<TextureDescriptors>(device, samplerManager, MAX_CUBEMAP_COUNT, BINDING_CUBEMAPS, allocator->GetFrameCount());
     cubemapUploader = std::make_shared<CubemapUploader>(device, allocator);
 
     VkCommandBuffer cmd = _cmdManager->StartGraphicsCmd();
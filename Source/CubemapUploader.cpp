@@ -21,7 +21,7 @@
 #include "CubemapUploader.h"
 
 RTGL1::CubemapUploader::CubemapUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator)
-    :TextureUploader(device, std::move(memAllocator))
+    :TextureUploader(device, std::move(memAllocator), nullptr)
 {}
 
 RTGL1::TextureUploader::UploadResult RTGL1::CubemapUploader::UploadImage(const UploadInfo &info)
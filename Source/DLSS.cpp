@@ -20,6 +20,7 @@
 
 #include "DLSS.h"
 
+#include <algorithm>
 #include <regex>
 
 #include "RTGL1/RTGL1.h"
@@ -56,7 +57,7 @@ RTGL1::DLSS::DLSS(
     isInitialized(false),
     pParams(nullptr),
     pDlssFeature(nullptr),
-    prevDlssFeatureValues{}
+    dlssFeatureValues{}
 {
     isInitialized = TryInit(_instance, _device, _physDevice, _pAppGuid, _enableDebug);
 
@@ -255,21 +256,33 @@ static NVSDK_NGX_PerfQuality_Value ToNGXPerfQuality(RgRenderResolutionMode mode)
     }
 }
 
-bool RTGL1::DLSS::AreSameDlssFeatureValues(const RenderResolutionHelper &renderResolution) const
+bool RTGL1::DLSS::IsDlssFeatureCompatible(const RenderResolutionHelper &renderResolution) const
 {
+    const ResolutionState maxState = renderResolution.GetMaxResolutionState();
+
+    // render size is passed as a sub-rectangle on each evaluation,
+    // so the feature is valid for any input that fits into its input extent
     return  
-        prevDlssFeatureValues.renderWidth    == renderResolution.Width() &&
-        prevDlssFeatureValues.renderHeight   == renderResolution.Height() &&
-        prevDlssFeatureValues.upscaledWidth  == renderResolution.UpscaledWidth() &&
-        prevDlssFeatureValues.upscaledHeight == renderResolution.UpscaledHeight();
+        maxState.renderWidth  <= dlssFeatureValues.renderWidth &&
+        maxState.renderHeight <= dlssFeatureValues.renderHeight &&
+        dlssFeatureValues.upscaledWidth  == renderResolution.UpscaledWidth() &&
+        dlssFeatureValues.upscaledHeight == renderResolution.UpscaledHeight();
 }
 
 void RTGL1::DLSS::SaveDlssFeatureValues(const RenderResolutionHelper &renderResolution)
 {
-    prevDlssFeatureValues.renderWidth = renderResolution.Width();
-    prevDlssFeatureValues.renderHeight = renderResolution.Height();
-    prevDlssFeatureValues.upscaledWidth = renderResolution.UpscaledWidth();
-    prevDlssFeatureValues.upscaledHeight = renderResolution.UpscaledHeight();
+    const ResolutionState maxState = renderResolution.GetMaxResolutionState();
+
+    // if only the output size is the same, keep the largest input extent,
+    // so switching between the render sizes doesn't recreate the feature
+    const bool sameOutput =
+        dlssFeatureValues.upscaledWidth  == renderResolution.UpscaledWidth() &&
+        dlssFeatureValues.upscaledHeight == renderResolution.UpscaledHeight();
+
+    dlssFeatureValues.renderWidth  = sameOutput ? std::max(dlssFeatureValues.renderWidth,  maxState.renderWidth)  : maxState.renderWidth;
+    dlssFeatureValues.renderHeight = sameOutput ? std::max(dlssFeatureValues.renderHeight, maxState.renderHeight) : maxState.renderHeight;
+    dlssFeatureValues.upscaledWidth = renderResolution.UpscaledWidth();
+    dlssFeatureValues.upscaledHeight = renderResolution.UpscaledHeight();
 }
 
 bool RTGL1::DLSS::ValidateDlssFeature(VkCommandBuffer cmd, const RenderResolutionHelper &renderResolution)
@@ -280,7 +293,7 @@ bool RTGL1::DLSS::ValidateDlssFeature(VkCommandBuffer cmd, const RenderResolutio
     }
 
 
-    if (AreSameDlssFeatureValues(renderResolution))
+    if (pDlssFeature != nullptr && IsDlssFeatureCompatible(renderResolution))
     {
         return true;
     }
@@ -294,10 +307,11 @@ bool RTGL1::DLSS::ValidateDlssFeature(VkCommandBuffer cmd, const RenderResolutio
 
 
     NVSDK_NGX_DLSS_Create_Params dlssParams = {};
-    dlssParams.Feature.InWidth = renderResolution.Width();
-    dlssParams.Feature.InHeight = renderResolution.Height();
-    dlssParams.Feature.InTargetWidth = renderResolution.UpscaledWidth();
-    dlssParams.Feature.InTargetHeight = renderResolution.UpscaledHeight();
+    // max input extent, the actual render size is set per evaluation
+    dlssParams.Feature.InWidth = dlssFeatureValues.renderWidth;
+    dlssParams.Feature.InHeight = dlssFeatureValues.renderHeight;
+    dlssParams.Feature.InTargetWidth = dlssFeatureValues.upscaledWidth;
+    dlssParams.Feature.InTargetHeight = dlssFeatureValues.upscaledHeight;
     // dlssParams.Feature.InPerfQualityValue = ToNGXPerfQuality(renderResolution.GetResolutionMode());
 
     int &dlssCreateFeatureFlags = dlssParams.InFeatureCreateFlags;
@@ -378,12 +392,14 @@ RTGL1::FramebufferImageIndex RTGL1::DLSS::Apply(VkCommandBuffer cmd, uint32_t fr
     NVSDK_NGX_Coordinates sourceOffset = { 0, 0 };
     NVSDK_NGX_Dimensions  sourceSize = { renderResolution.Width(),         renderResolution.Height()          };
     NVSDK_NGX_Dimensions  targetSize = { renderResolution.UpscaledWidth(), renderResolution.UpscaledHeight()  };
+    // render-size images can be larger than the source sub-rectangle
+    NVSDK_NGX_Dimensions  sourceImageSize = { framebuffers->GetAllocatedResolution().renderWidth, framebuffers->GetAllocatedResolution().renderHeight };
 
 
-    NVSDK_NGX_Resource_VK unresolvedColorResource   = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_FINAL,       sourceSize);
+    NVSDK_NGX_Resource_VK unresolvedColorResource   = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_FINAL,       sourceImageSize);
     NVSDK_NGX_Resource_VK resolvedColorResource     = ToNGXResource(framebuffers, frameIndex, outputImage,                    targetSize, true);
-    NVSDK_NGX_Resource_VK motionVectorsResource     = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_MOTION_DLSS, sourceSize);
-    NVSDK_NGX_Resource_VK depthResource             = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_DEPTH_DLSS,  sourceSize);
+    NVSDK_NGX_Resource_VK motionVectorsResource     = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_MOTION_DLSS, sourceImageSize);
+    NVSDK_NGX_Resource_VK depthResource             = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_DEPTH_DLSS,  sourceImageSize);
 
 
     NVSDK_NGX_VK_DLSS_Eval_Params evalParams = {};
@@ -487,7 +503,7 @@ std::vector<const char *> RTGL1::DLSS::GetDlssVulkanDeviceExtensions()
 #else 
 
 
-RTGL1::DLSS::DLSS(VkInstance _instance, VkDevice _device, VkPhysicalDevice _physDevice, const char *pAppGuid, bool _enableDebug) : device(_device),isInitialized(false), pParams(nullptr), pDlssFeature(nullptr), prevDlssFeatureValues{} { }
+RTGL1::DLSS::DLSS(VkInstance _instance, VkDevice _device, VkPhysicalDevice _physDevice, const char *pAppGuid, bool _enableDebug) : device(_device),isInitialized(false), pParams(nullptr), pDlssFeature(nullptr), dlssFeatureValues{} { }
 RTGL1::DLSS::~DLSS() { }
 
 RTGL1::FramebufferImageIndex RTGL1::DLSS::Apply(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<Framebuffers> &framebuffers, const RenderResolutionHelper &renderResolution, RgFloat2D jitterOffset)
@@ -507,7 +523,7 @@ bool RTGL1::DLSS::TryInit(VkInstance instance, VkDevice device, VkPhysicalDevice
 bool RTGL1::DLSS::CheckSupport() const { return false; }
 void RTGL1::DLSS::Destroy() { }
 void RTGL1::DLSS::DestroyDlssFeature() { }
-bool RTGL1::DLSS::AreSameDlssFeatureValues(const RenderResolutionHelper &renderResolution) const { return false; }
+bool RTGL1::DLSS::IsDlssFeatureCompatible(const RenderResolutionHelper &renderResolution) const { return false; }
 void RTGL1::DLSS::SaveDlssFeatureValues(const RenderResolutionHelper &renderResolution) { }
 bool RTGL1::DLSS::ValidateDlssFeature(VkCommandBuffer cmd, const RenderResolutionHelper &renderResolution) { return false; }
 
@@ -66,7 +66,9 @@ private:
     void DestroyDlssFeature();
     void Destroy();
 
-    bool AreSameDlssFeatureValues(const RenderResolutionHelper &renderResolution) const;
+    // Feature is recreated only if the output size is changed
+    // or if the render size exceeds the feature's input extent
+    bool IsDlssFeatureCompatible(const RenderResolutionHelper &renderResolution) const;
     void SaveDlssFeatureValues(const RenderResolutionHelper &renderResolution);
 
     bool ValidateDlssFeature(VkCommandBuffer cmd, const RenderResolutionHelper &renderResolution);
@@ -78,13 +80,14 @@ private:
     NVSDK_NGX_Parameter *pParams;
     NVSDK_NGX_Handle    *pDlssFeature;
 
-    struct PrevDlssFeatureValues
+    struct DlssFeatureValues
     {
+        // max input extent
         uint32_t renderWidth;
         uint32_t renderHeight;
         uint32_t upscaledWidth;
         uint32_t upscaledHeight;
-    } prevDlssFeatureValues;
+    } dlssFeatureValues;
 };
 
 }
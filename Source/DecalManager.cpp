@@ -20,8 +20,11 @@
 
 #include "DecalManager.h"
 
+#include <cmath>
+
 #include "CmdLabel.h"
 #include "Matrix.h"
+#include "RgException.h"
 #include "Generated/ShaderCommonC.h"
 
 
@@ -37,10 +40,12 @@ RTGL1::DecalManager::DecalManager(
     const std::shared_ptr<ShaderManager> &_shaderManager,
     const std::shared_ptr<GlobalUniform> &_uniform,
     std::shared_ptr<Framebuffers> _storageFramebuffers,
-    const std::shared_ptr<TextureManager> &_textureManager)
+    const std::shared_ptr<TextureManager> &_textureManager,
+    std::shared_ptr<SectorVisibility> _sectorVisibility)
 :
     device(_device),
     storageFramebuffers(std::move(_storageFramebuffers)),
+    sectorVisibility(std::move(_sectorVisibility)),
     decalCount(0),
     renderPass(VK_NULL_HANDLE),
     passFramebuffers{},
@@ -77,42 +82,213 @@ RTGL1::DecalManager::~DecalManager()
     DestroyPipelines();
 
     vkDestroyRenderPass(device, renderPass, nullptr);
-    DestroyFramebuffers();
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        DestroyFramebuffer(i);
+    }
 }
 
 void RTGL1::DecalManager::PrepareForFrame(uint32_t frameIndex)
 {
     decalCount = 0;
+    dynamicDecals.clear();
+}
+
+RTGL1::DecalManager::Decal RTGL1::DecalManager::MakeDecal(const RgTransform &transform, uint32_t material,
+                                                          const std::shared_ptr<TextureManager> &textureManager)
+{
+    Decal decal = {};
+    Matrix::ToMat4Transposed(decal.transform, transform);
+    // animated materials are resolved in shaders, so decals don't need to be updated on frame change
+    decal.textures = textureManager->GetGeometryMaterialTextures(material);
+    decal.material = material;
+
+    // decal box is a transformed [-0.5, 0.5] cube
+    float sqrLength = 0.0f;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        decal.center[i] = transform.matrix[i][3];
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            sqrLength += transform.matrix[i][j] * transform.matrix[i][j];
+        }
+    }
+
+    decal.radius = 0.5f * sqrtf(sqrLength);
+    decal.sector = SectorID{ 0 };
+
+    return decal;
 }
 
 void RTGL1::DecalManager::Upload(uint32_t frameIndex, const RgDecalUploadInfo &uploadInfo,
                                  const std::shared_ptr<TextureManager> &textureManager)
 {
-    if (decalCount >= DECAL_MAX_COUNT)
+    dynamicDecals.push_back(MakeDecal(uploadInfo.transform, uploadInfo.material, textureManager));
+}
+
+void RTGL1::DecalManager::UploadStatic(const RgStaticDecalUploadInfo &uploadInfo,
+                                       const std::shared_ptr<TextureManager> &textureManager)
+{
+    if (staticDecalIDToIndex.find(uploadInfo.uniqueID) != staticDecalIDToIndex.end())
     {
-        assert(0);
-        return;
+        throw RgException(RG_WRONG_ARGUMENT, "Static decal with ID=" + std::to_string(uploadInfo.uniqueID) + " already exists");
     }
 
-    const uint32_t decalIndex = decalCount;
-    decalCount++;
+    Decal decal = MakeDecal(uploadInfo.transform, uploadInfo.material, textureManager);
+    decal.sector = SectorID{ uploadInfo.sectorID };
 
-    const MaterialTextures mat = textureManager->GetMaterialTextures(uploadInfo.material);
+    staticDecalIDToIndex[uploadInfo.uniqueID] = (uint32_t)staticDecals.size();
+    staticDecals.push_back(decal);
+}
 
-    ShDecalInstance instance = {};
-    instance.textureAlbedoAlpha      = mat.indices[MATERIAL_ALBEDO_ALPHA_INDEX];
-    instance.textureRougnessMetallic = mat.indices[MATERIAL_ROUGHNESS_METALLIC_EMISSION_INDEX];
-    instance.textureNormals          = mat.indices[MATERIAL_NORMAL_INDEX];
-    Matrix::ToMat4Transposed(instance.transform, uploadInfo.transform);
+void RTGL1::DecalManager::RemoveStatic(uint64_t uniqueID)
+{
+    const auto found = staticDecalIDToIndex.find(uniqueID);
 
+    if (found == staticDecalIDToIndex.end())
     {
-        ShDecalInstance *dst = (ShDecalInstance *)instanceBuffer->GetMapped(frameIndex);
-        memcpy(&dst[decalIndex], &instance, sizeof(ShDecalInstance));
+        throw RgException(RG_WRONG_ARGUMENT, "Can't find static decal with ID=" + std::to_string(uniqueID));
     }
+
+    const uint32_t index = found->second;
+    const uint32_t last = (uint32_t)staticDecals.size() - 1;
+    staticDecalIDToIndex.erase(found);
+
+    // move the last decal to the place of the removed one
+    if (index != last)
+    {
+        staticDecals[index] = staticDecals[last];
+
+        for (auto &p : staticDecalIDToIndex)
+        {
+            if (p.second == last)
+            {
+                p.second = index;
+                break;
+            }
+        }
+    }
+
+    staticDecals.pop_back();
+}
+
+namespace
+{
+
+struct FrustumPlanes
+{
+    // Left, right, bottom, top. Near and far planes are ignored,
+    // as they depend on the depth range and the projection type.
+    float planes[4][4];
+};
+
+FrustumPlanes ExtractFrustumPlanes(const float *view, const float *projection)
+{
+    // column major
+    float viewProj[16];
+    RTGL1::Matrix::Multiply(viewProj, view, projection);
+
+    const auto row = [&viewProj] (int i, int k)
+    {
+        return viewProj[k * 4 + i];
+    };
+
+    FrustumPlanes f = {};
+
+    for (int k = 0; k < 4; k++)
+    {
+        f.planes[0][k] = row(3, k) + row(0, k);
+        f.planes[1][k] = row(3, k) - row(0, k);
+        f.planes[2][k] = row(3, k) + row(1, k);
+        f.planes[3][k] = row(3, k) - row(1, k);
+    }
+
+    for (auto &p : f.planes)
+    {
+        const float len = sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+
+        if (len > 0.0f)
+        {
+            p[0] /= len;
+            p[1] /= len;
+            p[2] /= len;
+            p[3] /= len;
+        }
+    }
+
+    return f;
 }
 
-void RTGL1::DecalManager::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
+bool IsSphereInFrustum(const FrustumPlanes &f, const float center[3], float radius)
 {
+    for (const auto &p : f.planes)
+    {
+        if (p[0] * center[0] + p[1] * center[1] + p[2] * center[2] + p[3] < -radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+void RTGL1::DecalManager::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex,
+                                         const std::shared_ptr<const GlobalUniform> &uniform,
+                                         const uint32_t *pCameraSectorID)
+{
+    assert(decalCount == 0);
+
+    const FrustumPlanes frustum = ExtractFrustumPlanes(uniform->GetData()->view, uniform->GetData()->projection);
+    ShDecalInstance *dst = (ShDecalInstance *)instanceBuffer->GetMapped(frameIndex);
+
+    const auto pack = [this, dst, &frustum] (const Decal &decal)
+    {
+        if (decalCount >= DECAL_MAX_COUNT)
+        {
+            return false;
+        }
+
+        if (!IsSphereInFrustum(frustum, decal.center, decal.radius))
+        {
+            return true;
+        }
+
+        ShDecalInstance &instance = dst[decalCount];
+        memcpy(instance.transform, decal.transform, sizeof(decal.transform));
+        instance.textureAlbedoAlpha      = decal.textures.indices[MATERIAL_ALBEDO_ALPHA_INDEX];
+        instance.textureRougnessMetallic = decal.textures.indices[MATERIAL_ROUGHNESS_METALLIC_EMISSION_INDEX];
+        instance.textureNormals          = decal.textures.indices[MATERIAL_NORMAL_INDEX];
+
+        decalCount++;
+        return true;
+    };
+
+    for (const Decal &decal : dynamicDecals)
+    {
+        if (!pack(decal))
+        {
+            break;
+        }
+    }
+
+    for (const Decal &decal : staticDecals)
+    {
+        if (pCameraSectorID != nullptr && !sectorVisibility->IsPotentiallyVisible(SectorID{ *pCameraSectorID }, decal.sector))
+        {
+            continue;
+        }
+
+        if (!pack(decal))
+        {
+            break;
+        }
+    }
+
     if (decalCount == 0)
     {
         return;
@@ -202,14 +378,26 @@ void RTGL1::DecalManager::Draw(VkCommandBuffer cmd, uint32_t frameIndex, const s
 
 void RTGL1::DecalManager::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroyPipelines();
+    shaderManager->DestroyWhenUnused(pipeline);
     CreatePipelines(shaderManager);
 }
 
-void RTGL1::DecalManager::OnFramebuffersSizeChange(const ResolutionState &resolutionState)
+void RTGL1::DecalManager::OnFramebuffersSizeChange(VkCommandBuffer cmd, uint32_t frameIndex, const ResolutionState &allocation)
+{
+    DestroyFramebuffer(frameIndex);
+    CreateFramebuffer(frameIndex, allocation.renderWidth, allocation.renderHeight);
+}
+
+void RTGL1::DecalManager::OnMaterialChange(uint32_t materialIndex, const MaterialTextures &newInfo)
 {
-    DestroyFramebuffers();
-    CreateFramebuffers(resolutionState.renderWidth, resolutionState.renderHeight);
+    // material changes are rare, and there are no other per-material structures for decals
+    for (Decal &decal : staticDecals)
+    {
+        if (decal.material == materialIndex)
+        {
+            decal.textures = newInfo;
+        }
+    }
 }
 
 void RTGL1::DecalManager::CreateRenderPass()
@@ -261,37 +449,31 @@ void RTGL1::DecalManager::CreateRenderPass()
     VK_CHECKERROR(r);
 }
 
-void RTGL1::DecalManager::CreateFramebuffers(uint32_t width, uint32_t height)
+void RTGL1::DecalManager::CreateFramebuffer(uint32_t frameIndex, uint32_t width, uint32_t height)
 {
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        assert(passFramebuffers[i] == VK_NULL_HANDLE);
+    assert(passFramebuffers[frameIndex] == VK_NULL_HANDLE);
 
-        VkImageView v = storageFramebuffers->GetImageView(FB_IMAGE_INDEX_ALBEDO, i);
+    VkImageView v = storageFramebuffers->GetImageView(FB_IMAGE_INDEX_ALBEDO, frameIndex);
 
-        VkFramebufferCreateInfo info = {};
-        info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        info.renderPass = renderPass;
-        info.attachmentCount = 1;
-        info.pAttachments = &v;
-        info.width = width;
-        info.height = height;
-        info.layers = 1;
+    VkFramebufferCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    info.renderPass = renderPass;
+    info.attachmentCount = 1;
+    info.pAttachments = &v;
+    info.width = width;
+    info.height = height;
+    info.layers = 1;
 
-        VkResult r = vkCreateFramebuffer(device, &info, nullptr, &passFramebuffers[i]);
-        VK_CHECKERROR(r);
-    }
+    VkResult r = vkCreateFramebuffer(device, &info, nullptr, &passFramebuffers[frameIndex]);
+    VK_CHECKERROR(r);
 }
 
-void RTGL1::DecalManager::DestroyFramebuffers()
+void RTGL1::DecalManager::DestroyFramebuffer(uint32_t frameIndex)
 {
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    if (passFramebuffers[frameIndex] != VK_NULL_HANDLE)
     {
-        if (passFramebuffers[i] != VK_NULL_HANDLE)
-        {
-            vkDestroyFramebuffer(device, passFramebuffers[i], nullptr);
-            passFramebuffers[i] = VK_NULL_HANDLE;
-        }
+        vkDestroyFramebuffer(device, passFramebuffers[frameIndex], nullptr);
+        passFramebuffers[frameIndex] = VK_NULL_HANDLE;
     }
 }
 
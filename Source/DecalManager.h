@@ -23,13 +23,15 @@
 #include "AutoBuffer.h"
 #include "Framebuffers.h"
 #include "GlobalUniform.h"
+#include "IMaterialDependency.h"
+#include "SectorVisibility.h"
 #include "ShaderManager.h"
 #include "TextureManager.h"
 
 namespace RTGL1
 {
 
-class DecalManager : public IShaderDependency, public IFramebuffersDependency
+class DecalManager : public IShaderDependency, public IFramebuffersDependency, public IMaterialDependency
 {
 public:
     DecalManager(VkDevice device,
@@ -37,7 +39,8 @@ public:
                  const std::shared_ptr<ShaderManager> &shaderManager,
                  const std::shared_ptr<GlobalUniform> &uniform,
                  std::shared_ptr<Framebuffers> _storageFramebuffers,
-                 const std::shared_ptr<TextureManager> &textureManager);
+                 const std::shared_ptr<TextureManager> &textureManager,
+                 std::shared_ptr<SectorVisibility> sectorVisibility);
     ~DecalManager() override;
 
     DecalManager(const DecalManager &other) = delete;
@@ -48,19 +51,41 @@ public:
     void PrepareForFrame(uint32_t frameIndex);
     void Upload(uint32_t frameIndex, const RgDecalUploadInfo &uploadInfo,
                 const std::shared_ptr<TextureManager> &textureManager);
-    void SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex);
+    void UploadStatic(const RgStaticDecalUploadInfo &uploadInfo,
+                      const std::shared_ptr<TextureManager> &textureManager);
+    void RemoveStatic(uint64_t uniqueID);
+    // Cull decals and copy visible ones to the instance buffer
+    void SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex,
+                        const std::shared_ptr<const GlobalUniform> &uniform,
+                        const uint32_t *pCameraSectorID);
     void Draw(VkCommandBuffer cmd, uint32_t frameIndex,
               const std::shared_ptr<GlobalUniform> &uniform,
               const std::shared_ptr<Framebuffers> &framebuffers,
               const std::shared_ptr<TextureManager> &textureManager);
 
     void OnShaderReload(const ShaderManager *shaderManager) override;
-    void OnFramebuffersSizeChange(const ResolutionState &resolutionState) override;
+    void OnFramebuffersSizeChange(VkCommandBuffer cmd, uint32_t frameIndex, const ResolutionState &allocation) override;
+    void OnMaterialChange(uint32_t materialIndex, const MaterialTextures &newInfo) override;
 
 private:
+    struct Decal
+    {
+        // Transposed, as in ShDecalInstance
+        float transform[16];
+        MaterialTextures textures;
+        uint32_t material;
+        // Bounding sphere: center and radius
+        float center[3];
+        float radius;
+        SectorID sector;
+    };
+
+    static Decal MakeDecal(const RgTransform &transform, uint32_t material,
+                           const std::shared_ptr<TextureManager> &textureManager);
+
     void CreateRenderPass();
-    void CreateFramebuffers(uint32_t width, uint32_t height);
-    void DestroyFramebuffers();
+    void CreateFramebuffer(uint32_t frameIndex, uint32_t width, uint32_t height);
+    void DestroyFramebuffer(uint32_t frameIndex);
     void CreatePipelineLayout(const VkDescriptorSetLayout *pSetLayouts, uint32_t setLayoutCount);
     void CreatePipelines(const ShaderManager *shaderManager);
     void DestroyPipelines();
@@ -70,7 +95,15 @@ private:
     VkDevice device;
     std::shared_ptr<Framebuffers> storageFramebuffers;
 
+    std::shared_ptr<SectorVisibility> sectorVisibility;
+
+    std::vector<Decal> staticDecals;
+    rgl::unordered_map<uint64_t, uint32_t> staticDecalIDToIndex;
+    // Uploaded in the current frame
+    std::vector<Decal> dynamicDecals;
+
     std::unique_ptr<AutoBuffer> instanceBuffer;
+    // Count of visible decals in the instance buffer
     uint32_t decalCount;
 
     VkRenderPass renderPass;
@@ -37,6 +37,7 @@ RTGL1::Denoiser::Denoiser(
     pipelineLayout(VK_NULL_HANDLE),
     pipelineVerticesLayout(VK_NULL_HANDLE),
     merging(VK_NULL_HANDLE),
+    indirectReconstruction(VK_NULL_HANDLE),
     gradientSamples(VK_NULL_HANDLE),
     gradientAtrous{},
     temporalAccumulation(VK_NULL_HANDLE),
@@ -126,6 +127,50 @@ void RTGL1::Denoiser::MergeSamples(
 #endif // GRADIENT_ESTIMATION_ENABLED 
 }
 
+void RTGL1::Denoiser::ReconstructIndirect(
+    VkCommandBuffer cmd, uint32_t frameIndex,
+    const std::shared_ptr<const GlobalUniform> &uniform)
+{
+    if (uniform->GetData()->indirectIlluminationMode == INDIRECT_ILLUMINATION_MODE_FULL)
+    {
+        return;
+    }
+
+    typedef FramebufferImageIndex FI;
+
+    CmdLabel label(cmd, "Indirect reconstruction");
+
+
+    // bind desc sets
+    VkDescriptorSet sets[] =
+    {
+        framebuffers->GetDescSet(frameIndex),
+        uniform->GetDescSet(frameIndex)
+    };
+
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                        pipelineLayout,
+                        0, std::size(sets), sets,
+                        0, nullptr);
+
+    uint32_t wgCountX = Utils::GetWorkGroupCount(uniform->GetData()->renderWidth, COMPUTE_INDIRECT_RECONSTRUCT_GROUP_SIZE_X);
+    uint32_t wgCountY = Utils::GetWorkGroupCount(uniform->GetData()->renderHeight, COMPUTE_INDIRECT_RECONSTRUCT_GROUP_SIZE_Y);
+
+    FI fs[] =
+    {
+        FI::FB_IMAGE_INDEX_UNFILTERED_SPECULAR,
+        FI::FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_R,
+        FI::FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_G,
+        FI::FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_B,
+        FI::FB_IMAGE_INDEX_UNFILTERED_INDIRECT_SPECULAR,
+        FI::FB_IMAGE_INDEX_VIEW_DIRECTION,
+    };
+    framebuffers->BarrierMultiple(cmd, frameIndex, fs);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, indirectReconstruction);
+    vkCmdDispatch(cmd, wgCountX, wgCountY, 1);
+}
+
 void RTGL1::Denoiser::Denoise(
     VkCommandBuffer cmd, uint32_t frameIndex,
     const std::shared_ptr<const GlobalUniform> &uniform)
@@ -337,7 +382,22 @@ void RTGL1::Denoiser::Denoise(
 
 void RTGL1::Denoiser::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroyPipelines();
+    shaderManager->DestroyWhenUnused(merging);
+    shaderManager->DestroyWhenUnused(indirectReconstruction);
+    shaderManager->DestroyWhenUnused(gradientSamples);
+    shaderManager->DestroyWhenUnused(temporalAccumulation);
+    shaderManager->DestroyWhenUnused(varianceEstimation);
+
+    for (VkPipeline &p : gradientAtrous)
+    {
+        shaderManager->DestroyWhenUnused(p);
+    }
+
+    for (VkPipeline &p : atrous)
+    {
+        shaderManager->DestroyWhenUnused(p);
+    }
+
     CreatePipelines(shaderManager);
 }
 
@@ -370,6 +430,7 @@ void RTGL1::Denoiser::CreatePipelineLayout(VkDescriptorSetLayout*pSetLayouts, ui
 void RTGL1::Denoiser::DestroyPipelines()
 {
     vkDestroyPipeline(device, merging, nullptr);
+    vkDestroyPipeline(device, indirectReconstruction, nullptr);
     vkDestroyPipeline(device, gradientSamples, nullptr);
     vkDestroyPipeline(device, temporalAccumulation, nullptr);
     vkDestroyPipeline(device, varianceEstimation, nullptr);
@@ -387,6 +448,7 @@ void RTGL1::Denoiser::DestroyPipelines()
     }
 
     merging = VK_NULL_HANDLE;
+    indirectReconstruction = VK_NULL_HANDLE;
     gradientSamples = VK_NULL_HANDLE;
     temporalAccumulation = VK_NULL_HANDLE;
     varianceEstimation = VK_NULL_HANDLE;
@@ -425,6 +487,15 @@ void RTGL1::Denoiser::CreatePipelines(const ShaderManager *shaderManager)
     plInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     plInfo.layout = pipelineLayout;
 
+    {
+        plInfo.stage = shaderManager->GetStageInfo("CIndirectReconstruct");
+
+        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &indirectReconstruction);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, indirectReconstruction, VK_OBJECT_TYPE_PIPELINE, "Indirect reconstruction pipeline");
+    }
+
     {
         plInfo.stage = shaderManager->GetStageInfo("CASVGFGradientSamples");
 
@@ -49,6 +49,12 @@ public:
         const std::shared_ptr<const GlobalUniform> &uniform,
         const std::shared_ptr<const ASManager> &asManager);
 
+    // If indirect illumination was traced only for a pattern of pixels,
+    // fill the rest from the traced neighbors
+    void ReconstructIndirect(
+        VkCommandBuffer cmd, uint32_t frameIndex,
+        const std::shared_ptr<const GlobalUniform> &uniform);
+
     void Denoise(
         VkCommandBuffer cmd, uint32_t frameIndex,
         const std::shared_ptr<const GlobalUniform> &uniform);
@@ -70,6 +76,7 @@ private:
     VkPipelineLayout pipelineVerticesLayout;
 
     VkPipeline merging;
+    VkPipeline indirectReconstruction;
     VkPipeline gradientSamples;
     VkPipeline gradientAtrous[4];
 
@@ -48,7 +48,10 @@ RTGL1::DepthCopying::~DepthCopying()
     vkDestroyPipeline(device, pipeline, nullptr);
     vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
 
-    DestroyFramebuffers();
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        DestroyFramebuffer(i);
+    }
 }
 
 void RTGL1::DepthCopying::Process(VkCommandBuffer cmd, uint32_t frameIndex, 
@@ -114,8 +117,7 @@ void RTGL1::DepthCopying::Process(VkCommandBuffer cmd, uint32_t frameIndex,
 
 void RTGL1::DepthCopying::OnShaderReload(const ShaderManager *shaderManager)
 {
-    vkDestroyPipeline(device, pipeline, nullptr);
-    pipeline = VK_NULL_HANDLE;
+    shaderManager->DestroyWhenUnused(pipeline);
 
     CreatePipeline(shaderManager);
 }
@@ -166,37 +168,30 @@ void RTGL1::DepthCopying::CreateRenderPass(VkFormat depthFormat)
     SET_DEBUG_NAME(device, renderPass, VK_OBJECT_TYPE_RENDER_PASS, "Depth copying render pass");
 }
 
-void RTGL1::DepthCopying::CreateFramebuffers(VkImageView pDepthAttchViews[MAX_FRAMES_IN_FLIGHT], uint32_t width, uint32_t height)
+void RTGL1::DepthCopying::CreateFramebuffer(uint32_t frameIndex, VkImageView depthAttchView, uint32_t width, uint32_t height)
 {
     assert(renderPass);
-
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        assert(framebuffers[i] == VK_NULL_HANDLE);
-
-        VkFramebufferCreateInfo fbInfo = {};
-        fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        fbInfo.renderPass = renderPass;
-        fbInfo.attachmentCount = 1;
-        fbInfo.pAttachments = &pDepthAttchViews[i];
-        fbInfo.width = width;
-        fbInfo.height = height;
-        fbInfo.layers = 1;
-
-        VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &framebuffers[i]);
-        VK_CHECKERROR(r);
-    }
+    assert(framebuffers[frameIndex] == VK_NULL_HANDLE);
+
+    VkFramebufferCreateInfo fbInfo = {};
+    fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbInfo.renderPass = renderPass;
+    fbInfo.attachmentCount = 1;
+    fbInfo.pAttachments = &depthAttchView;
+    fbInfo.width = width;
+    fbInfo.height = height;
+    fbInfo.layers = 1;
+
+    VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &framebuffers[frameIndex]);
+    VK_CHECKERROR(r);
 }
 
-void RTGL1::DepthCopying::DestroyFramebuffers()
+void RTGL1::DepthCopying::DestroyFramebuffer(uint32_t frameIndex)
 {
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    if (framebuffers[frameIndex] != VK_NULL_HANDLE)
     {
-        if (framebuffers[i] != VK_NULL_HANDLE)
-        {
-            vkDestroyFramebuffer(device, framebuffers[i], nullptr);
-            framebuffers[i] = VK_NULL_HANDLE;
-        }
+        vkDestroyFramebuffer(device, framebuffers[frameIndex], nullptr);
+        framebuffers[frameIndex] = VK_NULL_HANDLE;
     }
 }
 
@@ -49,8 +49,8 @@ public:
                  uint32_t width, uint32_t height,
                  bool justClear);
 
-    void CreateFramebuffers(VkImageView pDepthAttchViews[MAX_FRAMES_IN_FLIGHT], uint32_t width, uint32_t height);
-    void DestroyFramebuffers();
+    void CreateFramebuffer(uint32_t frameIndex, VkImageView depthAttchView, uint32_t width, uint32_t height);
+    void DestroyFramebuffer(uint32_t frameIndex);
 
     void OnShaderReload(const ShaderManager *shaderManager);
 
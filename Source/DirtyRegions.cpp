@@ -0,0 +1,145 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "DirtyRegions.h"
+
+#include <algorithm>
+
+RTGL1::DirtyRegions::DirtyRegions(VkDeviceSize _mergeGap)
+:
+    mergeGap(_mergeGap),
+    isSorted(true),
+    isCoalesced(true),
+    lowerBound(UINT64_MAX),
+    upperBound(0)
+{}
+
+void RTGL1::DirtyRegions::Add(VkDeviceSize offset, VkDeviceSize size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    const VkDeviceSize end = offset + size;
+
+    lowerBound = std::min(lowerBound, offset);
+    upperBound = std::max(upperBound, end);
+
+    if (!regions.empty())
+    {
+        VkBufferCopy &last = regions.back();
+        const VkDeviceSize lastEnd = last.srcOffset + last.size;
+
+        // fast path: most of the writes are sequential,
+        // so just extend the last region
+        if (offset >= last.srcOffset && offset <= lastEnd + mergeGap)
+        {
+            last.size = std::max(lastEnd, end) - last.srcOffset;
+            return;
+        }
+
+        if (offset < last.srcOffset)
+        {
+            isSorted = false;
+        }
+    }
+
+    VkBufferCopy r = {};
+    r.srcOffset = offset;
+    r.dstOffset = offset;
+    r.size = size;
+
+    regions.push_back(r);
+    isCoalesced = false;
+}
+
+void RTGL1::DirtyRegions::Clear()
+{
+    regions.clear();
+    isSorted = true;
+    isCoalesced = true;
+    lowerBound = UINT64_MAX;
+    upperBound = 0;
+}
+
+bool RTGL1::DirtyRegions::IsEmpty() const
+{
+    return regions.empty();
+}
+
+const std::vector<VkBufferCopy> &RTGL1::DirtyRegions::GetCopyInfos()
+{
+    if (!isCoalesced)
+    {
+        Coalesce();
+    }
+
+    return regions;
+}
+
+void RTGL1::DirtyRegions::Coalesce()
+{
+    if (!isSorted)
+    {
+        std::sort(regions.begin(), regions.end(), [] (const VkBufferCopy &a, const VkBufferCopy &b)
+        {
+            return a.srcOffset < b.srcOffset;
+        });
+    }
+
+    size_t dst = 0;
+
+    for (size_t src = 1; src < regions.size(); src++)
+    {
+        VkBufferCopy &cur = regions[dst];
+        const VkBufferCopy &next = regions[src];
+
+        const VkDeviceSize curEnd = cur.srcOffset + cur.size;
+
+        if (next.srcOffset <= curEnd + mergeGap)
+        {
+            cur.size = std::max(curEnd, next.srcOffset + next.size) - cur.srcOffset;
+        }
+        else
+        {
+            dst++;
+            regions[dst] = next;
+        }
+    }
+
+    if (!regions.empty())
+    {
+        regions.resize(dst + 1);
+    }
+
+    isSorted = true;
+    isCoalesced = true;
+}
+
+VkDeviceSize RTGL1::DirtyRegions::GetLowerBound() const
+{
+    return regions.empty() ? 0 : lowerBound;
+}
+
+VkDeviceSize RTGL1::DirtyRegions::GetUpperBound() const
+{
+    return regions.empty() ? 0 : upperBound;
+}
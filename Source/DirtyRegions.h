@@ -0,0 +1,76 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "Common.h"
+
+namespace RTGL1
+{
+
+// Set of byte ranges that were modified in a staging buffer and need to be
+// copied to a device local one. Ranges that overlap or are closer than
+// the gap threshold are merged into one, so the resulting copy list is minimal.
+class DirtyRegions
+{
+public:
+    // Copying a small gap is cheaper than an additional copy region
+    static constexpr VkDeviceSize DEFAULT_MERGE_GAP = 256;
+
+public:
+    explicit DirtyRegions(VkDeviceSize mergeGap = DEFAULT_MERGE_GAP);
+    ~DirtyRegions() = default;
+
+    DirtyRegions(const DirtyRegions &other) = default;
+    DirtyRegions(DirtyRegions &&other) noexcept = default;
+    DirtyRegions &operator=(const DirtyRegions &other) = default;
+    DirtyRegions &operator=(DirtyRegions &&other) noexcept = default;
+
+    void Add(VkDeviceSize offset, VkDeviceSize size);
+    void Clear();
+
+    bool IsEmpty() const;
+
+    // Sort and merge added ranges. Returned copy infos have the same
+    // source and destination offsets, and are valid until next Add() or Clear().
+    const std::vector<VkBufferCopy> &GetCopyInfos();
+
+    // Bounds of all added ranges
+    VkDeviceSize GetLowerBound() const;
+    VkDeviceSize GetUpperBound() const;
+
+private:
+    void Coalesce();
+
+private:
+    VkDeviceSize mergeGap;
+
+    // capacity is kept between frames to not reallocate
+    std::vector<VkBufferCopy> regions;
+    bool isSorted;
+    bool isCoalesced;
+
+    VkDeviceSize lowerBound;
+    VkDeviceSize upperBound;
+};
+
+}
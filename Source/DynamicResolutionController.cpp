@@ -0,0 +1,173 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "DynamicResolutionController.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+
+namespace
+{
+constexpr float KP = 0.5f;
+constexpr float KI = 0.05f;
+constexpr float KD = 0.1f;
+constexpr float INTEGRAL_LIMIT = 4.0f;
+
+// weight of a new measurement in the filtered GPU time
+constexpr float TIME_SMOOTHING = 0.25f;
+
+// relative GPU time error that is considered to be at the target;
+// must be larger than the time change of a single scale step near the target,
+// otherwise the scale would cycle between two neighbouring steps
+constexpr float ERROR_DEADBAND = 0.08f;
+// don't change the scale, if a change is less than this
+constexpr float HYSTERESIS_SCALE_DELTA = 0.04f;
+// let the previous change take effect, as measurements are late by the frames in flight
+constexpr uint32_t MIN_FRAMES_BETWEEN_CHANGES = 8;
+// scale is rounded to this step, to get the same sizes for close values
+constexpr float SCALE_STEP = 0.01f;
+
+constexpr float SCALE_LOWEST = 0.1f;
+}
+
+RTGL1::DynamicResolutionController::DynamicResolutionController()
+{
+    Reset();
+}
+
+void RTGL1::DynamicResolutionController::Reset()
+{
+    scale = 1.0f;
+    std::fill(std::begin(costHistoryMs), std::end(costHistoryMs), 0.0f);
+    costHistoryCount = 0;
+    filteredCostMs = 0.0f;
+    integral = 0.0f;
+    prevError = 0.0f;
+    framesSinceChange = 0;
+    hasHistory = false;
+}
+
+void RTGL1::DynamicResolutionController::ClampBounds(float &minScale, float &maxScale) const
+{
+    minScale = std::clamp(minScale, SCALE_LOWEST, 1.0f);
+    maxScale = std::clamp(maxScale, minScale, 1.0f);
+}
+
+float RTGL1::DynamicResolutionController::GetMedianCost() const
+{
+    assert(costHistoryCount > 0);
+
+    const uint32_t count = std::min(costHistoryCount, COST_HISTORY_SIZE);
+
+    float sorted[COST_HISTORY_SIZE];
+    std::copy(costHistoryMs, costHistoryMs + count, sorted);
+    std::nth_element(sorted, sorted + count / 2, sorted + count);
+
+    return sorted[count / 2];
+}
+
+float RTGL1::DynamicResolutionController::GetScale(float minScale, float maxScale)
+{
+    ClampBounds(minScale, maxScale);
+    scale = std::clamp(scale, minScale, maxScale);
+
+    return scale;
+}
+
+float RTGL1::DynamicResolutionController::GetMaxScale(float minScale, float maxScale) const
+{
+    ClampBounds(minScale, maxScale);
+    return maxScale;
+}
+
+float RTGL1::DynamicResolutionController::Update(float gpuTimeMs, float measuredScale, float targetTimeMs, float minScale, float maxScale)
+{
+    assert(targetTimeMs > 0.0f);
+
+    if (gpuTimeMs < 0.0f || measuredScale <= 0.0f || targetTimeMs <= 0.0f)
+    {
+        return GetScale(minScale, maxScale);
+    }
+
+    ClampBounds(minScale, maxScale);
+    scale = std::clamp(scale, minScale, maxScale);
+
+
+    // cost of the scaled passes is roughly proportional to the pixel count,
+    // so keep the history as if the frames were rendered with scale 1.0
+    costHistoryMs[costHistoryCount % COST_HISTORY_SIZE] = gpuTimeMs / (measuredScale * measuredScale);
+    costHistoryCount++;
+
+    const float medianCostMs = GetMedianCost();
+
+    filteredCostMs = hasHistory ? 
+        filteredCostMs + TIME_SMOOTHING * (medianCostMs - filteredCostMs) : 
+        medianCostMs;
+
+    const float estimatedMs = filteredCostMs * scale * scale;
+
+
+    // positive, if there's a headroom
+    const float error = (targetTimeMs - estimatedMs) / targetTimeMs;
+    const float derivative = hasHistory ? error - prevError : 0.0f;
+
+    prevError = error;
+    hasHistory = true;
+    framesSinceChange++;
+
+    // close enough: don't accumulate a steady-state error that is less than a scale step
+    if (std::abs(error) < ERROR_DEADBAND)
+    {
+        integral = 0.0f;
+        return scale;
+    }
+
+    const float newIntegral = std::clamp(integral + error, -INTEGRAL_LIMIT, INTEGRAL_LIMIT);
+
+
+    // relative change of the pixel count
+    const float u = KP * error + KI * newIntegral + KD * derivative;
+
+    const float unclamped = scale * std::sqrt(std::max(0.1f, 1.0f + u));
+    float newScale = std::clamp(unclamped, minScale, maxScale);
+
+    // don't accumulate, if the bounds don't allow to react anyway
+    if (newScale == unclamped)
+    {
+        integral = newIntegral;
+    }
+
+
+    if (framesSinceChange < MIN_FRAMES_BETWEEN_CHANGES ||
+        std::abs(newScale - scale) < HYSTERESIS_SCALE_DELTA)
+    {
+        return scale;
+    }
+
+    newScale = std::round(newScale / SCALE_STEP) * SCALE_STEP;
+    newScale = std::clamp(newScale, minScale, maxScale);
+
+    scale = newScale;
+    framesSinceChange = 0;
+
+    return scale;
+}
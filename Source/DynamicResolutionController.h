@@ -0,0 +1,74 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+namespace RTGL1
+{
+
+// Chooses a render resolution scale to keep GPU time of the scaled passes
+// near the target. It's a PID controller over a relative pixel count change,
+// with a hysteresis, so framebuffers are not resized on each small fluctuation.
+// Single-frame spikes are rejected by a median over the last measurements.
+// Doesn't depend on Vulkan, so it can be fed with synthetic timings.
+class DynamicResolutionController
+{
+public:
+    DynamicResolutionController();
+    ~DynamicResolutionController() = default;
+
+    DynamicResolutionController(const DynamicResolutionController &other) = delete;
+    DynamicResolutionController(DynamicResolutionController &&other) noexcept = delete;
+    DynamicResolutionController &operator=(const DynamicResolutionController &other) = delete;
+    DynamicResolutionController &operator=(DynamicResolutionController &&other) noexcept = delete;
+
+    // "gpuTimeMs" was measured on a frame that was rendered with "measuredScale",
+    // it can be different from the current scale, as measurements have a latency.
+    // Returns a scale for the next frame.
+    float Update(float gpuTimeMs, float measuredScale, float targetTimeMs, float minScale, float maxScale);
+    // Current scale, clamped to the bounds. Use, if there's no new measurement.
+    float GetScale(float minScale, float maxScale);
+    // Upper bound of the scale, after clamping the bounds
+    float GetMaxScale(float minScale, float maxScale) const;
+    void Reset();
+
+private:
+    void ClampBounds(float &minScale, float &maxScale) const;
+    float GetMedianCost() const;
+
+private:
+    static constexpr uint32_t COST_HISTORY_SIZE = 5;
+
+private:
+    float scale;
+    // GPU time of the last frames, as if they were rendered with scale 1.0
+    float costHistoryMs[COST_HISTORY_SIZE];
+    uint32_t costHistoryCount;
+    // estimated GPU time with scale 1.0
+    float filteredCostMs;
+    float integral;
+    float prevError;
+    uint32_t framesSinceChange;
+    bool hasHistory;
+};
+
+}
@@ -35,7 +35,11 @@ RTGL1::EffectBase::~EffectBase()
 
 void RTGL1::EffectBase::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroyPipelines();
+    for (VkPipeline &t : pipelines)
+    {
+        shaderManager->DestroyWhenUnused(t);
+    }
+
     CreatePipelines(shaderManager);
 }
 
@@ -25,28 +25,20 @@
 namespace RTGL1
 {
 
-template<typename PUSH_CONST>
-struct EffectSimple : public EffectBase
+struct EffectSimpleTransition
 {
-    explicit EffectSimple(
-        VkDevice device, const char *pShaderName,
-        const std::shared_ptr<const Framebuffers> &framebuffers,
-        const std::shared_ptr<const GlobalUniform> &uniform,
-        const std::shared_ptr<const ShaderManager> &shaderManager)
-    :
-        EffectBase(device),
-        push{},
-        isCurrentlyActive(false),
-        shaderName(pShaderName)
-    {
-        VkDescriptorSetLayout setLayouts[] =
-        {
-            framebuffers->GetDescSetLayout(),
-            uniform->GetDescSetLayout(),
-        };
+    uint32_t transitionType; // 0 - in, 1 - out
+    float transitionBeginTime;
+    float transitionDuration;
+};
 
-        InitBase(shaderManager, setLayouts, push);
-    }
+
+// Activity and transition state of an effect, without any GPU resources.
+// Used directly by effects that are fused into EffectSimpleChain.
+template<typename PUSH_CONST>
+struct EffectSimpleParams
+{
+    EffectSimpleParams() : push{}, isCurrentlyActive(false) {}
 
 protected:
     bool SetupNull()
@@ -63,21 +55,71 @@ protected:
         // if to start
         if (!wasActivePreviously && isCurrentlyActive)
         {
-            push.transitionType = 0;
-            push.transitionBeginTime = args.currentTime;
-            push.transitionDuration = transitionDurationIn;
+            push.transition.transitionType = 0;
+            push.transition.transitionBeginTime = args.currentTime;
+            push.transition.transitionDuration = transitionDurationIn;
         }
         // if to end
         else if (wasActivePreviously && !isCurrentlyActive)
         {
-            push.transitionType = 1;
-            push.transitionBeginTime = args.currentTime;
-            push.transitionDuration = transitionDurationOut;
+            push.transition.transitionType = 1;
+            push.transition.transitionBeginTime = args.currentTime;
+            push.transition.transitionDuration = transitionDurationOut;
         }
 
         return
             isCurrentlyActive ||
-            (push.transitionType == 1 && args.currentTime - push.transitionBeginTime <= push.transitionDuration);
+            (push.transition.transitionType == 1 && args.currentTime - push.transition.transitionBeginTime <= push.transition.transitionDuration);
+    }
+
+public:
+    const EffectSimpleTransition &GetTransition() const
+    {
+        return push.transition;
+    }
+
+    const PUSH_CONST &GetCustom() const
+    {
+        return push.custom;
+    }
+
+protected:
+    // Can be changed by child classes
+    PUSH_CONST &GetPush()
+    {
+        return push.custom;
+    }
+
+protected:
+    struct
+    {
+        EffectSimpleTransition transition;
+        PUSH_CONST custom;
+    } push;
+private:
+    bool isCurrentlyActive;
+};
+
+
+template<typename PUSH_CONST>
+struct EffectSimple : public EffectBase, public EffectSimpleParams<PUSH_CONST>
+{
+    explicit EffectSimple(
+        VkDevice device, const char *pShaderName,
+        const std::shared_ptr<const Framebuffers> &framebuffers,
+        const std::shared_ptr<const GlobalUniform> &uniform,
+        const std::shared_ptr<const ShaderManager> &shaderManager)
+    :
+        EffectBase(device),
+        shaderName(pShaderName)
+    {
+        VkDescriptorSetLayout setLayouts[] =
+        {
+            framebuffers->GetDescSetLayout(),
+            uniform->GetDescSetLayout(),
+        };
+
+        InitBase(shaderManager, setLayouts, this->push);
     }
 
 public:
@@ -95,9 +137,9 @@ public:
 protected:
     bool GetPushConstData(uint8_t(&pData)[128], uint32_t *pDataSize) const override
     {
-        static_assert(sizeof(push) <= 128, "");
-        memcpy(pData, &push, sizeof(push));
-        *pDataSize = sizeof(push);
+        static_assert(sizeof(this->push) <= 128, "");
+        memcpy(pData, &this->push, sizeof(this->push));
+        *pDataSize = sizeof(this->push);
         return true;
     }
 
@@ -106,22 +148,7 @@ protected:
         return shaderName;
     }
 
-    // Can be changed by child classes
-    PUSH_CONST &GetPush()
-    {
-        return push.custom;
-    }
-
-protected:
-    struct
-    {
-        uint32_t transitionType; // 0 - in, 1 - out
-        float transitionBeginTime;                
-        float transitionDuration;
-        PUSH_CONST custom;
-    } push;
 private:
-    bool isCurrentlyActive;
     const char *shaderName;
 };
 
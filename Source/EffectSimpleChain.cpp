@@ -0,0 +1,253 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "EffectSimpleChain.h"
+#include "Generated/ShaderCommonC.h"
+
+static_assert(RTGL1::EFFECT_SIMPLE_CHAIN_EFFECT_COUNT == EFFECT_SIMPLE_CHAIN_LENGTH, "Change effect count in EffectSimpleChain.h");
+
+namespace
+{
+
+// Order of effects in EfSimpleChain.comp
+enum ChainIndex : uint32_t
+{
+    CHAIN_INDEX_COLOR_TINT,
+    CHAIN_INDEX_INVERSE_BW,
+    CHAIN_INDEX_HUE_SHIFT,
+    CHAIN_INDEX_CHROMATIC_ABERRATION,
+    CHAIN_INDEX_DISTORTED_SIDES,
+    CHAIN_INDEX_RADIAL_BLUR,
+};
+
+uint32_t MakePipelineKey(uint32_t effectMask, bool isSourcePing)
+{
+    return (effectMask << 1) | (isSourcePing ? 1 : 0);
+}
+
+}
+
+RTGL1::EffectSimpleChain::EffectSimpleChain(
+    VkDevice _device,
+    const std::shared_ptr<const Framebuffers> &_framebuffers,
+    const std::shared_ptr<const GlobalUniform> &_uniform,
+    const std::shared_ptr<const ShaderManager> &_shaderManager)
+:
+    device(_device),
+    pipelineLayout(VK_NULL_HANDLE),
+    shaderStageInfo{},
+    currentEffectMask(0),
+    push{}
+{
+    static_assert(sizeof(PushConst) <= 128, "Push constant must have size <= 128");
+
+    VkDescriptorSetLayout setLayouts[] =
+    {
+        _framebuffers->GetDescSetLayout(),
+        _uniform->GetDescSetLayout(),
+    };
+
+    CreatePipelineLayout(setLayouts, std::size(setLayouts));
+    shaderStageInfo = _shaderManager->GetStageInfo("EffectSimpleChain");
+}
+
+RTGL1::EffectSimpleChain::~EffectSimpleChain()
+{
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    DestroyPipelines();
+}
+
+void RTGL1::EffectSimpleChain::AddTransition(uint32_t effectBit, uint32_t indexInChain, const EffectSimpleTransition &transition)
+{
+    assert(indexInChain < EFFECT_SIMPLE_CHAIN_EFFECT_COUNT);
+    assert(effectBit == (1u << indexInChain));
+
+    currentEffectMask |= effectBit;
+    push.transitions[indexInChain] = transition;
+}
+
+void RTGL1::EffectSimpleChain::Add(const EffectColorTint &effect)
+{
+    AddTransition(EFFECT_SIMPLE_CHAIN_COLOR_TINT, CHAIN_INDEX_COLOR_TINT, effect.GetTransition());
+    push.colorTint = effect.GetCustom();
+}
+
+void RTGL1::EffectSimpleChain::Add(const EffectInverseBW &effect)
+{
+    AddTransition(EFFECT_SIMPLE_CHAIN_INVERSE_BW, CHAIN_INDEX_INVERSE_BW, effect.GetTransition());
+}
+
+void RTGL1::EffectSimpleChain::Add(const EffectHueShift &effect)
+{
+    AddTransition(EFFECT_SIMPLE_CHAIN_HUE_SHIFT, CHAIN_INDEX_HUE_SHIFT, effect.GetTransition());
+}
+
+void RTGL1::EffectSimpleChain::Add(const EffectChromaticAberration &effect)
+{
+    AddTransition(EFFECT_SIMPLE_CHAIN_CHROMATIC_ABERRATION, CHAIN_INDEX_CHROMATIC_ABERRATION, effect.GetTransition());
+    push.chromaticAberration = effect.GetCustom();
+}
+
+void RTGL1::EffectSimpleChain::Add(const EffectDistortedSides &effect)
+{
+    AddTransition(EFFECT_SIMPLE_CHAIN_DISTORTED_SIDES, CHAIN_INDEX_DISTORTED_SIDES, effect.GetTransition());
+}
+
+void RTGL1::EffectSimpleChain::Add(const EffectRadialBlur &effect)
+{
+    AddTransition(EFFECT_SIMPLE_CHAIN_RADIAL_BLUR, CHAIN_INDEX_RADIAL_BLUR, effect.GetTransition());
+}
+
+RTGL1::FramebufferImageIndex RTGL1::EffectSimpleChain::Apply(const CommonnlyUsedEffectArguments &args, FramebufferImageIndex inputFramebuf)
+{
+    if (currentEffectMask == 0)
+    {
+        return inputFramebuf;
+    }
+
+    CmdLabel label(args.cmd, "EffectSimpleChain");
+
+
+    assert(inputFramebuf == FB_IMAGE_INDEX_UPSCALED_PING || inputFramebuf == FB_IMAGE_INDEX_UPSCALED_PONG);
+    bool isSourcePing = inputFramebuf == FB_IMAGE_INDEX_UPSCALED_PING;
+
+
+    const uint32_t wgCountX = Utils::GetWorkGroupCount(args.width, EFFECT_BASE_COMPUTE_GROUP_SIZE_X);
+    const uint32_t wgCountY = Utils::GetWorkGroupCount(args.height, EFFECT_BASE_COMPUTE_GROUP_SIZE_Y);
+
+    VkDescriptorSet descSets[] =
+    {
+        args.framebuffers->GetDescSet(args.frameIndex),
+        args.uniform->GetDescSet(args.frameIndex),
+    };
+
+    vkCmdBindDescriptorSets(args.cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipelineLayout,
+                            0, std::size(descSets), descSets,
+                            0, nullptr);
+
+    vkCmdBindPipeline(args.cmd, VK_PIPELINE_BIND_POINT_COMPUTE, GetPipeline(currentEffectMask, isSourcePing));
+
+    vkCmdPushConstants(args.cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+
+    FramebufferImageIndex fs[] =
+    {
+        inputFramebuf,
+    };
+    args.framebuffers->BarrierMultiple(args.cmd, args.frameIndex, fs);
+
+    vkCmdDispatch(args.cmd, wgCountX, wgCountY, 1);
+
+
+    currentEffectMask = 0;
+    return isSourcePing ? FB_IMAGE_INDEX_UPSCALED_PONG : FB_IMAGE_INDEX_UPSCALED_PING;
+}
+
+void RTGL1::EffectSimpleChain::OnShaderReload(const ShaderManager *shaderManager)
+{
+    for (auto &p : pipelines)
+    {
+        shaderManager->DestroyWhenUnused(p.second);
+    }
+
+    pipelines.clear();
+
+    // pipelines will be created on demand with the new module
+    shaderStageInfo = shaderManager->GetStageInfo("EffectSimpleChain");
+}
+
+void RTGL1::EffectSimpleChain::CreatePipelineLayout(const VkDescriptorSetLayout *pSetLayouts, uint32_t setLayoutCount)
+{
+    VkPushConstantRange pushRange = {};
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(PushConst);
+
+    VkPipelineLayoutCreateInfo plLayoutInfo = {};
+    plLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    plLayoutInfo.setLayoutCount = setLayoutCount;
+    plLayoutInfo.pSetLayouts = pSetLayouts;
+    plLayoutInfo.pushConstantRangeCount = 1;
+    plLayoutInfo.pPushConstantRanges = &pushRange;
+
+    VkResult r = vkCreatePipelineLayout(device, &plLayoutInfo, nullptr, &pipelineLayout);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, pipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "EffectSimpleChain pipeline layout");
+}
+
+VkPipeline RTGL1::EffectSimpleChain::GetPipeline(uint32_t effectMask, bool isSourcePing)
+{
+    const uint32_t key = MakePipelineKey(effectMask, isSourcePing);
+
+    const auto found = pipelines.find(key);
+
+    if (found != pipelines.end())
+    {
+        return found->second;
+    }
+
+    struct
+    {
+        uint32_t isSourcePing;
+        uint32_t effectMask;
+    } specData = { isSourcePing ? 1u : 0u, effectMask };
+
+    VkSpecializationMapEntry specEntries[2] = {};
+    specEntries[0].constantID = 0;
+    specEntries[0].offset = offsetof(decltype(specData), isSourcePing);
+    specEntries[0].size = sizeof(specData.isSourcePing);
+    specEntries[1].constantID = 1;
+    specEntries[1].offset = offsetof(decltype(specData), effectMask);
+    specEntries[1].size = sizeof(specData.effectMask);
+
+    VkSpecializationInfo specInfo = {};
+    specInfo.mapEntryCount = std::size(specEntries);
+    specInfo.pMapEntries = specEntries;
+    specInfo.dataSize = sizeof(specData);
+    specInfo.pData = &specData;
+
+    VkComputePipelineCreateInfo plInfo = {};
+    plInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    plInfo.layout = pipelineLayout;
+    plInfo.stage = shaderStageInfo;
+    plInfo.stage.pSpecializationInfo = &specInfo;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipeline);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, pipeline, VK_OBJECT_TYPE_PIPELINE, 
+                   ("EffectSimpleChain " + std::to_string(effectMask) + " from " + (isSourcePing ? "Ping" : "Pong")).c_str());
+
+    pipelines[key] = pipeline;
+    return pipeline;
+}
+
+void RTGL1::EffectSimpleChain::DestroyPipelines()
+{
+    for (auto &p : pipelines)
+    {
+        vkDestroyPipeline(device, p.second, nullptr);
+    }
+
+    pipelines.clear();
+}
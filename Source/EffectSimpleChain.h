@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EffectSimple_Instances.h"
+
+namespace RTGL1
+{
+
+constexpr uint32_t EFFECT_SIMPLE_CHAIN_EFFECT_COUNT = 6;
+
+// Applies all active simple effects in one compute dispatch, so the upscaled
+// image is read and written once. A pipeline is created for each combination
+// of active effects on the first use.
+class EffectSimpleChain final : public IShaderDependency
+{
+public:
+    explicit EffectSimpleChain(
+        VkDevice device,
+        const std::shared_ptr<const Framebuffers> &framebuffers,
+        const std::shared_ptr<const GlobalUniform> &uniform,
+        const std::shared_ptr<const ShaderManager> &shaderManager);
+    ~EffectSimpleChain() override;
+
+    EffectSimpleChain(const EffectSimpleChain &other) = delete;
+    EffectSimpleChain(EffectSimpleChain &&other) noexcept = delete;
+    EffectSimpleChain &operator=(const EffectSimpleChain &other) = delete;
+    EffectSimpleChain &operator=(EffectSimpleChain &&other) noexcept = delete;
+
+    // Add an effect that was successfully set up in the current frame.
+    // The order of effects is defined by the shader.
+    void Add(const EffectColorTint &effect);
+    void Add(const EffectInverseBW &effect);
+    void Add(const EffectHueShift &effect);
+    void Add(const EffectChromaticAberration &effect);
+    void Add(const EffectDistortedSides &effect);
+    void Add(const EffectRadialBlur &effect);
+
+    // Apply added effects and clear the list. If there were none, returns "inputFramebuf".
+    FramebufferImageIndex Apply(const CommonnlyUsedEffectArguments &args, FramebufferImageIndex inputFramebuf);
+
+    void OnShaderReload(const ShaderManager *shaderManager) override;
+
+private:
+    // Must be the same as EffectSimpleChainPush_BT in EfSimpleChain.comp
+    struct PushConst
+    {
+        EffectSimpleTransition transitions[EFFECT_SIMPLE_CHAIN_EFFECT_COUNT];
+        EffectColorTint_PushConst colorTint;
+        EffectChromaticAberration_PushConst chromaticAberration;
+    };
+
+    void AddTransition(uint32_t effectBit, uint32_t indexInChain, const EffectSimpleTransition &transition);
+
+    void CreatePipelineLayout(const VkDescriptorSetLayout *pSetLayouts, uint32_t setLayoutCount);
+    VkPipeline GetPipeline(uint32_t effectMask, bool isSourcePing);
+    void DestroyPipelines();
+
+private:
+    VkDevice device;
+    VkPipelineLayout pipelineLayout;
+
+    VkPipelineShaderStageCreateInfo shaderStageInfo;
+    // (effect mask, is source ping) to a pipeline
+    rgl::unordered_map<uint32_t, VkPipeline> pipelines;
+
+    uint32_t currentEffectMask;
+    PushConst push;
+};
+
+}
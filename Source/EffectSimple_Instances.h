@@ -28,18 +28,16 @@ namespace RTGL1
 struct EffectRadialBlur_PushConst
 {};
 
-struct EffectRadialBlur final : public EffectSimple<EffectRadialBlur_PushConst>
+struct EffectRadialBlur final : public EffectSimpleParams<EffectRadialBlur_PushConst>
 {
-    RTGL1_EFFECT_SIMPLE_INHERIT_CONSTRUCTOR(EffectRadialBlur, "EffectRadialBlur")
-
-        bool Setup(const CommonnlyUsedEffectArguments &args, const RgPostEffectRadialBlur *params)
+    bool Setup(const CommonnlyUsedEffectArguments &args, const RgPostEffectRadialBlur *params)
     {
         if (params == nullptr)
         {
             return SetupNull();
         }
 
-        return EffectSimple::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
+        return EffectSimpleParams::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
     }
 };
 
@@ -52,10 +50,8 @@ struct EffectChromaticAberration_PushConst
     float intensity;
 };
 
-struct EffectChromaticAberration final : public EffectSimple<EffectChromaticAberration_PushConst>
+struct EffectChromaticAberration final : public EffectSimpleParams<EffectChromaticAberration_PushConst>
 {
-    RTGL1_EFFECT_SIMPLE_INHERIT_CONSTRUCTOR(EffectChromaticAberration, "EffectChromaticAberration")
-
     bool Setup(const CommonnlyUsedEffectArguments &args, const RgPostEffectChromaticAberration *params)
     {
         if (params == nullptr || params->intensity <= 0.0f)
@@ -64,7 +60,7 @@ struct EffectChromaticAberration final : public EffectSimple<EffectChromaticAber
         }
 
         GetPush().intensity = params->intensity;
-        return EffectSimple::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
+        return EffectSimpleParams::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
     }
 };
 
@@ -75,10 +71,8 @@ struct EffectChromaticAberration final : public EffectSimple<EffectChromaticAber
 struct EffectInverseBW_PushConst
 {};
 
-struct EffectInverseBW final : public EffectSimple<EffectInverseBW_PushConst>
+struct EffectInverseBW final : public EffectSimpleParams<EffectInverseBW_PushConst>
 {
-    RTGL1_EFFECT_SIMPLE_INHERIT_CONSTRUCTOR(EffectInverseBW, "EffectInverseBW")
-
     bool Setup(const CommonnlyUsedEffectArguments &args, const RgPostEffectInverseBlackAndWhite *params)
     {
         if (params == nullptr)
@@ -86,7 +80,7 @@ struct EffectInverseBW final : public EffectSimple<EffectInverseBW_PushConst>
             return SetupNull();
         }
         
-        return EffectSimple::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
+        return EffectSimpleParams::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
     }
 };
 
@@ -97,10 +91,8 @@ struct EffectInverseBW final : public EffectSimple<EffectInverseBW_PushConst>
 struct EffectDistortedSides_PushConst
 {};
 
-struct EffectDistortedSides final : public EffectSimple<EffectDistortedSides_PushConst>
+struct EffectDistortedSides final : public EffectSimpleParams<EffectDistortedSides_PushConst>
 {
-    RTGL1_EFFECT_SIMPLE_INHERIT_CONSTRUCTOR(EffectDistortedSides, "EffectDistortedSides")
-
     bool Setup(const CommonnlyUsedEffectArguments &args, const RgPostEffectDistortedSides *params)
     {
         if (params == nullptr)
@@ -108,7 +100,7 @@ struct EffectDistortedSides final : public EffectSimple<EffectDistortedSides_Pus
             return SetupNull();
         }
 
-        return EffectSimple::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
+        return EffectSimpleParams::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
     }
 };
 
@@ -122,10 +114,8 @@ struct EffectColorTint_PushConst
     float r, g, b;
 };
 
-struct EffectColorTint final : public EffectSimple<EffectColorTint_PushConst>
+struct EffectColorTint final : public EffectSimpleParams<EffectColorTint_PushConst>
 {
-    RTGL1_EFFECT_SIMPLE_INHERIT_CONSTRUCTOR(EffectColorTint, "EffectColorTint")
-
     bool Setup(const CommonnlyUsedEffectArguments &args, const RgPostEffectColorTint *params)
     {
         if (params == nullptr)
@@ -137,7 +127,7 @@ struct EffectColorTint final : public EffectSimple<EffectColorTint_PushConst>
         GetPush().r = params->color.data[0];
         GetPush().g = params->color.data[1];
         GetPush().b = params->color.data[2];
-        return EffectSimple::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
+        return EffectSimpleParams::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
     }
 };
 
@@ -148,18 +138,16 @@ struct EffectColorTint final : public EffectSimple<EffectColorTint_PushConst>
 struct EffectHueShift_PushConst
 {};
 
-struct EffectHueShift final : public EffectSimple<EffectHueShift_PushConst>
+struct EffectHueShift final : public EffectSimpleParams<EffectHueShift_PushConst>
 {
-    RTGL1_EFFECT_SIMPLE_INHERIT_CONSTRUCTOR(EffectHueShift, "EffectHueShift")
-
-        bool Setup(const CommonnlyUsedEffectArguments &args, const RgPostEffectHueShift *params)
+    bool Setup(const CommonnlyUsedEffectArguments &args, const RgPostEffectHueShift *params)
     {
         if (params == nullptr)
         {
             return SetupNull();
         }
 
-        return EffectSimple::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
+        return EffectSimpleParams::Setup(args, params->isActive, params->transitionDurationIn, params->transitionDurationOut);
     }
 };
 
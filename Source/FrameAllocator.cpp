@@ -0,0 +1,109 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FrameAllocator.h"
+
+#include <algorithm>
+
+static size_t AlignUp(size_t x, size_t alignment)
+{
+    return (x + alignment - 1) & ~(alignment - 1);
+}
+
+RTGL1::FrameAllocator::FrameAllocator(size_t initialCapacity)
+:
+    curOffset(0),
+    usedBytes(0),
+    heapAllocationCount(0),
+    prevFrameHeapAllocationCount(0)
+{
+    AddBlock(initialCapacity);
+
+    // initial block is not a growth
+    heapAllocationCount = 0;
+}
+
+void RTGL1::FrameAllocator::Reset()
+{
+    // blocks can legitimately grow at any time, e.g. on a level load,
+    // so it's only reported and not treated as an error
+    prevFrameHeapAllocationCount = heapAllocationCount;
+
+    if (blocks.size() > 1)
+    {
+        // replace all blocks with one, so next frames with the same usage won't allocate
+        const size_t capacity = GetCapacity();
+
+        blocks.clear();
+        AddBlock(capacity);
+    }
+
+    curOffset = 0;
+    usedBytes = 0;
+    heapAllocationCount = 0;
+}
+
+void *RTGL1::FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+    assert(!blocks.empty());
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    assert(alignment <= alignof(std::max_align_t));
+
+    size_t offset = AlignUp(curOffset, alignment);
+
+    if (offset + size > blocks.back().size)
+    {
+        // new block is at least as big as all previous ones
+        AddBlock(std::max(GetCapacity(), size + alignment));
+        curOffset = 0;
+        offset = 0;
+    }
+
+    usedBytes += offset + size - curOffset;
+    curOffset = offset + size;
+    return blocks.back().data.get() + offset;
+}
+
+void RTGL1::FrameAllocator::AddBlock(size_t minSize)
+{
+    Block b = {};
+    b.data = std::make_unique<uint8_t[]>(minSize);
+    b.size = minSize;
+
+    blocks.push_back(std::move(b));
+    heapAllocationCount++;
+}
+
+size_t RTGL1::FrameAllocator::GetCapacity() const
+{
+    size_t capacity = 0;
+
+    for (const auto &b : blocks)
+    {
+        capacity += b.size;
+    }
+
+    return capacity;
+}
+
+uint32_t RTGL1::FrameAllocator::GetPrevFrameHeapAllocationCount() const
+{
+    return prevFrameHeapAllocationCount;
+}
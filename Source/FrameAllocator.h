@@ -0,0 +1,114 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace RTGL1
+{
+
+// Linear allocator for transient CPU data that lives only during one frame.
+// Memory is given out by bumping an offset and is reclaimed all at once in Reset().
+// If a frame requires more memory than there is, a new block is allocated,
+// and on the next Reset() all blocks are replaced with one block of the summed size,
+// so the steady-state frames don't touch the heap at all.
+class FrameAllocator
+{
+public:
+    explicit FrameAllocator(size_t initialCapacity = 1 << 20);
+    ~FrameAllocator() = default;
+
+    FrameAllocator(const FrameAllocator &other) = delete;
+    FrameAllocator(FrameAllocator &&other) noexcept = delete;
+    FrameAllocator &operator=(const FrameAllocator &other) = delete;
+    FrameAllocator &operator=(FrameAllocator &&other) noexcept = delete;
+
+    // Must be called at the beginning of a frame, all previously allocated memory becomes invalid
+    void Reset();
+
+    void *Allocate(size_t size, size_t alignment);
+
+    size_t GetCapacity() const;
+    // Amount of block allocations during the frame before the last Reset(),
+    // non-zero only if that frame required more memory than any frame before
+    uint32_t GetPrevFrameHeapAllocationCount() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+    };
+
+    void AddBlock(size_t minSize);
+
+private:
+    std::vector<Block> blocks;
+    size_t curOffset;
+
+    size_t usedBytes;
+
+    // heap allocations during the current frame, zeroed in Reset()
+    uint32_t heapAllocationCount;
+    uint32_t prevFrameHeapAllocationCount;
+};
+
+
+// Stateful STL allocator over FrameAllocator. Deallocation is a no-op,
+// so containers must not outlive the frame they were created in.
+template <typename T>
+class FrameStlAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit FrameStlAllocator(FrameAllocator *_pFrameAllocator) : pFrameAllocator(_pFrameAllocator)
+    {
+        assert(pFrameAllocator != nullptr);
+    }
+
+    template <typename U>
+    FrameStlAllocator(const FrameStlAllocator<U> &other) : pFrameAllocator(other.pFrameAllocator) {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(pFrameAllocator->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {}
+
+    template <typename U>
+    bool operator==(const FrameStlAllocator<U> &other) const { return pFrameAllocator == other.pFrameAllocator; }
+    template <typename U>
+    bool operator!=(const FrameStlAllocator<U> &other) const { return pFrameAllocator != other.pFrameAllocator; }
+
+private:
+    template <typename U>
+    friend class FrameStlAllocator;
+
+    FrameAllocator *pFrameAllocator;
+};
+
+}
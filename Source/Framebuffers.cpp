@@ -26,20 +26,22 @@ using namespace RTGL1;
 #include "Utils.h"
 #include "CmdLabel.h"
 
+#include <algorithm>
 #include <vector>
 
-static_assert(MAX_FRAMES_IN_FLIGHT == FRAMEBUFFERS_HISTORY_LENGTH, "Framebuffers class logic must be changed if history length is not equal to max frames in flight");
+static_assert(FRAMEBUFFERS_HISTORY_LENGTH == 2, "Framebuffers class logic must be changed if history length is not 2");
 
 FramebufferImageIndex Framebuffers::FrameIndexToFBIndex(FramebufferImageIndex framebufferImageIndex, uint32_t frameIndex)
 {
-    assert(frameIndex < FRAMEBUFFERS_HISTORY_LENGTH);
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
     assert(framebufferImageIndex >= 0 && framebufferImageIndex < ShFramebuffers_Count);
 
     // if framubuffer with given index can be swapped,
-    // use one that is currently in use
+    // use one that is currently in use; frame count is even,
+    // so consecutive frame indices always have different parity
     if (ShFramebuffers_Bindings[framebufferImageIndex] != ShFramebuffers_BindingsSwapped[framebufferImageIndex])
     {
-        return (FramebufferImageIndex)(framebufferImageIndex + frameIndex);
+        return (FramebufferImageIndex)(framebufferImageIndex + frameIndex % FRAMEBUFFERS_HISTORY_LENGTH);
     }
 
     return framebufferImageIndex;
@@ -55,13 +57,16 @@ Framebuffers::Framebuffers(
     nearestSampler(VK_NULL_HANDLE),
     allocator(std::move(_allocator)),
     cmdManager(std::move(_cmdManager)),
+    frameCount(allocator->GetFrameCount()),
     currentResolution{},
+    allocatedResolution{},
     descSetLayout(VK_NULL_HANDLE),
     descPool(VK_NULL_HANDLE),
-    descSets{}
+    descSets{},
+    isFrameOutdated{},
+    stats{}
 {
     images.resize(ShFramebuffers_Count);
-    imageMemories.resize(ShFramebuffers_Count);
     imageViews.resize(ShFramebuffers_Count);
 
     CreateDescriptors();
@@ -72,6 +77,11 @@ Framebuffers::~Framebuffers()
 {
     DestroyImages();
 
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        DestroyRetiredImages(i);
+    }
+
     vkDestroySampler(device, nearestSampler, nullptr);
     vkDestroySampler(device, bilinearSampler, nullptr);
     
@@ -135,22 +145,22 @@ void Framebuffers::CreateDescriptors()
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
 
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    poolSizes[0].descriptorCount = allBindingsCount * FRAMEBUFFERS_HISTORY_LENGTH;
+    poolSizes[0].descriptorCount = allBindingsCount * frameCount;
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLER;
-    poolSizes[1].descriptorCount = allBindingsCount * FRAMEBUFFERS_HISTORY_LENGTH;
+    poolSizes[1].descriptorCount = allBindingsCount * frameCount;
 
     VkDescriptorPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = poolSizes.size();
     poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = FRAMEBUFFERS_HISTORY_LENGTH;
+    poolInfo.maxSets = frameCount;
 
     r = vkCreateDescriptorPool(device, &poolInfo, nullptr, &descPool);
     VK_CHECKERROR(r);
 
     SET_DEBUG_NAME(device, descPool, VK_OBJECT_TYPE_DESCRIPTOR_POOL, "Framebuffers Desc pool");
 
-    for (uint32_t i = 0; i < FRAMEBUFFERS_HISTORY_LENGTH; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         VkDescriptorSetAllocateInfo allocInfo = {};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -196,20 +206,78 @@ void RTGL1::Framebuffers::CreateSamplers()
     }
 }
 
-bool RTGL1::Framebuffers::PrepareForSize(ResolutionState resolutionState)
+bool RTGL1::Framebuffers::PrepareForSize(VkCommandBuffer cmd, uint32_t frameIndex, ResolutionState resolutionState, ResolutionState maxResolutionState)
 {
-    if (currentResolution == resolutionState)
+    const bool isChanged = currentResolution != resolutionState;
+
+    const ResolutionState allocation = GetAllocation(resolutionState, maxResolutionState);
+
+    if (allocation != allocatedResolution)
     {
-        return false;
+        // previous frame can still use the images
+        RetireImages(frameIndex);
+        CreateImages(cmd, allocation);
+
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            isFrameOutdated[i] = true;
+        }
     }
 
-    vkDeviceWaitIdle(device);
+    currentResolution = resolutionState;
 
-    DestroyImages();
-    CreateImages(resolutionState);
+    // descriptors and subscribers' resources of the previous frame
+    // will be updated, when that frame index is processed again
+    if (isFrameOutdated[frameIndex])
+    {
+        UpdateDescriptors(frameIndex);
+        NotifySubscribersAboutResize(cmd, frameIndex, allocatedResolution);
 
-    assert(currentResolution == resolutionState);
-    return true;
+        isFrameOutdated[frameIndex] = false;
+    }
+
+    return isChanged;
+}
+
+void RTGL1::Framebuffers::PrepareForFrame(uint32_t frameIndex)
+{
+    DestroyRetiredImages(frameIndex);
+}
+
+void RTGL1::Framebuffers::BeginPass(VkCommandBuffer cmd, FramebufferPass pass)
+{
+    assert(pass < FB_PASS_COUNT);
+
+    const auto &barriers = aliasingBarriers[pass];
+
+    if (barriers.empty())
+    {
+        return;
+    }
+
+    VkDependencyInfoKHR dependencyInfo = {};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+    dependencyInfo.imageMemoryBarrierCount = barriers.size();
+    dependencyInfo.pImageMemoryBarriers = barriers.data();
+
+    svkCmdPipelineBarrier2KHR(cmd, &dependencyInfo);
+}
+
+RTGL1::ResolutionState RTGL1::Framebuffers::GetAllocation(const ResolutionState &requested, const ResolutionState &maxRequested)
+{
+    assert(requested.upscaledWidth  == maxRequested.upscaledWidth &&
+           requested.upscaledHeight == maxRequested.upscaledHeight);
+
+    // upscaled-size images are used as an output, so they must be exact
+    ResolutionState a = requested;
+
+    // with a dynamic resolution, render size is changed often,
+    // so allocate render-size images for its upper bound;
+    // otherwise, the bound is the render size itself
+    a.renderWidth  = std::max(requested.renderWidth,  maxRequested.renderWidth);
+    a.renderHeight = std::max(requested.renderHeight, maxRequested.renderHeight);
+
+    return a;
 }
 
 void RTGL1::Framebuffers::BarrierOne(VkCommandBuffer cmd, uint32_t frameIndex, FramebufferImageIndex framebufImageIndex, BarrierType barrierTypeFrom)
@@ -302,6 +370,21 @@ RTGL1::FramebufferImageIndex RTGL1::Framebuffers::BlitForEffects(VkCommandBuffer
     return dst;
 }
 
+const RTGL1::ResolutionState &RTGL1::Framebuffers::GetCurrentResolution() const
+{
+    return currentResolution;
+}
+
+const RTGL1::ResolutionState &RTGL1::Framebuffers::GetAllocatedResolution() const
+{
+    return allocatedResolution;
+}
+
+void RTGL1::Framebuffers::GetStats(RgFramebuffersStats *pResult) const
+{
+    *pResult = stats;
+}
+
 VkDescriptorSet Framebuffers::GetDescSet(uint32_t frameIndex) const
 {
     return descSets[frameIndex];
@@ -398,18 +481,162 @@ VkExtent2D RTGL1::Framebuffers::GetFramebufSize(FramebufferImageFlags flags, con
     return extent;
 }
 
-void Framebuffers::CreateImages(ResolutionState resolutionState)
+namespace
+{
+
+struct MemorySlot
+{
+    VkMemoryRequirements memReqs;
+    std::vector<uint32_t> images;
+};
+
+}
+
+// Pipeline stages at which framebufs are accessed during each pass
+static VkPipelineStageFlags2KHR GetPassStages(uint32_t pass)
+{
+    switch (pass)
+    {
+        case FB_PASS_PRIMARY:
+            // ray tracing, compute for sample merging and reconstruction, decals
+            return 
+                VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR |
+                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR;
+
+        case FB_PASS_DENOISE:
+        case FB_PASS_BLOOM:
+            return VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
+
+        case FB_PASS_COMPOSITION:
+            // composition, rasterized geometry
+            return 
+                VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR |
+                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR;
+
+        case FB_PASS_POSTPROCESS:
+            // upscaling and effects, blits, rasterized geometry on the swapchain image
+            return 
+                VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR |
+                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR;
+
+        default:
+            assert(0);
+            return VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR;
+    }
+}
+
+static VkPipelineStageFlags2KHR GetLifetimeStages(uint32_t fbIndex)
+{
+    VkPipelineStageFlags2KHR stages = 0;
+
+    for (uint32_t p = ShFramebuffers_LifetimeFirstPass[fbIndex]; p <= ShFramebuffers_LifetimeLastPass[fbIndex]; p++)
+    {
+        stages |= GetPassStages(p);
+    }
+
+    return stages;
+}
+
+static bool IsPersistent(uint32_t fbIndex)
+{
+    return ShFramebuffers_LifetimeFirstPass[fbIndex] == FB_LIFETIME_PERSISTENT;
+}
+
+static bool AreLifetimesIntersecting(uint32_t a, uint32_t b)
+{
+    if (IsPersistent(a) || IsPersistent(b))
+    {
+        return true;
+    }
+
+    return ShFramebuffers_LifetimeFirstPass[a] <= ShFramebuffers_LifetimeLastPass[b] &&
+           ShFramebuffers_LifetimeFirstPass[b] <= ShFramebuffers_LifetimeLastPass[a];
+}
+
+// Greedily place framebufs, starting from the largest ones, into memory slots
+// where all other framebufs have non-intersecting lifetimes.
+// From the suitable slots, the one that grows the least is chosen.
+static std::vector<MemorySlot> AssignMemorySlots(const std::vector<VkMemoryRequirements> &memReqs)
+{
+    std::vector<uint32_t> order(memReqs.size());
+
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&memReqs] (uint32_t a, uint32_t b)
+    {
+        return memReqs[a].size > memReqs[b].size;
+    });
+
+    std::vector<MemorySlot> slots;
+
+    for (uint32_t fb : order)
+    {
+        const VkMemoryRequirements &r = memReqs[fb];
+
+        MemorySlot *best = nullptr;
+        VkDeviceSize bestGrowth = 0;
+
+        if (!IsPersistent(fb))
+        {
+            for (MemorySlot &slot : slots)
+            {
+                if ((slot.memReqs.memoryTypeBits & r.memoryTypeBits) == 0)
+                {
+                    continue;
+                }
+
+                bool canShare = std::none_of(slot.images.begin(), slot.images.end(), [fb] (uint32_t other)
+                {
+                    return AreLifetimesIntersecting(fb, other);
+                });
+
+                if (!canShare)
+                {
+                    continue;
+                }
+
+                VkDeviceSize growth = r.size > slot.memReqs.size ? r.size - slot.memReqs.size : 0;
+
+                if (best == nullptr || growth < bestGrowth)
+                {
+                    best = &slot;
+                    bestGrowth = growth;
+                }
+            }
+        }
+
+        if (best != nullptr)
+        {
+            // all images are bound at offset 0
+            best->memReqs.size = std::max(best->memReqs.size, r.size);
+            best->memReqs.alignment = std::max(best->memReqs.alignment, r.alignment);
+            best->memReqs.memoryTypeBits &= r.memoryTypeBits;
+            best->images.push_back(fb);
+        }
+        else
+        {
+            slots.push_back({ r, { fb } });
+        }
+    }
+
+    return slots;
+}
+
+void Framebuffers::CreateImages(VkCommandBuffer cmd, ResolutionState allocation)
 {
     VkResult r;
 
-    VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
+    std::vector<VkMemoryRequirements> memReqs(ShFramebuffers_Count);
 
     for (uint32_t i = 0; i < ShFramebuffers_Count; i++)
     {
         VkFormat format = ShFramebuffers_Formats[i];
         FramebufferImageFlags flags = ShFramebuffers_Flags[i];
 
-        VkExtent2D extent = GetFramebufSize(flags, resolutionState);
+        VkExtent2D extent = GetFramebufSize(flags, allocation);
 
         // create image
         VkImageCreateInfo imageInfo = {};
@@ -440,14 +667,81 @@ void Framebuffers::CreateImages(ResolutionState resolutionState)
         r = vkCreateImage(device, &imageInfo, nullptr, &images[i]);
         VK_CHECKERROR(r);
 
-        // allocate dedicated memory
-        VkMemoryRequirements memReqs;
-        vkGetImageMemoryRequirements(device, images[i], &memReqs);
+        vkGetImageMemoryRequirements(device, images[i], &memReqs[i]);
+    }
 
-        imageMemories[i] = allocator->AllocDedicated(memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryAllocator::AllocType::DEFAULT, ShFramebuffers_DebugNames[i]);
 
-        r = vkBindImageMemory(device, images[i], imageMemories[i], 0);
-        VK_CHECKERROR(r);
+    // allocate memory, framebufs with non-intersecting lifetimes share it
+    imageMemories.clear();
+    stats = {};
+
+    for (auto &bs : aliasingBarriers)
+    {
+        bs.clear();
+    }
+
+    for (const MemorySlot &slot : AssignMemorySlots(memReqs))
+    {
+        const bool isShared = slot.images.size() > 1;
+
+        VkDeviceMemory memory = allocator->AllocDedicated(
+            slot.memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryAllocator::AllocType::DEFAULT,
+            isShared ? "Framebuffers shared memory" : ShFramebuffers_DebugNames[slot.images[0]]);
+
+        imageMemories.push_back(memory);
+        stats.allocatedSize += slot.memReqs.size;
+
+        for (uint32_t i : slot.images)
+        {
+            r = vkBindImageMemory(device, images[i], memory, 0);
+            VK_CHECKERROR(r);
+
+            if (isShared)
+            {
+                // memory could be used by other framebufs of the slot, in the previous passes
+                // or in the previous frame; wait only for the stages they are accessed at
+                VkPipelineStageFlags2KHR srcStages = 0;
+
+                for (uint32_t other : slot.images)
+                {
+                    srcStages |= other != i ? GetLifetimeStages(other) : 0;
+                }
+
+                VkImageMemoryBarrier2KHR b = {};
+                b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+                b.image = images[i];
+                b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                b.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT_KHR;
+                b.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT_KHR | VK_ACCESS_2_MEMORY_WRITE_BIT_KHR;
+                b.srcStageMask = srcStages;
+                b.dstStageMask = GetPassStages(ShFramebuffers_LifetimeFirstPass[i]);
+                // the content is not needed, so the layout is undefined
+                b.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                b.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+                b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                b.subresourceRange.baseMipLevel = 0;
+                b.subresourceRange.levelCount = 1;
+                b.subresourceRange.baseArrayLayer = 0;
+                b.subresourceRange.layerCount = 1;
+
+                aliasingBarriers[ShFramebuffers_LifetimeFirstPass[i]].push_back(b);
+
+                stats.aliasedSize += memReqs[i].size;
+                stats.savedSize += memReqs[i].size;
+            }
+        }
+
+        if (isShared)
+        {
+            stats.savedSize -= slot.memReqs.size;
+        }
+    }
+
+
+    for (uint32_t i = 0; i < ShFramebuffers_Count; i++)
+    {
+        VkFormat format = ShFramebuffers_Formats[i];
 
         // create image view
         VkImageViewCreateInfo viewInfo = {};
@@ -474,20 +768,13 @@ void Framebuffers::CreateImages(ResolutionState resolutionState)
             VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
     }
 
-    // image creation happens rarely
-    cmdManager->Submit(cmd);
-    cmdManager->WaitGraphicsIdle();
-
-    currentResolution = resolutionState;
-
-
-    UpdateDescriptors();
-
-    NotifySubscribersAboutResize(resolutionState);
+    allocatedResolution = allocation;
 }
 
-void Framebuffers::UpdateDescriptors()
+void Framebuffers::UpdateDescriptors(uint32_t descSetIndex)
 {
+    assert(descSetIndex < frameCount);
+
     const uint32_t allBindingsCount = ShFramebuffers_Count * 2;
     const uint32_t samplerBindingOffset = ShFramebuffers_Count;
 
@@ -514,11 +801,15 @@ void Framebuffers::UpdateDescriptors()
         imageInfos[samplerBindingOffset + i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
     }
 
-    std::vector<VkWriteDescriptorSet> writes(allBindingsCount * FRAMEBUFFERS_HISTORY_LENGTH);
+    std::vector<VkWriteDescriptorSet> writes(allBindingsCount);
     uint32_t wrtCount = 0;
 
-    for (uint32_t k = 0; k < FRAMEBUFFERS_HISTORY_LENGTH; k++)
+    // only one set, as the other ones can be in use
     {
+        const uint32_t k = descSetIndex;
+        // odd frame indices use swapped images, see FrameIndexToFBIndex
+        const bool swapped = k % FRAMEBUFFERS_HISTORY_LENGTH != 0;
+
         // gimage2D
         for (uint32_t i = 0; i < ShFramebuffers_Count; i++)
         {
@@ -526,7 +817,7 @@ void Framebuffers::UpdateDescriptors()
 
             wrt.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             wrt.dstSet = descSets[k];
-            wrt.dstBinding = k == 0 ?
+            wrt.dstBinding = !swapped ?
                 ShFramebuffers_Bindings[i] :
                 ShFramebuffers_BindingsSwapped[i];
             wrt.dstArrayElement = 0;
@@ -542,7 +833,7 @@ void Framebuffers::UpdateDescriptors()
         {
             auto &wrt = writes[wrtCount];
 
-            uint32_t dstBinding = k == 0 ?
+            uint32_t dstBinding = !swapped ?
                 ShFramebuffers_Sampler_Bindings[i] :
                 ShFramebuffers_Sampler_BindingsSwapped[i];
 
@@ -596,13 +887,65 @@ void Framebuffers::DestroyImages()
     }
 }
 
-void Framebuffers::NotifySubscribersAboutResize(const ResolutionState &resolutionState)
+void Framebuffers::RetireImages(uint32_t frameIndex)
+{
+    for (auto &i : images)
+    {
+        if (i != VK_NULL_HANDLE)
+        {
+            imagesToDestroy[frameIndex].push_back(i);
+            i = VK_NULL_HANDLE;
+        }
+    }
+
+    for (auto &m : imageMemories)
+    {
+        if (m != VK_NULL_HANDLE)
+        {
+            imageMemoriesToDestroy[frameIndex].push_back(m);
+            m = VK_NULL_HANDLE;
+        }
+    }
+
+    for (auto &v : imageViews)
+    {
+        if (v != VK_NULL_HANDLE)
+        {
+            imageViewsToDestroy[frameIndex].push_back(v);
+            v = VK_NULL_HANDLE;
+        }
+    }
+}
+
+void Framebuffers::DestroyRetiredImages(uint32_t frameIndex)
+{
+    for (VkImageView v : imageViewsToDestroy[frameIndex])
+    {
+        vkDestroyImageView(device, v, nullptr);
+    }
+
+    for (VkImage i : imagesToDestroy[frameIndex])
+    {
+        vkDestroyImage(device, i, nullptr);
+    }
+
+    for (VkDeviceMemory m : imageMemoriesToDestroy[frameIndex])
+    {
+        vkFreeMemory(device, m, nullptr);
+    }
+
+    imageViewsToDestroy[frameIndex].clear();
+    imagesToDestroy[frameIndex].clear();
+    imageMemoriesToDestroy[frameIndex].clear();
+}
+
+void Framebuffers::NotifySubscribersAboutResize(VkCommandBuffer cmd, uint32_t frameIndex, const ResolutionState &allocation)
 {
     for (auto &ws : subscribers)
     {
         if (auto s = ws.lock())
         {
-            s->OnFramebuffersSizeChange(resolutionState);
+            s->OnFramebuffersSizeChange(cmd, frameIndex, allocation);
         }
     }
 }
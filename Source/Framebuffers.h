@@ -31,6 +31,7 @@
 #include "MemoryAllocator.h"
 #include "SamplerManager.h"
 #include "Generated/ShaderCommonCFramebuf.h"
+#include "RTGL1/RTGL1.h"
 
 namespace RTGL1
 {
@@ -51,7 +52,18 @@ public:
     Framebuffers &operator=(const Framebuffers &other) = delete;
     Framebuffers &operator=(Framebuffers &&other) noexcept = delete;
 
-    bool PrepareForSize(ResolutionState resolutionState);
+    // Render-size images are allocated for "maxResolutionState" (the max dynamic
+    // render size, or just the render size if it's not dynamic) and smaller render sizes
+    // are drawn into a sub-rectangle, so a dynamic render size change doesn't require reallocation.
+    // If reallocation is needed, replaced images are destroyed when they're not in use.
+    // Returns true, if current resolution was changed.
+    bool PrepareForSize(VkCommandBuffer cmd, uint32_t frameIndex, ResolutionState resolutionState, ResolutionState maxResolutionState);
+    // Destroy replaced images that were used by the frame with that index
+    void PrepareForFrame(uint32_t frameIndex);
+    // Must be called at the start of each recorded pass, in the order of FramebufferPass.
+    // Framebufs that share memory and whose lifetime starts at this pass
+    // are transitioned from the undefined layout, their content is discarded.
+    void BeginPass(VkCommandBuffer cmd, FramebufferPass pass);
 
     enum class BarrierType { All, Storage, ColorAttachment, Transfer };
 
@@ -81,6 +93,13 @@ public:
     void GetImageHandles(FramebufferImageIndex framebufferImageIndex, uint32_t frameIndex,
                          VkImage *pOutImage, VkImageView *pOutView, VkFormat *pOutFormat) const;
 
+    // Size of the area that is being rendered to
+    const ResolutionState &GetCurrentResolution() const;
+    // Actual size of the images, each dimension is not less than in the current resolution
+    const ResolutionState &GetAllocatedResolution() const;
+
+    void GetStats(RgFramebuffersStats *pResult) const;
+
     // Subscribe to framebuffers' size change event.
     // shared_ptr will be transformed to weak_ptr
     void Subscribe(std::shared_ptr<IFramebuffersDependency> subscriber);
@@ -92,14 +111,17 @@ private:
     void CreateDescriptors();
     void CreateSamplers();
 
-    void CreateImages(ResolutionState resolutionState);
-    void UpdateDescriptors();
+    void CreateImages(VkCommandBuffer cmd, ResolutionState allocation);
+    void UpdateDescriptors(uint32_t descSetIndex);
 
     static VkExtent2D GetFramebufSize(FramebufferImageFlags flags, const ResolutionState &resolutionState);
+    static ResolutionState GetAllocation(const ResolutionState &requested, const ResolutionState &maxRequested);
 
     void DestroyImages();
+    void RetireImages(uint32_t frameIndex);
+    void DestroyRetiredImages(uint32_t frameIndex);
 
-    void NotifySubscribersAboutResize(const ResolutionState &resolutionState);
+    void NotifySubscribersAboutResize(VkCommandBuffer cmd, uint32_t frameIndex, const ResolutionState &allocation);
 
 private:
     VkDevice device;
@@ -108,16 +130,34 @@ private:
 
     std::shared_ptr<MemoryAllocator> allocator;
     std::shared_ptr<CommandBufferManager> cmdManager;
+    uint32_t frameCount;
 
     ResolutionState currentResolution;
+    ResolutionState allocatedResolution;
 
     std::vector<VkImage> images;
-    std::vector<VkDeviceMemory> imageMemories;
     std::vector<VkImageView> imageViews;
+    // framebufs with non-intersecting lifetimes are bound to the same memory,
+    // so there can be less memory objects than images
+    std::vector<VkDeviceMemory> imageMemories;
+
+    // transitions of framebufs that share memory with others,
+    // grouped by the pass their lifetime starts at; built once, when images are created
+    std::vector<VkImageMemoryBarrier2KHR> aliasingBarriers[FB_PASS_COUNT];
+    RgFramebuffersStats stats;
+
+    // replaced images that can be still in use by the frame with that index
+    std::vector<VkImage> imagesToDestroy[MAX_FRAMES_IN_FLIGHT];
+    std::vector<VkDeviceMemory> imageMemoriesToDestroy[MAX_FRAMES_IN_FLIGHT];
+    std::vector<VkImageView> imageViewsToDestroy[MAX_FRAMES_IN_FLIGHT];
+
+    // if true, descriptor set and subscribers' resources for that frame index
+    // still reference replaced images
+    bool isFrameOutdated[MAX_FRAMES_IN_FLIGHT];
 
     VkDescriptorSetLayout descSetLayout;
     VkDescriptorPool descPool;
-    VkDescriptorSet descSets[FRAMEBUFFERS_HISTORY_LENGTH];
+    VkDescriptorSet descSets[MAX_FRAMES_IN_FLIGHT];
 
     std::list<std::weak_ptr<IFramebuffersDependency>> subscribers;
 };
@@ -212,10 +212,6 @@ GRADIENT_ESTIMATION_ENABLED = True
 FRAMEBUF_IGNORE_ATTACHMENTS_DEFINE = "FRAMEBUF_IGNORE_ATTACHMENTS" # define this, to not specify framebufs that are used as attachments
 
 CONST = {
-    "MAX_STATIC_VERTEX_COUNT"               : 1 << 20,
-    "MAX_DYNAMIC_VERTEX_COUNT"              : 1 << 21,
-    "MAX_INDEXED_PRIMITIVE_COUNT"           : 1 << 20,
-   
     "MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT"     : 1 << 12,
     "MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT_POW" : CONST_TO_EVALUATE,
     "MAX_GEOMETRY_PRIMITIVE_COUNT"          : CONST_TO_EVALUATE,
@@ -223,7 +219,9 @@ CONST = {
     # used for first-person geometries
     "LOWER_BOTTOM_LEVEL_GEOMETRIES_COUNT"   : 1 << 8,
     
-    "MAX_TOP_LEVEL_INSTANCE_COUNT"          : 45,
+    "MAX_TOP_LEVEL_INSTANCE_COUNT"          : 255,
+    "MAX_MESH_POOL_VERTEX_COUNT"            : 1 << 19,
+    "MAX_MESH_POOL_INDEX_COUNT"             : 1 << 20,
     
     "BINDING_VERTEX_BUFFER_STATIC"              : 0,
     "BINDING_VERTEX_BUFFER_DYNAMIC"             : 1,
@@ -234,6 +232,8 @@ CONST = {
     "BINDING_PREV_POSITIONS_BUFFER_DYNAMIC"     : 6,
     "BINDING_PREV_INDEX_BUFFER_DYNAMIC"         : 7,
     "BINDING_PER_TRIANGLE_INFO"                 : 8,
+    "BINDING_MESH_VERTEX_BUFFER"                : 9,
+    "BINDING_MESH_INDEX_BUFFER"                 : 10,
     "BINDING_GLOBAL_UNIFORM"                    : 0,
     "BINDING_ACCELERATION_STRUCTURE_MAIN"       : 0,
     "BINDING_TEXTURES"                          : 0,
@@ -255,6 +255,12 @@ CONST = {
     "BINDING_LENS_FLARES_DRAW_CMDS"             : 1,
     "BINDING_DRAW_LENS_FLARES_INSTANCES"        : 0,
     "BINDING_DECAL_INSTANCES"                   : 0,
+    "BINDING_VERT_PREPROC_CHUNKS"               : 0,
+    "BINDING_VERT_PREPROC_NORMALS_ACCUM"        : 1,
+    "BINDING_SKINNING_CHUNKS"                   : 0,
+    "BINDING_SKINNING_JOINT_INDICES"            : 1,
+    "BINDING_SKINNING_JOINT_WEIGHTS"            : 2,
+    "BINDING_SKINNING_JOINT_TRANSFORMS"         : 3,
     
     "INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC"                : "1 << 0",
     "INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON"           : "1 << 1",
@@ -289,6 +295,10 @@ CONST = {
     
     "MATERIAL_NO_TEXTURE"                   : 0,
 
+    "MAX_ANIMATED_MATERIAL_SLOTS"           : 128,
+    # if set, material texture index is a slot in globalUniform.animatedMaterialTextures
+    "MATERIAL_ANIMATED_SLOT_FLAG"           : "1 << 30",
+
     "MATERIAL_BLENDING_FLAG_OPAQUE"         : "1 << 0",
     "MATERIAL_BLENDING_FLAG_ALPHA"          : "1 << 1",
     "MATERIAL_BLENDING_FLAG_ADD"            : "1 << 2",
@@ -304,7 +314,7 @@ CONST = {
     "GEOM_INST_FLAG_RESERVED_3"             : "1 << 16",
     "GEOM_INST_FLAG_RESERVED_4"             : "1 << 17",
     "GEOM_INST_FLAG_RESERVED_5"             : "1 << 18",
-    "GEOM_INST_FLAG_RESERVED_6"             : "1 << 19",
+    "GEOM_INST_FLAG_RESIDENT_MESH"          : "1 << 19",
     "GEOM_INST_FLAG_IGNORE_REFL_REFR_AFTER" : "1 << 20",
     "GEOM_INST_FLAG_REFL_REFR_ALBEDO_MULT"  : "1 << 21",
     "GEOM_INST_FLAG_REFL_REFR_ALBEDO_ADD"   : "1 << 22",
@@ -340,6 +350,15 @@ CONST = {
     "COMPUTE_EFFECT_GROUP_SIZE_X"           : 16,
     "COMPUTE_EFFECT_GROUP_SIZE_Y"           : 16,
 
+    # effects in the order they're applied in EfSimpleChain.comp
+    "EFFECT_SIMPLE_CHAIN_COLOR_TINT"            : "1 << 0",
+    "EFFECT_SIMPLE_CHAIN_INVERSE_BW"            : "1 << 1",
+    "EFFECT_SIMPLE_CHAIN_HUE_SHIFT"             : "1 << 2",
+    "EFFECT_SIMPLE_CHAIN_CHROMATIC_ABERRATION"  : "1 << 3",
+    "EFFECT_SIMPLE_CHAIN_DISTORTED_SIDES"       : "1 << 4",
+    "EFFECT_SIMPLE_CHAIN_RADIAL_BLUR"           : "1 << 5",
+    "EFFECT_SIMPLE_CHAIN_LENGTH"                : 6,
+
     "COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_X"    : 16,
     "COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_Y"    : 16,
     "COMPUTE_LUM_HISTOGRAM_BIN_COUNT"       : 256,
@@ -348,6 +367,12 @@ CONST = {
     "VERT_PREPROC_MODE_ONLY_DYNAMIC"        : 0,
     "VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE" : 1,
     "VERT_PREPROC_MODE_ALL"                 : 2,
+    "VERT_PREPROC_PASS_ACCUMULATE"          : 0,
+    "VERT_PREPROC_PASS_RESOLVE"             : 1,
+    "MAX_VERT_PREPROC_ACCUM_VERTEX_COUNT"   : 1 << 20,
+    "COMPUTE_SKINNING_GROUP_SIZE_X"         : 256,
+    "MAX_SKINNED_VERTEX_COUNT"              : 1 << 18,
+    "MAX_SKINNING_JOINT_COUNT"              : 1 << 13,
 
     "GRADIENT_ESTIMATION_ENABLED"           : int(GRADIENT_ESTIMATION_ENABLED),
     "COMPUTE_GRADIENT_SAMPLES_GROUP_SIZE_X" : 16,
@@ -357,6 +382,12 @@ CONST = {
     "COMPUTE_SVGF_VARIANCE_GROUP_SIZE_X"    : 16,
     "COMPUTE_SVGF_ATROUS_GROUP_SIZE_X"      : 16,
     "COMPUTE_SVGF_ATROUS_ITERATION_COUNT"   : 4,
+    "COMPUTE_INDIRECT_RECONSTRUCT_GROUP_SIZE_X" : 16,
+    "COMPUTE_INDIRECT_RECONSTRUCT_GROUP_SIZE_Y" : 16,
+
+    "INDIRECT_ILLUMINATION_MODE_FULL"           : 0,
+    "INDIRECT_ILLUMINATION_MODE_CHECKERBOARD"   : 1,
+    "INDIRECT_ILLUMINATION_MODE_HALF"           : 2,
 
     "COMPUTE_ASVGF_STRATA_SIZE"                         : 3,
     "COMPUTE_ASVGF_GRADIENT_ATROUS_ITERATION_COUNT"     : 4,  
@@ -423,20 +454,6 @@ def evalConst():
 # If count > 1 and dimensions is 2, 3 or 4 (matrices are not supported)
 # then it'll be represented as an array with size (count*dimensions).
 
-STATIC_BUFFER_STRUCT = [
-    (TYPE_FLOAT32,      3,     "positions",             CONST["MAX_STATIC_VERTEX_COUNT"]),
-    (TYPE_FLOAT32,      3,     "normals",               CONST["MAX_STATIC_VERTEX_COUNT"]),
-    (TYPE_FLOAT32,      2,     "texCoords",             CONST["MAX_STATIC_VERTEX_COUNT"]),
-    (TYPE_FLOAT32,      2,     "texCoordsLayer1",       CONST["MAX_STATIC_VERTEX_COUNT"]),
-    (TYPE_FLOAT32,      2,     "texCoordsLayer2",       CONST["MAX_STATIC_VERTEX_COUNT"]),
-]
-
-DYNAMIC_BUFFER_STRUCT = [
-    (TYPE_FLOAT32,      3,     "positions",             CONST["MAX_DYNAMIC_VERTEX_COUNT"]),
-    (TYPE_FLOAT32,      3,     "normals",               CONST["MAX_DYNAMIC_VERTEX_COUNT"]),
-    (TYPE_FLOAT32,      2,     "texCoords",             CONST["MAX_DYNAMIC_VERTEX_COUNT"]),
-]
-
 # Must be careful with std140 offsets! They are set manually.
 # Other structs are using std430 and padding is done automatically.
 GLOBAL_UNIFORM_STRUCT = [
@@ -565,9 +582,19 @@ GLOBAL_UNIFORM_STRUCT = [
     (TYPE_UINT32,       1,      "areFramebufsInitedByRT",           1),
 
     (TYPE_FLOAT32,      1,      "bloomEmissionSaturationBias",      1),
-    (TYPE_FLOAT32,      1,      "_pad1",                            1),
-    (TYPE_FLOAT32,      1,      "_pad2",                            1),
-    (TYPE_FLOAT32,      1,      "_pad3",                            1),
+    (TYPE_UINT32,       1,      "staticNormalsOffset",              1),
+    (TYPE_UINT32,       1,      "staticTexCoordsOffset",            1),
+    (TYPE_UINT32,       1,      "staticTexCoordsLayer1Offset",      1),
+
+    (TYPE_UINT32,       1,      "staticTexCoordsLayer2Offset",      1),
+    (TYPE_UINT32,       1,      "dynamicNormalsOffset",             1),
+    (TYPE_UINT32,       1,      "dynamicTexCoordsOffset",           1),
+    (TYPE_FLOAT32,      1,      "renderAllocatedWidth",             1),
+
+    (TYPE_FLOAT32,      1,      "renderAllocatedHeight",            1),
+    (TYPE_UINT32,       1,      "indirectIlluminationMode",         1),
+    (TYPE_FLOAT32,      1,      "prevRenderWidth",                  1),
+    (TYPE_FLOAT32,      1,      "prevRenderHeight",                 1),
 
     #(TYPE_FLOAT32,      1,      "_pad0",                            1),
     #(TYPE_FLOAT32,      1,      "_pad1",                            1),
@@ -577,9 +604,9 @@ GLOBAL_UNIFORM_STRUCT = [
     # for std140
     (TYPE_INT32,        4,      "instanceGeomInfoOffset",       align4(CONST["MAX_TOP_LEVEL_INSTANCE_COUNT"]) // 4),
     (TYPE_INT32,        4,      "instanceGeomInfoOffsetPrev",   align4(CONST["MAX_TOP_LEVEL_INSTANCE_COUNT"]) // 4),
-    (TYPE_INT32,        4,      "instanceGeomCount",            align4(CONST["MAX_TOP_LEVEL_INSTANCE_COUNT"]) // 4),
     (TYPE_FLOAT32,     44,      "viewProjCubemap",              6),
     (TYPE_FLOAT32,     44,      "skyCubemapRotationTransform",  1),
+    (TYPE_UINT32,       4,      "animatedMaterialTextures",     CONST["MAX_ANIMATED_MATERIAL_SLOTS"]),
 ]
 
 GEOM_INSTANCE_STRUCT = [
@@ -634,8 +661,47 @@ TONEMAPPING_STRUCT = [
 ]
 
 VERT_PREPROC_PUSH_STRUCT = [
-    (TYPE_UINT32,       1,      "tlasInstanceCount",                1),
-    (TYPE_UINT32,       1,      "tlasInstanceIsDynamicBits",        align(CONST["MAX_TOP_LEVEL_INSTANCE_COUNT"], 32) // 32),
+    # chunks of the current batch
+    (TYPE_UINT32,       1,      "chunkOffset",                      1),
+    (TYPE_UINT32,       1,      "chunkCount",                       1),
+    (TYPE_UINT32,       1,      "totalTriangleCount",               1),
+    (TYPE_UINT32,       1,      "totalAccumVertexCount",            1),
+]
+
+# Geometry to preprocess; one thread is dispatched per triangle to accumulate
+# face normals, then one thread per vertex of indexed geometry to resolve them
+VERT_PREPROC_CHUNK_STRUCT = [
+    (TYPE_UINT32,       1,      "globalGeomIndex",                  1),
+    # sum of triangle counts of all previous chunks in the batch
+    (TYPE_UINT32,       1,      "triangleOffset",                   1),
+    (TYPE_UINT32,       1,      "triangleCount",                    1),
+    (TYPE_UINT32,       1,      "isDynamic",                        1),
+    # sum of accumulated vertex counts of all previous chunks in the batch
+    (TYPE_UINT32,       1,      "accumVertexOffset",                1),
+    # 0, if vertices are not shared between triangles
+    (TYPE_UINT32,       1,      "accumVertexCount",                 1),
+]
+
+# Vertex buffer offsets are in push constants, as skinning
+# is done before the global uniform is uploaded
+SKINNING_PUSH_STRUCT = [
+    (TYPE_UINT32,       1,      "chunkCount",                       1),
+    (TYPE_UINT32,       1,      "totalVertexCount",                 1),
+    # in floats
+    (TYPE_UINT32,       1,      "positionsStride",                  1),
+    (TYPE_UINT32,       1,      "normalsStride",                    1),
+    (TYPE_UINT32,       1,      "normalsOffset",                    1),
+]
+
+# Mesh instance to skin in the dynamic vertex buffer; one thread is dispatched per vertex
+SKINNING_CHUNK_STRUCT = [
+    (TYPE_UINT32,       1,      "baseVertexIndex",                  1),
+    # sum of vertex counts of all previous chunks, also an index in joint index / weight arrays
+    (TYPE_UINT32,       1,      "vertexOffset",                     1),
+    (TYPE_UINT32,       1,      "vertexCount",                      1),
+    (TYPE_UINT32,       1,      "jointOffset",                      1),
+    (TYPE_UINT32,       1,      "jointCount",                       1),
+    (TYPE_UINT32,       1,      "skinNormals",                      1),
 ]
 
 INDIRECT_DRAW_CMD_STRUCT = [
@@ -673,8 +739,6 @@ STRUCT_BREAK_TYPE_ONLY_C    = 2
 # breakType         -- if member's type is not primitive and its count>0 then
 #                      it'll be represented as an array of primitive types
 STRUCTS = {
-    "ShVertexBufferStatic":     (STATIC_BUFFER_STRUCT,          False,  0,                          STRUCT_BREAK_TYPE_COMPLEX),
-    "ShVertexBufferDynamic":    (DYNAMIC_BUFFER_STRUCT,         False,  0,                          STRUCT_BREAK_TYPE_COMPLEX),
     "ShGlobalUniform":          (GLOBAL_UNIFORM_STRUCT,         False,  STRUCT_ALIGNMENT_STD140,    STRUCT_BREAK_TYPE_ONLY_C),
     "ShGeometryInstance":       (GEOM_INSTANCE_STRUCT,          False,  STRUCT_ALIGNMENT_STD430,    0),
     "ShTonemapping":            (TONEMAPPING_STRUCT,            False,  0,                          0),
@@ -682,6 +746,9 @@ STRUCTS = {
     # "ShLightDirectional":     (LIGHT_DIRECTIONAL_STRUCT,      False,  STRUCT_ALIGNMENT_STD430,    0),
     "ShLightPolygonal":         (LIGHT_POLYGONAL_STRUCT,        False,  STRUCT_ALIGNMENT_STD430,    0),
     "ShVertPreprocessing":      (VERT_PREPROC_PUSH_STRUCT,      False,  0,                          0),
+    "ShVertPreprocessChunk":    (VERT_PREPROC_CHUNK_STRUCT,     False,  STRUCT_ALIGNMENT_STD430,    0),
+    "ShSkinning":               (SKINNING_PUSH_STRUCT,          False,  0,                          0),
+    "ShSkinningChunk":          (SKINNING_CHUNK_STRUCT,         False,  STRUCT_ALIGNMENT_STD430,    0),
     "ShIndirectDrawCommand":    (INDIRECT_DRAW_CMD_STRUCT,      False,  STRUCT_ALIGNMENT_STD430,    0),
     # TODO: should be STRUCT_ALIGNMENT_STD430, but current generator is not great as it just adds pads at the end, so it's 0
     "ShLensFlareInstance":      (LENS_FLARES_INSTANCE_STRUCT,   False,  0,                          0),
@@ -694,8 +761,6 @@ STRUCTS = {
 
 GETTERS = {
     # (struct type): (member to access with)
-    "ShVertexBufferStatic": "staticVertices",
-    "ShVertexBufferDynamic": "dynamicVertices",
 }
 
 
@@ -756,6 +821,8 @@ FRAMEBUFFERS = {
     "UnfilteredIndirectSH_R"            : (TYPE_FLOAT16,    COMPONENT_RGBA, 0),
     "UnfilteredIndirectSH_G"            : (TYPE_FLOAT16,    COMPONENT_RGBA, 0),
     "UnfilteredIndirectSH_B"            : (TYPE_FLOAT16,    COMPONENT_RGBA, 0),
+    # rgb - indirect specular, a - hit distance; for reconstruction, if indirect is not traced for every pixel
+    "UnfilteredIndirectSpecular"        : (TYPE_FLOAT16,    COMPONENT_RGBA, 0),
     "SurfacePosition"                   : (TYPE_FLOAT32,    COMPONENT_RGBA, 0),
     "VisibilityBuffer"                  : (TYPE_FLOAT32,    COMPONENT_RGBA, FRAMEBUF_FLAGS_STORE_PREV),
     "SectorIndex"                       : (TYPE_UINT16,     COMPONENT_R,    FRAMEBUF_FLAGS_STORE_PREV),
@@ -816,6 +883,59 @@ if GRADIENT_ESTIMATION_ENABLED:
     })
 
 
+# Coarse passes of a frame, in the order of execution
+FRAMEBUF_PASSES = [
+    "PRIMARY",              # primary rays, decals, reflection/refraction rays, direct and indirect illumination
+    "DENOISE",              # gradients, temporal accumulation, variance estimation, atrous, tonemapping
+    "BLOOM",                # bloom downsample/upsample
+    "COMPOSITION",          # composition, rasterized geometry
+    "POSTPROCESS",          # upscaling, sharpening, bloom apply, effects, present
+]
+
+# Framebufs whose content is not needed between frames:
+# they are written and read only in the range of passes [first, last].
+# Framebufs with non-intersecting ranges share memory.
+# Should be used carefully: if a framebuf is read before it's written in a frame,
+# or is read outside of its range, the content is undefined.
+FRAMEBUFFERS_LIFETIMES = {
+    # (image name)                      : (first pass,      last pass)
+    "SurfacePosition"                   : ("PRIMARY",       "DENOISE"),
+    "ViewDirection"                     : ("PRIMARY",       "DENOISE"),
+    "PrimaryToReflRefr"                 : ("PRIMARY",       "PRIMARY"),
+    "UnfilteredIndirectSpecular"        : ("PRIMARY",       "PRIMARY"),
+    "Final"                             : ("COMPOSITION",   "POSTPROCESS"),
+    "UpscaledPing"                      : ("POSTPROCESS",   "POSTPROCESS"),
+    "UpscaledPong"                      : ("POSTPROCESS",   "POSTPROCESS"),
+    "DiffPingColorAndVariance"          : ("DENOISE",       "DENOISE"),
+    "DiffPongColorAndVariance"          : ("DENOISE",       "DENOISE"),
+    "SpecPingColor"                     : ("DENOISE",       "DENOISE"),
+    "SpecPongColor"                     : ("DENOISE",       "DENOISE"),
+    "IndirPingSH_R"                     : ("DENOISE",       "DENOISE"),
+    "IndirPingSH_G"                     : ("DENOISE",       "DENOISE"),
+    "IndirPingSH_B"                     : ("DENOISE",       "DENOISE"),
+    # composition can show it for debugging
+    "IndirPongSH_R"                     : ("DENOISE",       "COMPOSITION"),
+    "IndirPongSH_G"                     : ("DENOISE",       "COMPOSITION"),
+    "IndirPongSH_B"                     : ("DENOISE",       "COMPOSITION"),
+    "AtrousFilteredVariance"            : ("DENOISE",       "DENOISE"),
+    "Bloom_Mip1"                        : ("BLOOM",         "BLOOM"),
+    "Bloom_Mip2"                        : ("BLOOM",         "BLOOM"),
+    "Bloom_Mip3"                        : ("BLOOM",         "BLOOM"),
+    "Bloom_Mip4"                        : ("BLOOM",         "BLOOM"),
+    "Bloom_Mip5"                        : ("BLOOM",         "BLOOM"),
+    "Bloom_Result"                      : ("BLOOM",         "POSTPROCESS"),
+}
+
+if GRADIENT_ESTIMATION_ENABLED:
+    FRAMEBUFFERS_LIFETIMES.update({
+        # composition can show it for debugging
+        "DiffAndSpecPingGradient"           : ("DENOISE",       "COMPOSITION"),
+        "DiffAndSpecPongGradient"           : ("DENOISE",       "DENOISE"),
+        "IndirPingGradient"                 : ("DENOISE",       "COMPOSITION"),
+        "IndirPongGradient"                 : ("DENOISE",       "DENOISE"),
+    })
+
+
 # ---
 # User defined structs END
 # ---
@@ -1154,7 +1274,11 @@ def getAllFramebufConstants():
         for (flName, flValue) in FRAMEBUF_FLAGS_ENUM.items()
     ) + "\n};\ntypedef uint32_t FramebufferImageFlags;\n\n"
 
-    return fbConst + fbEnum + fbFlags
+    fbPasses = "#define FB_LIFETIME_PERSISTENT 0xFFFFFFFF\n\n" + "enum FramebufferPass\n{\n" + "\n".join(
+        "    FB_PASS_%s = %d," % (FRAMEBUF_PASSES[i], i) for i in range(len(FRAMEBUF_PASSES))
+    ) + "\n    FB_PASS_COUNT = %d,\n};\n\n" % len(FRAMEBUF_PASSES)
+
+    return fbConst + fbEnum + fbFlags + fbPasses
 
 
 def getPublicFlags(flags):
@@ -1177,7 +1301,18 @@ def getAllVulkanFramebufDeclarations():
             "extern const uint32_t ShFramebuffers_BindingsSwapped[];\n"
             "extern const uint32_t ShFramebuffers_Sampler_Bindings[];\n"
             "extern const uint32_t ShFramebuffers_Sampler_BindingsSwapped[];\n"
-            "extern const char *const ShFramebuffers_DebugNames[];\n\n")
+            "extern const char *const ShFramebuffers_DebugNames[];\n"
+            "extern const uint32_t ShFramebuffers_LifetimeFirstPass[];\n"
+            "extern const uint32_t ShFramebuffers_LifetimeLastPass[];\n\n")
+
+
+def getLifetimePass(name, isFirst):
+    if name not in FRAMEBUFFERS_LIFETIMES:
+        return "FB_LIFETIME_PERSISTENT"
+    first, last = FRAMEBUFFERS_LIFETIMES[name]
+    assert not (FRAMEBUFFERS[name][2] & FRAMEBUF_FLAGS_STORE_PREV), "Framebuf with history can't have a lifetime: " + name
+    assert FRAMEBUF_PASSES.index(first) <= FRAMEBUF_PASSES.index(last), "Wrong lifetime range: " + name
+    return "RTGL1::FB_PASS_" + (first if isFirst else last)
 
 
 def getAllVulkanFramebufDefinitions():
@@ -1188,7 +1323,9 @@ def getAllVulkanFramebufDefinitions():
                 "const uint32_t RTGL1::ShFramebuffers_BindingsSwapped[] = \n{\n%s};\n\n"
                 "const uint32_t RTGL1::ShFramebuffers_Sampler_Bindings[] = \n{\n%s};\n\n"
                 "const uint32_t RTGL1::ShFramebuffers_Sampler_BindingsSwapped[] = \n{\n%s};\n\n"
-                "const char *const RTGL1::ShFramebuffers_DebugNames[] = \n{\n%s};\n\n")
+                "const char *const RTGL1::ShFramebuffers_DebugNames[] = \n{\n%s};\n\n"
+                "const uint32_t RTGL1::ShFramebuffers_LifetimeFirstPass[] = \n{\n%s};\n\n"
+                "const uint32_t RTGL1::ShFramebuffers_LifetimeLastPass[] = \n{\n%s};\n\n")
     TAB_STR = "    "
     formats = ""
     count = 0
@@ -1199,10 +1336,14 @@ def getAllVulkanFramebufDefinitions():
     samplerBindings = ""
     samplerBindingsSwapped = ""
     names = ""
+    lifetimeFirst = ""
+    lifetimeLast = ""
     for name, (baseFormat, components, flags) in FRAMEBUFFERS.items():
         formats += TAB_STR + VULKAN_IMAGE_FORMATS[(baseFormat, components)] + ",\n"
         names += TAB_STR + "\"" + FRAMEBUF_DEBUG_NAME_PREFIX + name + "\",\n"
         publicFlags += TAB_STR + getPublicFlags(flags) + ",\n"
+        lifetimeFirst += TAB_STR + getLifetimePass(name, True) + ",\n"
+        lifetimeLast += TAB_STR + getLifetimePass(name, False) + ",\n"
 
         if not flags & FRAMEBUF_FLAGS_STORE_PREV:
             bindings                += TAB_STR + str(count)         + ",\n"
@@ -1216,6 +1357,9 @@ def getAllVulkanFramebufDefinitions():
             formats += TAB_STR + VULKAN_IMAGE_FORMATS[(baseFormat, components)] + ",\n"
             names += TAB_STR + "\"" + FRAMEBUF_DEBUG_NAME_PREFIX + name + FRAMEBUF_STORE_PREV_POSTFIX + "\",\n"
             publicFlags += TAB_STR + getPublicFlags(flags) + ",\n"
+            # history is always persistent
+            lifetimeFirst += TAB_STR + "FB_LIFETIME_PERSISTENT,\n"
+            lifetimeLast += TAB_STR + "FB_LIFETIME_PERSISTENT,\n"
             count += 1
 
         count += 1
@@ -1239,7 +1383,7 @@ def getAllVulkanFramebufDefinitions():
 
         samplerCount += 1
 
-    return template % (count, formats, publicFlags, bindings, bindingsSwapped, samplerBindings, samplerBindingsSwapped, names)
+    return template % (count, formats, publicFlags, bindings, bindingsSwapped, samplerBindings, samplerBindingsSwapped, names, lifetimeFirst, lifetimeLast)
 
 
 FILE_HEADER = "// This file was generated by GenerateShaderCommon.py\n\n"
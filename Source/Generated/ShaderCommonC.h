@@ -7,15 +7,14 @@ namespace RTGL1
 
 #include <stdint.h>
 
-#define MAX_STATIC_VERTEX_COUNT (1048576)
-#define MAX_DYNAMIC_VERTEX_COUNT (2097152)
-#define MAX_INDEXED_PRIMITIVE_COUNT (1048576)
 #define MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT (4096)
 #define MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT_POW (12)
 #define MAX_GEOMETRY_PRIMITIVE_COUNT (1048576)
 #define MAX_GEOMETRY_PRIMITIVE_COUNT_POW (20)
 #define LOWER_BOTTOM_LEVEL_GEOMETRIES_COUNT (256)
-#define MAX_TOP_LEVEL_INSTANCE_COUNT (45)
+#define MAX_TOP_LEVEL_INSTANCE_COUNT (255)
+#define MAX_MESH_POOL_VERTEX_COUNT (524288)
+#define MAX_MESH_POOL_INDEX_COUNT (1048576)
 #define BINDING_VERTEX_BUFFER_STATIC (0)
 #define BINDING_VERTEX_BUFFER_DYNAMIC (1)
 #define BINDING_INDEX_BUFFER_STATIC (2)
@@ -25,6 +24,8 @@ namespace RTGL1
 #define BINDING_PREV_POSITIONS_BUFFER_DYNAMIC (6)
 #define BINDING_PREV_INDEX_BUFFER_DYNAMIC (7)
 #define BINDING_PER_TRIANGLE_INFO (8)
+#define BINDING_MESH_VERTEX_BUFFER (9)
+#define BINDING_MESH_INDEX_BUFFER (10)
 #define BINDING_GLOBAL_UNIFORM (0)
 #define BINDING_ACCELERATION_STRUCTURE_MAIN (0)
 #define BINDING_TEXTURES (0)
@@ -46,6 +47,12 @@ namespace RTGL1
 #define BINDING_LENS_FLARES_DRAW_CMDS (1)
 #define BINDING_DRAW_LENS_FLARES_INSTANCES (0)
 #define BINDING_DECAL_INSTANCES (0)
+#define BINDING_VERT_PREPROC_CHUNKS (0)
+#define BINDING_VERT_PREPROC_NORMALS_ACCUM (1)
+#define BINDING_SKINNING_CHUNKS (0)
+#define BINDING_SKINNING_JOINT_INDICES (1)
+#define BINDING_SKINNING_JOINT_WEIGHTS (2)
+#define BINDING_SKINNING_JOINT_TRANSFORMS (3)
 #define INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC (1 << 0)
 #define INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON (1 << 1)
 #define INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON_VIEWER (1 << 2)
@@ -73,6 +80,8 @@ namespace RTGL1
 #define MATERIAL_ROUGHNESS_METALLIC_EMISSION_INDEX (1)
 #define MATERIAL_NORMAL_INDEX (2)
 #define MATERIAL_NO_TEXTURE (0)
+#define MAX_ANIMATED_MATERIAL_SLOTS (128)
+#define MATERIAL_ANIMATED_SLOT_FLAG (1 << 30)
 #define MATERIAL_BLENDING_FLAG_OPAQUE (1 << 0)
 #define MATERIAL_BLENDING_FLAG_ALPHA (1 << 1)
 #define MATERIAL_BLENDING_FLAG_ADD (1 << 2)
@@ -87,7 +96,7 @@ namespace RTGL1
 #define GEOM_INST_FLAG_RESERVED_3 (1 << 16)
 #define GEOM_INST_FLAG_RESERVED_4 (1 << 17)
 #define GEOM_INST_FLAG_RESERVED_5 (1 << 18)
-#define GEOM_INST_FLAG_RESERVED_6 (1 << 19)
+#define GEOM_INST_FLAG_RESIDENT_MESH (1 << 19)
 #define GEOM_INST_FLAG_IGNORE_REFL_REFR_AFTER (1 << 20)
 #define GEOM_INST_FLAG_REFL_REFR_ALBEDO_MULT (1 << 21)
 #define GEOM_INST_FLAG_REFL_REFR_ALBEDO_ADD (1 << 22)
@@ -117,6 +126,13 @@ namespace RTGL1
 #define COMPUTE_BLOOM_STEP_COUNT (5)
 #define COMPUTE_EFFECT_GROUP_SIZE_X (16)
 #define COMPUTE_EFFECT_GROUP_SIZE_Y (16)
+#define EFFECT_SIMPLE_CHAIN_COLOR_TINT (1 << 0)
+#define EFFECT_SIMPLE_CHAIN_INVERSE_BW (1 << 1)
+#define EFFECT_SIMPLE_CHAIN_HUE_SHIFT (1 << 2)
+#define EFFECT_SIMPLE_CHAIN_CHROMATIC_ABERRATION (1 << 3)
+#define EFFECT_SIMPLE_CHAIN_DISTORTED_SIDES (1 << 4)
+#define EFFECT_SIMPLE_CHAIN_RADIAL_BLUR (1 << 5)
+#define EFFECT_SIMPLE_CHAIN_LENGTH (6)
 #define COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_X (16)
 #define COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_Y (16)
 #define COMPUTE_LUM_HISTOGRAM_BIN_COUNT (256)
@@ -124,6 +140,12 @@ namespace RTGL1
 #define VERT_PREPROC_MODE_ONLY_DYNAMIC (0)
 #define VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE (1)
 #define VERT_PREPROC_MODE_ALL (2)
+#define VERT_PREPROC_PASS_ACCUMULATE (0)
+#define VERT_PREPROC_PASS_RESOLVE (1)
+#define MAX_VERT_PREPROC_ACCUM_VERTEX_COUNT (1048576)
+#define COMPUTE_SKINNING_GROUP_SIZE_X (256)
+#define MAX_SKINNED_VERTEX_COUNT (262144)
+#define MAX_SKINNING_JOINT_COUNT (8192)
 #define GRADIENT_ESTIMATION_ENABLED (1)
 #define COMPUTE_GRADIENT_SAMPLES_GROUP_SIZE_X (16)
 #define COMPUTE_GRADIENT_MERGING_GROUP_SIZE_X (16)
@@ -132,6 +154,11 @@ namespace RTGL1
 #define COMPUTE_SVGF_VARIANCE_GROUP_SIZE_X (16)
 #define COMPUTE_SVGF_ATROUS_GROUP_SIZE_X (16)
 #define COMPUTE_SVGF_ATROUS_ITERATION_COUNT (4)
+#define COMPUTE_INDIRECT_RECONSTRUCT_GROUP_SIZE_X (16)
+#define COMPUTE_INDIRECT_RECONSTRUCT_GROUP_SIZE_Y (16)
+#define INDIRECT_ILLUMINATION_MODE_FULL (0)
+#define INDIRECT_ILLUMINATION_MODE_CHECKERBOARD (1)
+#define INDIRECT_ILLUMINATION_MODE_HALF (2)
 #define COMPUTE_ASVGF_STRATA_SIZE (3)
 #define COMPUTE_ASVGF_GRADIENT_ATROUS_ITERATION_COUNT (4)
 #define COMPUTE_INDIRECT_DRAW_FLARES_GROUP_SIZE_X (256)
@@ -150,22 +177,6 @@ namespace RTGL1
 #define GEOM_INST_NO_TRIANGLE_INFO (UINT32_MAX)
 #define SECTOR_INDEX_NONE (32767)
 
-struct ShVertexBufferStatic
-{
-    float positions[3145728];
-    float normals[3145728];
-    float texCoords[2097152];
-    float texCoordsLayer1[2097152];
-    float texCoordsLayer2[2097152];
-};
-
-struct ShVertexBufferDynamic
-{
-    float positions[6291456];
-    float normals[6291456];
-    float texCoords[4194304];
-};
-
 struct ShGlobalUniform
 {
     float view[16];
@@ -266,14 +277,22 @@ struct ShGlobalUniform
     uint32_t applyViewProjToLensFlares;
     uint32_t areFramebufsInitedByRT;
     float bloomEmissionSaturationBias;
-    float _pad1;
-    float _pad2;
-    float _pad3;
-    int32_t instanceGeomInfoOffset[48];
-    int32_t instanceGeomInfoOffsetPrev[48];
-    int32_t instanceGeomCount[48];
+    uint32_t staticNormalsOffset;
+    uint32_t staticTexCoordsOffset;
+    uint32_t staticTexCoordsLayer1Offset;
+    uint32_t staticTexCoordsLayer2Offset;
+    uint32_t dynamicNormalsOffset;
+    uint32_t dynamicTexCoordsOffset;
+    float renderAllocatedWidth;
+    float renderAllocatedHeight;
+    uint32_t indirectIlluminationMode;
+    float prevRenderWidth;
+    float prevRenderHeight;
+    int32_t instanceGeomInfoOffset[256];
+    int32_t instanceGeomInfoOffsetPrev[256];
     float viewProjCubemap[96];
     float skyCubemapRotationTransform[16];
+    uint32_t animatedMaterialTextures[512];
 };
 
 struct ShGeometryInstance
@@ -328,8 +347,43 @@ struct ShLightPolygonal
 
 struct ShVertPreprocessing
 {
-    uint32_t tlasInstanceCount;
-    uint32_t tlasInstanceIsDynamicBits[2];
+    uint32_t chunkOffset;
+    uint32_t chunkCount;
+    uint32_t totalTriangleCount;
+    uint32_t totalAccumVertexCount;
+};
+
+struct ShVertPreprocessChunk
+{
+    uint32_t globalGeomIndex;
+    uint32_t triangleOffset;
+    uint32_t triangleCount;
+    uint32_t isDynamic;
+    uint32_t accumVertexOffset;
+    uint32_t accumVertexCount;
+    uint32_t __pad0;
+    uint32_t __pad1;
+};
+
+struct ShSkinning
+{
+    uint32_t chunkCount;
+    uint32_t totalVertexCount;
+    uint32_t positionsStride;
+    uint32_t normalsStride;
+    uint32_t normalsOffset;
+};
+
+struct ShSkinningChunk
+{
+    uint32_t baseVertexIndex;
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+    uint32_t jointOffset;
+    uint32_t jointCount;
+    uint32_t skinNormals;
+    uint32_t __pad0;
+    uint32_t __pad1;
 };
 
 struct ShIndirectDrawCommand
@@ -2,7 +2,7 @@
 
 #include "ShaderCommonCFramebuf.h"
 
-const uint32_t RTGL1::ShFramebuffers_Count = 70;
+const uint32_t RTGL1::ShFramebuffers_Count = 71;
 
 const VkFormat RTGL1::ShFramebuffers_Formats[] = 
 {
@@ -23,6 +23,7 @@ const VkFormat RTGL1::ShFramebuffers_Formats[] =
     VK_FORMAT_R16G16B16A16_SFLOAT,
     VK_FORMAT_R16G16B16A16_SFLOAT,
     VK_FORMAT_R16G16B16A16_SFLOAT,
+    VK_FORMAT_R16G16B16A16_SFLOAT,
     VK_FORMAT_R32G32B32A32_SFLOAT,
     VK_FORMAT_R32G32B32A32_SFLOAT,
     VK_FORMAT_R32G32B32A32_SFLOAT,
@@ -105,6 +106,7 @@ const RTGL1::FramebufferImageFlags RTGL1::ShFramebuffers_Flags[] =
     0,
     0,
     0,
+    0,
     RTGL1::FB_IMAGE_FLAGS_FRAMEBUF_FLAGS_BILINEAR_SAMPLER,
     RTGL1::FB_IMAGE_FLAGS_FRAMEBUF_FLAGS_IS_ATTACHMENT,
     RTGL1::FB_IMAGE_FLAGS_FRAMEBUF_FLAGS_IS_ATTACHMENT | RTGL1::FB_IMAGE_FLAGS_FRAMEBUF_FLAGS_UPSCALED_SIZE | RTGL1::FB_IMAGE_FLAGS_FRAMEBUF_FLAGS_USAGE_TRANSFER,
@@ -224,6 +226,7 @@ const uint32_t RTGL1::ShFramebuffers_Bindings[] =
     67,
     68,
     69,
+    70,
 };
 
 const uint32_t RTGL1::ShFramebuffers_BindingsSwapped[] = 
@@ -246,11 +249,11 @@ const uint32_t RTGL1::ShFramebuffers_BindingsSwapped[] =
     15,
     16,
     17,
-    19,
     18,
-    21,
     20,
+    19,
     22,
+    21,
     23,
     24,
     25,
@@ -259,26 +262,26 @@ const uint32_t RTGL1::ShFramebuffers_BindingsSwapped[] =
     28,
     29,
     30,
-    32,
     31,
-    34,
     33,
-    36,
+    32,
     35,
+    34,
     37,
+    36,
     38,
     39,
-    41,
     40,
     42,
+    41,
     43,
-    45,
     44,
-    47,
     46,
-    49,
+    45,
     48,
+    47,
     50,
+    49,
     51,
     52,
     53,
@@ -292,17 +295,17 @@ const uint32_t RTGL1::ShFramebuffers_BindingsSwapped[] =
     61,
     62,
     63,
-    65,
     64,
     66,
+    65,
     67,
     68,
     69,
+    70,
 };
 
 const uint32_t RTGL1::ShFramebuffers_Sampler_Bindings[] = 
 {
-    70,
     71,
     72,
     73,
@@ -372,34 +375,35 @@ const uint32_t RTGL1::ShFramebuffers_Sampler_Bindings[] =
     137,
     138,
     139,
+    140,
+    141,
 };
 
 const uint32_t RTGL1::ShFramebuffers_Sampler_BindingsSwapped[] = 
 {
-    70,
-    72,
     71,
-    74,
     73,
-    76,
+    72,
     75,
-    78,
+    74,
     77,
-    80,
+    76,
     79,
+    78,
     81,
+    80,
     82,
     83,
     84,
     85,
     86,
     87,
-    89,
     88,
+    89,
     91,
     90,
-    92,
     93,
+    92,
     94,
     95,
     96,
@@ -407,27 +411,27 @@ const uint32_t RTGL1::ShFramebuffers_Sampler_BindingsSwapped[] =
     98,
     99,
     100,
-    102,
     101,
+    102,
     104,
     103,
     106,
     105,
-    107,
     108,
+    107,
     109,
-    111,
     110,
-    112,
+    111,
     113,
-    115,
+    112,
     114,
+    115,
     117,
     116,
     119,
     118,
-    120,
     121,
+    120,
     122,
     123,
     124,
@@ -440,12 +444,14 @@ const uint32_t RTGL1::ShFramebuffers_Sampler_BindingsSwapped[] =
     131,
     132,
     133,
-    135,
     134,
-    136,
+    135,
     137,
+    136,
     138,
     139,
+    140,
+    141,
 };
 
 const char *const RTGL1::ShFramebuffers_DebugNames[] = 
@@ -467,6 +473,7 @@ const char *const RTGL1::ShFramebuffers_DebugNames[] =
     "Framebuf UnfilteredIndirectSH_R",
     "Framebuf UnfilteredIndirectSH_G",
     "Framebuf UnfilteredIndirectSH_B",
+    "Framebuf UnfilteredIndirectSpecular",
     "Framebuf SurfacePosition",
     "Framebuf VisibilityBuffer",
     "Framebuf VisibilityBuffer_Prev",
@@ -522,3 +529,153 @@ const char *const RTGL1::ShFramebuffers_DebugNames[] =
     "Framebuf IndirPongGradient",
 };
 
+const uint32_t RTGL1::ShFramebuffers_LifetimeFirstPass[] = 
+{
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_PRIMARY,
+    RTGL1::FB_PASS_PRIMARY,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_PRIMARY,
+    RTGL1::FB_PASS_PRIMARY,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_COMPOSITION,
+    RTGL1::FB_PASS_POSTPROCESS,
+    RTGL1::FB_PASS_POSTPROCESS,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+};
+
+const uint32_t RTGL1::ShFramebuffers_LifetimeLastPass[] = 
+{
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_PRIMARY,
+    RTGL1::FB_PASS_DENOISE,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_PRIMARY,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_POSTPROCESS,
+    RTGL1::FB_PASS_POSTPROCESS,
+    RTGL1::FB_PASS_POSTPROCESS,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_COMPOSITION,
+    RTGL1::FB_PASS_COMPOSITION,
+    RTGL1::FB_PASS_COMPOSITION,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_BLOOM,
+    RTGL1::FB_PASS_POSTPROCESS,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    FB_LIFETIME_PERSISTENT,
+    RTGL1::FB_PASS_COMPOSITION,
+    RTGL1::FB_PASS_DENOISE,
+    RTGL1::FB_PASS_COMPOSITION,
+    RTGL1::FB_PASS_DENOISE,
+};
+
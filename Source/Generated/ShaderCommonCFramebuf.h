@@ -28,59 +28,60 @@ enum FramebufferImageIndex
     FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_R = 14,
     FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_G = 15,
     FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_B = 16,
-    FB_IMAGE_INDEX_SURFACE_POSITION = 17,
-    FB_IMAGE_INDEX_VISIBILITY_BUFFER = 18,
-    FB_IMAGE_INDEX_VISIBILITY_BUFFER_PREV = 19,
-    FB_IMAGE_INDEX_SECTOR_INDEX = 20,
-    FB_IMAGE_INDEX_SECTOR_INDEX_PREV = 21,
-    FB_IMAGE_INDEX_VIEW_DIRECTION = 22,
-    FB_IMAGE_INDEX_PRIMARY_TO_REFL_REFR = 23,
-    FB_IMAGE_INDEX_THROUGHPUT = 24,
-    FB_IMAGE_INDEX_PRE_FINAL = 25,
-    FB_IMAGE_INDEX_FINAL = 26,
-    FB_IMAGE_INDEX_UPSCALED_PING = 27,
-    FB_IMAGE_INDEX_UPSCALED_PONG = 28,
-    FB_IMAGE_INDEX_DEPTH_DLSS = 29,
-    FB_IMAGE_INDEX_MOTION_DLSS = 30,
-    FB_IMAGE_INDEX_ACCUM_HISTORY_LENGTH = 31,
-    FB_IMAGE_INDEX_ACCUM_HISTORY_LENGTH_PREV = 32,
-    FB_IMAGE_INDEX_DIFF_ACCUM_COLOR = 33,
-    FB_IMAGE_INDEX_DIFF_ACCUM_COLOR_PREV = 34,
-    FB_IMAGE_INDEX_DIFF_ACCUM_MOMENTS = 35,
-    FB_IMAGE_INDEX_DIFF_ACCUM_MOMENTS_PREV = 36,
-    FB_IMAGE_INDEX_DIFF_COLOR_HISTORY = 37,
-    FB_IMAGE_INDEX_DIFF_PING_COLOR_AND_VARIANCE = 38,
-    FB_IMAGE_INDEX_DIFF_PONG_COLOR_AND_VARIANCE = 39,
-    FB_IMAGE_INDEX_SPEC_ACCUM_COLOR = 40,
-    FB_IMAGE_INDEX_SPEC_ACCUM_COLOR_PREV = 41,
-    FB_IMAGE_INDEX_SPEC_PING_COLOR = 42,
-    FB_IMAGE_INDEX_SPEC_PONG_COLOR = 43,
-    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_R = 44,
-    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_R_PREV = 45,
-    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_G = 46,
-    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_G_PREV = 47,
-    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_B = 48,
-    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_B_PREV = 49,
-    FB_IMAGE_INDEX_INDIR_PING_S_H_R = 50,
-    FB_IMAGE_INDEX_INDIR_PING_S_H_G = 51,
-    FB_IMAGE_INDEX_INDIR_PING_S_H_B = 52,
-    FB_IMAGE_INDEX_INDIR_PONG_S_H_R = 53,
-    FB_IMAGE_INDEX_INDIR_PONG_S_H_G = 54,
-    FB_IMAGE_INDEX_INDIR_PONG_S_H_B = 55,
-    FB_IMAGE_INDEX_ATROUS_FILTERED_VARIANCE = 56,
-    FB_IMAGE_INDEX_BLOOM_MIP1 = 57,
-    FB_IMAGE_INDEX_BLOOM_MIP2 = 58,
-    FB_IMAGE_INDEX_BLOOM_MIP3 = 59,
-    FB_IMAGE_INDEX_BLOOM_MIP4 = 60,
-    FB_IMAGE_INDEX_BLOOM_MIP5 = 61,
-    FB_IMAGE_INDEX_BLOOM_RESULT = 62,
-    FB_IMAGE_INDEX_WIPE_EFFECT_SOURCE = 63,
-    FB_IMAGE_INDEX_GRADIENT_SAMPLES = 64,
-    FB_IMAGE_INDEX_GRADIENT_SAMPLES_PREV = 65,
-    FB_IMAGE_INDEX_DIFF_AND_SPEC_PING_GRADIENT = 66,
-    FB_IMAGE_INDEX_DIFF_AND_SPEC_PONG_GRADIENT = 67,
-    FB_IMAGE_INDEX_INDIR_PING_GRADIENT = 68,
-    FB_IMAGE_INDEX_INDIR_PONG_GRADIENT = 69,
+    FB_IMAGE_INDEX_UNFILTERED_INDIRECT_SPECULAR = 17,
+    FB_IMAGE_INDEX_SURFACE_POSITION = 18,
+    FB_IMAGE_INDEX_VISIBILITY_BUFFER = 19,
+    FB_IMAGE_INDEX_VISIBILITY_BUFFER_PREV = 20,
+    FB_IMAGE_INDEX_SECTOR_INDEX = 21,
+    FB_IMAGE_INDEX_SECTOR_INDEX_PREV = 22,
+    FB_IMAGE_INDEX_VIEW_DIRECTION = 23,
+    FB_IMAGE_INDEX_PRIMARY_TO_REFL_REFR = 24,
+    FB_IMAGE_INDEX_THROUGHPUT = 25,
+    FB_IMAGE_INDEX_PRE_FINAL = 26,
+    FB_IMAGE_INDEX_FINAL = 27,
+    FB_IMAGE_INDEX_UPSCALED_PING = 28,
+    FB_IMAGE_INDEX_UPSCALED_PONG = 29,
+    FB_IMAGE_INDEX_DEPTH_DLSS = 30,
+    FB_IMAGE_INDEX_MOTION_DLSS = 31,
+    FB_IMAGE_INDEX_ACCUM_HISTORY_LENGTH = 32,
+    FB_IMAGE_INDEX_ACCUM_HISTORY_LENGTH_PREV = 33,
+    FB_IMAGE_INDEX_DIFF_ACCUM_COLOR = 34,
+    FB_IMAGE_INDEX_DIFF_ACCUM_COLOR_PREV = 35,
+    FB_IMAGE_INDEX_DIFF_ACCUM_MOMENTS = 36,
+    FB_IMAGE_INDEX_DIFF_ACCUM_MOMENTS_PREV = 37,
+    FB_IMAGE_INDEX_DIFF_COLOR_HISTORY = 38,
+    FB_IMAGE_INDEX_DIFF_PING_COLOR_AND_VARIANCE = 39,
+    FB_IMAGE_INDEX_DIFF_PONG_COLOR_AND_VARIANCE = 40,
+    FB_IMAGE_INDEX_SPEC_ACCUM_COLOR = 41,
+    FB_IMAGE_INDEX_SPEC_ACCUM_COLOR_PREV = 42,
+    FB_IMAGE_INDEX_SPEC_PING_COLOR = 43,
+    FB_IMAGE_INDEX_SPEC_PONG_COLOR = 44,
+    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_R = 45,
+    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_R_PREV = 46,
+    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_G = 47,
+    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_G_PREV = 48,
+    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_B = 49,
+    FB_IMAGE_INDEX_INDIR_ACCUM_S_H_B_PREV = 50,
+    FB_IMAGE_INDEX_INDIR_PING_S_H_R = 51,
+    FB_IMAGE_INDEX_INDIR_PING_S_H_G = 52,
+    FB_IMAGE_INDEX_INDIR_PING_S_H_B = 53,
+    FB_IMAGE_INDEX_INDIR_PONG_S_H_R = 54,
+    FB_IMAGE_INDEX_INDIR_PONG_S_H_G = 55,
+    FB_IMAGE_INDEX_INDIR_PONG_S_H_B = 56,
+    FB_IMAGE_INDEX_ATROUS_FILTERED_VARIANCE = 57,
+    FB_IMAGE_INDEX_BLOOM_MIP1 = 58,
+    FB_IMAGE_INDEX_BLOOM_MIP2 = 59,
+    FB_IMAGE_INDEX_BLOOM_MIP3 = 60,
+    FB_IMAGE_INDEX_BLOOM_MIP4 = 61,
+    FB_IMAGE_INDEX_BLOOM_MIP5 = 62,
+    FB_IMAGE_INDEX_BLOOM_RESULT = 63,
+    FB_IMAGE_INDEX_WIPE_EFFECT_SOURCE = 64,
+    FB_IMAGE_INDEX_GRADIENT_SAMPLES = 65,
+    FB_IMAGE_INDEX_GRADIENT_SAMPLES_PREV = 66,
+    FB_IMAGE_INDEX_DIFF_AND_SPEC_PING_GRADIENT = 67,
+    FB_IMAGE_INDEX_DIFF_AND_SPEC_PONG_GRADIENT = 68,
+    FB_IMAGE_INDEX_INDIR_PING_GRADIENT = 69,
+    FB_IMAGE_INDEX_INDIR_PONG_GRADIENT = 70,
 };
 
 enum FramebufferImageFlagBits
@@ -99,6 +100,18 @@ enum FramebufferImageFlagBits
 };
 typedef uint32_t FramebufferImageFlags;
 
+#define FB_LIFETIME_PERSISTENT 0xFFFFFFFF
+
+enum FramebufferPass
+{
+    FB_PASS_PRIMARY = 0,
+    FB_PASS_DENOISE = 1,
+    FB_PASS_BLOOM = 2,
+    FB_PASS_COMPOSITION = 3,
+    FB_PASS_POSTPROCESS = 4,
+    FB_PASS_COUNT = 5,
+};
+
 extern const uint32_t ShFramebuffers_Count;
 extern const VkFormat ShFramebuffers_Formats[];
 extern const FramebufferImageFlags ShFramebuffers_Flags[];
@@ -107,5 +120,7 @@ extern const uint32_t ShFramebuffers_BindingsSwapped[];
 extern const uint32_t ShFramebuffers_Sampler_Bindings[];
 extern const uint32_t ShFramebuffers_Sampler_BindingsSwapped[];
 extern const char *const ShFramebuffers_DebugNames[];
+extern const uint32_t ShFramebuffers_LifetimeFirstPass[];
+extern const uint32_t ShFramebuffers_LifetimeLastPass[];
 
 }
\ No newline at end of file
@@ -1,14 +1,13 @@
 // This file was generated by GenerateShaderCommon.py
 
-#define MAX_STATIC_VERTEX_COUNT (1048576)
-#define MAX_DYNAMIC_VERTEX_COUNT (2097152)
-#define MAX_INDEXED_PRIMITIVE_COUNT (1048576)
 #define MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT (4096)
 #define MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT_POW (12)
 #define MAX_GEOMETRY_PRIMITIVE_COUNT (1048576)
 #define MAX_GEOMETRY_PRIMITIVE_COUNT_POW (20)
 #define LOWER_BOTTOM_LEVEL_GEOMETRIES_COUNT (256)
-#define MAX_TOP_LEVEL_INSTANCE_COUNT (45)
+#define MAX_TOP_LEVEL_INSTANCE_COUNT (255)
+#define MAX_MESH_POOL_VERTEX_COUNT (524288)
+#define MAX_MESH_POOL_INDEX_COUNT (1048576)
 #define BINDING_VERTEX_BUFFER_STATIC (0)
 #define BINDING_VERTEX_BUFFER_DYNAMIC (1)
 #define BINDING_INDEX_BUFFER_STATIC (2)
@@ -18,6 +17,8 @@
 #define BINDING_PREV_POSITIONS_BUFFER_DYNAMIC (6)
 #define BINDING_PREV_INDEX_BUFFER_DYNAMIC (7)
 #define BINDING_PER_TRIANGLE_INFO (8)
+#define BINDING_MESH_VERTEX_BUFFER (9)
+#define BINDING_MESH_INDEX_BUFFER (10)
 #define BINDING_GLOBAL_UNIFORM (0)
 #define BINDING_ACCELERATION_STRUCTURE_MAIN (0)
 #define BINDING_TEXTURES (0)
@@ -39,6 +40,12 @@
 #define BINDING_LENS_FLARES_DRAW_CMDS (1)
 #define BINDING_DRAW_LENS_FLARES_INSTANCES (0)
 #define BINDING_DECAL_INSTANCES (0)
+#define BINDING_VERT_PREPROC_CHUNKS (0)
+#define BINDING_VERT_PREPROC_NORMALS_ACCUM (1)
+#define BINDING_SKINNING_CHUNKS (0)
+#define BINDING_SKINNING_JOINT_INDICES (1)
+#define BINDING_SKINNING_JOINT_WEIGHTS (2)
+#define BINDING_SKINNING_JOINT_TRANSFORMS (3)
 #define INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC (1 << 0)
 #define INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON (1 << 1)
 #define INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON_VIEWER (1 << 2)
@@ -66,6 +73,8 @@
 #define MATERIAL_ROUGHNESS_METALLIC_EMISSION_INDEX (1)
 #define MATERIAL_NORMAL_INDEX (2)
 #define MATERIAL_NO_TEXTURE (0)
+#define MAX_ANIMATED_MATERIAL_SLOTS (128)
+#define MATERIAL_ANIMATED_SLOT_FLAG (1 << 30)
 #define MATERIAL_BLENDING_FLAG_OPAQUE (1 << 0)
 #define MATERIAL_BLENDING_FLAG_ALPHA (1 << 1)
 #define MATERIAL_BLENDING_FLAG_ADD (1 << 2)
@@ -80,7 +89,7 @@
 #define GEOM_INST_FLAG_RESERVED_3 (1 << 16)
 #define GEOM_INST_FLAG_RESERVED_4 (1 << 17)
 #define GEOM_INST_FLAG_RESERVED_5 (1 << 18)
-#define GEOM_INST_FLAG_RESERVED_6 (1 << 19)
+#define GEOM_INST_FLAG_RESIDENT_MESH (1 << 19)
 #define GEOM_INST_FLAG_IGNORE_REFL_REFR_AFTER (1 << 20)
 #define GEOM_INST_FLAG_REFL_REFR_ALBEDO_MULT (1 << 21)
 #define GEOM_INST_FLAG_REFL_REFR_ALBEDO_ADD (1 << 22)
@@ -110,6 +119,13 @@
 #define COMPUTE_BLOOM_STEP_COUNT (5)
 #define COMPUTE_EFFECT_GROUP_SIZE_X (16)
 #define COMPUTE_EFFECT_GROUP_SIZE_Y (16)
+#define EFFECT_SIMPLE_CHAIN_COLOR_TINT (1 << 0)
+#define EFFECT_SIMPLE_CHAIN_INVERSE_BW (1 << 1)
+#define EFFECT_SIMPLE_CHAIN_HUE_SHIFT (1 << 2)
+#define EFFECT_SIMPLE_CHAIN_CHROMATIC_ABERRATION (1 << 3)
+#define EFFECT_SIMPLE_CHAIN_DISTORTED_SIDES (1 << 4)
+#define EFFECT_SIMPLE_CHAIN_RADIAL_BLUR (1 << 5)
+#define EFFECT_SIMPLE_CHAIN_LENGTH (6)
 #define COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_X (16)
 #define COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_Y (16)
 #define COMPUTE_LUM_HISTOGRAM_BIN_COUNT (256)
@@ -117,6 +133,12 @@
 #define VERT_PREPROC_MODE_ONLY_DYNAMIC (0)
 #define VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE (1)
 #define VERT_PREPROC_MODE_ALL (2)
+#define VERT_PREPROC_PASS_ACCUMULATE (0)
+#define VERT_PREPROC_PASS_RESOLVE (1)
+#define MAX_VERT_PREPROC_ACCUM_VERTEX_COUNT (1048576)
+#define COMPUTE_SKINNING_GROUP_SIZE_X (256)
+#define MAX_SKINNED_VERTEX_COUNT (262144)
+#define MAX_SKINNING_JOINT_COUNT (8192)
 #define GRADIENT_ESTIMATION_ENABLED (1)
 #define COMPUTE_GRADIENT_SAMPLES_GROUP_SIZE_X (16)
 #define COMPUTE_GRADIENT_MERGING_GROUP_SIZE_X (16)
@@ -125,6 +147,11 @@
 #define COMPUTE_SVGF_VARIANCE_GROUP_SIZE_X (16)
 #define COMPUTE_SVGF_ATROUS_GROUP_SIZE_X (16)
 #define COMPUTE_SVGF_ATROUS_ITERATION_COUNT (4)
+#define COMPUTE_INDIRECT_RECONSTRUCT_GROUP_SIZE_X (16)
+#define COMPUTE_INDIRECT_RECONSTRUCT_GROUP_SIZE_Y (16)
+#define INDIRECT_ILLUMINATION_MODE_FULL (0)
+#define INDIRECT_ILLUMINATION_MODE_CHECKERBOARD (1)
+#define INDIRECT_ILLUMINATION_MODE_HALF (2)
 #define COMPUTE_ASVGF_STRATA_SIZE (3)
 #define COMPUTE_ASVGF_GRADIENT_ATROUS_ITERATION_COUNT (4)
 #define COMPUTE_INDIRECT_DRAW_FLARES_GROUP_SIZE_X (256)
@@ -146,22 +173,6 @@
 #define FIDELITY_SUPER_RESOLUTION_GAMMA_SPACE (3.0)
 #define SURFACE_POSITION_INCORRECT (10000000.0)
 
-struct ShVertexBufferStatic
-{
-    float positions[3145728];
-    float normals[3145728];
-    float texCoords[2097152];
-    float texCoordsLayer1[2097152];
-    float texCoordsLayer2[2097152];
-};
-
-struct ShVertexBufferDynamic
-{
-    float positions[6291456];
-    float normals[6291456];
-    float texCoords[4194304];
-};
-
 struct ShGlobalUniform
 {
     mat4 view;
@@ -262,14 +273,22 @@ struct ShGlobalUniform
     uint applyViewProjToLensFlares;
     uint areFramebufsInitedByRT;
     float bloomEmissionSaturationBias;
-    float _pad1;
-    float _pad2;
-    float _pad3;
-    ivec4 instanceGeomInfoOffset[12];
-    ivec4 instanceGeomInfoOffsetPrev[12];
-    ivec4 instanceGeomCount[12];
+    uint staticNormalsOffset;
+    uint staticTexCoordsOffset;
+    uint staticTexCoordsLayer1Offset;
+    uint staticTexCoordsLayer2Offset;
+    uint dynamicNormalsOffset;
+    uint dynamicTexCoordsOffset;
+    float renderAllocatedWidth;
+    float renderAllocatedHeight;
+    uint indirectIlluminationMode;
+    float prevRenderWidth;
+    float prevRenderHeight;
+    ivec4 instanceGeomInfoOffset[64];
+    ivec4 instanceGeomInfoOffsetPrev[64];
     mat4 viewProjCubemap[6];
     mat4 skyCubemapRotationTransform;
+    uvec4 animatedMaterialTextures[128];
 };
 
 struct ShGeometryInstance
@@ -324,8 +343,43 @@ struct ShLightPolygonal
 
 struct ShVertPreprocessing
 {
-    uint tlasInstanceCount;
-    uint tlasInstanceIsDynamicBits[2];
+    uint chunkOffset;
+    uint chunkCount;
+    uint totalTriangleCount;
+    uint totalAccumVertexCount;
+};
+
+struct ShVertPreprocessChunk
+{
+    uint globalGeomIndex;
+    uint triangleOffset;
+    uint triangleCount;
+    uint isDynamic;
+    uint accumVertexOffset;
+    uint accumVertexCount;
+    uint __pad0;
+    uint __pad1;
+};
+
+struct ShSkinning
+{
+    uint chunkCount;
+    uint totalVertexCount;
+    uint positionsStride;
+    uint normalsStride;
+    uint normalsOffset;
+};
+
+struct ShSkinningChunk
+{
+    uint baseVertexIndex;
+    uint vertexOffset;
+    uint vertexCount;
+    uint jointOffset;
+    uint jointCount;
+    uint skinNormals;
+    uint __pad0;
+    uint __pad1;
 };
 
 struct ShIndirectDrawCommand
@@ -374,59 +428,60 @@ struct ShDecalInstance
 #define FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_R 14
 #define FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_G 15
 #define FB_IMAGE_INDEX_UNFILTERED_INDIRECT_S_H_B 16
-#define FB_IMAGE_INDEX_SURFACE_POSITION 17
-#define FB_IMAGE_INDEX_VISIBILITY_BUFFER 18
-#define FB_IMAGE_INDEX_VISIBILITY_BUFFER_PREV 19
-#define FB_IMAGE_INDEX_SECTOR_INDEX 20
-#define FB_IMAGE_INDEX_SECTOR_INDEX_PREV 21
-#define FB_IMAGE_INDEX_VIEW_DIRECTION 22
-#define FB_IMAGE_INDEX_PRIMARY_TO_REFL_REFR 23
-#define FB_IMAGE_INDEX_THROUGHPUT 24
-#define FB_IMAGE_INDEX_PRE_FINAL 25
-#define FB_IMAGE_INDEX_FINAL 26
-#define FB_IMAGE_INDEX_UPSCALED_PING 27
-#define FB_IMAGE_INDEX_UPSCALED_PONG 28
-#define FB_IMAGE_INDEX_DEPTH_DLSS 29
-#define FB_IMAGE_INDEX_MOTION_DLSS 30
-#define FB_IMAGE_INDEX_ACCUM_HISTORY_LENGTH 31
-#define FB_IMAGE_INDEX_ACCUM_HISTORY_LENGTH_PREV 32
-#define FB_IMAGE_INDEX_DIFF_ACCUM_COLOR 33
-#define FB_IMAGE_INDEX_DIFF_ACCUM_COLOR_PREV 34
-#define FB_IMAGE_INDEX_DIFF_ACCUM_MOMENTS 35
-#define FB_IMAGE_INDEX_DIFF_ACCUM_MOMENTS_PREV 36
-#define FB_IMAGE_INDEX_DIFF_COLOR_HISTORY 37
-#define FB_IMAGE_INDEX_DIFF_PING_COLOR_AND_VARIANCE 38
-#define FB_IMAGE_INDEX_DIFF_PONG_COLOR_AND_VARIANCE 39
-#define FB_IMAGE_INDEX_SPEC_ACCUM_COLOR 40
-#define FB_IMAGE_INDEX_SPEC_ACCUM_COLOR_PREV 41
-#define FB_IMAGE_INDEX_SPEC_PING_COLOR 42
-#define FB_IMAGE_INDEX_SPEC_PONG_COLOR 43
-#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_R 44
-#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_R_PREV 45
-#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_G 46
-#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_G_PREV 47
-#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_B 48
-#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_B_PREV 49
-#define FB_IMAGE_INDEX_INDIR_PING_S_H_R 50
-#define FB_IMAGE_INDEX_INDIR_PING_S_H_G 51
-#define FB_IMAGE_INDEX_INDIR_PING_S_H_B 52
-#define FB_IMAGE_INDEX_INDIR_PONG_S_H_R 53
-#define FB_IMAGE_INDEX_INDIR_PONG_S_H_G 54
-#define FB_IMAGE_INDEX_INDIR_PONG_S_H_B 55
-#define FB_IMAGE_INDEX_ATROUS_FILTERED_VARIANCE 56
-#define FB_IMAGE_INDEX_BLOOM_MIP1 57
-#define FB_IMAGE_INDEX_BLOOM_MIP2 58
-#define FB_IMAGE_INDEX_BLOOM_MIP3 59
-#define FB_IMAGE_INDEX_BLOOM_MIP4 60
-#define FB_IMAGE_INDEX_BLOOM_MIP5 61
-#define FB_IMAGE_INDEX_BLOOM_RESULT 62
-#define FB_IMAGE_INDEX_WIPE_EFFECT_SOURCE 63
-#define FB_IMAGE_INDEX_GRADIENT_SAMPLES 64
-#define FB_IMAGE_INDEX_GRADIENT_SAMPLES_PREV 65
-#define FB_IMAGE_INDEX_DIFF_AND_SPEC_PING_GRADIENT 66
-#define FB_IMAGE_INDEX_DIFF_AND_SPEC_PONG_GRADIENT 67
-#define FB_IMAGE_INDEX_INDIR_PING_GRADIENT 68
-#define FB_IMAGE_INDEX_INDIR_PONG_GRADIENT 69
+#define FB_IMAGE_INDEX_UNFILTERED_INDIRECT_SPECULAR 17
+#define FB_IMAGE_INDEX_SURFACE_POSITION 18
+#define FB_IMAGE_INDEX_VISIBILITY_BUFFER 19
+#define FB_IMAGE_INDEX_VISIBILITY_BUFFER_PREV 20
+#define FB_IMAGE_INDEX_SECTOR_INDEX 21
+#define FB_IMAGE_INDEX_SECTOR_INDEX_PREV 22
+#define FB_IMAGE_INDEX_VIEW_DIRECTION 23
+#define FB_IMAGE_INDEX_PRIMARY_TO_REFL_REFR 24
+#define FB_IMAGE_INDEX_THROUGHPUT 25
+#define FB_IMAGE_INDEX_PRE_FINAL 26
+#define FB_IMAGE_INDEX_FINAL 27
+#define FB_IMAGE_INDEX_UPSCALED_PING 28
+#define FB_IMAGE_INDEX_UPSCALED_PONG 29
+#define FB_IMAGE_INDEX_DEPTH_DLSS 30
+#define FB_IMAGE_INDEX_MOTION_DLSS 31
+#define FB_IMAGE_INDEX_ACCUM_HISTORY_LENGTH 32
+#define FB_IMAGE_INDEX_ACCUM_HISTORY_LENGTH_PREV 33
+#define FB_IMAGE_INDEX_DIFF_ACCUM_COLOR 34
+#define FB_IMAGE_INDEX_DIFF_ACCUM_COLOR_PREV 35
+#define FB_IMAGE_INDEX_DIFF_ACCUM_MOMENTS 36
+#define FB_IMAGE_INDEX_DIFF_ACCUM_MOMENTS_PREV 37
+#define FB_IMAGE_INDEX_DIFF_COLOR_HISTORY 38
+#define FB_IMAGE_INDEX_DIFF_PING_COLOR_AND_VARIANCE 39
+#define FB_IMAGE_INDEX_DIFF_PONG_COLOR_AND_VARIANCE 40
+#define FB_IMAGE_INDEX_SPEC_ACCUM_COLOR 41
+#define FB_IMAGE_INDEX_SPEC_ACCUM_COLOR_PREV 42
+#define FB_IMAGE_INDEX_SPEC_PING_COLOR 43
+#define FB_IMAGE_INDEX_SPEC_PONG_COLOR 44
+#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_R 45
+#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_R_PREV 46
+#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_G 47
+#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_G_PREV 48
+#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_B 49
+#define FB_IMAGE_INDEX_INDIR_ACCUM_S_H_B_PREV 50
+#define FB_IMAGE_INDEX_INDIR_PING_S_H_R 51
+#define FB_IMAGE_INDEX_INDIR_PING_S_H_G 52
+#define FB_IMAGE_INDEX_INDIR_PING_S_H_B 53
+#define FB_IMAGE_INDEX_INDIR_PONG_S_H_R 54
+#define FB_IMAGE_INDEX_INDIR_PONG_S_H_G 55
+#define FB_IMAGE_INDEX_INDIR_PONG_S_H_B 56
+#define FB_IMAGE_INDEX_ATROUS_FILTERED_VARIANCE 57
+#define FB_IMAGE_INDEX_BLOOM_MIP1 58
+#define FB_IMAGE_INDEX_BLOOM_MIP2 59
+#define FB_IMAGE_INDEX_BLOOM_MIP3 60
+#define FB_IMAGE_INDEX_BLOOM_MIP4 61
+#define FB_IMAGE_INDEX_BLOOM_MIP5 62
+#define FB_IMAGE_INDEX_BLOOM_RESULT 63
+#define FB_IMAGE_INDEX_WIPE_EFFECT_SOURCE 64
+#define FB_IMAGE_INDEX_GRADIENT_SAMPLES 65
+#define FB_IMAGE_INDEX_GRADIENT_SAMPLES_PREV 66
+#define FB_IMAGE_INDEX_DIFF_AND_SPEC_PING_GRADIENT 67
+#define FB_IMAGE_INDEX_DIFF_AND_SPEC_PONG_GRADIENT 68
+#define FB_IMAGE_INDEX_INDIR_PING_GRADIENT 69
+#define FB_IMAGE_INDEX_INDIR_PONG_GRADIENT 70
 
 // framebuffers
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
@@ -448,145 +503,147 @@ layout(set = DESC_SET_FRAMEBUFFERS, binding = 13, r32ui) uniform uimage2D frameb
 layout(set = DESC_SET_FRAMEBUFFERS, binding = 14, rgba16f) uniform image2D framebufUnfilteredIndirectSH_R;
 layout(set = DESC_SET_FRAMEBUFFERS, binding = 15, rgba16f) uniform image2D framebufUnfilteredIndirectSH_G;
 layout(set = DESC_SET_FRAMEBUFFERS, binding = 16, rgba16f) uniform image2D framebufUnfilteredIndirectSH_B;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 17, rgba32f) uniform image2D framebufSurfacePosition;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 18, rgba32f) uniform image2D framebufVisibilityBuffer;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 19, rgba32f) uniform image2D framebufVisibilityBuffer_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 20, r16ui) uniform uimage2D framebufSectorIndex;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 21, r16ui) uniform uimage2D framebufSectorIndex_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 22, rgba16f) uniform image2D framebufViewDirection;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 23, rg32ui) uniform uimage2D framebufPrimaryToReflRefr;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 24, rgba16f) uniform image2D framebufThroughput;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 25, r11f_g11f_b10f) uniform image2D framebufPreFinal;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 17, rgba16f) uniform image2D framebufUnfilteredIndirectSpecular;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 18, rgba32f) uniform image2D framebufSurfacePosition;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 19, rgba32f) uniform image2D framebufVisibilityBuffer;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 20, rgba32f) uniform image2D framebufVisibilityBuffer_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 21, r16ui) uniform uimage2D framebufSectorIndex;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 22, r16ui) uniform uimage2D framebufSectorIndex_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 23, rgba16f) uniform image2D framebufViewDirection;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 24, rg32ui) uniform uimage2D framebufPrimaryToReflRefr;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 25, rgba16f) uniform image2D framebufThroughput;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 26, r11f_g11f_b10f) uniform image2D framebufPreFinal;
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 26, r11f_g11f_b10f) uniform image2D framebufFinal;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 27, r11f_g11f_b10f) uniform image2D framebufFinal;
 #endif
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 27, r11f_g11f_b10f) uniform image2D framebufUpscaledPing;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 28, r11f_g11f_b10f) uniform image2D framebufUpscaledPing;
 #endif
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 28, r11f_g11f_b10f) uniform image2D framebufUpscaledPong;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 29, r11f_g11f_b10f) uniform image2D framebufUpscaledPong;
 #endif
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 29, r32f) uniform image2D framebufDepthDlss;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 30, rg16f) uniform image2D framebufMotionDlss;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 31, r11f_g11f_b10f) uniform image2D framebufAccumHistoryLength;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 32, r11f_g11f_b10f) uniform image2D framebufAccumHistoryLength_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 33, r32ui) uniform uimage2D framebufDiffAccumColor;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 34, r32ui) uniform uimage2D framebufDiffAccumColor_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 35, rg16f) uniform image2D framebufDiffAccumMoments;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 36, rg16f) uniform image2D framebufDiffAccumMoments_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 37, rgba16f) uniform image2D framebufDiffColorHistory;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 38, rgba16f) uniform image2D framebufDiffPingColorAndVariance;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 39, rgba16f) uniform image2D framebufDiffPongColorAndVariance;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 40, r32ui) uniform uimage2D framebufSpecAccumColor;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 41, r32ui) uniform uimage2D framebufSpecAccumColor_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 42, r32ui) uniform uimage2D framebufSpecPingColor;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 43, r32ui) uniform uimage2D framebufSpecPongColor;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 44, rgba16f) uniform image2D framebufIndirAccumSH_R;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 45, rgba16f) uniform image2D framebufIndirAccumSH_R_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 46, rgba16f) uniform image2D framebufIndirAccumSH_G;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 47, rgba16f) uniform image2D framebufIndirAccumSH_G_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 48, rgba16f) uniform image2D framebufIndirAccumSH_B;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 49, rgba16f) uniform image2D framebufIndirAccumSH_B_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 50, rgba16f) uniform image2D framebufIndirPingSH_R;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 51, rgba16f) uniform image2D framebufIndirPingSH_G;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 52, rgba16f) uniform image2D framebufIndirPingSH_B;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 53, rgba16f) uniform image2D framebufIndirPongSH_R;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 54, rgba16f) uniform image2D framebufIndirPongSH_G;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 55, rgba16f) uniform image2D framebufIndirPongSH_B;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 56, r16f) uniform image2D framebufAtrousFilteredVariance;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 57, r11f_g11f_b10f) uniform image2D framebufBloom_Mip1;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 58, r11f_g11f_b10f) uniform image2D framebufBloom_Mip2;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 59, r11f_g11f_b10f) uniform image2D framebufBloom_Mip3;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 60, r11f_g11f_b10f) uniform image2D framebufBloom_Mip4;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 61, r11f_g11f_b10f) uniform image2D framebufBloom_Mip5;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 62, r11f_g11f_b10f) uniform image2D framebufBloom_Result;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 63, r11f_g11f_b10f) uniform image2D framebufWipeEffectSource;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 64, rgba32ui) uniform uimage2D framebufGradientSamples;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 65, rgba32ui) uniform uimage2D framebufGradientSamples_Prev;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 66, rgba16f) uniform image2D framebufDiffAndSpecPingGradient;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 67, rgba16f) uniform image2D framebufDiffAndSpecPongGradient;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 68, r16f) uniform image2D framebufIndirPingGradient;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 69, r16f) uniform image2D framebufIndirPongGradient;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 30, r32f) uniform image2D framebufDepthDlss;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 31, rg16f) uniform image2D framebufMotionDlss;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 32, r11f_g11f_b10f) uniform image2D framebufAccumHistoryLength;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 33, r11f_g11f_b10f) uniform image2D framebufAccumHistoryLength_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 34, r32ui) uniform uimage2D framebufDiffAccumColor;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 35, r32ui) uniform uimage2D framebufDiffAccumColor_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 36, rg16f) uniform image2D framebufDiffAccumMoments;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 37, rg16f) uniform image2D framebufDiffAccumMoments_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 38, rgba16f) uniform image2D framebufDiffColorHistory;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 39, rgba16f) uniform image2D framebufDiffPingColorAndVariance;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 40, rgba16f) uniform image2D framebufDiffPongColorAndVariance;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 41, r32ui) uniform uimage2D framebufSpecAccumColor;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 42, r32ui) uniform uimage2D framebufSpecAccumColor_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 43, r32ui) uniform uimage2D framebufSpecPingColor;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 44, r32ui) uniform uimage2D framebufSpecPongColor;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 45, rgba16f) uniform image2D framebufIndirAccumSH_R;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 46, rgba16f) uniform image2D framebufIndirAccumSH_R_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 47, rgba16f) uniform image2D framebufIndirAccumSH_G;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 48, rgba16f) uniform image2D framebufIndirAccumSH_G_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 49, rgba16f) uniform image2D framebufIndirAccumSH_B;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 50, rgba16f) uniform image2D framebufIndirAccumSH_B_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 51, rgba16f) uniform image2D framebufIndirPingSH_R;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 52, rgba16f) uniform image2D framebufIndirPingSH_G;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 53, rgba16f) uniform image2D framebufIndirPingSH_B;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 54, rgba16f) uniform image2D framebufIndirPongSH_R;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 55, rgba16f) uniform image2D framebufIndirPongSH_G;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 56, rgba16f) uniform image2D framebufIndirPongSH_B;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 57, r16f) uniform image2D framebufAtrousFilteredVariance;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 58, r11f_g11f_b10f) uniform image2D framebufBloom_Mip1;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 59, r11f_g11f_b10f) uniform image2D framebufBloom_Mip2;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 60, r11f_g11f_b10f) uniform image2D framebufBloom_Mip3;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 61, r11f_g11f_b10f) uniform image2D framebufBloom_Mip4;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 62, r11f_g11f_b10f) uniform image2D framebufBloom_Mip5;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 63, r11f_g11f_b10f) uniform image2D framebufBloom_Result;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 64, r11f_g11f_b10f) uniform image2D framebufWipeEffectSource;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 65, rgba32ui) uniform uimage2D framebufGradientSamples;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 66, rgba32ui) uniform uimage2D framebufGradientSamples_Prev;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 67, rgba16f) uniform image2D framebufDiffAndSpecPingGradient;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 68, rgba16f) uniform image2D framebufDiffAndSpecPongGradient;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 69, r16f) uniform image2D framebufIndirPingGradient;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 70, r16f) uniform image2D framebufIndirPongGradient;
 
 // samplers
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 70) uniform sampler2D framebufAlbedo_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 71) uniform sampler2D framebufAlbedo_Sampler;
 #endif
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 71) uniform usampler2D framebufNormal_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 72) uniform usampler2D framebufNormal_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 73) uniform usampler2D framebufNormalGeometry_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 74) uniform usampler2D framebufNormalGeometry_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 75) uniform sampler2D framebufMetallicRoughness_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 76) uniform sampler2D framebufMetallicRoughness_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 77) uniform sampler2D framebufDepth_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 78) uniform sampler2D framebufDepth_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 79) uniform usampler2D framebufRandomSeed_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 80) uniform usampler2D framebufRandomSeed_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 81) uniform sampler2D framebufMotion_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 82) uniform usampler2D framebufUnfilteredDirect_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 83) uniform usampler2D framebufUnfilteredSpecular_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 84) uniform sampler2D framebufUnfilteredIndirectSH_R_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 85) uniform sampler2D framebufUnfilteredIndirectSH_G_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 86) uniform sampler2D framebufUnfilteredIndirectSH_B_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 87) uniform sampler2D framebufSurfacePosition_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 88) uniform sampler2D framebufVisibilityBuffer_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 89) uniform sampler2D framebufVisibilityBuffer_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 90) uniform usampler2D framebufSectorIndex_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 91) uniform usampler2D framebufSectorIndex_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 92) uniform sampler2D framebufViewDirection_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 93) uniform usampler2D framebufPrimaryToReflRefr_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 94) uniform sampler2D framebufThroughput_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 95) uniform sampler2D framebufPreFinal_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 72) uniform usampler2D framebufNormal_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 73) uniform usampler2D framebufNormal_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 74) uniform usampler2D framebufNormalGeometry_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 75) uniform usampler2D framebufNormalGeometry_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 76) uniform sampler2D framebufMetallicRoughness_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 77) uniform sampler2D framebufMetallicRoughness_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 78) uniform sampler2D framebufDepth_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 79) uniform sampler2D framebufDepth_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 80) uniform usampler2D framebufRandomSeed_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 81) uniform usampler2D framebufRandomSeed_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 82) uniform sampler2D framebufMotion_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 83) uniform usampler2D framebufUnfilteredDirect_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 84) uniform usampler2D framebufUnfilteredSpecular_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 85) uniform sampler2D framebufUnfilteredIndirectSH_R_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 86) uniform sampler2D framebufUnfilteredIndirectSH_G_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 87) uniform sampler2D framebufUnfilteredIndirectSH_B_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 88) uniform sampler2D framebufUnfilteredIndirectSpecular_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 89) uniform sampler2D framebufSurfacePosition_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 90) uniform sampler2D framebufVisibilityBuffer_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 91) uniform sampler2D framebufVisibilityBuffer_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 92) uniform usampler2D framebufSectorIndex_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 93) uniform usampler2D framebufSectorIndex_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 94) uniform sampler2D framebufViewDirection_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 95) uniform usampler2D framebufPrimaryToReflRefr_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 96) uniform sampler2D framebufThroughput_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 97) uniform sampler2D framebufPreFinal_Sampler;
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 96) uniform sampler2D framebufFinal_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 98) uniform sampler2D framebufFinal_Sampler;
 #endif
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 97) uniform sampler2D framebufUpscaledPing_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 99) uniform sampler2D framebufUpscaledPing_Sampler;
 #endif
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 98) uniform sampler2D framebufUpscaledPong_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 100) uniform sampler2D framebufUpscaledPong_Sampler;
 #endif
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 99) uniform sampler2D framebufDepthDlss_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 100) uniform sampler2D framebufMotionDlss_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 101) uniform sampler2D framebufAccumHistoryLength_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 102) uniform sampler2D framebufAccumHistoryLength_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 103) uniform usampler2D framebufDiffAccumColor_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 104) uniform usampler2D framebufDiffAccumColor_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 105) uniform sampler2D framebufDiffAccumMoments_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 106) uniform sampler2D framebufDiffAccumMoments_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 107) uniform sampler2D framebufDiffColorHistory_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 108) uniform sampler2D framebufDiffPingColorAndVariance_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 109) uniform sampler2D framebufDiffPongColorAndVariance_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 110) uniform usampler2D framebufSpecAccumColor_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 111) uniform usampler2D framebufSpecAccumColor_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 112) uniform usampler2D framebufSpecPingColor_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 113) uniform usampler2D framebufSpecPongColor_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 114) uniform sampler2D framebufIndirAccumSH_R_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 115) uniform sampler2D framebufIndirAccumSH_R_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 116) uniform sampler2D framebufIndirAccumSH_G_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 117) uniform sampler2D framebufIndirAccumSH_G_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 118) uniform sampler2D framebufIndirAccumSH_B_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 119) uniform sampler2D framebufIndirAccumSH_B_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 120) uniform sampler2D framebufIndirPingSH_R_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 121) uniform sampler2D framebufIndirPingSH_G_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 122) uniform sampler2D framebufIndirPingSH_B_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 123) uniform sampler2D framebufIndirPongSH_R_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 124) uniform sampler2D framebufIndirPongSH_G_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 125) uniform sampler2D framebufIndirPongSH_B_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 126) uniform sampler2D framebufAtrousFilteredVariance_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 127) uniform sampler2D framebufBloom_Mip1_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 128) uniform sampler2D framebufBloom_Mip2_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 129) uniform sampler2D framebufBloom_Mip3_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 130) uniform sampler2D framebufBloom_Mip4_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 131) uniform sampler2D framebufBloom_Mip5_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 132) uniform sampler2D framebufBloom_Result_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 133) uniform sampler2D framebufWipeEffectSource_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 134) uniform usampler2D framebufGradientSamples_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 135) uniform usampler2D framebufGradientSamples_Prev_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 136) uniform sampler2D framebufDiffAndSpecPingGradient_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 137) uniform sampler2D framebufDiffAndSpecPongGradient_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 138) uniform sampler2D framebufIndirPingGradient_Sampler;
-layout(set = DESC_SET_FRAMEBUFFERS, binding = 139) uniform sampler2D framebufIndirPongGradient_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 101) uniform sampler2D framebufDepthDlss_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 102) uniform sampler2D framebufMotionDlss_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 103) uniform sampler2D framebufAccumHistoryLength_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 104) uniform sampler2D framebufAccumHistoryLength_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 105) uniform usampler2D framebufDiffAccumColor_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 106) uniform usampler2D framebufDiffAccumColor_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 107) uniform sampler2D framebufDiffAccumMoments_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 108) uniform sampler2D framebufDiffAccumMoments_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 109) uniform sampler2D framebufDiffColorHistory_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 110) uniform sampler2D framebufDiffPingColorAndVariance_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 111) uniform sampler2D framebufDiffPongColorAndVariance_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 112) uniform usampler2D framebufSpecAccumColor_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 113) uniform usampler2D framebufSpecAccumColor_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 114) uniform usampler2D framebufSpecPingColor_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 115) uniform usampler2D framebufSpecPongColor_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 116) uniform sampler2D framebufIndirAccumSH_R_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 117) uniform sampler2D framebufIndirAccumSH_R_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 118) uniform sampler2D framebufIndirAccumSH_G_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 119) uniform sampler2D framebufIndirAccumSH_G_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 120) uniform sampler2D framebufIndirAccumSH_B_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 121) uniform sampler2D framebufIndirAccumSH_B_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 122) uniform sampler2D framebufIndirPingSH_R_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 123) uniform sampler2D framebufIndirPingSH_G_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 124) uniform sampler2D framebufIndirPingSH_B_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 125) uniform sampler2D framebufIndirPongSH_R_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 126) uniform sampler2D framebufIndirPongSH_G_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 127) uniform sampler2D framebufIndirPongSH_B_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 128) uniform sampler2D framebufAtrousFilteredVariance_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 129) uniform sampler2D framebufBloom_Mip1_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 130) uniform sampler2D framebufBloom_Mip2_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 131) uniform sampler2D framebufBloom_Mip3_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 132) uniform sampler2D framebufBloom_Mip4_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 133) uniform sampler2D framebufBloom_Mip5_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 134) uniform sampler2D framebufBloom_Result_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 135) uniform sampler2D framebufWipeEffectSource_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 136) uniform usampler2D framebufGradientSamples_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 137) uniform usampler2D framebufGradientSamples_Prev_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 138) uniform sampler2D framebufDiffAndSpecPingGradient_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 139) uniform sampler2D framebufDiffAndSpecPongGradient_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 140) uniform sampler2D framebufIndirPingGradient_Sampler;
+layout(set = DESC_SET_FRAMEBUFFERS, binding = 141) uniform sampler2D framebufIndirPongGradient_Sampler;
 
 // pack/unpack formats
 void imageStoreUnfilteredDirect(const ivec2 pix, const vec3 unpacked) { imageStore(framebufUnfilteredDirect, pix, uvec4(encodeE5B9G9R9(unpacked))); }
@@ -32,6 +32,7 @@ static_assert(sizeof(RTGL1::ShGeometryInstance) % 16 == 0, "Std430 structs must
 RTGL1::GeomInfoManager::GeomInfoManager(VkDevice _device, std::shared_ptr<MemoryAllocator> &_allocator)
 :
     device(_device),
+    frameCount(_allocator->GetFrameCount()),
     staticGeomCount(0),
     dynamicGeomCount(0)
 {
@@ -43,12 +44,6 @@ RTGL1::GeomInfoManager::GeomInfoManager(VkDevice _device, std::shared_ptr<Memory
     buffer->Create(allBottomLevelGeomsCount * sizeof(RTGL1::ShGeometryInstance), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Geometry info buffer");
     matchPrev->Create(allBottomLevelGeomsCount * sizeof(int32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Match previous Geometry infos buffer");
     matchPrevShadow = std::make_unique<int32_t[]>(allBottomLevelGeomsCount);
-
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        copyRegionLowerBounds[i].resize(MAX_TOP_LEVEL_INSTANCE_COUNT, UINT32_MAX);
-        copyRegionUpperBounds[i].resize(MAX_TOP_LEVEL_INSTANCE_COUNT, 0);
-    }
 }
 
 RTGL1::GeomInfoManager::~GeomInfoManager()
@@ -59,12 +54,10 @@ bool RTGL1::GeomInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t frame
 {
     CmdLabel label(cmd, "Copying geom infos");
 
-    {
-        VkBufferCopy copyInfos[MAX_TOP_LEVEL_INSTANCE_COUNT];
-        VkBufferMemoryBarrier barriers[MAX_TOP_LEVEL_INSTANCE_COUNT];
-
-        uint32_t infoCount = 0;
+    VkBufferMemoryBarrier barriers[2];
+    uint32_t barrierCount = 0;
 
+    {
         for (auto cf : VertexCollectorFilterGroup_ChangeFrequency)
         {
             uint64_t upperBoundSize = cf & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC ?
@@ -95,127 +88,38 @@ bool RTGL1::GeomInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t frame
                     }
 
                     // copy from staging
-                    {
-                        VkBufferCopy &c = copyInfos[infoCount];
-
-                        c = {};
-                        c.srcOffset = offset;
-                        c.dstOffset = offset;
-                        c.size = size;
-                    }
-
-                    {
-                        VkBufferMemoryBarrier &b = barriers[infoCount];
-
-                        b = {};
-                        b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-                        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                        b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-                        b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-                        b.buffer = matchPrev->GetDeviceLocal();
-                        b.offset = offset;
-                        b.size = size;
-                    }
-
-                    infoCount++;
+                    matchPrev->MarkDirty(frameIndex, offset, size);
                 }
             }
         }
 
-        if (infoCount > 0)
+        if (matchPrev->CopyDirtyFromStaging(cmd, frameIndex, &barriers[barrierCount]))
         {
-            matchPrev->CopyFromStaging(cmd, frameIndex, copyInfos, infoCount);
-
-            if (insertBarrier)
-            {
-                vkCmdPipelineBarrier(
-                    cmd,
-                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
-                    0,
-                    0, nullptr,
-                    infoCount, barriers,
-                    0, nullptr);
-            }
+            barriers[barrierCount].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barrierCount++;
         }
     }
 
+    bool infosCopied = buffer->CopyDirtyFromStaging(cmd, frameIndex, &barriers[barrierCount]);
 
+    if (infosCopied)
     {
-        VkBufferCopy copyInfos[MAX_TOP_LEVEL_INSTANCE_COUNT];
-        VkBufferMemoryBarrier barriers[MAX_TOP_LEVEL_INSTANCE_COUNT];
-
-        uint32_t infoCount = 0;
-
-        for (auto cf : VertexCollectorFilterGroup_ChangeFrequency)
-        {
-            for (auto pt : VertexCollectorFilterGroup_PassThrough)
-            {
-                for (auto pm : VertexCollectorFilterGroup_PrimaryVisibility)
-                {
-                    uint32_t flagsId = VertexCollectorFilterTypeFlags_GetID(cf | pt | pm);
-
-                    const uint32_t lower = copyRegionLowerBounds[frameIndex][flagsId];
-                    const uint32_t upper = copyRegionUpperBounds[frameIndex][flagsId];
-
-                    if (lower < upper)
-                    {
-                        const uint32_t offsetInArray = VertexCollectorFilterTypeFlags_GetOffsetInGlobalArray(cf | pt | pm);
-
-                        const uint64_t offset = sizeof(ShGeometryInstance) * (offsetInArray + lower);
-                        const uint64_t size = sizeof(ShGeometryInstance) * (upper - lower);
-
-                        {
-                            VkBufferCopy &c = copyInfos[infoCount];
-
-                            c = {};
-                            c.srcOffset = offset;
-                            c.dstOffset = offset;
-                            c.size = size;
-                        }
-
-                        {
-                            VkBufferMemoryBarrier &b = barriers[infoCount];
-
-                            b = {};
-                            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-                            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                            b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-                            b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-                            b.buffer = buffer->GetDeviceLocal();
-                            b.offset = offset;
-                            b.size = size;
-                        }
-
-                        infoCount++;
-                    }
-                }
-            }
-        }
-
-        if (infoCount == 0)
-        {
-            return false;
-        }
-
-        buffer->CopyFromStaging(cmd, frameIndex, copyInfos, infoCount);
+        barriers[barrierCount].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrierCount++;
+    }
 
-        if (insertBarrier)
-        {
-            vkCmdPipelineBarrier(
-                cmd,
-                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
-                0,
-                0, nullptr,
-                infoCount, barriers,
-                0, nullptr);
-        }
+    if (insertBarrier && barrierCount > 0)
+    {
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+            0,
+            0, nullptr,
+            barrierCount, barriers,
+            0, nullptr);
     }
 
-    return true;
+    return infosCopied;
 }
 
 void RTGL1::GeomInfoManager::ResetMatchPrevForGroup(uint32_t frameIndex, VertexCollectorFilterTypeFlags groupFlags)
@@ -265,12 +169,7 @@ void RTGL1::GeomInfoManager::ResetOnlyDynamic(uint32_t frameIndex)
 
         // reset only dynamic count
         dynamicGeomCount = 0;
-    }
-
-    for (uint32_t type = 0; type < MAX_TOP_LEVEL_INSTANCE_COUNT; type++)
-    {
-        std::fill(copyRegionLowerBounds[frameIndex].begin(), copyRegionLowerBounds[frameIndex].end(), UINT32_MAX);
-        std::fill(copyRegionUpperBounds[frameIndex].begin(), copyRegionUpperBounds[frameIndex].end(), 0);
+        dynamicToPreprocess.clear();
     }
 }
 
@@ -278,7 +177,7 @@ void RTGL1::GeomInfoManager::ResetWithStatic()
 {
     movableIDToGeomFrameInfo.clear();
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         // reset each group
         for (auto cf : VertexCollectorFilterGroup_ChangeFrequency)
@@ -298,8 +197,9 @@ void RTGL1::GeomInfoManager::ResetWithStatic()
 
     geomType.clear();
     simpleToLocalIndex.clear();
+    staticToPreprocess.clear();
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         ResetOnlyDynamic(i);
     }
@@ -375,7 +275,7 @@ uint32_t RTGL1::GeomInfoManager::WriteGeomInfo(
 
         // copy to all staging buffers
         frameBegin = 0;
-        frameEnd = MAX_FRAMES_IN_FLIGHT;
+        frameEnd = frameCount;
     }
     else
     {
@@ -388,7 +288,18 @@ uint32_t RTGL1::GeomInfoManager::WriteGeomInfo(
 
     uint32_t globalGeomIndex = GetGlobalGeomIndex(localGeomIndex, flags);
 
-    uint32_t flagsId = VertexCollectorFilterTypeFlags_GetID(flags);
+    // only normals generation requires vertex preprocessing
+    if (src.flags & GEOM_INST_FLAG_GENERATE_NORMALS)
+    {
+        const bool useIndices = src.baseIndexIndex != UINT32_MAX;
+        const uint32_t triangleCount = useIndices ? src.indexCount / 3 : src.vertexCount / 3;
+
+        if (triangleCount > 0)
+        {
+            auto &toPreprocess = isStatic ? staticToPreprocess : dynamicToPreprocess;
+            toPreprocess.push_back({ globalGeomIndex, triangleCount, useIndices ? src.vertexCount : 0 });
+        }
+    }
 
     for (uint32_t i = frameBegin; i < frameEnd; i++)
     {
@@ -397,7 +308,7 @@ uint32_t RTGL1::GeomInfoManager::WriteGeomInfo(
         ShGeometryInstance *dst = GetGeomInfoAddressByGlobalIndex(i, globalGeomIndex);
         memcpy(dst, &src, sizeof(ShGeometryInstance));
 
-        MarkGeomInfoIndexToCopy(i, localGeomIndex, flagsId);
+        MarkGeomInfoIndexToCopy(i, globalGeomIndex);
     }
 
     WriteInfoForNextUsage(flags, geomUniqueID, globalGeomIndex, src, frameIndex);        
@@ -405,12 +316,9 @@ uint32_t RTGL1::GeomInfoManager::WriteGeomInfo(
     return simpleIndex;
 }
 
-void RTGL1::GeomInfoManager::MarkGeomInfoIndexToCopy(uint32_t frameIndex, uint32_t localGeomIndex, uint32_t flagsId)
+void RTGL1::GeomInfoManager::MarkGeomInfoIndexToCopy(uint32_t frameIndex, uint32_t globalGeomIndex)
 {
-    assert(flagsId < MAX_TOP_LEVEL_INSTANCE_COUNT);
-
-    copyRegionLowerBounds[frameIndex][flagsId] = std::min(localGeomIndex,     copyRegionLowerBounds[frameIndex][flagsId]);
-    copyRegionUpperBounds[frameIndex][flagsId] = std::max(localGeomIndex + 1, copyRegionUpperBounds[frameIndex][flagsId]);
+    buffer->MarkDirty(frameIndex, globalGeomIndex * sizeof(ShGeometryInstance), sizeof(ShGeometryInstance));
 }
 
 void RTGL1::GeomInfoManager::FillWithPrevFrameData(
@@ -427,8 +335,7 @@ void RTGL1::GeomInfoManager::FillWithPrevFrameData(
     // fill prev info, but only for movable and dynamic geoms
     if (isDynamic)
     {
-        static_assert(MAX_FRAMES_IN_FLIGHT == 2, "Assuming MAX_FRAMES_IN_FLIGHT==2");
-        uint32_t prevFrame = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+        uint32_t prevFrame = GetPrevFrameIndex(frameIndex, frameCount);
 
         prevIdToInfo = &dynamicIDToGeomFrameInfo[prevFrame];
     }
@@ -531,11 +438,10 @@ void RTGL1::GeomInfoManager::WriteStaticGeomInfoMaterials(uint32_t simpleIndex,
     assert(!(geomType[simpleIndex] & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC));
     assert(geomType.size() == simpleToLocalIndex.size());
 
-    const uint32_t flagsId = VertexCollectorFilterTypeFlags_GetID(geomType[simpleIndex]);
     const uint32_t globalIndex = ConvertSimpleIndexToGlobal(simpleIndex);
 
-    // need to write to both staging buffers for static geometry
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    // need to write to all staging buffers for static geometry
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         ShGeometryInstance *dst = GetGeomInfoAddressByGlobalIndex(i, globalIndex);
 
@@ -545,7 +451,7 @@ void RTGL1::GeomInfoManager::WriteStaticGeomInfoMaterials(uint32_t simpleIndex,
         memcpy(&pMatArr[layer * TEXTURES_PER_MATERIAL_COUNT], src.indices, TEXTURES_PER_MATERIAL_COUNT * sizeof(uint32_t));
 
         // mark to be copied
-        MarkGeomInfoIndexToCopy(i, simpleToLocalIndex[simpleIndex], flagsId);
+        MarkGeomInfoIndexToCopy(i, globalIndex);
     }
 }
 
@@ -561,7 +467,6 @@ void RTGL1::GeomInfoManager::WriteStaticGeomInfoTransform(uint32_t simpleIndex,
 
 
     const auto flags = geomType[simpleIndex];
-    const uint32_t flagsId = VertexCollectorFilterTypeFlags_GetID(flags);
 
     // only static and movable
     // geoms are allowed to update transforms
@@ -589,8 +494,8 @@ void RTGL1::GeomInfoManager::WriteStaticGeomInfoTransform(uint32_t simpleIndex,
     const uint32_t localGeomIndex = simpleToLocalIndex[simpleIndex];
     const uint32_t globalIndex = GetGlobalGeomIndex(localGeomIndex, flags);
 
-    // need to write to both staging buffers for static geometry
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    // need to write to all staging buffers for static geometry
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         ShGeometryInstance *dst = GetGeomInfoAddressByGlobalIndex(i, globalIndex);
 
@@ -601,7 +506,7 @@ void RTGL1::GeomInfoManager::WriteStaticGeomInfoTransform(uint32_t simpleIndex,
         MarkMovableHasPrevInfo(*dst);
 
         // mark to be copied
-        MarkGeomInfoIndexToCopy(i, localGeomIndex, flagsId);
+        MarkGeomInfoIndexToCopy(i, globalIndex);
     }
 
 
@@ -614,6 +519,21 @@ uint32_t RTGL1::GeomInfoManager::GetCount() const
     return staticGeomCount + dynamicGeomCount;
 }
 
+const std::vector<RTGL1::GeomPreprocessInfo> &RTGL1::GeomInfoManager::GetStaticToPreprocess() const
+{
+    return staticToPreprocess;
+}
+
+const std::vector<RTGL1::GeomPreprocessInfo> &RTGL1::GeomInfoManager::GetDynamicToPreprocess() const
+{
+    return dynamicToPreprocess;
+}
+
+void RTGL1::GeomInfoManager::OnStaticPreprocessed()
+{
+    staticToPreprocess.clear();
+}
+
 uint32_t RTGL1::GeomInfoManager::GetStaticCount() const
 {
     return staticGeomCount;
@@ -639,3 +559,8 @@ uint32_t RTGL1::GeomInfoManager::GetStaticGeomBaseVertexIndex(uint32_t simpleInd
     // just use frame 0, as infos have same values in both staging buffers
     return GetGeomInfoAddressByGlobalIndex(0, ConvertSimpleIndexToGlobal(simpleIndex))->baseVertexIndex;
 }
+
+uint32_t RTGL1::GeomInfoManager::GetDynamicGeomBaseVertexIndex(uint32_t frameIndex, uint32_t simpleIndex)
+{
+    return GetGeomInfoAddressByGlobalIndex(frameIndex, ConvertSimpleIndexToGlobal(simpleIndex))->baseVertexIndex;
+}
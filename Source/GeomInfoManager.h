@@ -34,6 +34,15 @@ namespace RTGL1
 
 struct ShGeometryInstance;
 
+// Geometry which vertices must be processed in VertexPreprocessing
+struct GeomPreprocessInfo
+{
+    uint32_t globalGeomIndex;
+    uint32_t triangleCount;
+    // vertex count, if vertices can be shared between triangles, otherwise 0
+    uint32_t accumVertexCount;
+};
+
 // SimpleIndex -- linear index, incremented with each addition of new geometry
 // LocalGeomIndex -- geometry index in its filter's space
 // GlobalGeomIndex = ToOffset(geomType) * MAX_BLAS_GEOMS + geomLocalIndex
@@ -80,6 +89,13 @@ public:
     VkBuffer GetBuffer() const;
     VkBuffer GetMatchPrevBuffer() const;
     uint32_t GetStaticGeomBaseVertexIndex(uint32_t simpleIndex);
+    uint32_t GetDynamicGeomBaseVertexIndex(uint32_t frameIndex, uint32_t simpleIndex);
+
+    // Static geometry is returned only once after it was written,
+    // as its vertices are not changed until the next static scene
+    const std::vector<GeomPreprocessInfo> &GetStaticToPreprocess() const;
+    const std::vector<GeomPreprocessInfo> &GetDynamicToPreprocess() const;
+    void OnStaticPreprocessed();
     
 private:
     struct GeomFrameInfo
@@ -109,7 +125,7 @@ private:
     uint32_t ConvertSimpleIndexToGlobal(uint32_t simpleIndex) const;
 
     // Mark memory to be copied to device local buffer
-    void MarkGeomInfoIndexToCopy(uint32_t frameIndex, uint32_t localGeomIndex, uint32_t flagsOffset);
+    void MarkGeomInfoIndexToCopy(uint32_t frameIndex, uint32_t globalGeomIndex);
 
     // Fill ShGeometryInstance with the data from previous frame
     // Note: frameIndex is not used if geom is not dynamic
@@ -127,6 +143,7 @@ private:
 
 private:
     VkDevice device;
+    uint32_t frameCount;
 
     // Dynamic geoms must be added only after static ones
     // so the variable "staticGeomCount" is used to "protect" static geoms
@@ -142,14 +159,14 @@ private:
     std::unique_ptr<int32_t[]> matchPrevShadow;
     MatchPrevCopyInfo matchPrevCopyInfo;
 
-    std::vector<uint32_t> copyRegionLowerBounds[MAX_FRAMES_IN_FLIGHT];
-    std::vector<uint32_t> copyRegionUpperBounds[MAX_FRAMES_IN_FLIGHT];
-
     // each geometry has its type as they're can be in different filters
     std::vector<VertexCollectorFilterTypeFlags> geomType;
 
     std::vector<uint32_t> simpleToLocalIndex;
 
+    std::vector<GeomPreprocessInfo> staticToPreprocess;
+    std::vector<GeomPreprocessInfo> dynamicToPreprocess;
+
     // geometry's uniqueID to geom frame info,
     // used for getting info from previous frame
     rgl::unordered_map<uint64_t, GeomFrameInfo> dynamicIDToGeomFrameInfo[MAX_FRAMES_IN_FLIGHT];
@@ -0,0 +1,127 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "GpuTimestamps.h"
+
+constexpr uint32_t QUERIES_PER_FRAME = 2;
+
+RTGL1::GpuTimestamps::GpuTimestamps(VkDevice _device, const std::shared_ptr<PhysicalDevice> &_physDevice, uint32_t frameCount)
+:
+    device(_device),
+    queryPool(VK_NULL_HANDLE),
+    timestampPeriod(_physDevice->GetTimestampPeriod()),
+    isWritten{},
+    durationMs{}
+{
+    assert(frameCount > 0 && frameCount <= MAX_FRAMES_IN_FLIGHT);
+
+    if (timestampPeriod <= 0.0f)
+    {
+        return;
+    }
+
+    VkQueryPoolCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    info.queryCount = QUERIES_PER_FRAME * frameCount;
+
+    VkResult r = vkCreateQueryPool(device, &info, nullptr, &queryPool);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, queryPool, VK_OBJECT_TYPE_QUERY_POOL, "GPU timestamps query pool");
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        durationMs[i] = -1.0f;
+    }
+}
+
+RTGL1::GpuTimestamps::~GpuTimestamps()
+{
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+    }
+}
+
+void RTGL1::GpuTimestamps::PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (queryPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    const uint32_t firstQuery = frameIndex * QUERIES_PER_FRAME;
+
+    if (isWritten[frameIndex])
+    {
+        uint64_t ticks[QUERIES_PER_FRAME] = {};
+
+        // frame's fence was waited, so don't wait for the results
+        VkResult r = vkGetQueryPoolResults(
+            device, queryPool, 
+            firstQuery, QUERIES_PER_FRAME, 
+            sizeof(ticks), ticks, sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT);
+
+        durationMs[frameIndex] = r == VK_SUCCESS && ticks[1] >= ticks[0] ?
+            (float)((double)(ticks[1] - ticks[0]) * timestampPeriod / 1000000.0) :
+            -1.0f;
+    }
+    else
+    {
+        durationMs[frameIndex] = -1.0f;
+    }
+
+    vkCmdResetQueryPool(cmd, queryPool, firstQuery, QUERIES_PER_FRAME);
+    isWritten[frameIndex] = false;
+}
+
+void RTGL1::GpuTimestamps::WriteBegin(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (queryPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, frameIndex * QUERIES_PER_FRAME + 0);
+}
+
+void RTGL1::GpuTimestamps::WriteEnd(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (queryPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, frameIndex * QUERIES_PER_FRAME + 1);
+    isWritten[frameIndex] = true;
+}
+
+bool RTGL1::GpuTimestamps::GetDurationMs(uint32_t frameIndex, float *pOutDurationMs) const
+{
+    if (durationMs[frameIndex] < 0.0f)
+    {
+        return false;
+    }
+
+    *pOutDurationMs = durationMs[frameIndex];
+    return true;
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+#include "PhysicalDevice.h"
+
+namespace RTGL1
+{
+
+// Measures GPU time between two points of a frame's command buffer.
+// Results are read when the frame with the same index is started again,
+// i.e. they're late by the count of frame indices.
+class GpuTimestamps
+{
+public:
+    GpuTimestamps(VkDevice device, const std::shared_ptr<PhysicalDevice> &physDevice, uint32_t frameCount);
+    ~GpuTimestamps();
+
+    GpuTimestamps(const GpuTimestamps &other) = delete;
+    GpuTimestamps(GpuTimestamps &&other) noexcept = delete;
+    GpuTimestamps &operator=(const GpuTimestamps &other) = delete;
+    GpuTimestamps &operator=(GpuTimestamps &&other) noexcept = delete;
+
+    // Must be called after waiting for the frame's fence
+    void PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    void WriteBegin(VkCommandBuffer cmd, uint32_t frameIndex);
+    void WriteEnd(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    // Get duration that was measured the last time with this frame index.
+    // Returns false, if there's no result.
+    bool GetDurationMs(uint32_t frameIndex, float *pOutDurationMs) const;
+
+private:
+    VkDevice device;
+    VkQueryPool queryPool;
+    // nanoseconds per timestamp tick; 0, if timestamps are not supported
+    float timestampPeriod;
+
+    bool isWritten[MAX_FRAMES_IN_FLIGHT];
+    float durationMs[MAX_FRAMES_IN_FLIGHT];
+};
+
+}
@@ -32,7 +32,9 @@ class IFramebuffersDependency
 {
 public:
     virtual ~IFramebuffersDependency() = default;
-    virtual void OnFramebuffersSizeChange(const ResolutionState &resolutionState) = 0;
+    // Called separately for each frame index, when it's safe to recreate resources of that frame.
+    // "allocation" is the size of framebuffer images, not the size of the area that is rendered to.
+    virtual void OnFramebuffersSizeChange(VkCommandBuffer cmd, uint32_t frameIndex, const ResolutionState &allocation) = 0;
 };
 
 }
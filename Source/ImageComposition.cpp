@@ -85,7 +85,9 @@ void RTGL1::ImageComposition::Compose(
 
 void RTGL1::ImageComposition::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroyPipelines();
+    shaderManager->DestroyWhenUnused(composePipeline);
+    shaderManager->DestroyWhenUnused(checkerboardPipeline);
+
     CreatePipelines(shaderManager);
 }
 
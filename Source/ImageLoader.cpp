@@ -19,9 +19,11 @@
 // SOFTWARE.
 
 #include "ImageLoader.h"
+#include "Utils.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cstdio>
 
 #include <ktx.h>
 #include <ktxvulkan.h>
@@ -34,12 +36,66 @@ ImageLoader::ImageLoader(std::shared_ptr<UserFileLoad> _userFileLoad) : userFile
 ImageLoader::~ImageLoader()
 {
     assert(loadedImages.empty());
+    assert(loadedSupercompressedFiles.empty());
 }
 
-bool ImageLoader::LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture)
+// KTX2 header is followed by the level index, see KTX2 specification
+constexpr size_t KTX2_LEVEL_INDEX_OFFSET = 80;
+
+struct Ktx2LevelIndexEntry
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+static bool IsZstdSupercompressed(ktxTexture *pTexture)
+{
+    return 
+        pTexture->classId == ktxTexture2_c &&
+        reinterpret_cast<ktxTexture2 *>(pTexture)->supercompressionScheme == KTX_SS_ZSTD;
+}
+
+// Texel block extent of the formats that can be stored in a texture file
+static uint32_t GetBlockExtent(VkFormat format)
+{
+    if ((format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK) ||
+        (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK))
+    {
+        return 4;
+    }
+
+    // otherwise, only uncompressed formats are expected
+    return 1;
+}
+
+static bool ReadWholeFile(const char *pFilePath, std::vector<uint8_t> &dst)
+{
+    FILE *pFile = fopen(pFilePath, "rb");
+
+    if (pFile == nullptr)
+    {
+        return false;
+    }
+
+    const long fileSize = fseek(pFile, 0, SEEK_END) == 0 ? ftell(pFile) : -1;
+    bool success = fileSize > 0 && fseek(pFile, 0, SEEK_SET) == 0;
+
+    if (success)
+    {
+        dst.resize(static_cast<size_t>(fileSize));
+        success = fread(dst.data(), 1, dst.size(), pFile) == dst.size();
+    }
+
+    fclose(pFile);
+    return success;
+}
+
+bool ImageLoader::LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture, std::vector<uint8_t> *pSupercompressedFile)
 {
     KTX_error_code r;
 
+    // image data is loaded separately, after checking the supercompression scheme
     if (userFileLoad->Exists())
     {
         auto fileHandle = userFileLoad->Open(pFilePath);
@@ -49,25 +105,129 @@ bool ImageLoader::LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture)
             return false;
         }
 
+        const uint8_t *pFileData = static_cast<const uint8_t *>(fileHandle.pData);
+
         r = ktxTexture_CreateFromMemory(
-            static_cast<const uint8_t *>(fileHandle.pData), fileHandle.dataSize,
-            KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+            pFileData, fileHandle.dataSize,
+            KTX_TEXTURE_CREATE_NO_FLAGS,
             ppTexture
         );
+
+        if (r != KTX_SUCCESS)
+        {
+            return false;
+        }
+
+        if (pSupercompressedFile != nullptr && IsZstdSupercompressed(*ppTexture))
+        {
+            pSupercompressedFile->assign(pFileData, pFileData + fileHandle.dataSize);
+            return true;
+        }
+
+        // must be loaded while the file is open
+        r = ktxTexture_LoadImageData(*ppTexture, nullptr, 0);
     }
     else
     {
         r = ktxTexture_CreateFromNamedFile(
             pFilePath,
-            KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+            KTX_TEXTURE_CREATE_NO_FLAGS,
             ppTexture);
-       
+
+        if (r != KTX_SUCCESS)
+        {
+            return false;
+        }
+
+        if (pSupercompressedFile != nullptr && IsZstdSupercompressed(*ppTexture))
+        {
+            r = ReadWholeFile(pFilePath, *pSupercompressedFile) ? KTX_SUCCESS : KTX_FILE_READ_ERROR;
+        }
+        else
+        {
+            r = ktxTexture_LoadImageData(*ppTexture, nullptr, 0);
+        }
+    }
+
+    if (r != KTX_SUCCESS)
+    {
+        ktxTexture_Destroy(*ppTexture);
+        *ppTexture = nullptr;
+
+        return false;
     }
 
-    return r == KTX_SUCCESS;
+    return true;
+}
+
+bool ImageLoader::GetSupercompressedLevels(ktxTexture *pTexture, const std::vector<uint8_t> &file, ResultInfo *pResultInfo) const
+{
+    const uint32_t levelCount = std::min(pTexture->numLevels, MAX_PREGENERATED_MIPMAP_LEVELS);
+    const uint32_t elementSize = ktxTexture_GetElementSize(pTexture);
+    const uint32_t blockExtent = GetBlockExtent(ktxTexture_GetVkFormat(pTexture));
+
+    if (levelCount == 0 || elementSize == 0 ||
+        file.size() > UINT32_MAX ||
+        file.size() < KTX2_LEVEL_INDEX_OFFSET + levelCount * sizeof(Ktx2LevelIndexEntry))
+    {
+        return false;
+    }
+
+    // inflated levels are copied from a buffer to an image, so their offsets
+    // must be a multiple of 4 and of the texel block size
+    uint32_t alignment = 4;
+    while (alignment % elementSize != 0)
+    {
+        alignment += 4;
+    }
+
+    uint64_t inflatedSize = 0;
+
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        // KTX2 is little-endian, as are all the target platforms
+        Ktx2LevelIndexEntry entry;
+        memcpy(&entry, &file[KTX2_LEVEL_INDEX_OFFSET + level * sizeof(Ktx2LevelIndexEntry)], sizeof(Ktx2LevelIndexEntry));
+
+        if (entry.byteLength == 0 || entry.uncompressedByteLength == 0 ||
+            entry.byteOffset + entry.byteLength > file.size())
+        {
+            return false;
+        }
+
+        // a level is inflated to a buffer of this size, so it must match the format exactly
+        const uint64_t expectedSize = Utils::GetMipLevelSize(
+            pTexture->baseWidth, pTexture->baseHeight, level, blockExtent, blockExtent, elementSize);
+
+        if (entry.uncompressedByteLength != expectedSize)
+        {
+            return false;
+        }
+
+        inflatedSize = (inflatedSize + alignment - 1) / alignment * alignment;
+
+        if (inflatedSize + entry.uncompressedByteLength > UINT32_MAX)
+        {
+            return false;
+        }
+
+        pResultInfo->levelSupercompressedOffsets[level] = static_cast<uint32_t>(entry.byteOffset);
+        pResultInfo->levelSupercompressedSizes[level] = static_cast<uint32_t>(entry.byteLength);
+        pResultInfo->levelOffsets[level] = static_cast<uint32_t>(inflatedSize);
+        pResultInfo->levelSizes[level] = static_cast<uint32_t>(entry.uncompressedByteLength);
+
+        inflatedSize += pResultInfo->levelSizes[level];
+    }
+
+    pResultInfo->levelCount = levelCount;
+    pResultInfo->isPregenerated = true;
+    pResultInfo->isSupercompressed = true;
+    pResultInfo->dataSize = static_cast<uint32_t>(inflatedSize);
+
+    return true;
 }
 
-bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo)
+bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo, bool keepSupercompressed)
 {
     assert(pResultInfo != nullptr);
     *pResultInfo = {};
@@ -79,7 +239,8 @@ bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo)
     }
 
     ktxTexture *pTexture = nullptr;
-    bool loaded = LoadTextureFile(pFilePath, &pTexture);
+    std::vector<uint8_t> supercompressedFile;
+    bool loaded = LoadTextureFile(pFilePath, &pTexture, keepSupercompressed ? &supercompressedFile : nullptr);
 
     if (!loaded)
     {
@@ -94,6 +255,28 @@ bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo)
 
     pResultInfo->baseSize = { pTexture->baseWidth, pTexture->baseHeight };
     pResultInfo->format = ktxTexture_GetVkFormat(pTexture);
+
+
+    if (!supercompressedFile.empty())
+    {
+        bool isValid = GetSupercompressedLevels(pTexture, supercompressedFile, pResultInfo);
+
+        // only the header was needed, levels are inflated by a user
+        ktxTexture_Destroy(pTexture);
+
+        if (!isValid)
+        {
+            *pResultInfo = {};
+            return false;
+        }
+
+        loadedSupercompressedFiles.push_back(std::move(supercompressedFile));
+        pResultInfo->pData = loadedSupercompressedFiles.back().data();
+
+        return true;
+    }
+
+
     pResultInfo->pData = ktxTexture_GetData(pTexture);
     pResultInfo->dataSize = static_cast<uint32_t>(ktxTexture_GetDataSize(pTexture));
     pResultInfo->isPregenerated = true;
@@ -134,7 +317,7 @@ bool ImageLoader::LoadLayered(const char *pFilePath, LayeredResultInfo *pResultI
     }
 
     ktxTexture *pTexture = nullptr;
-    bool loaded = LoadTextureFile(pFilePath, &pTexture);
+    bool loaded = LoadTextureFile(pFilePath, &pTexture, nullptr);
 
     if (!loaded)
     {
@@ -181,4 +364,5 @@ void ImageLoader::FreeLoaded()
     }
 
     loadedImages.clear();
+    loadedSupercompressedFiles.clear();
 }
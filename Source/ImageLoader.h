@@ -45,6 +45,12 @@ public:
         uint32_t        dataSize;
         RgExtent2D      baseSize;
         VkFormat        format;
+        // If true, pData contains zstd-supercompressed levels: level i is in
+        // [levelSupercompressedOffsets[i], +levelSupercompressedSizes[i]) of pData,
+        // and it must be inflated to levelOffsets[i] of a buffer with dataSize bytes
+        bool            isSupercompressed;
+        uint32_t        levelSupercompressedOffsets[MAX_PREGENERATED_MIPMAP_LEVELS];
+        uint32_t        levelSupercompressedSizes[MAX_PREGENERATED_MIPMAP_LEVELS];
     };
 
     struct LayeredResultInfo
@@ -64,18 +70,24 @@ public:
     ImageLoader &operator=(const ImageLoader &other) = delete;
     ImageLoader &operator=(ImageLoader &&other) noexcept = delete;
 
-    bool Load(const char *pFilePath, ResultInfo *pResultInfo);
+    // If keepSupercompressed is true, zstd-supercompressed files are not inflated,
+    // so a user of the result can inflate levels directly to their destination
+    bool Load(const char *pFilePath, ResultInfo *pResultInfo, bool keepSupercompressed);
     bool LoadLayered(const char *pFilePath, LayeredResultInfo *pResultInfo);
 
     // Must be called after using the loaded data to free the allocated memory
     void FreeLoaded();
 
 private:
-    bool LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture);
+    // If pSupercompressedFile is not null and the file is zstd-supercompressed,
+    // image data is not loaded to the texture, but the whole file is copied to pSupercompressedFile
+    bool LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture, std::vector<uint8_t> *pSupercompressedFile);
+    bool GetSupercompressedLevels(ktxTexture *pTexture, const std::vector<uint8_t> &file, ResultInfo *pResultInfo) const;
 
 private:
     std::shared_ptr<UserFileLoad> userFileLoad;
     std::vector<void *> loadedImages;
+    std::vector<std::vector<uint8_t>> loadedSupercompressedFiles;
 };
 
 }
\ No newline at end of file
@@ -486,10 +486,10 @@ void RTGL1::LensFlares::DestroyPipelines()
 
 void RTGL1::LensFlares::OnShaderReload(const ShaderManager *shaderManager)
 {
-    rasterPipelines->Clear();
+    rasterPipelines->Clear(shaderManager);
     rasterPipelines->SetShaders(shaderManager, VERT_SHADER, FRAG_SHADER);
 
-    DestroyPipelines();
+    shaderManager->DestroyWhenUnused(cullPipeline);
     CreatePipelines(shaderManager);
 }
 
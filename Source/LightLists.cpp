@@ -81,8 +81,12 @@ void RTGL1::LightLists::AddLightToSectorLightList(LightArrayIndex lightIndex, Se
 {
     auto &v = lightLists[lightSectorIndex.GetArrayIndex()];
 
-    // guarantee capacity of >= VECTOR_START_CAPACITY
-    v.reserve(VECTOR_START_CAPACITY);
+    // guarantee capacity of >= VECTOR_START_CAPACITY, but only once,
+    // as PrepareForFrame doesn't deallocate
+    if (v.capacity() == 0)
+    {
+        v.reserve(VECTOR_START_CAPACITY);
+    }
     v.push_back(lightIndex);
 
     // values must be unique
@@ -93,8 +97,17 @@ void RTGL1::LightLists::AddLightToSectorLightList(LightArrayIndex lightIndex, Se
 void RTGL1::LightLists::InsertLight(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex,
                                     PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn)
 {
-    // sector is always visible from itself, so append the light unconditionally
-    AddLightToSectorLightList(lightIndex, lightSectorIndex);
+    const LightToInsert l = { lightIndex, pfnRgIsLightVisibleFromSector, pUserDataForPfn };
+    InsertLights(lightSectorIndex, &l, 1);
+}
+
+void RTGL1::LightLists::InsertLights(SectorArrayIndex lightSectorIndex, const LightToInsert *pLights, uint32_t count)
+{
+    // sector is always visible from itself, so append the lights unconditionally
+    for (uint32_t i = 0; i < count; i++)
+    {
+        AddLightToSectorLightList(pLights[i].lightIndex, lightSectorIndex);
+    }
 
 
     if (sectorVisibility->ArePotentiallyVisibleSectorsExist(lightSectorIndex))
@@ -105,19 +118,26 @@ void RTGL1::LightLists::InsertLight(LightArrayIndex lightIndex, SectorArrayIndex
         {
             assert(visibleSector != lightSectorIndex);
 
-            // check if truly can be added
-            if (pfnRgIsLightVisibleFromSector != nullptr)
+            const SectorID visibleSectorID = sectorVisibility->SectorArrayIndexToID(visibleSector);
+
+            for (uint32_t i = 0; i < count; i++)
             {
-                RgBool32 isAdded = pfnRgIsLightVisibleFromSector(sectorVisibility->SectorArrayIndexToID(visibleSector).GetID(), pUserDataForPfn);
+                const LightToInsert &l = pLights[i];
 
-                if (!isAdded)
+                // check if truly can be added
+                if (l.pfnRgIsLightVisibleFromSector != nullptr)
                 {
-                    continue;
+                    RgBool32 isAdded = l.pfnRgIsLightVisibleFromSector(visibleSectorID.GetID(), l.pUserDataForPfn);
+
+                    if (!isAdded)
+                    {
+                        continue;
+                    }
                 }
-            }
 
-            // append given light to light list of such sector
-            AddLightToSectorLightList(lightIndex, visibleSector);
+                // append given light to light list of such sector
+                AddLightToSectorLightList(l.lightIndex, visibleSector);
+            }
         }
     }
 }
@@ -48,8 +48,17 @@ public:
     void PrepareForFrame();
     void Reset();
 
+    struct LightToInsert
+    {
+        LightArrayIndex lightIndex;
+        PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector;
+        void *pUserDataForPfn;
+    };
+
     void InsertLight(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex, 
                      PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn);
+    // All lights must be in the same sector, so its potentially visible sectors are traversed only once
+    void InsertLights(SectorArrayIndex lightSectorIndex, const LightToInsert *pLights, uint32_t count);
     void BuildAndCopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex);
 
     SectorArrayIndex SectorIDToArrayIndex(SectorID id) const;
@@ -20,6 +20,7 @@
 
 #include "LightManager.h"
 
+#include <algorithm>
 #include <cmath>
 #include <array>
 
@@ -42,9 +43,12 @@ constexpr uint32_t MAX_LIGHT_COUNT_POLYGONAL = 1024;
 RTGL1::LightManager::LightManager(
     VkDevice _device, 
     std::shared_ptr<MemoryAllocator> &_allocator, 
+    std::shared_ptr<FrameAllocator> _frameAllocator,
     std::shared_ptr<SectorVisibility> &_sectorVisibility)
 :
     device(_device),
+    frameAllocator(std::move(_frameAllocator)),
+    frameCount(_allocator->GetFrameCount()),
     sphLightCount(0),
     sphLightCountPrev(0),
     dirLightCount(0),
@@ -189,13 +193,18 @@ void RTGL1::LightManager::PrepareForFrame(VkCommandBuffer cmd, uint32_t frameInd
     sphericalUniqueIDToPrevIndex[frameIndex].clear();
     polygonalUniqueIDToPrevIndex[frameIndex].clear();
 
+    // lights of the previous frame will be searched by unique ID
+    uint32_t prevFrame = GetPrevFrameIndex(frameIndex, frameCount);
+    SortByUniqueID(sphericalUniqueIDToPrevIndex[prevFrame]);
+    SortByUniqueID(polygonalUniqueIDToPrevIndex[prevFrame]);
+
     lightListsForSpherical->PrepareForFrame();
     lightListsForPolygonal->PrepareForFrame();
 }
 
 void RTGL1::LightManager::Reset()
 {
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         memset(sphericalLightMatchPrev->GetMapped(i), 0xFF, sizeof(uint32_t) * std::max(sphLightCount, sphLightCountPrev));
         memset(polygonalLightMatchPrev->GetMapped(i), 0xFF, sizeof(uint32_t) * std::max(polyLightCount, polyLightCountPrev));
@@ -244,11 +253,8 @@ void RTGL1::LightManager::AddSphericalLight(uint32_t frameIndex, const RgSpheric
 
     FillMatchPrev(sphericalUniqueIDToPrevIndex, sphericalLightMatchPrev, frameIndex, index, info.uniqueID);
 
-    // must be unique
-    assert(sphericalUniqueIDToPrevIndex[frameIndex].find(info.uniqueID) == sphericalUniqueIDToPrevIndex[frameIndex].end());
-
     // save index for the next frame
-    sphericalUniqueIDToPrevIndex[frameIndex][info.uniqueID] = index;
+    sphericalUniqueIDToPrevIndex[frameIndex].push_back({ info.uniqueID, index });
 
 
     lightListsForSpherical->InsertLight(index, sectorArrayIndex,
@@ -281,17 +287,121 @@ void RTGL1::LightManager::AddPolygonalLight(uint32_t frameIndex, const RgPolygon
 
     FillMatchPrev(polygonalUniqueIDToPrevIndex, polygonalLightMatchPrev, frameIndex, index, info.uniqueID);
 
-    // must be unique
-    assert(polygonalUniqueIDToPrevIndex[frameIndex].find(info.uniqueID) == polygonalUniqueIDToPrevIndex[frameIndex].end());
-
     // save index for the next frame
-    polygonalUniqueIDToPrevIndex[frameIndex][info.uniqueID] = index;
+    polygonalUniqueIDToPrevIndex[frameIndex].push_back({ info.uniqueID, index });
 
 
     lightListsForPolygonal->InsertLight(index, sectorArrayIndex,
                                         info.pfnIsLightVisibleFromSector, info.pUserDataForPfn);
 }
 
+void RTGL1::LightManager::AddSphericalLights(uint32_t frameIndex, const RgSphericalLightUploadInfo *pInfos, uint32_t count)
+{
+    auto *dst = (ShLightSpherical *)sphericalLights->GetMapped(frameIndex);
+    const size_t firstNew = sphericalUniqueIDToPrevIndex[frameIndex].size();
+
+    rgl::frame_vector<SectorLight> sectorLights(FrameStlAllocator<SectorLight>(frameAllocator.get()));
+    sectorLights.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const RgSphericalLightUploadInfo &info = pInfos[i];
+
+        if (IsColorTooDim(info.color))
+        {
+            continue;
+        }
+
+        if (sphLightCount >= MAX_LIGHT_COUNT_SPHERICAL)
+        {
+            assert(0);
+            break;
+        }
+
+
+        const SectorID sectorId = SectorID{ info.sectorID };
+        const SectorArrayIndex sectorArrayIndex = lightListsForSpherical->SectorIDToArrayIndex(sectorId);
+
+
+        const LightArrayIndex index = LightArrayIndex{ sphLightCount };
+        sphLightCount++;
+
+        FillInfoSpherical(info, &dst[index.GetArrayIndex()]);
+
+        sphericalUniqueIDToPrevIndex[frameIndex].push_back({ info.uniqueID, index });
+        sectorLights.push_back({ sectorArrayIndex, { index, nullptr, nullptr } });
+    }
+
+    FillMatchPrevBatch(sphericalUniqueIDToPrevIndex, sphericalLightMatchPrev, frameIndex, firstNew);
+    InsertLightsBySector(lightListsForSpherical, sectorLights);
+}
+
+void RTGL1::LightManager::AddPolygonalLights(uint32_t frameIndex, const RgPolygonalLightUploadInfo *pInfos, uint32_t count)
+{
+    auto *dst = (ShLightPolygonal *)polygonalLights->GetMapped(frameIndex);
+    const size_t firstNew = polygonalUniqueIDToPrevIndex[frameIndex].size();
+
+    rgl::frame_vector<SectorLight> sectorLights(FrameStlAllocator<SectorLight>(frameAllocator.get()));
+    sectorLights.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const RgPolygonalLightUploadInfo &info = pInfos[i];
+
+        if (IsColorTooDim(info.color))
+        {
+            continue;
+        }
+
+        if (polyLightCount >= MAX_LIGHT_COUNT_POLYGONAL)
+        {
+            assert(0);
+            break;
+        }
+
+
+        const SectorID sectorId = SectorID{ info.sectorID };
+        const SectorArrayIndex sectorArrayIndex = lightListsForPolygonal->SectorIDToArrayIndex(sectorId);
+
+
+        const LightArrayIndex index = LightArrayIndex{ polyLightCount };
+        polyLightCount++;
+
+        FillInfoPolygonal(info, &dst[index.GetArrayIndex()]);
+
+        polygonalUniqueIDToPrevIndex[frameIndex].push_back({ info.uniqueID, index });
+        sectorLights.push_back({ sectorArrayIndex, { index, info.pfnIsLightVisibleFromSector, info.pUserDataForPfn } });
+    }
+
+    FillMatchPrevBatch(polygonalUniqueIDToPrevIndex, polygonalLightMatchPrev, frameIndex, firstNew);
+    InsertLightsBySector(lightListsForPolygonal, sectorLights);
+}
+
+void RTGL1::LightManager::InsertLightsBySector(const std::shared_ptr<LightLists> &lightLists, rgl::frame_vector<SectorLight> &sectorLights)
+{
+    // group by sector, but keep the upload order inside a group
+    std::stable_sort(sectorLights.begin(), sectorLights.end(), [] (const SectorLight &a, const SectorLight &b)
+    {
+        return a.sectorIndex.GetArrayIndex() < b.sectorIndex.GetArrayIndex();
+    });
+
+    rgl::frame_vector<LightLists::LightToInsert> group(FrameStlAllocator<LightLists::LightToInsert>(frameAllocator.get()));
+    group.reserve(sectorLights.size());
+
+    for (size_t i = 0; i < sectorLights.size(); )
+    {
+        const SectorArrayIndex sectorIndex = sectorLights[i].sectorIndex;
+        group.clear();
+
+        for (; i < sectorLights.size() && sectorLights[i].sectorIndex == sectorIndex; i++)
+        {
+            group.push_back(sectorLights[i].light);
+        }
+
+        lightLists->InsertLights(sectorIndex, group.data(), (uint32_t)group.size());
+    }
+}
+
 void RTGL1::LightManager::AddSpotlight(uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, const RgSpotlightUploadInfo &info)
 {
     if (IsColorTooDim(info.color) ||
@@ -382,26 +492,84 @@ VkDescriptorSet RTGL1::LightManager::GetDescSet(uint32_t frameIndex)
     return descSets[frameIndex];
 }
 
+constexpr auto UniqueIDLess = [] (const auto &a, const auto &b)
+{
+    return a.uniqueID < b.uniqueID;
+};
+
+void RTGL1::LightManager::SortByUniqueID(UniqueIDToIndexList &list)
+{
+    std::sort(list.begin(), list.end(), UniqueIDLess);
+
+    // must be unique
+    assert(std::adjacent_find(list.cbegin(), list.cend(), [] (const UniqueIDToIndex &a, const UniqueIDToIndex &b)
+    {
+        return a.uniqueID == b.uniqueID;
+    }) == list.cend());
+}
+
 void RTGL1::LightManager::FillMatchPrev(
-    const rgl::unordered_map<UniqueLightID, LightArrayIndex> *pUniqueToPrevIndex,
+    const UniqueIDToIndexList *pUniqueToPrevIndex,
     const std::shared_ptr<AutoBuffer> &matchPrev,
     uint32_t curFrameIndex, LightArrayIndex lightIndexInCurFrame, UniqueLightID uniqueID)
 {
-    uint32_t prevFrame = (curFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
-    const rgl::unordered_map<UniqueLightID, LightArrayIndex> &uniqueToPrevIndex = pUniqueToPrevIndex[prevFrame];
+    uint32_t prevFrame = GetPrevFrameIndex(curFrameIndex, frameCount);
+    const UniqueIDToIndexList &uniqueToPrevIndex = pUniqueToPrevIndex[prevFrame];
 
-    auto found = uniqueToPrevIndex.find(uniqueID);
-    if (found == uniqueToPrevIndex.end())
+    // sorted in PrepareForFrame
+    auto found = std::lower_bound(uniqueToPrevIndex.cbegin(), uniqueToPrevIndex.cend(), UniqueIDToIndex{ uniqueID, {} }, UniqueIDLess);
+    if (found == uniqueToPrevIndex.cend() || found->uniqueID != uniqueID)
     {
         return;
     }
 
-    LightArrayIndex lightIndexInPrevFrame = found->second;
+    LightArrayIndex lightIndexInPrevFrame = found->index;
 
     uint32_t *dst = (uint32_t*)matchPrev->GetMapped(curFrameIndex);
     dst[lightIndexInPrevFrame.GetArrayIndex()] = lightIndexInCurFrame.GetArrayIndex();
 }
 
+void RTGL1::LightManager::FillMatchPrevBatch(
+    const UniqueIDToIndexList *pUniqueToPrevIndex,
+    const std::shared_ptr<AutoBuffer> &matchPrev,
+    uint32_t curFrameIndex, size_t firstNew)
+{
+    uint32_t prevFrame = GetPrevFrameIndex(curFrameIndex, frameCount);
+    const UniqueIDToIndexList &uniqueToPrevIndex = pUniqueToPrevIndex[prevFrame];
+    const UniqueIDToIndexList &uniqueToCurIndex = pUniqueToPrevIndex[curFrameIndex];
+
+    assert(firstNew <= uniqueToCurIndex.size());
+
+    rgl::frame_vector<UniqueIDToIndex> added(
+        uniqueToCurIndex.cbegin() + firstNew, uniqueToCurIndex.cend(), 
+        FrameStlAllocator<UniqueIDToIndex>(frameAllocator.get()));
+
+    std::sort(added.begin(), added.end(), UniqueIDLess);
+
+    uint32_t *dst = (uint32_t *)matchPrev->GetMapped(curFrameIndex);
+
+    // both are sorted, so walk them simultaneously
+    auto prev = uniqueToPrevIndex.cbegin();
+
+    for (const UniqueIDToIndex &cur : added)
+    {
+        while (prev != uniqueToPrevIndex.cend() && prev->uniqueID < cur.uniqueID)
+        {
+            ++prev;
+        }
+
+        if (prev == uniqueToPrevIndex.cend())
+        {
+            break;
+        }
+
+        if (prev->uniqueID == cur.uniqueID)
+        {
+            dst[prev->index.GetArrayIndex()] = cur.index.GetArrayIndex();
+        }
+    }
+}
+
 constexpr uint32_t BINDINGS[] =
 {
     BINDING_LIGHT_SOURCES_SPHERICAL,
@@ -446,11 +614,11 @@ void RTGL1::LightManager::CreateDescriptors()
 
     VkDescriptorPoolSize poolSize = {};
     poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSize.descriptorCount = bindings.size() * MAX_FRAMES_IN_FLIGHT;
+    poolSize.descriptorCount = bindings.size() * frameCount;
 
     VkDescriptorPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+    poolInfo.maxSets = frameCount;
     poolInfo.poolSizeCount = 1;
     poolInfo.pPoolSizes = &poolSize;
 
@@ -465,7 +633,7 @@ void RTGL1::LightManager::CreateDescriptors()
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &descSetLayout;
     
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         r = vkAllocateDescriptorSets(device, &allocInfo, &descSets[i]);
         VK_CHECKERROR(r);
@@ -473,7 +641,7 @@ void RTGL1::LightManager::CreateDescriptors()
         SET_DEBUG_NAME(device, descSets[i], VK_OBJECT_TYPE_DESCRIPTOR_SET, "Light buffers Desc set");
     }
     
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         UpdateDescriptors(i);
     }
@@ -562,5 +730,3 @@ uint32_t RTGL1::LightManager::GetPolygonalLightCountPrev() const
 {
     return polyLightCountPrev;
 }
-
-static_assert(RTGL1::MAX_FRAMES_IN_FLIGHT == 2, "");
\ No newline at end of file
@@ -33,7 +33,7 @@ namespace RTGL1
 class LightManager
 {
 public:
-    LightManager(VkDevice device, std::shared_ptr<MemoryAllocator> &allocator, std::shared_ptr<SectorVisibility> &sectorVisibility);
+    LightManager(VkDevice device, std::shared_ptr<MemoryAllocator> &allocator, std::shared_ptr<FrameAllocator> frameAllocator, std::shared_ptr<SectorVisibility> &sectorVisibility);
     ~LightManager();
 
     LightManager(const LightManager &other) = delete;
@@ -55,6 +55,10 @@ public:
 
     void AddSphericalLight(uint32_t frameIndex, const RgSphericalLightUploadInfo &info);
     void AddPolygonalLight(uint32_t frameIndex, const RgPolygonalLightUploadInfo &info);
+    // Lights are written to staging in one pass, matched with the previous frame's ones
+    // by one merge of sorted unique IDs, and inserted to light lists by groups of the same sector.
+    void AddSphericalLights(uint32_t frameIndex, const RgSphericalLightUploadInfo *pInfos, uint32_t count);
+    void AddPolygonalLights(uint32_t frameIndex, const RgPolygonalLightUploadInfo *pInfos, uint32_t count);
     void AddDirectionalLight(uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, const RgDirectionalLightUploadInfo &info);
     void AddSpotlight(uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, const RgSpotlightUploadInfo &info);
 
@@ -63,11 +67,35 @@ public:
     VkDescriptorSetLayout GetDescSetLayout();
     VkDescriptorSet GetDescSet(uint32_t frameIndex);
 
+private:
+    struct UniqueIDToIndex
+    {
+        UniqueLightID uniqueID;
+        LightArrayIndex index;
+    };
+
+    // Lights of a frame in upload order; sorted by unique ID, when the frame becomes previous
+    typedef std::vector<UniqueIDToIndex> UniqueIDToIndexList;
+
+    struct SectorLight
+    {
+        SectorArrayIndex sectorIndex;
+        LightLists::LightToInsert light;
+    };
+
 private:
     void FillMatchPrev(
-        const rgl::unordered_map<UniqueLightID, LightArrayIndex> *pUniqueToPrevIndex,
+        const UniqueIDToIndexList *pUniqueToPrevIndex,
         const std::shared_ptr<AutoBuffer> &matchPrev,
         uint32_t curFrameIndex, LightArrayIndex lightIndexInCurFrame, UniqueLightID uniqueID);
+    // Match lights that were added to the current frame's list, starting from "firstNew"
+    void FillMatchPrevBatch(
+        const UniqueIDToIndexList *pUniqueToPrevIndex,
+        const std::shared_ptr<AutoBuffer> &matchPrev,
+        uint32_t curFrameIndex, size_t firstNew);
+    static void SortByUniqueID(UniqueIDToIndexList &list);
+
+    void InsertLightsBySector(const std::shared_ptr<LightLists> &lightLists, rgl::frame_vector<SectorLight> &sectorLights);
 
     void CreateDescriptors();
     void UpdateDescriptors(uint32_t frameIndex);
@@ -75,6 +103,9 @@ private:
 private:
     VkDevice device;
 
+    std::shared_ptr<FrameAllocator> frameAllocator;
+    uint32_t frameCount;
+
     std::shared_ptr<LightLists> lightListsForPolygonal;
     std::shared_ptr<LightLists> lightListsForSpherical;
 
@@ -89,8 +120,8 @@ private:
     std::shared_ptr<AutoBuffer> sphericalLightMatchPrev;
     std::shared_ptr<AutoBuffer> polygonalLightMatchPrev;
 
-    rgl::unordered_map<UniqueLightID, LightArrayIndex> sphericalUniqueIDToPrevIndex[MAX_FRAMES_IN_FLIGHT];
-    rgl::unordered_map<UniqueLightID, LightArrayIndex> polygonalUniqueIDToPrevIndex[MAX_FRAMES_IN_FLIGHT];
+    UniqueIDToIndexList sphericalUniqueIDToPrevIndex[MAX_FRAMES_IN_FLIGHT];
+    UniqueIDToIndexList polygonalUniqueIDToPrevIndex[MAX_FRAMES_IN_FLIGHT];
 
     uint32_t sphLightCount;
     uint32_t sphLightCountPrev;
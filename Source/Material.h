@@ -55,6 +55,9 @@ struct AnimatedMaterial
     // Indices of static materials.
     std::vector<uint32_t>   materialIndices;
     uint32_t                currentFrame = 0;
+    // Index in the animated material table that shaders read
+    // current frame textures from, or NO_ANIMATED_MATERIAL_SLOT.
+    uint32_t                slot = NO_ANIMATED_MATERIAL_SLOT;
 };
 
 
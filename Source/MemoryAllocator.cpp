@@ -27,37 +27,63 @@ using namespace RTGL1;
 MemoryAllocator::MemoryAllocator(
     VkInstance _instance,
     VkDevice _device,
-    std::shared_ptr<PhysicalDevice> _physDevice)
+    std::shared_ptr<PhysicalDevice> _physDevice,
+    uint32_t _frameCount,
+    bool _useMemoryBudgetExtension)
 :
     device(_device),
     physDevice(std::move(_physDevice)),
+    frameCount(_frameCount),
     allocator(VK_NULL_HANDLE),
     texturesStagingPool(VK_NULL_HANDLE),
-    texturesFinalPool(VK_NULL_HANDLE)
+    texturesFinalPool(VK_NULL_HANDLE),
+    bufferPools{},
+    bufferPoolInfos{},
+    bufferCounters{}
 {
+    assert(frameCount > 0 && frameCount <= MAX_FRAMES_IN_FLIGHT);
+
     VmaAllocatorCreateInfo allocatorInfo = {};
     allocatorInfo.instance = _instance;
     allocatorInfo.device = device;
     allocatorInfo.physicalDevice = physDevice->Get();
     allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_2;
-    allocatorInfo.frameInUseCount = MAX_FRAMES_IN_FLIGHT;
+    allocatorInfo.frameInUseCount = frameCount;
 
     allocatorInfo.flags =
         // currently, the library uses only one thread
         VMA_ALLOCATOR_CREATE_EXTERNALLY_SYNCHRONIZED_BIT |
         // if buffer/image requires a dedicated allocation
-        VMA_ALLOCATOR_CREATE_KHR_DEDICATED_ALLOCATION_BIT;
+        VMA_ALLOCATOR_CREATE_KHR_DEDICATED_ALLOCATION_BIT |
+        // buffers from the pools can have VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+        VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+
+    if (_useMemoryBudgetExtension)
+    {
+        // query actual usage and budget from the driver
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
 
     VkResult r = vmaCreateAllocator(&allocatorInfo, &allocator);
     VK_CHECKERROR(r);
 
     CreateTexturesStagingPool();
     CreateTexturesFinalPool();
+
+    CreateBufferPool(BufferUsageClass::DEVICE_LOCAL);
+    CreateBufferPool(BufferUsageClass::ACCELERATION_STRUCTURE);
+    CreateBufferPool(BufferUsageClass::STAGING);
 }
 
 MemoryAllocator::~MemoryAllocator()
 {
     assert(bufAllocs.size() == 0);
+    assert(bufferAllocInfos.size() == 0);
+
+    for (VmaPool p : bufferPools)
+    {
+        vmaDestroyPool(allocator, p);
+    }
 
     vmaDestroyPool(allocator, texturesStagingPool);
     vmaDestroyPool(allocator, texturesFinalPool);
@@ -159,6 +185,212 @@ void MemoryAllocator::DestroyTextureImage(VkImage image)
     imgAllocs.erase(image);
 }
 
+VkBuffer MemoryAllocator::CreateBuffer(
+    const VkBufferCreateInfo *info, VkMemoryPropertyFlags properties, const char *pDebugName, 
+    VmaAllocation *pOutAllocation, void **pOutMappedData)
+{
+    const BufferUsageClass usageClass = GetBufferUsageClass(info->usage, properties);
+    const bool isHostVisible = usageClass == BufferUsageClass::STAGING;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+
+    VkResult r = vkCreateBuffer(device, info, nullptr, &buffer);
+    VK_CHECKERROR(r);
+    if (r != VK_SUCCESS)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+
+    // Vma doesn't check the pool's memory type against the buffer's requirements,
+    // so choose between the pool and a dedicated allocation before allocating
+    VkMemoryDedicatedRequirements dedicatedReqs = {};
+    dedicatedReqs.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    VkMemoryRequirements2 memReqs2 = {};
+    memReqs2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    memReqs2.pNext = &dedicatedReqs;
+
+    VkBufferMemoryRequirementsInfo2 bufferReqsInfo = {};
+    bufferReqsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    bufferReqsInfo.buffer = buffer;
+
+    vkGetBufferMemoryRequirements2(device, &bufferReqsInfo, &memReqs2);
+
+    const VkMemoryRequirements &memReqs = memReqs2.memoryRequirements;
+    const BufferPoolInfo &pool = bufferPoolInfos[(size_t)usageClass];
+
+    const bool isDedicated =
+        !(memReqs.memoryTypeBits & (1u << pool.memoryTypeIndex)) ||
+        dedicatedReqs.requiresDedicatedAllocation ||
+        dedicatedReqs.prefersDedicatedAllocation ||
+        // doesn't fit into a block
+        memReqs.size > pool.blockSize;
+
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.flags = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT;
+    allocInfo.pUserData = const_cast<char *>(pDebugName);
+
+    if (isHostVisible)
+    {
+        allocInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
+
+    if (isDedicated)
+    {
+        allocInfo.requiredFlags = properties;
+        allocInfo.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    }
+    else
+    {
+        allocInfo.pool = bufferPools[(size_t)usageClass];
+    }
+
+    VmaAllocation resultAlloc = VK_NULL_HANDLE;
+    VmaAllocationInfo resultAllocInfo = {};
+
+    r = vmaAllocateMemoryForBuffer(allocator, buffer, &allocInfo, &resultAlloc, &resultAllocInfo);
+    VK_CHECKERROR(r);
+
+    if (r == VK_SUCCESS)
+    {
+        r = vmaBindBufferMemory(allocator, resultAlloc, buffer);
+        VK_CHECKERROR(r);
+    }
+
+    if (r != VK_SUCCESS)
+    {
+        if (resultAlloc != VK_NULL_HANDLE)
+        {
+            vmaFreeMemory(allocator, resultAlloc);
+        }
+
+        vkDestroyBuffer(device, buffer, nullptr);
+        return VK_NULL_HANDLE;
+    }
+
+    SET_DEBUG_NAME(device, buffer, VK_OBJECT_TYPE_BUFFER, pDebugName);
+
+    BufferClassCounters &counters = bufferCounters[(size_t)usageClass];
+    counters.bufferCount++;
+    counters.usedSize += info->size;
+
+    if (isDedicated)
+    {
+        counters.dedicatedCount++;
+        counters.dedicatedSize += resultAllocInfo.size;
+    }
+
+    bufferAllocInfos[resultAlloc] = BufferAllocInfo
+    {
+        usageClass,
+        info->size,
+        isDedicated ? resultAllocInfo.size : 0,
+    };
+
+    *pOutAllocation = resultAlloc;
+
+    if (pOutMappedData != nullptr)
+    {
+        assert(!isHostVisible || resultAllocInfo.pMappedData != nullptr);
+        *pOutMappedData = resultAllocInfo.pMappedData;
+    }
+
+    return buffer;
+}
+
+void MemoryAllocator::DestroyBuffer(VkBuffer buffer, VmaAllocation allocation)
+{
+    auto f = bufferAllocInfos.find(allocation);
+
+    if (f == bufferAllocInfos.end())
+    {
+        assert(0);
+        return;
+    }
+
+    const BufferAllocInfo &info = f->second;
+    BufferClassCounters &counters = bufferCounters[(size_t)info.usageClass];
+
+    assert(counters.bufferCount > 0 && counters.usedSize >= info.bufferSize);
+    counters.bufferCount--;
+    counters.usedSize -= info.bufferSize;
+
+    if (info.dedicatedSize > 0)
+    {
+        assert(counters.dedicatedCount > 0 && counters.dedicatedSize >= info.dedicatedSize);
+        counters.dedicatedCount--;
+        counters.dedicatedSize -= info.dedicatedSize;
+    }
+
+    bufferAllocInfos.erase(f);
+    vmaDestroyBuffer(allocator, buffer, allocation);
+}
+
+VkDeviceMemory MemoryAllocator::GetBufferMemory(VmaAllocation allocation) const
+{
+    VmaAllocationInfo allocInfo = {};
+    vmaGetAllocationInfo(allocator, allocation, &allocInfo);
+
+    return allocInfo.deviceMemory;
+}
+
+void MemoryAllocator::GetBufferStats(RgBufferMemoryStats *pResult) const
+{
+    auto fill = [this] (BufferUsageClass usageClass, RgBufferMemoryClassStats *dst)
+    {
+        const BufferClassCounters &counters = bufferCounters[(size_t)usageClass];
+
+        VmaPoolStats poolStats = {};
+        vmaGetPoolStats(allocator, bufferPools[(size_t)usageClass], &poolStats);
+
+        dst->bufferCount = counters.bufferCount;
+        dst->deviceMemoryCount = static_cast<uint32_t>(poolStats.blockCount) + counters.dedicatedCount;
+        dst->usedSize = counters.usedSize;
+        dst->allocatedSize = poolStats.size + counters.dedicatedSize;
+    };
+
+    fill(BufferUsageClass::DEVICE_LOCAL, &pResult->deviceLocal);
+    fill(BufferUsageClass::ACCELERATION_STRUCTURE, &pResult->accelerationStructure);
+    fill(BufferUsageClass::STAGING, &pResult->staging);
+}
+
+void MemoryAllocator::GetDeviceLocalBudget(VkDeviceSize *pUsage, VkDeviceSize *pBudget) const
+{
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    vmaGetBudget(allocator, budgets);
+
+    const VkPhysicalDeviceMemoryProperties &memProps = physDevice->GetMemoryProperties();
+
+    *pUsage = 0;
+    *pBudget = 0;
+
+    for (uint32_t i = 0; i < memProps.memoryHeapCount; i++)
+    {
+        if (memProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        {
+            *pUsage += budgets[i].usage;
+            *pBudget += budgets[i].budget;
+        }
+    }
+}
+
+MemoryAllocator::BufferUsageClass MemoryAllocator::GetBufferUsageClass(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+{
+    if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        return BufferUsageClass::STAGING;
+    }
+
+    if (usage & VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR)
+    {
+        return BufferUsageClass::ACCELERATION_STRUCTURE;
+    }
+
+    return BufferUsageClass::DEVICE_LOCAL;
+}
+
 void MemoryAllocator::CreateTexturesStagingPool()
 {
     VkResult r;
@@ -180,8 +412,9 @@ void MemoryAllocator::CreateTexturesStagingPool()
     VK_CHECKERROR(r);
 
     VmaPoolCreateInfo poolInfo = {};
-    poolInfo.frameInUseCount = MAX_FRAMES_IN_FLIGHT;
+    poolInfo.frameInUseCount = frameCount;
     poolInfo.memoryTypeIndex = memTypeIndex;
+
     poolInfo.blockSize = ALLOCATOR_BLOCK_SIZE_STAGING_TEXTURES;
     // buddy algorithm as textures has commonly a size of power of 2
     poolInfo.flags = VMA_POOL_CREATE_BUDDY_ALGORITHM_BIT;
@@ -219,8 +452,9 @@ void MemoryAllocator::CreateTexturesFinalPool()
     VK_CHECKERROR(r);
 
     VmaPoolCreateInfo poolInfo = {};
-    poolInfo.frameInUseCount = MAX_FRAMES_IN_FLIGHT;
+    poolInfo.frameInUseCount = frameCount;
     poolInfo.memoryTypeIndex = memTypeIndex;
+
     poolInfo.blockSize = ALLOCATOR_BLOCK_SIZE_TEXTURES;
     // buddy algorithm as textures has commonly a size of power of 2
     poolInfo.flags = VMA_POOL_CREATE_BUDDY_ALGORITHM_BIT;
@@ -229,11 +463,83 @@ void MemoryAllocator::CreateTexturesFinalPool()
     VK_CHECKERROR(r);
 }
 
+void MemoryAllocator::CreateBufferPool(BufferUsageClass usageClass)
+{
+    VkResult r;
+
+    // Vma will create and destroy it for identifying the memory type index,
+    // so usage flags should cover all buffers of the class
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = 64;
+
+    VmaAllocationCreateInfo prototype = {};
+    prototype.flags = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT;
+
+    VmaPoolCreateInfo poolInfo = {};
+    poolInfo.frameInUseCount = frameCount;
+
+    switch (usageClass)
+    {
+        case BufferUsageClass::DEVICE_LOCAL:
+            bufferInfo.usage = 
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+            prototype.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            prototype.pUserData = const_cast<char *>("VMA Device local buffer pool prototype");
+            poolInfo.blockSize = ALLOCATOR_BLOCK_SIZE_BUFFERS;
+            break;
+
+        case BufferUsageClass::ACCELERATION_STRUCTURE:
+            bufferInfo.usage = 
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+            prototype.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            prototype.pUserData = const_cast<char *>("VMA Acceleration structure pool prototype");
+            poolInfo.blockSize = ALLOCATOR_BLOCK_SIZE_AS;
+            break;
+
+        case BufferUsageClass::STAGING:
+            bufferInfo.usage = 
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+            // same as the old HOST_VISIBLE | HOST_COHERENT requirement
+            prototype.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+            prototype.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            prototype.pUserData = const_cast<char *>("VMA Staging buffer pool prototype");
+            poolInfo.blockSize = ALLOCATOR_BLOCK_SIZE_STAGING_BUFFERS;
+            break;
+
+        default:
+            assert(0);
+            return;
+    }
+
+    uint32_t memTypeIndex;
+    r = vmaFindMemoryTypeIndexForBufferInfo(allocator, &bufferInfo, &prototype, &memTypeIndex);
+    VK_CHECKERROR(r);
+
+    poolInfo.memoryTypeIndex = memTypeIndex;
+
+    bufferPoolInfos[(size_t)usageClass] = { memTypeIndex, poolInfo.blockSize };
+
+    r = vmaCreatePool(allocator, &poolInfo, &bufferPools[(size_t)usageClass]);
+    VK_CHECKERROR(r);
+}
+
 VkDevice MemoryAllocator::GetDevice()
 {
     return device;
 }
 
+uint32_t MemoryAllocator::GetFrameCount() const
+{
+    return frameCount;
+}
+
 VkDeviceMemory MemoryAllocator::AllocDedicated(const VkMemoryRequirements &memReqs, VkMemoryPropertyFlags properties,
                                                AllocType allocType, const char *pDebugName) const
 {
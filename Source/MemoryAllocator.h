@@ -20,8 +20,11 @@
 
 #pragma once
 
+#include <array>
+
 #include "Common.h"
 #include "Containers.h"
+#include "RTGL1/RTGL1.h"
 #include "PhysicalDevice.h"
 #include "Vma/vk_mem_alloc.h"
 
@@ -38,11 +41,22 @@ public:
         WITH_ADDRESS_QUERY
     };
 
+    // Buffers of each class are suballocated from a separate pool
+    enum class BufferUsageClass
+    {
+        DEVICE_LOCAL,
+        ACCELERATION_STRUCTURE,
+        STAGING,
+        COUNT
+    };
+
 public:
     explicit MemoryAllocator(
         VkInstance instance,
         VkDevice device,
-        std::shared_ptr<PhysicalDevice> physDevice);
+        std::shared_ptr<PhysicalDevice> physDevice,
+        uint32_t frameCount,
+        bool useMemoryBudgetExtension);
     ~MemoryAllocator();
 
     MemoryAllocator(const MemoryAllocator &other) = delete;
@@ -51,6 +65,9 @@ public:
     MemoryAllocator &operator=(MemoryAllocator &&other) noexcept = delete;
 
     VkDevice GetDevice();
+    // Count of frame indices. Resources can be used by frames
+    // with other indices, while the current frame is recorded.
+    uint32_t GetFrameCount() const;
 
 
     // If addressQuery=true device address can be queried
@@ -58,6 +75,21 @@ public:
     VkDeviceMemory AllocDedicated(const VkMemoryRequirements2 &memReqs2, VkMemoryPropertyFlags properties, AllocType allocType, const char *pDebugName = nullptr) const;
     void FreeDedicated(VkDeviceMemory memory) const;
 
+
+    // Suballocate memory for the buffer from the pool of its usage class.
+    // Host visible buffers are persistently mapped, see pOutMappedData.
+    VkBuffer CreateBuffer(
+        const VkBufferCreateInfo *info, VkMemoryPropertyFlags properties, const char *pDebugName,
+        VmaAllocation *pOutAllocation, void **pOutMappedData);
+    void DestroyBuffer(VkBuffer buffer, VmaAllocation allocation);
+    VkDeviceMemory GetBufferMemory(VmaAllocation allocation) const;
+
+    void GetBufferStats(RgBufferMemoryStats *pResult) const;
+
+    // Sum of device local heaps: current usage by the process and the amount of memory it can use.
+    // If VK_EXT_memory_budget is not enabled, the values are estimated.
+    void GetDeviceLocalBudget(VkDeviceSize *pUsage, VkDeviceSize *pBudget) const;
+
     
     VkBuffer CreateStagingSrcTextureBuffer(
         const VkBufferCreateInfo *info, const char *pDebugName,
@@ -72,10 +104,14 @@ public:
 private:
     void CreateTexturesStagingPool();
     void CreateTexturesFinalPool();
+    void CreateBufferPool(BufferUsageClass usageClass);
+
+    static BufferUsageClass GetBufferUsageClass(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
 
 private:
     VkDevice device;
     std::shared_ptr<PhysicalDevice> physDevice;
+    uint32_t frameCount;
 
     VmaAllocator allocator;
 
@@ -85,6 +121,34 @@ private:
     // texture data will be copied from staging to this memory
     VmaPool texturesFinalPool;
 
+    struct BufferClassCounters
+    {
+        uint32_t bufferCount;
+        uint64_t usedSize;
+        // allocations that didn't fit into the pool's blocks
+        uint32_t dedicatedCount;
+        uint64_t dedicatedSize;
+    };
+
+    struct BufferPoolInfo
+    {
+        uint32_t memoryTypeIndex;
+        VkDeviceSize blockSize;
+    };
+
+    std::array<VmaPool, (size_t)BufferUsageClass::COUNT> bufferPools;
+    std::array<BufferPoolInfo, (size_t)BufferUsageClass::COUNT> bufferPoolInfos;
+    std::array<BufferClassCounters, (size_t)BufferUsageClass::COUNT> bufferCounters;
+    struct BufferAllocInfo
+    {
+        BufferUsageClass usageClass;
+        VkDeviceSize bufferSize;
+        // if not 0, then the allocation has its own VkDeviceMemory
+        VkDeviceSize dedicatedSize;
+    };
+
+    rgl::unordered_map<VmaAllocation, BufferAllocInfo> bufferAllocInfos;
+
     // maps for freeing corresponding allocations
     rgl::unordered_map<VkBuffer, VmaAllocation> bufAllocs;
     rgl::unordered_map<VkImage, VmaAllocation> imgAllocs;
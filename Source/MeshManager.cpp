@@ -0,0 +1,407 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MeshManager.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Generated/ShaderCommonC.h"
+#include "RgException.h"
+
+using namespace RTGL1;
+
+static uint32_t AlignUpBy3(uint32_t x)
+{
+    return ((x + 2) / 3) * 3;
+}
+
+MeshManager::MeshManager(VkDevice _device, std::shared_ptr<MemoryAllocator> _allocator, const VertexBufferProperties &_properties)
+    :
+    device(_device),
+    allocator(std::move(_allocator)),
+    properties(_properties),
+    lastMeshID(RG_NO_MESH)
+{
+    // attribute arrays of the pool go one after another, like in the vertex collectors' buffers
+    const VkDeviceSize vertexPoolSize = 
+        (VkDeviceSize)MAX_MESH_POOL_VERTEX_COUNT * (properties.positionStride + properties.normalStride + properties.texCoordStride);
+
+    const VkBufferUsageFlags usage = 
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | 
+        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+
+    vertexPool.Init(allocator, vertexPoolSize, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Mesh pool vertices buffer");
+    indexPool.Init(allocator, (VkDeviceSize)MAX_MESH_POOL_INDEX_COUNT * sizeof(uint32_t), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Mesh pool indices buffer");
+
+    freeVertexRanges.push_back({ 0, MAX_MESH_POOL_VERTEX_COUNT });
+    freeIndexRanges.push_back({ 0, MAX_MESH_POOL_INDEX_COUNT });
+}
+
+bool MeshManager::AllocateRange(std::vector<PoolRange> &freeRanges, uint32_t count, PoolRange *pResult)
+{
+    // first fit
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+    {
+        if (it->count >= count)
+        {
+            *pResult = { it->begin, count };
+
+            it->begin += count;
+            it->count -= count;
+
+            if (it->count == 0)
+            {
+                freeRanges.erase(it);
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void MeshManager::FreeRange(std::vector<PoolRange> &freeRanges, const PoolRange &range)
+{
+    if (range.count == 0)
+    {
+        return;
+    }
+
+    auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), range, 
+                                 [] (const PoolRange &a, const PoolRange &b) { return a.begin < b.begin; });
+
+    auto it = freeRanges.insert(next, range);
+
+    // merge with the next one
+    auto after = it + 1;
+    if (after != freeRanges.end() && it->begin + it->count == after->begin)
+    {
+        it->count += after->count;
+        freeRanges.erase(after);
+    }
+
+    // merge with the previous one
+    if (it != freeRanges.begin())
+    {
+        auto before = it - 1;
+
+        if (before->begin + before->count == it->begin)
+        {
+            before->count += it->count;
+            freeRanges.erase(it);
+        }
+    }
+}
+
+RgMesh MeshManager::CreateMesh(const RgMeshCreateInfo &info)
+{
+    assert(info.pVertexData != nullptr && info.vertexCount > 0);
+
+    const bool useIndices = info.pIndexData != nullptr && info.indexCount > 0;
+    const bool hasNormals = info.pNormalData != nullptr;
+    const bool hasJoints = info.pJointIndexData != nullptr && info.pJointWeightData != nullptr;
+
+
+    // aligned by 3 for per-triangle vertex attributes
+    PoolRange vertexRange = {};
+    PoolRange indexRange = {};
+
+    if (!AllocateRange(freeVertexRanges, AlignUpBy3(info.vertexCount), &vertexRange))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Mesh pool doesn't have enough space for " + std::to_string(info.vertexCount) + " vertices");
+    }
+
+    if (useIndices && !AllocateRange(freeIndexRanges, AlignUpBy3(info.indexCount), &indexRange))
+    {
+        FreeRange(freeVertexRanges, vertexRange);
+        throw RgException(RG_WRONG_ARGUMENT, "Mesh pool doesn't have enough space for " + std::to_string(info.indexCount) + " indices");
+    }
+
+
+    const VkDeviceSize positionsSize = (VkDeviceSize)info.vertexCount * properties.positionStride;
+    const VkDeviceSize normalsSize = (VkDeviceSize)info.vertexCount * properties.normalStride;
+    const VkDeviceSize texCoordsSize = (VkDeviceSize)info.vertexCount * properties.texCoordStride;
+    const VkDeviceSize indicesSize = useIndices ? (VkDeviceSize)info.indexCount * sizeof(uint32_t) : 0;
+    const VkDeviceSize jointIndicesSize = hasJoints ? (VkDeviceSize)info.vertexCount * 4 * sizeof(uint8_t) : 0;
+    const VkDeviceSize jointWeightsSize = hasJoints ? (VkDeviceSize)info.vertexCount * 4 * sizeof(float) : 0;
+
+
+    ResidentMeshData data = {};
+    data.vertexCount = info.vertexCount;
+    data.indexCount = useIndices ? info.indexCount : 0;
+    data.baseVertexIndex = vertexRange.begin;
+    data.baseIndexIndex = useIndices ? indexRange.begin : UINT32_MAX;
+
+    data.vertexBuffer = vertexPool.GetBuffer();
+    data.indexBuffer = indexPool.GetBuffer();
+
+    const VkDeviceSize poolNormals = (VkDeviceSize)MAX_MESH_POOL_VERTEX_COUNT * properties.positionStride;
+    const VkDeviceSize poolTexCoords = poolNormals + (VkDeviceSize)MAX_MESH_POOL_VERTEX_COUNT * properties.normalStride;
+
+    data.positions = (VkDeviceSize)vertexRange.begin * properties.positionStride;
+    data.normals = hasNormals ? poolNormals + (VkDeviceSize)vertexRange.begin * properties.normalStride : ResidentMeshData::NO_ATTRIBUTE;
+    data.texCoords = poolTexCoords + (VkDeviceSize)vertexRange.begin * properties.texCoordStride;
+    data.indices = useIndices ? (VkDeviceSize)indexRange.begin * sizeof(uint32_t) : ResidentMeshData::NO_ATTRIBUTE;
+
+    data.jointBuffer = VK_NULL_HANDLE;
+    data.jointIndices = ResidentMeshData::NO_ATTRIBUTE;
+    data.jointWeights = ResidentMeshData::NO_ATTRIBUTE;
+
+
+    // staging: positions, normals, tex coords, indices, joint indices, joint weights
+    const VkDeviceSize stPositions = 0;
+    const VkDeviceSize stNormals = stPositions + positionsSize;
+    const VkDeviceSize stTexCoords = stNormals + (hasNormals ? normalsSize : 0);
+    const VkDeviceSize stIndices = stTexCoords + texCoordsSize;
+    const VkDeviceSize stJointIndices = stIndices + indicesSize;
+    const VkDeviceSize stJointWeights = stJointIndices + jointIndicesSize;
+    const VkDeviceSize stagingSize = stJointWeights + jointWeightsSize;
+
+    auto staging = std::make_shared<Buffer>();
+    staging->Init(
+        allocator, stagingSize, 
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        "Mesh staging buffer");
+
+    auto *mapped = static_cast<uint8_t *>(staging->Map());
+    {
+        memcpy(mapped + stPositions, info.pVertexData, positionsSize);
+
+        if (hasNormals)
+        {
+            memcpy(mapped + stNormals, info.pNormalData, normalsSize);
+        }
+
+        // pool is read by shaders directly, so tex coords must be defined
+        if (info.pTexCoordData != nullptr)
+        {
+            memcpy(mapped + stTexCoords, info.pTexCoordData, texCoordsSize);
+        }
+        else
+        {
+            memset(mapped + stTexCoords, 0, texCoordsSize);
+        }
+
+        if (useIndices)
+        {
+            memcpy(mapped + stIndices, info.pIndexData, indicesSize);
+        }
+
+        if (hasJoints)
+        {
+            memcpy(mapped + stJointIndices, info.pJointIndexData, jointIndicesSize);
+            memcpy(mapped + stJointWeights, info.pJointWeightData, jointWeightsSize);
+        }
+    }
+    staging->Unmap();
+
+
+    PendingUpload upload = {};
+    upload.vertexCopies[upload.vertexCopyCount++] = { stPositions, data.positions, positionsSize };
+
+    if (hasNormals)
+    {
+        upload.vertexCopies[upload.vertexCopyCount++] = { stNormals, data.normals, normalsSize };
+    }
+
+    upload.vertexCopies[upload.vertexCopyCount++] = { stTexCoords, data.texCoords, texCoordsSize };
+
+    if (useIndices)
+    {
+        upload.indexCopy = { stIndices, data.indices, indicesSize };
+    }
+
+
+    // joint data is only read for skinning, so it's in a separate buffer
+    std::shared_ptr<Buffer> jointBuffer;
+
+    if (hasJoints)
+    {
+        jointBuffer = std::make_shared<Buffer>();
+        jointBuffer->Init(
+            allocator, jointIndicesSize + jointWeightsSize,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            "Mesh joints buffer");
+
+        data.jointBuffer = jointBuffer->GetBuffer();
+        data.jointIndices = 0;
+        data.jointWeights = jointIndicesSize;
+
+        upload.jointCopy = { stJointIndices, 0, jointIndicesSize + jointWeightsSize };
+        upload.jointBuffer = jointBuffer->GetBuffer();
+    }
+
+    upload.staging = std::move(staging);
+    pendingUploads.push_back(std::move(upload));
+
+
+    lastMeshID++;
+
+    // rigid instances are traced through the mesh's BLAS,
+    // but if normals are generated, each instance has its own
+    std::unique_ptr<BLASComponent> blas;
+
+    if (hasNormals)
+    {
+        blas = std::make_unique<BLASComponent>(device, "Mesh BLAS");
+        meshesToBuild.push_back(lastMeshID);
+    }
+
+    data.blas = blas.get();
+    data.isBlasBuilt = false;
+
+    meshes[lastMeshID] = { data, vertexRange, indexRange, std::move(jointBuffer), std::move(blas) };
+
+    return lastMeshID;
+}
+
+void MeshManager::DestroyMesh(uint32_t frameIndex, RgMesh mesh)
+{
+    auto f = meshes.find(mesh);
+
+    if (f == meshes.end())
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Mesh with ID=" + std::to_string(mesh) + " doesn't exist");
+    }
+
+    // instances can be still in use by the frames in flight
+    if (f->second.jointBuffer)
+    {
+        buffersToDestroy[frameIndex].push_back(std::move(f->second.jointBuffer));
+    }
+
+    if (f->second.blas)
+    {
+        blasToDestroy[frameIndex].push_back(std::move(f->second.blas));
+    }
+
+    rangesToFree[frameIndex].push_back({ f->second.vertexRange, f->second.indexRange });
+
+    meshes.erase(f);
+}
+
+const ResidentMeshData *MeshManager::GetMesh(RgMesh mesh) const
+{
+    auto f = meshes.find(mesh);
+
+    return f != meshes.end() ? &f->second.data : nullptr;
+}
+
+void MeshManager::PrepareForFrame(uint32_t frameIndex)
+{
+    buffersToDestroy[frameIndex].clear();
+    blasToDestroy[frameIndex].clear();
+
+    for (const RangesToFree &r : rangesToFree[frameIndex])
+    {
+        FreeRange(freeVertexRanges, r.vertexRange);
+        FreeRange(freeIndexRanges, r.indexRange);
+    }
+
+    rangesToFree[frameIndex].clear();
+}
+
+void MeshManager::UploadPending(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (pendingUploads.empty())
+    {
+        return;
+    }
+
+    for (auto &p : pendingUploads)
+    {
+        vkCmdCopyBuffer(cmd, p.staging->GetBuffer(), vertexPool.GetBuffer(), p.vertexCopyCount, p.vertexCopies);
+
+        if (p.indexCopy.size > 0)
+        {
+            vkCmdCopyBuffer(cmd, p.staging->GetBuffer(), indexPool.GetBuffer(), 1, &p.indexCopy);
+        }
+
+        if (p.jointCopy.size > 0)
+        {
+            vkCmdCopyBuffer(cmd, p.staging->GetBuffer(), p.jointBuffer, 1, &p.jointCopy);
+        }
+
+        buffersToDestroy[frameIndex].push_back(std::move(p.staging));
+    }
+
+    pendingUploads.clear();
+
+
+    // meshes are read by copying to the vertex collectors, by building BLAS and in shaders
+    VkMemoryBarrier br = {};
+    br.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    br.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    br.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | 
+                                        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &br,
+        0, nullptr,
+        0, nullptr);
+}
+
+const std::vector<RgMesh> &MeshManager::GetMeshesToBuild() const
+{
+    return meshesToBuild;
+}
+
+void MeshManager::OnMeshesBuilt()
+{
+    for (RgMesh m : meshesToBuild)
+    {
+        auto f = meshes.find(m);
+
+        // could be destroyed before the build
+        if (f != meshes.end())
+        {
+            f->second.data.isBlasBuilt = true;
+        }
+    }
+
+    meshesToBuild.clear();
+}
+
+VkBuffer MeshManager::GetVertexBuffer() const
+{
+    return vertexPool.GetBuffer();
+}
+
+VkBuffer MeshManager::GetIndexBuffer() const
+{
+    return indexPool.GetBuffer();
+}
+
+VkDeviceAddress MeshManager::GetVertexBufferAddress() const
+{
+    return vertexPool.GetAddress();
+}
+
+VkDeviceAddress MeshManager::GetIndexBufferAddress() const
+{
+    return indexPool.GetAddress();
+}
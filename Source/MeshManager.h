@@ -0,0 +1,165 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "ASComponent.h"
+#include "Buffer.h"
+#include "Common.h"
+#include "Containers.h"
+#include "VertexBufferProperties.h"
+#include "RTGL1/RTGL1.h"
+
+namespace RTGL1
+{
+
+// Vertex data of a resident mesh in the mesh pool,
+// strides are the same as in the vertex collectors' buffers.
+struct ResidentMeshData
+{
+    constexpr static VkDeviceSize NO_ATTRIBUTE = UINT64_MAX;
+
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    // first vertex and index of the mesh in the pool, as they're referenced by shaders
+    uint32_t baseVertexIndex;
+    uint32_t baseIndexIndex;
+
+    // byte offsets of the attribute arrays in the pool buffers;
+    // tex coords are zeros, if they weren't specified on creation
+    VkBuffer vertexBuffer;
+    VkBuffer indexBuffer;
+    VkDeviceSize positions;
+    VkDeviceSize normals;
+    VkDeviceSize texCoords;
+    VkDeviceSize indices;
+
+    // 4 uint8 joint indices and 4 float weights per vertex, in a separate buffer
+    VkBuffer jointBuffer;
+    VkDeviceSize jointIndices;
+    VkDeviceSize jointWeights;
+
+    // BLAS in mesh space, rigid instances reference it from TLAS with their own transforms;
+    // null, if the mesh doesn't have normals, as they're generated for each instance
+    BLASComponent *blas;
+    bool isBlasBuilt;
+};
+
+// Meshes, which vertex data is uploaded once to a device-local pool.
+// Rigid instances are traced through the mesh's BLAS and read the pool directly,
+// skinned instances and instances of meshes without normals are copied
+// to the dynamic vertex buffer on GPU each frame.
+class MeshManager
+{
+public:
+    explicit MeshManager(
+        VkDevice device,
+        std::shared_ptr<MemoryAllocator> allocator,
+        const VertexBufferProperties &properties);
+    ~MeshManager() = default;
+
+    MeshManager(const MeshManager &other) = delete;
+    MeshManager(MeshManager &&other) noexcept = delete;
+    MeshManager &operator=(const MeshManager &other) = delete;
+    MeshManager &operator=(MeshManager &&other) noexcept = delete;
+
+    RgMesh CreateMesh(const RgMeshCreateInfo &info);
+    void DestroyMesh(uint32_t frameIndex, RgMesh mesh);
+    // Null, if mesh doesn't exist
+    const ResidentMeshData *GetMesh(RgMesh mesh) const;
+
+    // Destroy buffers and BLAS, and free pool ranges that are not in use anymore
+    void PrepareForFrame(uint32_t frameIndex);
+    // Copy data of the created meshes from staging, and set a barrier
+    // for copying it to the vertex collectors, building BLAS and reading in shaders
+    void UploadPending(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    // Meshes, which BLAS must be built after UploadPending
+    const std::vector<RgMesh> &GetMeshesToBuild() const;
+    void OnMeshesBuilt();
+
+    VkBuffer GetVertexBuffer() const;
+    VkBuffer GetIndexBuffer() const;
+    VkDeviceAddress GetVertexBufferAddress() const;
+    VkDeviceAddress GetIndexBufferAddress() const;
+
+private:
+    // Range of vertices or indices [begin, begin + count) in the pool
+    struct PoolRange
+    {
+        uint32_t begin;
+        uint32_t count;
+    };
+
+    struct Mesh
+    {
+        ResidentMeshData data;
+        PoolRange vertexRange;
+        PoolRange indexRange;
+        std::shared_ptr<Buffer> jointBuffer;
+        std::unique_ptr<BLASComponent> blas;
+    };
+
+    struct PendingUpload
+    {
+        std::shared_ptr<Buffer> staging;
+        VkBufferCopy vertexCopies[3];
+        uint32_t vertexCopyCount;
+        VkBufferCopy indexCopy;
+        VkBufferCopy jointCopy;
+        VkBuffer jointBuffer;
+    };
+
+    struct RangesToFree
+    {
+        PoolRange vertexRange;
+        PoolRange indexRange;
+    };
+
+private:
+    static bool AllocateRange(std::vector<PoolRange> &freeRanges, uint32_t count, PoolRange *pResult);
+    static void FreeRange(std::vector<PoolRange> &freeRanges, const PoolRange &range);
+
+private:
+    VkDevice device;
+    std::shared_ptr<MemoryAllocator> allocator;
+    VertexBufferProperties properties;
+
+    Buffer vertexPool;
+    Buffer indexPool;
+    // sorted by begin, adjacent ranges are merged
+    std::vector<PoolRange> freeVertexRanges;
+    std::vector<PoolRange> freeIndexRanges;
+
+    rgl::unordered_map<RgMesh, Mesh> meshes;
+    RgMesh lastMeshID;
+
+    std::vector<PendingUpload> pendingUploads;
+    std::vector<RgMesh> meshesToBuild;
+
+    // resources that can be still in use by the frame with that index
+    std::vector<std::shared_ptr<Buffer>> buffersToDestroy[MAX_FRAMES_IN_FLIGHT];
+    std::vector<std::unique_ptr<BLASComponent>> blasToDestroy[MAX_FRAMES_IN_FLIGHT];
+    std::vector<RangesToFree> rangesToFree[MAX_FRAMES_IN_FLIGHT];
+};
+
+}
@@ -21,6 +21,7 @@
 #include "PathTracer.h"
 #include "Generated/ShaderCommonC.h"
 #include "CmdLabel.h"
+#include "Utils.h"
 
 using namespace RTGL1;
 
@@ -156,6 +157,7 @@ void PathTracer::TraceDirectllumination(VkCommandBuffer cmd, uint32_t frameIndex
 
 void PathTracer::TraceIndirectllumination(VkCommandBuffer cmd, uint32_t frameIndex, 
                                           uint32_t width, uint32_t height,
+                                          const std::shared_ptr<const GlobalUniform> &uniform,
                                           const std::shared_ptr<Framebuffers> &framebuffers)
 {
     CmdLabel label(cmd, "Indirect illumination");
@@ -172,8 +174,48 @@ void PathTracer::TraceIndirectllumination(VkCommandBuffer cmd, uint32_t frameInd
     VkStridedDeviceAddressRegionKHR raygenEntry, missEntry, hitEntry, callableEntry;
     rtPipeline->GetEntries(SBT_INDEX_RAYGEN_INDIRECT, raygenEntry, missEntry, hitEntry, callableEntry);
 
+    // launch only for the pixels of a pattern, see getIndirectPatternPix
+    const uint32_t mode = uniform->GetData()->indirectIlluminationMode;
+
+    uint32_t patternWidth  = width;
+    uint32_t patternHeight = height;
+
+    switch (mode)
+    {
+        case INDIRECT_ILLUMINATION_MODE_CHECKERBOARD:
+            patternWidth  = (width + 1) / 2;
+            break;
+        case INDIRECT_ILLUMINATION_MODE_HALF:
+            patternWidth  = (width + 1) / 2;
+            patternHeight = (height + 1) / 2;
+            break;
+        default:
+            break;
+    }
+
+    uint32_t isGradientPass = 0;
+    vkCmdPushConstants(cmd, rtPipeline->GetLayout(), VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+                       0, sizeof(isGradientPass), &isGradientPass);
+
     svkCmdTraceRaysKHR(
         cmd,
         &raygenEntry, &missEntry, &hitEntry, &callableEntry,
-        width, height, 1);
+        patternWidth, patternHeight, 1);
+
+#if GRADIENT_ESTIMATION_ENABLED
+    if (mode != INDIRECT_ILLUMINATION_MODE_FULL)
+    {
+        // gradient samples must always be traced, even if they're not in the pattern
+        isGradientPass = 1;
+        vkCmdPushConstants(cmd, rtPipeline->GetLayout(), VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+                           0, sizeof(isGradientPass), &isGradientPass);
+
+        svkCmdTraceRaysKHR(
+            cmd,
+            &raygenEntry, &missEntry, &hitEntry, &callableEntry,
+            Utils::GetWorkGroupCount(width, COMPUTE_ASVGF_STRATA_SIZE), 
+            Utils::GetWorkGroupCount(height, COMPUTE_ASVGF_STRATA_SIZE), 
+            1);
+    }
+#endif
 }
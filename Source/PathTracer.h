@@ -64,9 +64,12 @@ public:
         uint32_t width, uint32_t height,
         const std::shared_ptr<Framebuffers> &framebuffers);
 
+    // If GlobalUniform's indirect illumination mode is not full,
+    // only a pattern of pixels is traced, Denoiser::ReconstructIndirect must be called after
     void TraceIndirectllumination(
         VkCommandBuffer cmd, uint32_t frameIndex,
         uint32_t width, uint32_t height,
+        const std::shared_ptr<const GlobalUniform> &uniform,
         const std::shared_ptr<Framebuffers> &framebuffers);
 
 private:
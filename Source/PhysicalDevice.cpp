@@ -28,7 +28,7 @@
 using namespace RTGL1;
 
 PhysicalDevice::PhysicalDevice(VkInstance instance)
-    : physDevice(VK_NULL_HANDLE), memoryProperties{}, rtPipelineProperties{}
+    : physDevice(VK_NULL_HANDLE), memoryProperties{}, rtPipelineProperties{}, asProperties{}, timestampPeriod(0.0f)
 {
     VkResult r;
 
@@ -59,7 +59,10 @@ PhysicalDevice::PhysicalDevice(VkInstance instance)
         {
             physDevice = p;
 
+            asProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+            
             rtPipelineProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR;
+            rtPipelineProperties.pNext = &asProperties;
             VkPhysicalDeviceProperties2 deviceProp2 = {};
             deviceProp2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
             deviceProp2.pNext = &rtPipelineProperties;
@@ -67,6 +70,9 @@ PhysicalDevice::PhysicalDevice(VkInstance instance)
             vkGetPhysicalDeviceProperties2(physDevice, &deviceProp2);
             vkGetPhysicalDeviceMemoryProperties(physDevice, &memoryProperties);
 
+            const VkPhysicalDeviceLimits &limits = deviceProp2.properties.limits;
+            timestampPeriod = limits.timestampComputeAndGraphics ? limits.timestampPeriod : 0.0f;
+
             break;
         }
     }
@@ -131,3 +137,34 @@ const VkPhysicalDeviceRayTracingPipelinePropertiesKHR &PhysicalDevice::GetRTPipe
 {
     return rtPipelineProperties;
 }
+
+const VkPhysicalDeviceAccelerationStructurePropertiesKHR &PhysicalDevice::GetASProperties() const
+{
+    return asProperties;
+}
+
+float PhysicalDevice::GetTimestampPeriod() const
+{
+    return timestampPeriod;
+}
+
+bool PhysicalDevice::IsExtensionSupported(const char *pExtensionName) const
+{
+    uint32_t count = 0;
+    VkResult r = vkEnumerateDeviceExtensionProperties(physDevice, nullptr, &count, nullptr);
+    VK_CHECKERROR(r);
+
+    std::vector<VkExtensionProperties> extensions(count);
+    r = vkEnumerateDeviceExtensionProperties(physDevice, nullptr, &count, extensions.data());
+    VK_CHECKERROR(r);
+
+    for (const auto &e : extensions)
+    {
+        if (strcmp(e.extensionName, pExtensionName) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -40,12 +40,18 @@ public:
     uint32_t GetMemoryTypeIndex(uint32_t memoryTypeBits, VkFlags requirementsMask) const;
     const VkPhysicalDeviceMemoryProperties &GetMemoryProperties() const;
     const VkPhysicalDeviceRayTracingPipelinePropertiesKHR &GetRTPipelineProperties() const;
+    const VkPhysicalDeviceAccelerationStructurePropertiesKHR &GetASProperties() const;
+    // Nanoseconds per timestamp tick. Zero, if timestamps are not supported in all graphics and compute queues.
+    float GetTimestampPeriod() const;
+    bool IsExtensionSupported(const char *pExtensionName) const;
 
 private:
     // selected physical device
     VkPhysicalDevice physDevice;
     VkPhysicalDeviceMemoryProperties memoryProperties;
     VkPhysicalDeviceRayTracingPipelinePropertiesKHR rtPipelineProperties;
+    VkPhysicalDeviceAccelerationStructurePropertiesKHR asProperties;
+    float timestampPeriod;
 };
 
 }
\ No newline at end of file
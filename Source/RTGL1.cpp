@@ -142,6 +142,47 @@ RgResult rgUpdateGeometryTexCoords(RgInstance rgInstance, const RgUpdateTexCoord
     CATCH_OR_RETURN;
 }
 
+RgResult rgCreateMesh(RgInstance rgInstance, const RgMeshCreateInfo *pCreateInfo, RgMesh *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->CreateMesh(pCreateInfo, pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgDestroyMesh(RgInstance rgInstance, RgMesh mesh)
+{
+    try
+    {
+        GetDevice(rgInstance)->DestroyMesh(mesh);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgUploadMeshInstance(RgInstance rgInstance, RgMesh mesh, const RgGeometryUploadInfo *pUploadInfo)
+{
+    try
+    {
+        GetDevice(rgInstance)->UploadMeshInstance(mesh, pUploadInfo);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgUploadSkinnedMeshInstance(RgInstance rgInstance, RgMesh mesh, const RgGeometryUploadInfo *pUploadInfo, const RgMeshSkinningInfo *pSkinningInfo)
+{
+    try
+    {
+        if (pSkinningInfo == nullptr)
+        {
+            throw RTGL1::RgException(RG_WRONG_ARGUMENT, "Argument is null");
+        }
+
+        GetDevice(rgInstance)->UploadMeshInstance(mesh, pUploadInfo, pSkinningInfo);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgUploadRasterizedGeometry(RgInstance rgInstance, const RgRasterizedGeometryUploadInfo *pUploadInfo, 
                                     const float *pViewProjection, const RgViewport *pViewport)
 {
@@ -170,6 +211,24 @@ RgResult rgUploadDecal(RgInstance rgInstance, const RgDecalUploadInfo *pUploadIn
     CATCH_OR_RETURN;
 }
 
+RgResult rgUploadStaticDecal(RgInstance rgInstance, const RgStaticDecalUploadInfo *pUploadInfo)
+{
+    try
+    {
+        GetDevice(rgInstance)->UploadStaticDecal(pUploadInfo);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgRemoveStaticDecal(RgInstance rgInstance, uint64_t uniqueID)
+{
+    try
+    {
+        GetDevice(rgInstance)->RemoveStaticDecal(uniqueID);
+    }
+    CATCH_OR_RETURN;
+}
+
 
 RgResult rgSubmitStaticGeometries(RgInstance rgInstance)
 {
@@ -225,6 +284,24 @@ RgResult rgUploadPolygonalLight(RgInstance rgInstance, const RgPolygonalLightUpl
     CATCH_OR_RETURN;
 }
 
+RgResult rgUploadSphericalLights(RgInstance rgInstance, const RgSphericalLightUploadInfo *pLightInfos, uint32_t lightCount)
+{
+    try
+    {
+        GetDevice(rgInstance)->UploadLights(pLightInfos, lightCount);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgUploadPolygonalLights(RgInstance rgInstance, const RgPolygonalLightUploadInfo *pLightInfos, uint32_t lightCount)
+{
+    try
+    {
+        GetDevice(rgInstance)->UploadLights(pLightInfos, lightCount);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgCreateStaticMaterial(RgInstance rgInstance, const RgStaticMaterialCreateInfo *pCreateInfo,
                                RgMaterial *pResult)
 {
@@ -331,6 +408,33 @@ RgResult rgIsRenderUpscaleTechniqueAvailable(RgInstance rgInstance, RgRenderUpsc
     CATCH_OR_RETURN;
 }
 
+RgResult rgGetGeometryBuffersStats(RgInstance rgInstance, RgGeometryBuffersStats *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetGeometryBuffersStats(pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgGetFramebuffersStats(RgInstance rgInstance, RgFramebuffersStats *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetFramebuffersStats(pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgGetBufferMemoryStats(RgInstance rgInstance, RgBufferMemoryStats *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetBufferMemoryStats(pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgSetPotentialVisibility(RgInstance rgInstance, uint32_t sectorID_A, uint32_t sectorID_B)
 {
     try
@@ -43,8 +43,6 @@ RTGL1::RasterPass::RasterPass(
     device(_device),
     rasterRenderPass(VK_NULL_HANDLE),
     rasterSkyRenderPass(VK_NULL_HANDLE),
-    rasterWidth(0),
-    rasterHeight(0),
     rasterFramebuffers{},
     rasterSkyFramebuffers{},
     depthImages{},
@@ -74,7 +72,11 @@ RTGL1::RasterPass::~RasterPass()
 {
     vkDestroyRenderPass(device, rasterRenderPass, nullptr);
     vkDestroyRenderPass(device, rasterSkyRenderPass, nullptr);
-    DestroyFramebuffers();
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        DestroyFramebuffers(i);
+    }
 }
 
 void RTGL1::RasterPass::PrepareForFinal(
@@ -82,91 +84,79 @@ void RTGL1::RasterPass::PrepareForFinal(
     const std::shared_ptr<Framebuffers> &storageFramebuffers, 
     bool werePrimaryTraced)
 {
-    assert(rasterWidth > 0 && rasterHeight > 0);
+    assert(rasterFramebuffers[frameIndex] != VK_NULL_HANDLE);
+
+    // framebuffers can be larger than the area that is rendered to
+    const ResolutionState &r = storageFramebuffers->GetCurrentResolution();
 
     // firstly, copy data from storage buffer to depth buffer,
     // and only after getting correct depth buffer, draw the geometry
     // if no primary rays were traced, just clear depth buffer without copying
-    depthCopying->Process(cmd, frameIndex, storageFramebuffers, rasterWidth, rasterHeight, !werePrimaryTraced);
+    depthCopying->Process(cmd, frameIndex, storageFramebuffers, r.renderWidth, r.renderHeight, !werePrimaryTraced);
 }
 
-void RTGL1::RasterPass::CreateFramebuffers(uint32_t renderWidth, uint32_t renderHeight,
+void RTGL1::RasterPass::CreateFramebuffers(VkCommandBuffer cmd, uint32_t frameIndex,
+                                           uint32_t renderWidth, uint32_t renderHeight,
                                            const std::shared_ptr<Framebuffers> &storageFramebuffers,
-                                           const std::shared_ptr<MemoryAllocator> &allocator,
-                                           const std::shared_ptr<CommandBufferManager> &cmdManager)
+                                           const std::shared_ptr<MemoryAllocator> &allocator)
 {
-    CreateDepthBuffers(renderWidth, renderHeight, allocator, cmdManager);
+    CreateDepthBuffer(cmd, frameIndex, renderWidth, renderHeight, allocator);
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        assert(rasterFramebuffers[i] == VK_NULL_HANDLE);
-        assert(rasterSkyFramebuffers[i] == VK_NULL_HANDLE);
+    assert(rasterFramebuffers[frameIndex] == VK_NULL_HANDLE);
+    assert(rasterSkyFramebuffers[frameIndex] == VK_NULL_HANDLE);
 
-        VkFramebufferCreateInfo fbInfo = {};
-        fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        fbInfo.width = renderWidth;
-        fbInfo.height = renderHeight;
-        fbInfo.layers = 1;
+    VkFramebufferCreateInfo fbInfo = {};
+    fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbInfo.width = renderWidth;
+    fbInfo.height = renderHeight;
+    fbInfo.layers = 1;
 
-        VkImageView attchs[] =
-        {
-            VK_NULL_HANDLE,
-            depthViews[i]
-        };
+    VkImageView attchs[] =
+    {
+        VK_NULL_HANDLE,
+        depthViews[frameIndex]
+    };
 
-        fbInfo.attachmentCount = std::size(attchs);
-        fbInfo.pAttachments = attchs;
+    fbInfo.attachmentCount = std::size(attchs);
+    fbInfo.pAttachments = attchs;
 
-        {
-            fbInfo.renderPass = rasterRenderPass;
+    {
+        fbInfo.renderPass = rasterRenderPass;
 
-            attchs[0] = storageFramebuffers->GetImageView(FB_IMAGE_INDEX_FINAL, i);
+        attchs[0] = storageFramebuffers->GetImageView(FB_IMAGE_INDEX_FINAL, frameIndex);
 
-            VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &rasterFramebuffers[i]);
-            VK_CHECKERROR(r);
+        VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &rasterFramebuffers[frameIndex]);
+        VK_CHECKERROR(r);
 
-            SET_DEBUG_NAME(device, rasterFramebuffers[i], VK_OBJECT_TYPE_FRAMEBUFFER, "Rasterizer raster framebuffer");
-        }
+        SET_DEBUG_NAME(device, rasterFramebuffers[frameIndex], VK_OBJECT_TYPE_FRAMEBUFFER, "Rasterizer raster framebuffer");
+    }
 
-        {
-            fbInfo.renderPass = rasterSkyRenderPass;
+    {
+        fbInfo.renderPass = rasterSkyRenderPass;
 
-            attchs[0] = storageFramebuffers->GetImageView(FB_IMAGE_INDEX_ALBEDO, i);
+        attchs[0] = storageFramebuffers->GetImageView(FB_IMAGE_INDEX_ALBEDO, frameIndex);
 
-            VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &rasterSkyFramebuffers[i]);
-            VK_CHECKERROR(r);
+        VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &rasterSkyFramebuffers[frameIndex]);
+        VK_CHECKERROR(r);
 
-            SET_DEBUG_NAME(device, rasterSkyFramebuffers[i], VK_OBJECT_TYPE_FRAMEBUFFER, "Rasterizer raster sky framebuffer");
-        }
+        SET_DEBUG_NAME(device, rasterSkyFramebuffers[frameIndex], VK_OBJECT_TYPE_FRAMEBUFFER, "Rasterizer raster sky framebuffer");
     }
 
-    depthCopying->CreateFramebuffers(depthViews, renderWidth, renderHeight);
-
-    this->rasterWidth = renderWidth;
-    this->rasterHeight = renderHeight;
+    depthCopying->CreateFramebuffer(frameIndex, depthViews[frameIndex], renderWidth, renderHeight);
 }
 
-void RTGL1::RasterPass::DestroyFramebuffers()
+void RTGL1::RasterPass::DestroyFramebuffers(uint32_t frameIndex)
 {
-    depthCopying->DestroyFramebuffers();
+    depthCopying->DestroyFramebuffer(frameIndex);
 
-    DestroyDepthBuffers();
+    DestroyDepthBuffer(frameIndex);
 
-    for (VkFramebuffer &fb : rasterFramebuffers)
+    for (VkFramebuffer *fb : { &rasterFramebuffers[frameIndex], &rasterSkyFramebuffers[frameIndex] })
     {
-        if (fb != VK_NULL_HANDLE)
+        if (*fb != VK_NULL_HANDLE)
         {
-            vkDestroyFramebuffer(device, fb, nullptr);
-            fb = VK_NULL_HANDLE;
-        }
-    }
-
-    for (VkFramebuffer &fb : rasterSkyFramebuffers)
-    {
-        if (fb != VK_NULL_HANDLE)
-        {
-            vkDestroyFramebuffer(device, fb, nullptr);
-            fb = VK_NULL_HANDLE;
+            vkDestroyFramebuffer(device, *fb, nullptr);
+            *fb = VK_NULL_HANDLE;
         }
     }
 }
@@ -191,16 +181,6 @@ const std::shared_ptr<RTGL1::RasterizerPipelines> &RTGL1::RasterPass::GetSkyRast
     return rasterSkyPipelines;
 }
 
-uint32_t RTGL1::RasterPass::GetRasterWidth() const
-{
-    return rasterWidth;
-}
-
-uint32_t RTGL1::RasterPass::GetRasterHeight() const
-{
-    return rasterHeight;
-}
-
 VkFramebuffer RTGL1::RasterPass::GetFramebuffer(uint32_t frameIndex) const
 {
     return rasterFramebuffers[frameIndex];
@@ -213,8 +193,8 @@ VkFramebuffer RTGL1::RasterPass::GetSkyFramebuffer(uint32_t frameIndex) const
 
 void RTGL1::RasterPass::OnShaderReload(const ShaderManager *shaderManager)
 {
-    rasterPipelines->Clear();
-    rasterSkyPipelines->Clear();
+    rasterPipelines->Clear(shaderManager);
+    rasterSkyPipelines->Clear(shaderManager);
 
     rasterPipelines->SetShaders(shaderManager, VERT_SHADER, FRAG_SHADER);
     rasterSkyPipelines->SetShaders(shaderManager, VERT_SHADER, FRAG_SHADER);
@@ -311,117 +291,106 @@ void RTGL1::RasterPass::CreateRasterRenderPass(VkFormat finalImageFormat, VkForm
     }
 }
 
-void RTGL1::RasterPass::CreateDepthBuffers(uint32_t width, uint32_t height,
-                                           const std::shared_ptr<MemoryAllocator> &allocator, 
-                                           const std::shared_ptr<CommandBufferManager> &cmdManager)
+void RTGL1::RasterPass::CreateDepthBuffer(VkCommandBuffer cmd, uint32_t frameIndex,
+                                          uint32_t width, uint32_t height,
+                                          const std::shared_ptr<MemoryAllocator> &allocator)
 {
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    assert(depthImages[frameIndex] == VK_NULL_HANDLE);
+    assert(depthViews[frameIndex] == VK_NULL_HANDLE);
+    assert(depthMemory[frameIndex] == VK_NULL_HANDLE);
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.flags = 0;
+    imageInfo.format = DEPTH_FORMAT;
+    imageInfo.extent = { width, height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkResult r = vkCreateImage(device, &imageInfo, nullptr, &depthImages[frameIndex]);
+    VK_CHECKERROR(r);
+    SET_DEBUG_NAME(device, depthImages[frameIndex], VK_OBJECT_TYPE_IMAGE, "Rasterizer raster pass depth image" );
+
+
+    // allocate dedicated memory
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, depthImages[frameIndex], &memReqs);
+
+    depthMemory[frameIndex] = allocator->AllocDedicated(memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryAllocator::AllocType::DEFAULT, "Rasterizer raster pass depth memory");
+
+    if (depthMemory[frameIndex] == VK_NULL_HANDLE)
     {
-        assert(depthImages[i] == VK_NULL_HANDLE);
-        assert(depthViews[i] == VK_NULL_HANDLE);
-        assert(depthMemory[i] == VK_NULL_HANDLE);
-
-        VkImageCreateInfo imageInfo = {};
-        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        imageInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageInfo.flags = 0;
-        imageInfo.format = DEPTH_FORMAT;
-        imageInfo.extent = { width, height, 1 };
-        imageInfo.mipLevels = 1;
-        imageInfo.arrayLayers = 1;
-        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-        imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-
-        VkResult r = vkCreateImage(device, &imageInfo, nullptr, &depthImages[i]);
-        VK_CHECKERROR(r);
-        SET_DEBUG_NAME(device, depthImages[i], VK_OBJECT_TYPE_IMAGE, "Rasterizer raster pass depth image" );
-
-
-        // allocate dedicated memory
-        VkMemoryRequirements memReqs;
-        vkGetImageMemoryRequirements(device, depthImages[i], &memReqs);
-
-        depthMemory[i] = allocator->AllocDedicated(memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryAllocator::AllocType::DEFAULT, "Rasterizer raster pass depth memory");
-
-        if (depthMemory[i] == VK_NULL_HANDLE)
-        {
-            vkDestroyImage(device, depthImages[i], nullptr);
-            depthImages[i] = VK_NULL_HANDLE;
+        vkDestroyImage(device, depthImages[frameIndex], nullptr);
+        depthImages[frameIndex] = VK_NULL_HANDLE;
 
-            return;
-        }
-
-        r = vkBindImageMemory(device, depthImages[i], depthMemory[i], 0);
-        VK_CHECKERROR(r);
-
-
-        // create image view
-        VkImageViewCreateInfo viewInfo = {};
-        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = DEPTH_FORMAT;
-        viewInfo.subresourceRange = {};
-        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
-        viewInfo.subresourceRange.baseArrayLayer = 0;
-        viewInfo.subresourceRange.layerCount = 1;
-        viewInfo.image = depthImages[i];
-
-        r = vkCreateImageView(device, &viewInfo, nullptr, &depthViews[i]);
-        VK_CHECKERROR(r);
-        SET_DEBUG_NAME(device, depthViews[i], VK_OBJECT_TYPE_IMAGE_VIEW, "Rasterizer raster pass depth image view");
-
-
-        // make transition from undefined manually,
-        // so depthAttch.initialLayout can be specified as DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-        VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
-
-        VkImageMemoryBarrier imageBarrier = {};
-        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageBarrier.image = depthImages[i];
-        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageBarrier.srcAccessMask = 0;
-        imageBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-        imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        imageBarrier.subresourceRange.baseMipLevel = 0;
-        imageBarrier.subresourceRange.levelCount = 1;
-        imageBarrier.subresourceRange.baseArrayLayer = 0;
-        imageBarrier.subresourceRange.layerCount = 1;
-
-        vkCmdPipelineBarrier(
-            cmd,
-            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
-            0, nullptr,
-            0, nullptr,
-            1, &imageBarrier);
-
-        cmdManager->Submit(cmd);
-        cmdManager->WaitGraphicsIdle();
+        return;
     }
+
+    r = vkBindImageMemory(device, depthImages[frameIndex], depthMemory[frameIndex], 0);
+    VK_CHECKERROR(r);
+
+
+    // create image view
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = DEPTH_FORMAT;
+    viewInfo.subresourceRange = {};
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    viewInfo.image = depthImages[frameIndex];
+
+    r = vkCreateImageView(device, &viewInfo, nullptr, &depthViews[frameIndex]);
+    VK_CHECKERROR(r);
+    SET_DEBUG_NAME(device, depthViews[frameIndex], VK_OBJECT_TYPE_IMAGE_VIEW, "Rasterizer raster pass depth image view");
+
+
+    // make transition from undefined manually,
+    // so depthAttch.initialLayout can be specified as DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+    VkImageMemoryBarrier imageBarrier = {};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.image = depthImages[frameIndex];
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.srcAccessMask = 0;
+    imageBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    imageBarrier.subresourceRange.baseMipLevel = 0;
+    imageBarrier.subresourceRange.levelCount = 1;
+    imageBarrier.subresourceRange.baseArrayLayer = 0;
+    imageBarrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+        0, nullptr,
+        0, nullptr,
+        1, &imageBarrier);
 }
 
-void RTGL1::RasterPass::DestroyDepthBuffers()
+void RTGL1::RasterPass::DestroyDepthBuffer(uint32_t frameIndex)
 {
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        assert((depthImages[i] && depthViews[i] && depthMemory[i]) 
-               || (!depthImages[i] && !depthViews[i] && !depthMemory[i]));
+    assert((depthImages[frameIndex] && depthViews[frameIndex] && depthMemory[frameIndex]) 
+           || (!depthImages[frameIndex] && !depthViews[frameIndex] && !depthMemory[frameIndex]));
 
-        if (depthImages[i] != VK_NULL_HANDLE)
-        {
-            vkDestroyImage(device, depthImages[i], nullptr);
-            vkDestroyImageView(device, depthViews[i], nullptr);
-            vkFreeMemory(device, depthMemory[i], nullptr);
+    if (depthImages[frameIndex] != VK_NULL_HANDLE)
+    {
+        vkDestroyImage(device, depthImages[frameIndex], nullptr);
+        vkDestroyImageView(device, depthViews[frameIndex], nullptr);
+        vkFreeMemory(device, depthMemory[frameIndex], nullptr);
 
-            depthImages[i] = VK_NULL_HANDLE;
-            depthViews[i] = VK_NULL_HANDLE;
-            depthMemory[i] = VK_NULL_HANDLE;
-        }
+        depthImages[frameIndex] = VK_NULL_HANDLE;
+        depthViews[frameIndex] = VK_NULL_HANDLE;
+        depthMemory[frameIndex] = VK_NULL_HANDLE;
     }
 }
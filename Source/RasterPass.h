@@ -48,11 +48,12 @@ public:
                          const std::shared_ptr<Framebuffers> &storageFramebuffers,
                          bool werePrimaryTraced);
 
-    void CreateFramebuffers(uint32_t renderWidth, uint32_t renderHeight, 
+    // Create framebuffers that are used by the frame with that index
+    void CreateFramebuffers(VkCommandBuffer cmd, uint32_t frameIndex,
+                            uint32_t renderWidth, uint32_t renderHeight, 
                             const std::shared_ptr<Framebuffers> &storageFramebuffers,
-                            const std::shared_ptr<MemoryAllocator> &allocator,
-                            const std::shared_ptr<CommandBufferManager> &cmdManager);
-    void DestroyFramebuffers();
+                            const std::shared_ptr<MemoryAllocator> &allocator);
+    void DestroyFramebuffers(uint32_t frameIndex);
 
     void OnShaderReload(const ShaderManager *shaderManager) override;
 
@@ -60,18 +61,16 @@ public:
     VkRenderPass GetSkyRasterRenderPass() const;
     const std::shared_ptr<RasterizerPipelines> &GetRasterPipelines() const;
     const std::shared_ptr<RasterizerPipelines> &GetSkyRasterPipelines() const;
-    uint32_t GetRasterWidth() const;
-    uint32_t GetRasterHeight() const;
     VkFramebuffer GetFramebuffer(uint32_t frameIndex) const;
     VkFramebuffer GetSkyFramebuffer(uint32_t frameIndex) const;
 
 private:
     void CreateRasterRenderPass(VkFormat finalImageFormat, VkFormat skyFinalImageFormat, VkFormat depthImageFormat);
 
-    void CreateDepthBuffers(uint32_t width, uint32_t height, 
-                            const std::shared_ptr<MemoryAllocator> &allocator,
-                            const std::shared_ptr<CommandBufferManager> &cmdManager);
-    void DestroyDepthBuffers();
+    void CreateDepthBuffer(VkCommandBuffer cmd, uint32_t frameIndex,
+                           uint32_t width, uint32_t height, 
+                           const std::shared_ptr<MemoryAllocator> &allocator);
+    void DestroyDepthBuffer(uint32_t frameIndex);
 
 private:
     VkDevice device;
@@ -82,9 +81,6 @@ private:
     std::shared_ptr<RasterizerPipelines> rasterPipelines;
     std::shared_ptr<RasterizerPipelines> rasterSkyPipelines;
 
-    uint32_t rasterWidth;
-    uint32_t rasterHeight;
-
     VkFramebuffer rasterFramebuffers[MAX_FRAMES_IN_FLIGHT];
     VkFramebuffer rasterSkyFramebuffers[MAX_FRAMES_IN_FLIGHT];
 
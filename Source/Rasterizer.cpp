@@ -20,8 +20,10 @@
 
 #include "Rasterizer.h"
 
+#include <algorithm>
 #include <array>
 
+#include "CommandBufferManager.h"
 #include "Swapchain.h"
 #include "Matrix.h"
 #include "Utils.h"
@@ -34,6 +36,11 @@ namespace RTGL1
 
 
 
+// If there are less draw calls, recording them in parallel isn't worth it
+constexpr size_t MIN_DRAW_COUNT_PER_THREAD = 256;
+
+
+
 struct RasterizedPushConst
 {
     float vp[16];
@@ -73,12 +80,14 @@ Rasterizer::Rasterizer(
     std::shared_ptr<MemoryAllocator> _allocator,
     std::shared_ptr<Framebuffers> _storageFramebuffers,
     std::shared_ptr<CommandBufferManager> _cmdManager,
+    std::shared_ptr<TaskScheduler> _taskScheduler,
     const RgInstanceCreateInfo &_instanceInfo)
 :
     device(_device),
     commonPipelineLayout(VK_NULL_HANDLE),
     allocator(std::move(_allocator)),
     cmdManager(std::move(_cmdManager)),
+    taskScheduler(std::move(_taskScheduler)),
     storageFramebuffers(std::move(_storageFramebuffers)),
     isCubemapOutdated(true)
 {
@@ -184,8 +193,8 @@ void Rasterizer::DrawSkyToAlbedo(VkCommandBuffer cmd, uint32_t frameIndex, const
         rasterPass->GetSkyRasterRenderPass(),
         // sky FB
         rasterPass->GetSkyFramebuffer(frameIndex),
-        rasterPass->GetRasterWidth(),
-        rasterPass->GetRasterHeight(),
+        storageFramebuffers->GetCurrentResolution().renderWidth,
+        storageFramebuffers->GetCurrentResolution().renderHeight,
         // sky geometry
         collectorSky->GetVertexBuffer(),
         collectorSky->GetIndexBuffer(),
@@ -235,8 +244,8 @@ void Rasterizer::DrawToFinalImage(VkCommandBuffer cmd, uint32_t frameIndex,
         rasterPass->GetRasterRenderPass(),
         // ordinary FB
         rasterPass->GetFramebuffer(frameIndex),
-        rasterPass->GetRasterWidth(),
-        rasterPass->GetRasterHeight(),
+        storageFramebuffers->GetCurrentResolution().renderWidth,
+        storageFramebuffers->GetCurrentResolution().renderHeight,
         // ordinary geometry
         collectorGeneral->GetVertexBuffer(),
         collectorGeneral->GetIndexBuffer(),
@@ -292,7 +301,6 @@ void Rasterizer::Draw(VkCommandBuffer cmd, uint32_t frameIndex, const DrawParams
     }
 
 
-    const VkViewport defaultViewport = { 0, 0, (float)drawParams.width, (float)drawParams.height, 0.0f, 1.0f };
     const VkRect2D defaultRenderArea = { { 0, 0 }, { drawParams.width, drawParams.height }};
 
     VkClearValue clear[2] = {};
@@ -306,71 +314,160 @@ void Rasterizer::Draw(VkCommandBuffer cmd, uint32_t frameIndex, const DrawParams
     beginInfo.clearValueCount = 2;
     beginInfo.pClearValues = clear;
 
-    vkCmdBeginRenderPass(cmd, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    const size_t drawCount = drawParams.drawInfos.size();
+    const size_t threadCount = std::min<size_t>(
+        std::min(cmdManager->GetSecondaryThreadCount(), taskScheduler->GetConcurrency()),
+        (drawCount + MIN_DRAW_COUNT_PER_THREAD - 1) / MIN_DRAW_COUNT_PER_THREAD);
 
-
-    if (draw)
+    // few draw calls, record directly to the primary cmd
+    if (threadCount <= 1)
     {
-        VkPipeline curPipeline = VK_NULL_HANDLE;
-        BindPipelineIfNew(cmd, drawParams.drawInfos[0], drawParams.pipelines, curPipeline);
+        vkCmdBeginRenderPass(cmd, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        RecordDraws(cmd, drawParams, 0, drawCount);
 
+        if (drawLensFlares)
+        {
+            RecordLensFlares(cmd, frameIndex, drawParams);
+        }
 
-        VkDeviceSize offset = 0;
+        vkCmdEndRenderPass(cmd);
+        return;
+    }
 
-        vkCmdBindDescriptorSets(
-            cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, drawParams.pipelines->GetPipelineLayout(), 0,
-            1, &drawParams.texturesDescSet,
-            0, nullptr);
-        vkCmdBindVertexBuffers(cmd, 0, 1, &drawParams.vertexBuffer, &offset);
-        vkCmdBindIndexBuffer(cmd, drawParams.indexBuffer, offset, VK_INDEX_TYPE_UINT32);
 
+    // split draw calls into contiguous ranges, each one is recorded
+    // to a secondary cmd in parallel, and then they're executed in order
+    PrepareDrawPipelines(drawParams);
 
-        vkCmdSetScissor(cmd, 0, 1, &defaultRenderArea);
-        vkCmdSetViewport(cmd, 0, 1, &defaultViewport);
+    const size_t drawsPerThread = (drawCount + threadCount - 1) / threadCount;
 
-        VkViewport curViewport = defaultViewport;
+    std::array<VkCommandBuffer, CommandBufferManager::MAX_SECONDARY_THREAD_COUNT + 1> secondaryCmds = {};
 
-        for (const auto &info : drawParams.drawInfos)
+    // each range index is processed by exactly one task, so it can be used as a thread index
+    taskScheduler->ParallelFor((uint32_t)threadCount, 1, [this, &drawParams, &secondaryCmds, drawCount, drawsPerThread] (uint32_t firstRange, uint32_t endRange)
+    {
+        for (uint32_t threadIndex = firstRange; threadIndex < endRange; threadIndex++)
         {
-            SetViewportIfNew(cmd, info, defaultViewport, curViewport);
-            BindPipelineIfNew(cmd, info, drawParams.pipelines, curPipeline);
-
-            // push const
-            {
-                RasterizedPushConst push(info, drawParams.defaultViewProj);
-
-                vkCmdPushConstants(
-                    cmd, drawParams.pipelines->GetPipelineLayout(),
-                    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                    0, sizeof(push),
-                    &push);
-            }
-
-            // draw
-            if (info.indexCount > 0)
-            {
-                vkCmdDrawIndexed(cmd, info.indexCount, 1, info.firstIndex, info.firstVertex, 0);
-            }
-            else
-            {
-                vkCmdDraw(cmd, info.vertexCount, 1, info.firstVertex, 0);
-            }
+            const size_t first = std::min(drawCount, threadIndex * drawsPerThread);
+            const size_t end = std::min(drawCount, first + drawsPerThread);
+
+            VkCommandBuffer secondary = cmdManager->StartSecondaryGraphicsCmd(threadIndex, drawParams.renderPass, drawParams.framebuffer);
+            RecordDraws(secondary, drawParams, first, end);
+            cmdManager->EndSecondaryCmd(secondary);
+
+            secondaryCmds[threadIndex] = secondary;
         }
-    }
+    });
 
+    uint32_t secondaryCount = (uint32_t)threadCount;
 
+    // lens flares must be drawn after all geometry
     if (drawLensFlares)
     {
-        vkCmdSetScissor(cmd, 0, 1, &defaultRenderArea);
-        vkCmdSetViewport(cmd, 0, 1, &defaultViewport);
+        VkCommandBuffer secondary = cmdManager->StartSecondaryGraphicsCmd(0, drawParams.renderPass, drawParams.framebuffer);
+        RecordLensFlares(secondary, frameIndex, drawParams);
+        cmdManager->EndSecondaryCmd(secondary);
 
-        drawParams.pLensFlares->Draw(cmd, frameIndex);
+        secondaryCmds[secondaryCount] = secondary;
+        secondaryCount++;
     }
 
-
+    vkCmdBeginRenderPass(cmd, &beginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(cmd, secondaryCount, secondaryCmds.data());
     vkCmdEndRenderPass(cmd);
 }
 
+void Rasterizer::RecordDraws(VkCommandBuffer cmd, const DrawParams &drawParams, size_t firstDraw, size_t endDraw)
+{
+    if (firstDraw >= endDraw)
+    {
+        return;
+    }
+
+    const VkViewport defaultViewport = { 0, 0, (float)drawParams.width, (float)drawParams.height, 0.0f, 1.0f };
+    const VkRect2D defaultRenderArea = { { 0, 0 }, { drawParams.width, drawParams.height }};
+
+    VkPipeline curPipeline = VK_NULL_HANDLE;
+    BindPipelineIfNew(cmd, drawParams.drawInfos[firstDraw], drawParams.pipelines, curPipeline);
+
+
+    VkDeviceSize offset = 0;
+
+    vkCmdBindDescriptorSets(
+        cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, drawParams.pipelines->GetPipelineLayout(), 0,
+        1, &drawParams.texturesDescSet,
+        0, nullptr);
+    vkCmdBindVertexBuffers(cmd, 0, 1, &drawParams.vertexBuffer, &offset);
+    vkCmdBindIndexBuffer(cmd, drawParams.indexBuffer, offset, VK_INDEX_TYPE_UINT32);
+
+
+    vkCmdSetScissor(cmd, 0, 1, &defaultRenderArea);
+    vkCmdSetViewport(cmd, 0, 1, &defaultViewport);
+
+    VkViewport curViewport = defaultViewport;
+
+    for (size_t i = firstDraw; i < endDraw; i++)
+    {
+        const auto &info = drawParams.drawInfos[i];
+
+        SetViewportIfNew(cmd, info, defaultViewport, curViewport);
+        BindPipelineIfNew(cmd, info, drawParams.pipelines, curPipeline);
+
+        // push const
+        {
+            RasterizedPushConst push(info, drawParams.defaultViewProj);
+
+            vkCmdPushConstants(
+                cmd, drawParams.pipelines->GetPipelineLayout(),
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                0, sizeof(push),
+                &push);
+        }
+
+        // draw
+        if (info.indexCount > 0)
+        {
+            vkCmdDrawIndexed(cmd, info.indexCount, 1, info.firstIndex, info.firstVertex, 0);
+        }
+        else
+        {
+            vkCmdDraw(cmd, info.vertexCount, 1, info.firstVertex, 0);
+        }
+    }
+}
+
+void Rasterizer::RecordLensFlares(VkCommandBuffer cmd, uint32_t frameIndex, const DrawParams &drawParams)
+{
+    const VkViewport defaultViewport = { 0, 0, (float)drawParams.width, (float)drawParams.height, 0.0f, 1.0f };
+    const VkRect2D defaultRenderArea = { { 0, 0 }, { drawParams.width, drawParams.height }};
+
+    vkCmdSetScissor(cmd, 0, 1, &defaultRenderArea);
+    vkCmdSetViewport(cmd, 0, 1, &defaultViewport);
+
+    drawParams.pLensFlares->Draw(cmd, frameIndex);
+}
+
+void Rasterizer::PrepareDrawPipelines(const DrawParams &drawParams)
+{
+    const RasterizedDataCollector::DrawInfo *prev = nullptr;
+
+    for (const auto &info : drawParams.drawInfos)
+    {
+        // consecutive draw infos usually have the same state
+        if (prev != nullptr &&
+            prev->pipelineState == info.pipelineState &&
+            prev->blendFuncSrc == info.blendFuncSrc &&
+            prev->blendFuncDst == info.blendFuncDst)
+        {
+            continue;
+        }
+
+        drawParams.pipelines->GetPipeline(info.pipelineState, info.blendFuncSrc, info.blendFuncDst);
+        prev = &info;
+    }
+}
+
 void Rasterizer::SetViewportIfNew(VkCommandBuffer cmd, const RasterizedDataCollector::DrawInfo &info, 
                                   const VkViewport &defaultViewport, VkViewport &curViewport)
 {
@@ -407,13 +504,13 @@ void Rasterizer::OnShaderReload(const ShaderManager *shaderManager)
     lensFlares->OnShaderReload(shaderManager);
 }
 
-void Rasterizer::OnFramebuffersSizeChange(const ResolutionState &resolutionState)
+void Rasterizer::OnFramebuffersSizeChange(VkCommandBuffer cmd, uint32_t frameIndex, const ResolutionState &allocation)
 {
-    rasterPass->DestroyFramebuffers();
-    swapchainPass->DestroyFramebuffers();
+    rasterPass->DestroyFramebuffers(frameIndex);
+    swapchainPass->DestroyFramebuffers(frameIndex);
 
-    rasterPass->CreateFramebuffers(resolutionState.renderWidth, resolutionState.renderHeight, storageFramebuffers, allocator, cmdManager);
-    swapchainPass->CreateFramebuffers(resolutionState.upscaledWidth, resolutionState.upscaledHeight, storageFramebuffers);
+    rasterPass->CreateFramebuffers(cmd, frameIndex, allocation.renderWidth, allocation.renderHeight, storageFramebuffers, allocator);
+    swapchainPass->CreateFramebuffers(frameIndex, allocation.upscaledWidth, allocation.upscaledHeight, storageFramebuffers);
 }
 
 void Rasterizer::CreatePipelineLayout(VkDescriptorSetLayout texturesSetLayout)
@@ -33,6 +33,7 @@
 #include "RenderCubemap.h"
 #include "ShaderManager.h"
 #include "SwapchainPass.h"
+#include "TaskScheduler.h"
 #include "RTGL1/RTGL1.h"
 
 namespace RTGL1
@@ -56,6 +57,7 @@ public:
         std::shared_ptr<MemoryAllocator> allocator,
         std::shared_ptr<Framebuffers> storageFramebuffers,
         std::shared_ptr<CommandBufferManager> cmdManager,
+        std::shared_ptr<TaskScheduler> taskScheduler,
         const RgInstanceCreateInfo &instanceInfo);
     ~Rasterizer() override;
 
@@ -77,7 +79,7 @@ public:
     void DrawToSwapchain(VkCommandBuffer cmd, uint32_t frameIndex, FramebufferImageIndex imageToDrawIn, const std::shared_ptr<TextureManager> &textureManager, float *view, float *proj);
     
     void OnShaderReload(const ShaderManager *shaderManager) override;
-    void OnFramebuffersSizeChange(const ResolutionState &resolutionState) override;
+    void OnFramebuffersSizeChange(VkCommandBuffer cmd, uint32_t frameIndex, const ResolutionState &allocation) override;
 
     const std::shared_ptr<RenderCubemap> &GetRenderCubemap() const;
 
@@ -102,6 +104,11 @@ private:
 
 private:
     void Draw(VkCommandBuffer cmd, uint32_t frameIndex, const DrawParams &drawParams);
+    // Record draw infos in [firstDraw, endDraw) to cmd, that is inside the render pass.
+    void RecordDraws(VkCommandBuffer cmd, const DrawParams &drawParams, size_t firstDraw, size_t endDraw);
+    void RecordLensFlares(VkCommandBuffer cmd, uint32_t frameIndex, const DrawParams &drawParams);
+    // Create pipelines that are not created yet, so they can be accessed from several threads.
+    void PrepareDrawPipelines(const DrawParams &drawParams);
 
     void CreatePipelineLayout(VkDescriptorSetLayout texturesSetLayout);
 
@@ -118,6 +125,7 @@ private:
 
     std::shared_ptr<MemoryAllocator> allocator;
     std::shared_ptr<CommandBufferManager> cmdManager;
+    std::shared_ptr<TaskScheduler> taskScheduler;
     std::shared_ptr<Framebuffers> storageFramebuffers;
 
     std::shared_ptr<RasterPass> rasterPass;
@@ -243,11 +243,11 @@ RTGL1::RasterizerPipelines::~RasterizerPipelines()
     vkDestroyPipelineCache(device, pipelineCache, nullptr);
 }
 
-void RTGL1::RasterizerPipelines::Clear()
+void RTGL1::RasterizerPipelines::Clear(const ShaderManager *shaderManager)
 {
     for (auto &p : pipelines)
     {
-        vkDestroyPipeline(device, p.second, nullptr);
+        shaderManager->DestroyWhenUnused(p.second);
     }
 
     pipelines.clear();
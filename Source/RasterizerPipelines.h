@@ -44,7 +44,8 @@ public:
     RasterizerPipelines &operator=(const RasterizerPipelines &other) = delete;
     RasterizerPipelines &operator=(RasterizerPipelines &&other) noexcept = delete;
 
-    void Clear();
+    // Pipelines are destroyed when frames in flight stop using them
+    void Clear(const ShaderManager *shaderManager);
     void SetShaders(const ShaderManager *shaderManager, const char *vertexShaderName, const char *fragmentShaderName);
     void DisableDynamicState(const VkViewport &viewport, const VkRect2D &scissors);
 
@@ -43,6 +43,7 @@ RayTracingPipeline::RayTracingPipeline(
 :
     device(_device),
     physDevice(std::move(_physDevice)),
+    allocator(std::move(_allocator)),
     rtPipelineLayout(VK_NULL_HANDLE),
     rtPipeline(VK_NULL_HANDLE),
     copySBTFromStaging(false),
@@ -55,7 +56,7 @@ RayTracingPipeline::RayTracingPipeline(
     primaryRaysMaxAlbedoLayers(_rgInfo.primaryRaysMaxAlbedoLayers),
     indirectIlluminationMaxAlbedoLayers(_rgInfo.indirectIlluminationMaxAlbedoLayers)
 {
-    shaderBindingTable = std::make_shared<AutoBuffer>(device, std::move(_allocator));
+    shaderBindingTable = std::make_shared<AutoBuffer>(device, allocator);
 
     // all set layouts to be used
     std::vector<VkDescriptorSetLayout> setLayouts =
@@ -148,6 +149,15 @@ void RayTracingPipeline::CreatePipelineLayout(const VkDescriptorSetLayout *pSetL
     plLayoutInfo.setLayoutCount = setLayoutCount;
     plLayoutInfo.pSetLayouts = pSetLayouts;
 
+    // indirect illumination raygen: if the launch is for gradient samples
+    VkPushConstantRange pushRange = {};
+    pushRange.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(uint32_t);
+
+    plLayoutInfo.pushConstantRangeCount = 1;
+    plLayoutInfo.pPushConstantRanges = &pushRange;
+
     VkResult r = vkCreatePipelineLayout(device, &plLayoutInfo, nullptr, &rtPipelineLayout);
     VK_CHECKERROR(r);
 
@@ -244,11 +254,6 @@ void RayTracingPipeline::CreateSBT()
     copySBTFromStaging = true;
 }
 
-void RayTracingPipeline::DestroySBT()
-{
-    shaderBindingTable->Destroy();
-}
-
 void RayTracingPipeline::Bind(VkCommandBuffer cmd)
 {
     if (copySBTFromStaging)
@@ -313,8 +318,11 @@ VkPipelineLayout RayTracingPipeline::GetLayout() const
 
 void RayTracingPipeline::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroySBT();
-    DestroyPipeline();
+    // frames in flight can still trace rays with the old SBT
+    shaderManager->DestroyWhenUnused(shaderBindingTable);
+    shaderBindingTable = std::make_shared<AutoBuffer>(device, allocator);
+
+    shaderManager->DestroyWhenUnused(rtPipeline);
 
     CreatePipeline(shaderManager);
     CreateSBT();
@@ -71,7 +71,6 @@ private:
     void CreatePipeline(const ShaderManager *shaderManager);
     void DestroyPipeline();
     void CreateSBT();
-    void DestroySBT();
 
     void AddGeneralGroup(uint32_t generalIndex);
 
@@ -94,6 +93,7 @@ private:
 private:
     VkDevice device;
     std::shared_ptr<PhysicalDevice> physDevice;
+    std::shared_ptr<MemoryAllocator> allocator;
 
     std::vector<ShaderStageInfo> shaderStageInfos;
 
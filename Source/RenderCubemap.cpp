@@ -107,7 +107,7 @@ RTGL1::RenderCubemap::~RenderCubemap()
 
 void RTGL1::RenderCubemap::OnShaderReload(const ShaderManager *shaderManager)
 {
-    pipelines->Clear();
+    pipelines->Clear(shaderManager);
 
     // set reloaded shaders
     pipelines->SetShaders(shaderManager, "VertRasterizerMultiview", "FragRasterizer");
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 
 #include "DLSS.h"
@@ -40,13 +41,18 @@ public:
     RenderResolutionHelper &operator=(const RenderResolutionHelper &other) = delete;
     RenderResolutionHelper &operator=(RenderResolutionHelper &&other) noexcept = delete;
 
+    // "dynamicScale" and "dynamicMaxScale" are used only if resolution mode is DYNAMIC
     void Setup(const RgDrawFrameRenderResolutionParams *pParams, 
                uint32_t fullWidth, uint32_t fullHeight,
-               const std::shared_ptr<DLSS> &dlss)
+               const std::shared_ptr<DLSS> &dlss,
+               float dynamicScale = 1.0f, float dynamicMaxScale = 1.0f)
     {   
         renderWidth = fullWidth;
         renderHeight = fullHeight;
 
+        maxRenderWidth = fullWidth;
+        maxRenderHeight = fullHeight;
+
         upscaledWidth = fullWidth;
         upscaledHeight = fullHeight;
 
@@ -96,6 +102,7 @@ public:
                 case RG_RENDER_RESOLUTION_MODE_BALANCED:
                 case RG_RENDER_RESOLUTION_MODE_QUALITY:
                 case RG_RENDER_RESOLUTION_MODE_ULTRA_QUALITY:
+                case RG_RENDER_RESOLUTION_MODE_DYNAMIC:
                     break;
                 default:
                     throw RgException(RG_WRONG_ARGUMENT, "RgDrawFrameRenderResolutionParams::resolutionMode is incorrect");
@@ -108,6 +115,24 @@ public:
             renderWidth  = pParams->renderSize.width;
             renderHeight = pParams->renderSize.height;
 
+            maxRenderWidth  = renderWidth;
+            maxRenderHeight = renderHeight;
+
+            return;
+        }
+
+
+        // upscalers use render and upscaled sizes as is, so any scale can be used
+        if (resolutionMode == RG_RENDER_RESOLUTION_MODE_DYNAMIC)
+        {
+            assert(dynamicScale > 0.0f && dynamicScale <= dynamicMaxScale && dynamicMaxScale <= 1.0f);
+
+            renderWidth  = std::max(1u, (uint32_t)(dynamicScale * fullWidth));
+            renderHeight = std::max(1u, (uint32_t)(dynamicScale * fullHeight));
+
+            maxRenderWidth  = std::max(1u, (uint32_t)(dynamicMaxScale * fullWidth));
+            maxRenderHeight = std::max(1u, (uint32_t)(dynamicMaxScale * fullHeight));
+
             return;
         }
 
@@ -145,6 +170,9 @@ public:
                 renderHeight = fullHeight;
             }
         }
+
+        maxRenderWidth  = renderWidth;
+        maxRenderHeight = renderHeight;
     }
 
     float GetMipLodBias(float nativeBias = 0.0f) const
@@ -194,6 +222,16 @@ public:
         return ResolutionState{ Width(), Height(), UpscaledWidth(), UpscaledHeight() };
     }
 
+    // Same as GetResolutionState(), but with the largest render size
+    // that the current mode can request, i.e. with the max dynamic scale
+    ResolutionState GetMaxResolutionState() const
+    {
+        uint32_t maxWidth = maxRenderWidth + maxRenderWidth % 2;
+
+        assert(maxWidth >= Width() && maxRenderHeight >= Height());
+        return ResolutionState{ maxWidth, maxRenderHeight, UpscaledWidth(), UpscaledHeight() };
+    }
+
 private:
     uint32_t renderWidth = 0;
     uint32_t renderHeight = 0;
@@ -201,6 +239,9 @@ private:
     uint32_t upscaledWidth = 0;
     uint32_t upscaledHeight = 0;
 
+    uint32_t maxRenderWidth = 0;
+    uint32_t maxRenderHeight = 0;
+
     RgRenderUpscaleTechnique    upscaleTechnique = RG_RENDER_UPSCALE_TECHNIQUE_LINEAR;
     RgRenderSharpenTechnique    sharpenTechnique = RG_RENDER_SHARPEN_TECHNIQUE_NONE;
     RgRenderResolutionMode      resolutionMode   = RG_RENDER_RESOLUTION_MODE_CUSTOM;
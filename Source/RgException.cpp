@@ -21,6 +21,7 @@
 #include "RgException.h"
 
 #include <cassert>
+#include <cstring>
 
 static const char *GetRgResultName(RgResult r)
 {
@@ -50,21 +51,28 @@ static const char *GetRgResultName(RgResult r)
 }
 
 RTGL1::RgException::RgException(RgResult _errorCode)
-    : runtime_error(GetRgResultName(_errorCode)), errorCode(_errorCode)
-{
-    assert(errorCode != RG_SUCCESS);
-}
+    : RgException(_errorCode, GetRgResultName(_errorCode))
+{}
 
 RTGL1::RgException::RgException(RgResult _errorCode, const std::string &_Message)
-    : runtime_error(_Message), errorCode(_errorCode)
+    : RgException(_errorCode, _Message.c_str())
+{}
+
+RTGL1::RgException::RgException(RgResult _errorCode, const char *_Message)
+    : errorCode(_errorCode), message{}
 {
     assert(errorCode != RG_SUCCESS);
+
+    if (_Message != nullptr)
+    {
+        // truncate, if too long
+        strncpy(message, _Message, sizeof(message) - 1);
+    }
 }
 
-RTGL1::RgException::RgException(RgResult _errorCode, const char *_Message)
-    : runtime_error(_Message), errorCode(_errorCode)
+const char *RTGL1::RgException::what() const noexcept
 {
-    assert(errorCode != RG_SUCCESS);
+    return message;
 }
 
 RgResult RTGL1::RgException::GetErrorCode() const
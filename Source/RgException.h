@@ -20,14 +20,16 @@
 
 #pragma once
 
-#include <stdexcept>
+#include <exception>
+#include <string>
 
 #include "RTGL1/RTGL1.h"
 
 namespace RTGL1
 {
 
-class RgException : public std::runtime_error
+// Message is stored in a fixed-size buffer, so throwing doesn't allocate
+class RgException : public std::exception
 {
 public:
     explicit RgException(RgResult errorCode);
@@ -35,9 +37,11 @@ public:
     explicit RgException(RgResult errorCode, const char *_Message);
 
     RgResult GetErrorCode() const;
+    const char *what() const noexcept override;
 
 private:
     RgResult errorCode;
+    char message[256];
 };
 
 }
@@ -28,6 +28,8 @@ using namespace RTGL1;
 Scene::Scene(
     VkDevice _device,
     std::shared_ptr<MemoryAllocator> &_allocator,
+    const std::shared_ptr<PhysicalDevice> &_physDevice,
+    std::shared_ptr<FrameAllocator> &_frameAllocator,
     std::shared_ptr<CommandBufferManager> &_cmdManager,
     std::shared_ptr<TextureManager> &_textureManager,
     const std::shared_ptr<const GlobalUniform> &_uniform,
@@ -42,13 +44,15 @@ Scene::Scene(
 
     sectorVisibility = std::make_shared<SectorVisibility>();
 
-    lightManager = std::make_shared<LightManager>(_device, _allocator, sectorVisibility);
+    lightManager = std::make_shared<LightManager>(_device, _allocator, _frameAllocator, sectorVisibility);
     geomInfoMgr = std::make_shared<GeomInfoManager>(_device, _allocator);
     triangleInfoMgr = std::make_shared<TriangleInfoManager>(_device, _allocator, sectorVisibility);
 
-    asManager = std::make_shared<ASManager>(_device, _allocator, _cmdManager, _textureManager, geomInfoMgr, triangleInfoMgr, sectorVisibility, _properties);
+    meshManager = std::make_shared<MeshManager>(_device, _allocator, _properties);
+
+    asManager = std::make_shared<ASManager>(_device, _allocator, _physDevice, _frameAllocator, _cmdManager, _textureManager, geomInfoMgr, triangleInfoMgr, sectorVisibility, meshManager, _properties);
   
-    vertPreproc = std::make_shared<VertexPreprocessing>(_device, _uniform, asManager, _shaderManager);
+    vertPreproc = std::make_shared<VertexPreprocessing>(_device, _allocator, _uniform, asManager, _shaderManager, _properties);
 }
 
 Scene::~Scene()
@@ -57,10 +61,12 @@ Scene::~Scene()
 void Scene::PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
 {
     dynamicUniqueIDToSimpleIndex.clear();
+    meshInstanceUniqueIDs.clear();
 
     geomInfoMgr->PrepareForFrame(frameIndex);
     triangleInfoMgr->PrepareForFrame(frameIndex);
     lightManager->PrepareForFrame(cmd, frameIndex);
+    meshManager->PrepareForFrame(frameIndex);
 
     // dynamic geomtry
     asManager->BeginDynamicGeometry(cmd, frameIndex);
@@ -88,7 +94,14 @@ bool Scene::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex, const std::
         toResubmitMovable = false;
     }
 
-    // always submit dynamic geomtetry on the frame ending
+    // mesh data must be in device-local memory before copying its instances,
+    // and BLAS of the new meshes must be built before referencing them in TLAS
+    asManager->SubmitMeshes(cmd, frameIndex);
+
+    // always submit dynamic geomtetry on the frame ending;
+    // skinned vertices must be ready before building BLAS
+    asManager->CopyDynamicGeometry(cmd, frameIndex);
+    vertPreproc->Skin(cmd, frameIndex, uniform, asManager);
     asManager->SubmitDynamicGeometry(cmd, frameIndex);
 
 
@@ -97,17 +110,16 @@ bool Scene::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex, const std::
     triangleInfoMgr->CopyFromStaging(cmd, frameIndex);
 
 
-    ShVertPreprocessing push = {};
     ASManager::TLASPrepareResult prepare = {};
 
-    asManager->PrepareForBuildingTLAS(frameIndex, *uniform->GetData(), uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, &push, &prepare);
+    asManager->PrepareForBuildingTLAS(frameIndex, *uniform->GetData(), uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, &prepare);
 
     // upload uniform data
     uniform->GetData()->areFramebufsInitedByRT = !prepare.IsEmpty() && !disableRayTracing;
     uniform->Upload(cmd, frameIndex);
     
     
-    vertPreproc->Preprocess(cmd, frameIndex, preprocMode, uniform, asManager, push);
+    vertPreproc->Preprocess(cmd, frameIndex, preprocMode, uniform, asManager, geomInfoMgr);
 
 
     if (prepare.IsEmpty())
@@ -203,7 +215,76 @@ bool RTGL1::Scene::UpdateTexCoords(const RgUpdateTexCoordsInfo &texCoordsInfo)
     return true;
 }
 
-void Scene::SubmitStatic()
+RgMesh Scene::CreateMesh(const RgMeshCreateInfo &createInfo)
+{
+    return meshManager->CreateMesh(createInfo);
+}
+
+void Scene::DestroyMesh(uint32_t frameIndex, RgMesh mesh)
+{
+    meshManager->DestroyMesh(frameIndex, mesh);
+}
+
+bool Scene::UploadMeshInstance(uint32_t frameIndex, RgMesh mesh, const RgGeometryUploadInfo &uploadInfo,
+                               const RgMeshSkinningInfo *pSkinningInfo)
+{
+    assert(!DoesUniqueIDExist(uploadInfo.uniqueID));
+    assert(uploadInfo.geomType == RG_GEOMETRY_TYPE_DYNAMIC);
+
+    if (isRecordingStatic)
+    {
+        throw RgException(RG_WRONG_FUNCTION_CALL, "Dynamic geometry must not be uploaded between rgStartNewScene and rgSubmitStaticGeometries calls");
+    }
+
+    const ResidentMeshData *pMesh = meshManager->GetMesh(mesh);
+
+    if (pMesh == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Can't find mesh with ID=" + std::to_string(mesh));
+    }
+
+    if (pSkinningInfo != nullptr)
+    {
+        if (pMesh->jointIndices == ResidentMeshData::NO_ATTRIBUTE)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Mesh with ID=" + std::to_string(mesh) + " doesn't have joint data for skinning");
+        }
+
+        if (!vertPreproc->CanSkin(pMesh->vertexCount, pSkinningInfo->jointCount))
+        {
+            assert(false && "Too many skinned vertices or joints");
+            return false;
+        }
+    }
+
+    // rigid instances don't need vertex data copies, if the mesh has its own BLAS
+    if (pSkinningInfo == nullptr && pMesh->blas != nullptr)
+    {
+        if (asManager->AddMeshInstance(frameIndex, uploadInfo, mesh, *pMesh))
+        {
+            meshInstanceUniqueIDs.insert(uploadInfo.uniqueID);
+            return true;
+        }
+    }
+
+    uint32_t simpleIndex = asManager->AddDynamicGeometry(frameIndex, uploadInfo, pMesh);
+
+    if (simpleIndex != UINT32_MAX)
+    {
+        if (pSkinningInfo != nullptr)
+        {
+            uint32_t baseVertexIndex = geomInfoMgr->GetDynamicGeomBaseVertexIndex(frameIndex, simpleIndex);
+            vertPreproc->AddSkinnedInstance(frameIndex, baseVertexIndex, *pMesh, *pSkinningInfo);
+        }
+
+        dynamicUniqueIDToSimpleIndex[uploadInfo.uniqueID] = simpleIndex;
+        return true;
+    }
+
+    return false;
+}
+
+void Scene::SubmitStatic(uint32_t frameIndex)
 {
     // submit even if nothing was recorded, 
     // so the static scene will be empty
@@ -212,7 +293,7 @@ void Scene::SubmitStatic()
         asManager->BeginStaticGeometry();
     }
 
-    asManager->SubmitStaticGeometry();
+    asManager->SubmitStaticGeometry(frameIndex);
     isRecordingStatic = false;
 
     submittedStaticInCurrentFrame = true;
@@ -249,11 +330,17 @@ const std::shared_ptr<VertexPreprocessing> &RTGL1::Scene::GetVertexPreprocessing
     return vertPreproc;
 }
 
+const std::shared_ptr<SectorVisibility> &RTGL1::Scene::GetSectorVisibility()
+{
+    return sectorVisibility;
+}
+
 bool Scene::DoesUniqueIDExist(uint64_t uniqueID) const
 {
     return
         staticUniqueIDToSimpleIndex.find(uniqueID) != staticUniqueIDToSimpleIndex.end() ||
-        dynamicUniqueIDToSimpleIndex.find(uniqueID) != dynamicUniqueIDToSimpleIndex.end();
+        dynamicUniqueIDToSimpleIndex.find(uniqueID) != dynamicUniqueIDToSimpleIndex.end() ||
+        meshInstanceUniqueIDs.find(uniqueID) != meshInstanceUniqueIDs.end();
 }
 
 bool Scene::TryGetStaticSimpleIndex(uint64_t uniqueID, uint32_t *result) const
@@ -289,6 +376,16 @@ void Scene::UploadLight(uint32_t frameIndex, const std::shared_ptr<GlobalUniform
     lightManager->AddSpotlight(frameIndex, uniform, lightInfo);
 }
 
+void Scene::UploadLights(uint32_t frameIndex, const RgSphericalLightUploadInfo *pLightInfos, uint32_t lightCount)
+{
+    lightManager->AddSphericalLights(frameIndex, pLightInfos, lightCount);
+}
+
+void Scene::UploadLights(uint32_t frameIndex, const RgPolygonalLightUploadInfo *pLightInfos, uint32_t lightCount)
+{
+    lightManager->AddPolygonalLights(frameIndex, pLightInfos, lightCount);
+}
+
 void RTGL1::Scene::SetPotentialVisibility(SectorID sectorID_A, SectorID sectorID_B)
 {
     sectorVisibility->SetPotentialVisibility(sectorID_A, sectorID_B);
@@ -22,6 +22,7 @@
 
 #include "ASManager.h"
 #include "LightManager.h"
+#include "MeshManager.h"
 #include "VertexPreprocessing.h"
 #include "SectorVisibility.h"
 
@@ -34,6 +35,8 @@ public:
     explicit Scene(
         VkDevice device,
         std::shared_ptr<MemoryAllocator> &allocator,
+        const std::shared_ptr<PhysicalDevice> &physDevice,
+        std::shared_ptr<FrameAllocator> &frameAllocator,
         std::shared_ptr<CommandBufferManager> &cmdManager,
         std::shared_ptr<TextureManager> &textureManager,
         const std::shared_ptr<const GlobalUniform> &uniform,
@@ -56,19 +59,28 @@ public:
     bool UpdateTransform(const RgUpdateTransformInfo &updateInfo);
     bool UpdateTexCoords(const RgUpdateTexCoordsInfo &texCoordsInfo);
 
+    RgMesh CreateMesh(const RgMeshCreateInfo &createInfo);
+    void DestroyMesh(uint32_t frameIndex, RgMesh mesh);
+    // If pSkinningInfo is not null, the instance is skinned on GPU
+    bool UploadMeshInstance(uint32_t frameIndex, RgMesh mesh, const RgGeometryUploadInfo &uploadInfo,
+                            const RgMeshSkinningInfo *pSkinningInfo = nullptr);
+
     void UploadLight(uint32_t frameIndex, const RgSphericalLightUploadInfo &lightInfo);
     void UploadLight(uint32_t frameIndex, const RgPolygonalLightUploadInfo &lightInfo);
     void UploadLight(uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, const RgDirectionalLightUploadInfo &lightInfo);
     void UploadLight(uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, const RgSpotlightUploadInfo &lightInfo);
+    void UploadLights(uint32_t frameIndex, const RgSphericalLightUploadInfo *pLightInfos, uint32_t lightCount);
+    void UploadLights(uint32_t frameIndex, const RgPolygonalLightUploadInfo *pLightInfos, uint32_t lightCount);
 
     void SetPotentialVisibility(SectorID sectorID_A, SectorID sectorID_B);
 
-    void SubmitStatic();
+    void SubmitStatic(uint32_t frameIndex);
     void StartNewStatic();
 
     const std::shared_ptr<ASManager> &GetASManager();
     const std::shared_ptr<LightManager> &GetLightManager();
     const std::shared_ptr<VertexPreprocessing> &GetVertexPreprocessing();
+    const std::shared_ptr<SectorVisibility> &GetSectorVisibility();
 
     bool DoesUniqueIDExist(uint64_t uniqueID) const;
 
@@ -82,9 +94,12 @@ private:
     std::shared_ptr<TriangleInfoManager> triangleInfoMgr;
     std::shared_ptr<VertexPreprocessing> vertPreproc;
     std::shared_ptr<SectorVisibility> sectorVisibility;
+    std::shared_ptr<MeshManager> meshManager;
 
     // Dynamic indices are cleared every frame
     rgl::unordered_map<uint64_t, uint32_t> dynamicUniqueIDToSimpleIndex;
+    // Rigid mesh instances that are traced through the mesh's BLAS, cleared every frame
+    rgl::unordered_set<uint64_t> meshInstanceUniqueIDs;
     rgl::unordered_map<uint64_t, uint32_t> staticUniqueIDToSimpleIndex;
 
     // Movable geometry IDs
@@ -22,54 +22,155 @@
 
 #include <algorithm>
 
+#include "Utils.h"
+
 using namespace RTGL1;
 
 constexpr VkDeviceSize SCRATCH_CHUNK_BUFFER_SIZE = (1 << 24);
 
-ScratchBuffer::ScratchBuffer(std::shared_ptr<MemoryAllocator> _allocator)
-    : allocator(_allocator)
+ScratchBuffer::ScratchBuffer(
+    std::shared_ptr<MemoryAllocator> _allocator,
+    const std::shared_ptr<PhysicalDevice> &_physDevice, 
+    uint32_t _frameCount)
+:
+    allocator(_allocator),
+    alignment(std::max<VkDeviceSize>(1, _physDevice->GetASProperties().minAccelerationStructureScratchOffsetAlignment)),
+    regions(_frameCount + 1),
+    currentRegion(0),
+    regionBeforeImmediate(0)
+{
+    // must be a power of 2
+    assert((alignment & (alignment - 1)) == 0);
+
+    // immediate builds are rare, so allocate their region lazily
+    for (uint32_t i = 0; i < _frameCount; i++)
+    {
+        AddChunk(regions[i], SCRATCH_CHUNK_BUFFER_SIZE);
+    }
+}
+
+void ScratchBuffer::BeginFrame(uint32_t frameIndex)
+{
+    assert(frameIndex + 1 < regions.size());
+    assert(currentRegion != regions.size() - 1);
+
+    currentRegion = frameIndex;
+    ResetRegion(regions[currentRegion]);
+}
+
+void ScratchBuffer::BeginImmediate()
 {
-    AddChunk(SCRATCH_CHUNK_BUFFER_SIZE);
+    assert(currentRegion != regions.size() - 1);
+
+    regionBeforeImmediate = currentRegion;
+    currentRegion = static_cast<uint32_t>(regions.size() - 1);
+
+    // previous immediate builds were waited
+    ResetRegion(regions[currentRegion]);
+}
+
+void ScratchBuffer::EndImmediate()
+{
+    assert(currentRegion == regions.size() - 1);
+    currentRegion = regionBeforeImmediate;
+}
+
+VkDeviceSize ScratchBuffer::GetAlignedSize(VkDeviceSize scratchSize) const
+{
+    return Utils::Align(scratchSize, alignment);
+}
+
+void ScratchBuffer::Reserve(VkDeviceSize totalAlignedSize)
+{
+    Region &region = regions[currentRegion];
+
+    if (!region.chunks.empty() && region.offset + totalAlignedSize <= region.chunks.back().alignedSize)
+    {
+        return;
+    }
+
+    // previous chunks can be in use by already recorded builds,
+    // so keep them until the region is reset
+    AddChunk(region, std::max(SCRATCH_CHUNK_BUFFER_SIZE, totalAlignedSize));
 }
 
 VkDeviceAddress ScratchBuffer::GetScratchAddress(VkDeviceSize scratchSize)
 {
-    // find chunk with appropriate size
-    for (auto &c : chunks)
+    const VkDeviceSize alignedSize = GetAlignedSize(scratchSize);
+
+    Reserve(alignedSize);
+
+    Region &region = regions[currentRegion];
+    const Chunk &c = region.chunks.back();
+
+    VkDeviceAddress address = c.alignedAddress + region.offset;
+    assert(address % alignment == 0);
+
+    region.offset += alignedSize;
+    region.usage += alignedSize;
+    region.peakUsage = std::max(region.peakUsage, region.usage);
+
+    return address;
+}
+
+VkDeviceSize ScratchBuffer::GetAllocatedSize() const
+{
+    VkDeviceSize size = 0;
+
+    for (const auto &r : regions)
     {
-        if (scratchSize < c.buffer.GetSize() - c.currentOffset)
+        for (const auto &c : r.chunks)
         {
-            VkDeviceAddress address = c.buffer.GetAddress() + c.currentOffset;
-
-            c.currentOffset += scratchSize;
-            return address;
+            size += c.buffer.GetSize();
         }
     }
 
-    // couldn't find chunk, create new one
-    AddChunk(std::max(SCRATCH_CHUNK_BUFFER_SIZE, scratchSize));
-    return chunks.back().buffer.GetAddress();
+    return size;
 }
 
-void ScratchBuffer::Reset()
+VkDeviceSize ScratchBuffer::GetPeakUsage() const
 {
-    for (auto &c : chunks)
+    VkDeviceSize peak = 0;
+
+    for (const auto &r : regions)
     {
-        c.currentOffset = 0;
+        peak = std::max(peak, r.peakUsage);
     }
+
+    return peak;
 }
 
-void ScratchBuffer::AddChunk(VkDeviceSize size)
+void ScratchBuffer::ResetRegion(Region &region)
+{
+    // if region was expanded, merge chunks into one with the size of
+    // the highest usage, so the next frames won't need new chunks
+    if (region.chunks.size() > 1)
+    {
+        region.chunks.clear();
+        AddChunk(region, std::max(SCRATCH_CHUNK_BUFFER_SIZE, region.peakUsage));
+    }
+
+    region.offset = 0;
+    region.usage = 0;
+}
+
+void ScratchBuffer::AddChunk(Region &region, VkDeviceSize size)
 {
     if (const auto allc = allocator.lock())
     {
-        chunks.emplace_back();
-        auto &c = chunks.back();
+        region.chunks.emplace_back();
+        auto &c = region.chunks.back();
 
+        // buffer's address might not be aligned, so reserve space for the padding
         c.buffer.Init(
-            allc, size,
+            allc, size + alignment,
             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             "Scratch buffer");
+
+        c.alignedAddress = Utils::Align(c.buffer.GetAddress(), alignment);
+        c.alignedSize = size;
+
+        region.offset = 0;
     }
 }
@@ -21,38 +21,77 @@
 #pragma once
 
 #include <list>
+#include <vector>
 
 #include "Buffer.h"
+#include "PhysicalDevice.h"
 
 namespace RTGL1
 {
 
+// Scratch memory for acceleration structure builds.
+// Each frame in flight has its own region that is reused only after
+// the frame's fence was waited, so builds of different frames never overlap.
 class ScratchBuffer
 {
 public:
-    explicit ScratchBuffer(std::shared_ptr<MemoryAllocator> allocator);
+    explicit ScratchBuffer(
+        std::shared_ptr<MemoryAllocator> allocator, 
+        const std::shared_ptr<PhysicalDevice> &physDevice,
+        uint32_t frameCount);
 
     ScratchBuffer(const ScratchBuffer& other) = delete;
     ScratchBuffer(ScratchBuffer&& other) noexcept = delete;
     ScratchBuffer& operator=(const ScratchBuffer& other) = delete;
     ScratchBuffer& operator=(ScratchBuffer&& other) noexcept = delete;
 
-    // get scratch buffer address
+    // Must be called when the fence of the frame was waited
+    void BeginFrame(uint32_t frameIndex);
+    // Builds that are submitted and waited right away use a separate region,
+    // as recorded but not submitted builds of the current frame can be in its region
+    void BeginImmediate();
+    void EndImmediate();
+
+    // Scratch size with the alignment padding
+    VkDeviceSize GetAlignedSize(VkDeviceSize scratchSize) const;
+    // Guarantee that the next allocations with the total aligned size
+    // won't require a new chunk in the middle of a build batch
+    void Reserve(VkDeviceSize totalAlignedSize);
+    // Get scratch buffer address, it's aligned by minAccelerationStructureScratchOffsetAlignment
     VkDeviceAddress GetScratchAddress(VkDeviceSize scratchSize);
-    void Reset();
 
-private:
-    void AddChunk(VkDeviceSize size);
+    VkDeviceSize GetAllocatedSize() const;
+    // Maximum size that was used by one region
+    VkDeviceSize GetPeakUsage() const;
 
 private:
-    struct ChunkBuffer
+    struct Chunk
     {
         Buffer buffer;
-        uint32_t currentOffset = 0;
+        VkDeviceAddress alignedAddress = 0;
+        VkDeviceSize alignedSize = 0;
+    };
+
+    struct Region
+    {
+        // only the last one is used for new allocations
+        std::list<Chunk> chunks;
+        VkDeviceSize offset = 0;
+        VkDeviceSize usage = 0;
+        VkDeviceSize peakUsage = 0;
     };
 
+    void ResetRegion(Region &region);
+    void AddChunk(Region &region, VkDeviceSize size);
+
+private:
     std::weak_ptr<MemoryAllocator> allocator;
-    std::list<ChunkBuffer> chunks;
+    VkDeviceSize alignment;
+
+    // a region for each frame in flight, and the last one is for immediate builds
+    std::vector<Region> regions;
+    uint32_t currentRegion;
+    uint32_t regionBeforeImmediate;
 };
 
-}
\ No newline at end of file
+}
@@ -30,7 +30,13 @@
 constexpr RTGL1::SectorArrayIndex::index_t  SECTOR_ARRAY_INDEX_BASE_VALUE = 0;
 
 
-RTGL1::SectorVisibility::SectorVisibility() : lastSectorArrayIndex(SECTOR_ARRAY_INDEX_BASE_VALUE), sectorArrayIndexToID()
+RTGL1::SectorVisibility::SectorVisibility()
+:
+    lastSectorArrayIndex(SECTOR_ARRAY_INDEX_BASE_VALUE),
+    sectorArrayIndexToID(),
+    lastLookupValid(false),
+    lastLookupID{},
+    lastLookupIndex{}
 {
     Reset();
 }
@@ -63,6 +69,8 @@ void RTGL1::SectorVisibility::Reset()
 
     memset(sectorArrayIndexToID, 0, sizeof(sectorArrayIndexToID));
 
+    lastLookupValid = false;
+
     // but always keep potential visibility for sector ID = 0.
     
     SectorID defaultSectorId = { 0 };
@@ -82,6 +90,26 @@ const rgl::unordered_set<RTGL1::SectorArrayIndex> &RTGL1::SectorVisibility::GetP
     return pvs[fromThisSector];
 }
 
+bool RTGL1::SectorVisibility::IsPotentiallyVisible(SectorID fromThisSector, SectorID sector) const
+{
+    if (fromThisSector == sector)
+    {
+        return true;
+    }
+
+    const auto from = sectorIDToArrayIndex.find(fromThisSector);
+    const auto to = sectorIDToArrayIndex.find(sector);
+
+    if (from == sectorIDToArrayIndex.end() || to == sectorIDToArrayIndex.end())
+    {
+        return true;
+    }
+
+    const auto sv = pvs.find(from->second);
+
+    return sv != pvs.end() && sv->second.find(to->second) != sv->second.end();
+}
+
 void RTGL1::SectorVisibility::CheckSize(SectorArrayIndex index, SectorID id) const
 {
     assert(SectorIDToArrayIndex(id) == index);
@@ -117,6 +145,12 @@ RTGL1::SectorArrayIndex RTGL1::SectorVisibility::AssignArrayIndexForID(SectorID
 
 RTGL1::SectorArrayIndex RTGL1::SectorVisibility::SectorIDToArrayIndex(SectorID id) const
 {
+    // array indices of already assigned IDs are not changed until Reset
+    if (lastLookupValid && lastLookupID == id)
+    {
+        return lastLookupIndex;
+    }
+
     const auto &found = sectorIDToArrayIndex.find(id);
 
     if (found == sectorIDToArrayIndex.end())
@@ -126,6 +160,10 @@ RTGL1::SectorArrayIndex RTGL1::SectorVisibility::SectorIDToArrayIndex(SectorID i
                           ". Probably, it wasn't referenced with rgSetPotentialVisibility");
     }
 
+    lastLookupValid = true;
+    lastLookupID = id;
+    lastLookupIndex = found->second;
+
     return found->second;
 }
 
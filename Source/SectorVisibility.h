@@ -46,6 +46,8 @@ public:
 
     bool ArePotentiallyVisibleSectorsExist(SectorArrayIndex forThisSector) const;
     const rgl::unordered_set<SectorArrayIndex> &GetPotentiallyVisibleSectors(SectorArrayIndex fromThisSector);
+    // Sectors that were never referenced in SetPotentialVisibility are treated as visible.
+    bool IsPotentiallyVisible(SectorID fromThisSector, SectorID sector) const;
 
 private:
     void CheckSize(SectorArrayIndex index, SectorID id) const;
@@ -59,6 +61,11 @@ private:
 
     // indexed by SectorArrayIndex::index_t
     SectorID sectorArrayIndexToID[MAX_SECTOR_COUNT];
+
+    // the last successful SectorIDToArrayIndex result, as the same IDs are usually queried in a row
+    mutable bool lastLookupValid;
+    mutable SectorID lastLookupID;
+    mutable SectorArrayIndex lastLookupIndex;
 };
 
 }
\ No newline at end of file
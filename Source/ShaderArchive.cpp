@@ -0,0 +1,168 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ShaderArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "RgException.h"
+#include "zstd.h"
+
+static_assert(sizeof(RTGL1::ShaderArchiveHeader) == 16, "Archive header must be tightly packed");
+static_assert(sizeof(RTGL1::ShaderArchiveEntry) == 88, "Archive entry must be tightly packed");
+
+RTGL1::ShaderArchive::ShaderArchive(const char *pPath, const std::shared_ptr<UserFileLoad> &userFileLoad)
+{
+    if (userFileLoad->Exists())
+    {
+        auto fileHandle = userFileLoad->Open(pPath);
+
+        if (fileHandle.Contains())
+        {
+            Parse(static_cast<const uint8_t *>(fileHandle.pData), fileHandle.dataSize, pPath);
+        }
+    }
+    else
+    {
+        std::ifstream file(pPath, std::ios::binary);
+
+        if (file)
+        {
+            std::vector<uint8_t> data(std::istreambuf_iterator<char>(file), {});
+            Parse(data.data(), data.size(), pPath);
+        }
+    }
+}
+
+void RTGL1::ShaderArchive::Parse(const uint8_t *pFile, size_t fileSize, const char *pPath)
+{
+    using namespace std::string_literals;
+
+    ShaderArchiveHeader header = {};
+
+    if (fileSize < sizeof(header))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Shader archive \""s + pPath + "\" is corrupted");
+    }
+
+    memcpy(&header, pFile, sizeof(header));
+
+    if (header.magic != SHADER_ARCHIVE_MAGIC || header.version != SHADER_ARCHIVE_VERSION)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Shader archive \""s + pPath + "\" has wrong format or version");
+    }
+
+    if (header.entryCount > (fileSize - sizeof(ShaderArchiveHeader)) / sizeof(ShaderArchiveEntry))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Shader archive \""s + pPath + "\" is corrupted");
+    }
+
+    const size_t dataStart = sizeof(ShaderArchiveHeader) + (size_t)header.entryCount * sizeof(ShaderArchiveEntry);
+    const size_t avail = fileSize - dataStart;
+
+    std::vector<ShaderArchiveEntry> entries(header.entryCount);
+    memcpy(entries.data(), pFile + sizeof(ShaderArchiveHeader), entries.size() * sizeof(ShaderArchiveEntry));
+
+    // each module starts at 4-byte aligned position
+    size_t wordCount = 0;
+
+    for (const auto &e : entries)
+    {
+        // compare without addition, so a huge offset can't wrap around
+        if (e.size % sizeof(uint32_t) != 0 || e.compressedSize > avail || e.offset > avail - e.compressedSize)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Shader archive \""s + pPath + "\" is corrupted");
+        }
+
+        wordCount += e.size / sizeof(uint32_t);
+    }
+
+    code.resize(wordCount);
+    size_t dstOffset = 0;
+
+    for (const auto &e : entries)
+    {
+        // name is not required to be null-terminated
+        const char *nameEnd = std::find(e.name, e.name + sizeof(e.name), '\0');
+        const std::string name(e.name, nameEnd);
+
+        const uint8_t *src = pFile + dataStart + e.offset;
+        uint32_t *dst = code.data() + dstOffset;
+
+        if (e.compressedSize == e.size)
+        {
+            memcpy(dst, src, e.size);
+        }
+        else
+        {
+            size_t r = ZSTD_decompress(dst, e.size, src, e.compressedSize);
+
+            if (ZSTD_isError(r) || r != e.size)
+            {
+                throw RgException(RG_WRONG_ARGUMENT, "Shader archive \""s + pPath + "\": can't decompress " + name);
+            }
+        }
+
+        if (HashCode(reinterpret_cast<const uint8_t *>(dst), e.size) != e.hash)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Shader archive \""s + pPath + "\": hash mismatch for " + name);
+        }
+
+        modules[name] = { dstOffset, e.size, e.hash };
+
+        dstOffset += e.size / sizeof(uint32_t);
+    }
+}
+
+bool RTGL1::ShaderArchive::IsEmpty() const
+{
+    return modules.empty();
+}
+
+const uint32_t *RTGL1::ShaderArchive::GetCode(const char *pName, uint32_t *pOutSize, uint64_t *pOutHash) const
+{
+    const auto f = modules.find(pName);
+
+    if (f == modules.end())
+    {
+        return nullptr;
+    }
+
+    *pOutSize = f->second.size;
+    *pOutHash = f->second.hash;
+
+    return code.data() + f->second.offset;
+}
+
+uint64_t RTGL1::ShaderArchive::HashCode(const uint8_t *pData, size_t size)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ull;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        h ^= pData[i];
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "Containers.h"
+#include "UserFunction.h"
+
+namespace RTGL1
+{
+
+// Layout of a shader archive file, all values are little-endian:
+//   ShaderArchiveHeader
+//   ShaderArchiveEntry[entryCount]
+//   data: SPIR-V code of each entry, zstd-compressed if compressedSize != size
+struct ShaderArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct ShaderArchiveEntry
+{
+    // file name of the module, e.g. "RtMiss.rmiss.spv"
+    char name[64];
+    // offset from the beginning of the data section
+    uint64_t offset;
+    uint32_t size;
+    uint32_t compressedSize;
+    // FNV-1a of the uncompressed code
+    uint64_t hash;
+};
+
+constexpr uint32_t SHADER_ARCHIVE_MAGIC = 0x41534752; // "RGSA"
+constexpr uint32_t SHADER_ARCHIVE_VERSION = 1;
+constexpr const char *SHADER_ARCHIVE_FILE_NAME = "Shaders.rgsa";
+
+// Holds SPIR-V code of all modules that were packed into one file,
+// so instead of opening each shader file, only one file is read.
+class ShaderArchive
+{
+public:
+    // If the file doesn't exist, archive is empty
+    explicit ShaderArchive(const char *pPath, const std::shared_ptr<UserFileLoad> &userFileLoad);
+    ~ShaderArchive() = default;
+
+    ShaderArchive(const ShaderArchive &other) = delete;
+    ShaderArchive(ShaderArchive &&other) noexcept = delete;
+    ShaderArchive &operator=(const ShaderArchive &other) = delete;
+    ShaderArchive &operator=(ShaderArchive &&other) noexcept = delete;
+
+    bool IsEmpty() const;
+    // Returns null if there's no module with such file name.
+    // Code is 4-byte aligned and valid while the archive exists.
+    const uint32_t *GetCode(const char *pName, uint32_t *pOutSize, uint64_t *pOutHash) const;
+
+    static uint64_t HashCode(const uint8_t *pData, size_t size);
+
+private:
+    void Parse(const uint8_t *pFile, size_t fileSize, const char *pPath);
+
+private:
+    struct Module
+    {
+        size_t offset;
+        uint32_t size;
+        uint64_t hash;
+    };
+
+    // uncompressed code of all modules
+    std::vector<uint32_t> code;
+    rgl::unordered_map<std::string, Module> modules;
+};
+
+}
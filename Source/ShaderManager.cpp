@@ -20,10 +20,13 @@
 
 #include "ShaderManager.h"
 
+#include <algorithm>
 #include <fstream>
 #include <vector>
 #include <cstring>
+#include "AutoBuffer.h"
 #include "RgException.h"
+#include "ShaderArchive.h"
 
 using namespace RTGL1;
 
@@ -55,6 +58,7 @@ static ShaderModuleDefinition G_SHADERS[] =
     {"VertFullscreenQuad",      "RsFullscreenQuad.vert.spv"            },
     {"FragDepthCopying",        "RsDepthCopying.frag.spv"              },
     {"CVertexPreprocess",       "CmVertexPreprocess.comp.spv"          },
+    {"CSkinning",               "CmSkinning.comp.spv"                  },
     {"CSVGFTemporalAccum",      "CmSVGFTemporalAccumulation.comp.spv"  },
     {"CSVGFVarianceEstim",      "CmSVGFEstimateVariance.comp.spv"      },
     {"CSVGFAtrous",             "CmSVGFAtrous.comp.spv"                },
@@ -62,6 +66,7 @@ static ShaderModuleDefinition G_SHADERS[] =
     {"CASVGFMerging",           "CmASVGFMerging.comp.spv"              },
     {"CASVGFGradientSamples",   "CmASVGFGradientSamples.comp.spv"      },
     {"CASVGFGradientAtrous",    "CmASVGFGradientAtrous.comp.spv"       },
+    {"CIndirectReconstruct",    "CmIndirectReconstruct.comp.spv"       },
     {"CBloomDownsample",        "CmBloomDownsample.comp.spv"           },
     {"CBloomUpsample",          "CmBloomUpsample.comp.spv"             },
     {"CBloomApply",             "CmBloomApply.comp.spv"                },
@@ -75,38 +80,86 @@ static ShaderModuleDefinition G_SHADERS[] =
     {"VertDecal",               "RsDecal.vert.spv"                     },
     {"FragDecal",               "RsDecal.frag.spv"                     },
     {"EffectWipe",                  "EfWipe.comp.spv"                  },
-    {"EffectRadialBlur",            "EfRadialBlur.comp.spv"            },
-    {"EffectChromaticAberration",   "EfChromaticAberration.comp.spv"   },
-    {"EffectInverseBW",             "EfInverseBW.comp.spv"             },
-    {"EffectDistortedSides",        "EfDistortedSides.comp.spv"        },
-    {"EffectColorTint",             "EfColorTint.comp.spv"             },
-    {"EffectHueShift",              "EfHueShift.comp.spv"              },
+    {"EffectSimpleChain",           "EfSimpleChain.comp.spv"           },
     {"EffectCrtDemodulateEncode",   "EfCrtDemodulateEncode.comp.spv"   },
     {"EffectCrtDecode",             "EfCrtDecode.comp.spv"             },
 };
 
 
 ShaderManager::ShaderManager(VkDevice _device, const char *_pShaderFolderPath, std::shared_ptr<UserFileLoad> _userFileLoad)
-    : device(_device), userFileLoad(std::move(_userFileLoad)), shaderFolderPath(_pShaderFolderPath)
+    : device(_device), userFileLoad(std::move(_userFileLoad)), shaderFolderPath(_pShaderFolderPath),
+    reloadFrameIndex(MAX_FRAMES_IN_FLIGHT), usageRecording(nullptr)
 {
     LoadShaderModules();
 }
 
 ShaderManager::~ShaderManager()
 {
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        PrepareForFrame(i);
+    }
+
     UnloadShaderModules();
 }
 
-void ShaderManager::ReloadShaders()
+void ShaderManager::PrepareForFrame(uint32_t frameIndex)
 {
-    vkDeviceWaitIdle(device);
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
 
-    UnloadShaderModules();
-    LoadShaderModules();
+    for (VkShaderModule m : modulesToDestroy[frameIndex])
+    {
+        vkDestroyShaderModule(device, m, nullptr);
+    }
+
+    for (VkPipeline p : pipelinesToDestroy[frameIndex])
+    {
+        vkDestroyPipeline(device, p, nullptr);
+    }
+
+    modulesToDestroy[frameIndex].clear();
+    pipelinesToDestroy[frameIndex].clear();
+    buffersToDestroy[frameIndex].clear();
+}
+
+void ShaderManager::ReloadShaders(uint32_t frameIndex)
+{
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    const auto changedModules = ReloadChangedShaderModules(modulesToDestroy[frameIndex], true);
+
+    if (changedModules.empty())
+    {
+        return;
+    }
+
+    // subscribers recreate their pipelines, and old ones are
+    // destroyed when this frame index is used next time
+    reloadFrameIndex = frameIndex;
+    NotifySubscribersAboutReload(changedModules);
+    reloadFrameIndex = MAX_FRAMES_IN_FLIGHT;
+}
+
+void ShaderManager::DestroyWhenUnused(VkPipeline &pipeline) const
+{
+    assert(reloadFrameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    if (pipeline != VK_NULL_HANDLE)
+    {
+        pipelinesToDestroy[reloadFrameIndex].push_back(pipeline);
+        pipeline = VK_NULL_HANDLE;
+    }
+}
 
-    NotifySubscribersAboutReload();
+void ShaderManager::DestroyWhenUnused(std::shared_ptr<AutoBuffer> &buffer) const
+{
+    assert(reloadFrameIndex < MAX_FRAMES_IN_FLIGHT);
 
-    vkDeviceWaitIdle(device);
+    if (buffer)
+    {
+        buffersToDestroy[reloadFrameIndex].push_back(std::move(buffer));
+        buffer.reset();
+    }
 }
 
 void ShaderManager::LoadShaderModules()
@@ -121,14 +174,75 @@ void ShaderManager::LoadShaderModules()
             // parse stage if needed, it's done only once, as names won't be changing
             s.stage = GetStageByExtension(s.filename);
         }
+    }
+
+    std::vector<VkShaderModule> outdated;
+    ReloadChangedShaderModules(outdated, false);
+
+    assert(outdated.empty());
+}
+
+rgl::unordered_set<std::string> ShaderManager::ReloadChangedShaderModules(std::vector<VkShaderModule> &outdated, bool preferSeparateFiles)
+{
+    // if there's an archive, all modules are read from it at once;
+    // it's read on each reload, as it could be rebuilt
+    const auto archivePath = shaderFolderPath + SHADER_ARCHIVE_FILE_NAME;
+    const ShaderArchive archive(archivePath.c_str(), userFileLoad);
+
+    std::vector<uint8_t> storage;
+
+    // new modules are committed only if all of them were loaded, otherwise
+    // already replaced modules would have new hashes, but their subscribers
+    // wouldn't be notified, and the next reload wouldn't see the change
+    rgl::unordered_map<std::string, ShaderModule> loaded;
+
+    try
+    {
+        for (const auto &s : G_SHADERS)
+        {
+            uint32_t codeSize = 0;
+            uint64_t codeHash = 0;
+            const uint32_t *pCode = GetCode(archive, s.filename, preferSeparateFiles, storage, &codeSize, &codeHash);
+
+            const auto &cur = modules.find(s.name);
+
+            if (cur != modules.end() && cur->second.module != VK_NULL_HANDLE && cur->second.codeHash == codeHash)
+            {
+                continue;
+            }
+
+            VkShaderModule m = LoadModuleFromMemory(pCode, codeSize);
+            SET_DEBUG_NAME(device, m, VK_OBJECT_TYPE_SHADER_MODULE, s.name);
+
+            loaded[s.name] = { m, s.stage, codeHash };
+        }
+    }
+    catch (...)
+    {
+        for (const auto &l : loaded)
+        {
+            vkDestroyShaderModule(device, l.second.module, nullptr);
+        }
+
+        throw;
+    }
 
-        auto path = shaderFolderPath + s.filename;
+    rgl::unordered_set<std::string> changedModules;
 
-        VkShaderModule m = LoadModule(path.c_str());
-        SET_DEBUG_NAME(device, m, VK_OBJECT_TYPE_SHADER_MODULE, s.name);
+    for (auto &l : loaded)
+    {
+        ShaderModule &dst = modules[l.first];
 
-        modules[s.name] = { m, s.stage };
+        if (dst.module != VK_NULL_HANDLE)
+        {
+            outdated.push_back(dst.module);
+        }
+
+        dst = l.second;
+        changedModules.insert(l.first);
     }
+
+    return changedModules;
 }
 
 void ShaderManager::UnloadShaderModules()
@@ -143,18 +257,24 @@ void ShaderManager::UnloadShaderModules()
 
 VkShaderModule ShaderManager::GetShaderModule(const char* name) const
 {
+    RecordUsage(name);
+
     const auto &m = modules.find(name);
     return m != modules.end() ? m->second.module : VK_NULL_HANDLE;
 }
 
 VkShaderStageFlagBits ShaderManager::GetModuleStage(const char* name) const
 {
+    RecordUsage(name);
+
     const auto &m = modules.find(name);
     return m != modules.end() ? m->second.shaderStage : static_cast<VkShaderStageFlagBits>(0);
 }
 
 VkPipelineShaderStageCreateInfo ShaderManager::GetStageInfo(const char *name) const
 {
+    RecordUsage(name);
+
     const auto &m = modules.find(name);
 
     if (m == modules.end())
@@ -174,7 +294,33 @@ VkPipelineShaderStageCreateInfo ShaderManager::GetStageInfo(const char *name) co
     return info;
 }
 
-VkShaderModule RTGL1::ShaderManager::LoadModule(const char *path)
+const uint32_t *ShaderManager::GetCode(
+    const ShaderArchive &archive, const char *filename, bool preferSeparateFiles, std::vector<uint8_t> &storage,
+    uint32_t *pOutSize, uint64_t *pOutHash) const
+{
+    auto path = shaderFolderPath + filename;
+
+    // shaders are recompiled to separate files while developing,
+    // and the archive is rebuilt only on packaging, so it would be stale
+    if (!preferSeparateFiles || !TryLoadCode(path.c_str(), storage))
+    {
+        const uint32_t *pCode = archive.GetCode(filename, pOutSize, pOutHash);
+
+        if (pCode != nullptr)
+        {
+            return pCode;
+        }
+
+        storage = LoadCode(path.c_str());
+    }
+
+    *pOutSize = static_cast<uint32_t>(storage.size());
+    *pOutHash = ShaderArchive::HashCode(storage.data(), storage.size());
+
+    return reinterpret_cast<const uint32_t*>(storage.data());
+}
+
+std::vector<uint8_t> ShaderManager::LoadCode(const char *path) const
 {
     if (userFileLoad->Exists())
     {
@@ -186,15 +332,39 @@ VkShaderModule RTGL1::ShaderManager::LoadModule(const char *path)
             throw RgException(RG_WRONG_ARGUMENT, "Can't load shader file \""s + path + "\" using user's file load function"s);
         }
 
-        return LoadModuleFromMemory(static_cast<const uint32_t*>(fileHandle.pData), fileHandle.dataSize);
+        const auto *pData = static_cast<const uint8_t*>(fileHandle.pData);
+        return std::vector<uint8_t>(pData, pData + fileHandle.dataSize);
+    }
+    else
+    {
+        return LoadCodeFromFile(path);
+    }
+}
+
+bool ShaderManager::TryLoadCode(const char *path, std::vector<uint8_t> &dst) const
+{
+    if (userFileLoad->Exists())
+    {
+        auto fileHandle = userFileLoad->Open(path);
+
+        if (!fileHandle.Contains())
+        {
+            return false;
+        }
+
+        const auto *pData = static_cast<const uint8_t*>(fileHandle.pData);
+        dst.assign(pData, pData + fileHandle.dataSize);
     }
     else
     {
-        return LoadModuleFromFile(path);
+        std::ifstream shaderFile(path, std::ios::binary);
+        dst.assign(std::istreambuf_iterator<char>(shaderFile), {});
     }
+
+    return !dst.empty();
 }
 
-VkShaderModule ShaderManager::LoadModuleFromFile(const char *path)
+std::vector<uint8_t> ShaderManager::LoadCodeFromFile(const char *path) const
 {
     std::ifstream shaderFile(path, std::ios::binary);
     std::vector<uint8_t> shaderSource(std::istreambuf_iterator<char>(shaderFile), {});
@@ -205,7 +375,7 @@ VkShaderModule ShaderManager::LoadModuleFromFile(const char *path)
         throw RgException(RG_WRONG_ARGUMENT, "Can't find shader file: \""s + path + "\"");
     }
 
-    return LoadModuleFromMemory(reinterpret_cast<const uint32_t*>(shaderSource.data()), shaderSource.size());
+    return shaderSource;
 }
 
 VkShaderModule ShaderManager::LoadModuleFromMemory(const uint32_t *pCode, uint32_t codeSize)
@@ -286,14 +456,14 @@ VkShaderStageFlagBits ShaderManager::GetStageByExtension(const char *name)
 
 void ShaderManager::Subscribe(std::shared_ptr<IShaderDependency> subscriber)
 {
-    subscribers.emplace_back(subscriber);
+    subscribers.push_back({ subscriber, {}, false });
 }
 
 void ShaderManager::Unsubscribe(const IShaderDependency *subscriber)
 {
-    subscribers.remove_if([subscriber] (const std::weak_ptr<IShaderDependency> &ws)
+    subscribers.remove_if([subscriber] (const Subscriber &sb)
     {
-        if (const auto s = ws.lock())
+        if (const auto s = sb.dependency.lock())
         {
             return s.get() == subscriber;
         }
@@ -302,13 +472,45 @@ void ShaderManager::Unsubscribe(const IShaderDependency *subscriber)
     });
 }
 
-void ShaderManager::NotifySubscribersAboutReload()
+void ShaderManager::NotifySubscribersAboutReload(const rgl::unordered_set<std::string> &changedModules)
 {
-    for (auto &ws : subscribers)
+    for (auto &sb : subscribers)
     {
-        if (auto s = ws.lock())
+        auto s = sb.dependency.lock();
+
+        if (!s)
         {
-            s->OnShaderReload(this);
+            continue;
         }
+
+        bool isDependent = !sb.isUsageKnown || std::any_of(
+            sb.usedModules.begin(), sb.usedModules.end(),
+            [&changedModules] (const std::string &name)
+            {
+                return changedModules.find(name) != changedModules.end();
+            });
+
+        if (!isDependent)
+        {
+            continue;
+        }
+
+        // remember which modules are used, to skip the subscriber
+        // on the next reload, if they're not changed
+        sb.usedModules.clear();
+        usageRecording = &sb.usedModules;
+
+        s->OnShaderReload(this);
+
+        usageRecording = nullptr;
+        sb.isUsageKnown = true;
+    }
+}
+
+void ShaderManager::RecordUsage(const char *name) const
+{
+    if (usageRecording != nullptr)
+    {
+        usageRecording->insert(name);
     }
 }
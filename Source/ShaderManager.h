@@ -22,6 +22,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include "Common.h"
 #include "Containers.h"
@@ -31,6 +32,9 @@
 namespace RTGL1
 {
 
+class AutoBuffer;
+class ShaderArchive;
+
 // This class provides shader modules by their name
 class ShaderManager
 {
@@ -43,7 +47,17 @@ public:
     ShaderManager& operator=(const ShaderManager& other) = delete;
     ShaderManager& operator=(ShaderManager&& other) noexcept = delete;
 
-    void ReloadShaders();
+    // Destroy objects that were replaced on reload, when frameIndex was used last time
+    void PrepareForFrame(uint32_t frameIndex);
+    // Reload only modules which files were changed, and
+    // recreate only subscribers that use those modules.
+    // Must be called after PrepareForFrame.
+    void ReloadShaders(uint32_t frameIndex);
+
+    // Objects that are replaced in OnShaderReload can be still in use by frames in flight,
+    // so subscribers pass them here instead of destroying. The handle is set to null.
+    void DestroyWhenUnused(VkPipeline &pipeline) const;
+    void DestroyWhenUnused(std::shared_ptr<AutoBuffer> &buffer) const;
 
     VkShaderModule GetShaderModule(const char *name) const;
     VkShaderStageFlagBits GetModuleStage(const char *name) const;
@@ -59,18 +73,42 @@ private:
     {
         VkShaderModule module;
         VkShaderStageFlagBits shaderStage;
+        // to check if the file was changed
+        uint64_t codeHash;
+    };
+
+    struct Subscriber
+    {
+        std::weak_ptr<IShaderDependency> dependency;
+        // names of modules that were requested by the subscriber
+        // during its last OnShaderReload call
+        rgl::unordered_set<std::string> usedModules;
+        // if false, subscriber wasn't reloaded yet, so it's
+        // assumed that it depends on every module
+        bool isUsageKnown;
     };
 
 private:
     static VkShaderStageFlagBits GetStageByExtension(const char *name);
 
-    VkShaderModule LoadModule(const char *path);
-    VkShaderModule LoadModuleFromFile(const char *path);
+    // Get code from the archive, or if it's not there, load from a separate file to 'storage'.
+    // If 'preferSeparateFiles', a separate file is checked first, and the archive is a fallback.
+    const uint32_t *GetCode(
+        const ShaderArchive &archive, const char *filename, bool preferSeparateFiles, std::vector<uint8_t> &storage,
+        uint32_t *pOutSize, uint64_t *pOutHash) const;
+    std::vector<uint8_t> LoadCode(const char *path) const;
+    // Returns false, if there's no such file
+    bool TryLoadCode(const char *path, std::vector<uint8_t> &dst) const;
+    std::vector<uint8_t> LoadCodeFromFile(const char *path) const;
     VkShaderModule LoadModuleFromMemory(const uint32_t *pCode, uint32_t codeSize);
     void LoadShaderModules();
     void UnloadShaderModules();
+    // Returns names of modules that were recreated, their old
+    // versions are moved to 'outdated' to be destroyed by the caller
+    rgl::unordered_set<std::string> ReloadChangedShaderModules(std::vector<VkShaderModule> &outdated, bool preferSeparateFiles);
 
-    void NotifySubscribersAboutReload();
+    void NotifySubscribersAboutReload(const rgl::unordered_set<std::string> &changedModules);
+    void RecordUsage(const char *name) const;
 
 private:
     VkDevice device;
@@ -79,7 +117,15 @@ private:
 
     rgl::unordered_map<std::string, ShaderModule> modules;
 
-    std::list<std::weak_ptr<IShaderDependency>> subscribers;
+    // valid only while subscribers are notified
+    uint32_t reloadFrameIndex;
+    std::vector<VkShaderModule> modulesToDestroy[MAX_FRAMES_IN_FLIGHT];
+    mutable std::vector<VkPipeline> pipelinesToDestroy[MAX_FRAMES_IN_FLIGHT];
+    mutable std::vector<std::shared_ptr<AutoBuffer>> buffersToDestroy[MAX_FRAMES_IN_FLIGHT];
+
+    std::list<Subscriber> subscribers;
+    // if not null, names of requested modules are written to it
+    mutable rgl::unordered_set<std::string> *usageRecording;
 };
 
 }
\ No newline at end of file
@@ -23,9 +23,12 @@ import sys
 import os
 import subprocess
 import pathlib
+import struct
 
 
 CACHE_FOLDER_PATH           = "Build/"
+OUTPUT_FOLDER_PATH          = "../../Build/"
+ARCHIVE_FILE_NAME           = "Shaders.rgsa"
 CACHE_FILE_NAME             = "GenerateShadersCache.txt"
 EXTENSIONS                  = [ ".comp", ".vert", "frag", ".rgen", ".rahit", ".rchit", ".rmiss" ]
 DEPENDENCY_EXTENSIONS       = [ ".h", ".inl" ]
@@ -63,6 +66,60 @@ def printInPowerShell(msg, color):
     ])
 
 
+# Must be in sync with ShaderArchive.h
+ARCHIVE_MAGIC               = 0x41534752
+ARCHIVE_VERSION             = 1
+ARCHIVE_ENTRY_NAME_SIZE     = 64
+
+
+def hashCode(data):
+    # FNV-1a
+    h = 14695981039346656037
+    for b in data:
+        h ^= b
+        h = (h * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def packShaders(compress):
+    if compress:
+        try:
+            import zstandard
+        except ImportError:
+            print("> Python module \"zstandard\" is not found, archive won't be compressed")
+            compress = False
+
+    names = sorted([f for f in os.listdir(OUTPUT_FOLDER_PATH) if f.endswith(".spv")])
+
+    entries = b""
+    entryCount = 0
+    data = b""
+
+    for name in names:
+        if len(name) >= ARCHIVE_ENTRY_NAME_SIZE:
+            print("> Shader file name \"" + name + "\" is too long for the archive. Skipping.")
+            continue
+
+        with open(OUTPUT_FOLDER_PATH + name, "rb") as f:
+            code = f.read()
+
+        packed = zstandard.ZstdCompressor(level=19).compress(code) if compress else code
+        # store uncompressed, if compression doesn't help
+        if len(packed) >= len(code):
+            packed = code
+
+        entries += struct.pack("<64sQIIQ", name.encode("ascii"), len(data), len(code), len(packed), hashCode(code))
+        data += packed
+        entryCount += 1
+
+    header = struct.pack("<IIII", ARCHIVE_MAGIC, ARCHIVE_VERSION, entryCount, 0)
+
+    with open(OUTPUT_FOLDER_PATH + ARCHIVE_FILE_NAME, "wb") as f:
+        f.write(header + entries + data)
+
+    print("> Packed " + str(entryCount) + " shaders to " + ARCHIVE_FILE_NAME)
+
+
 def getDependentFoldersProcArg():
     return [a for p in DEPENDENCY_FOLDERS if p != "" for a in ("-I", p)]
 
@@ -94,6 +151,8 @@ def main():
         print("-rebuild  : clear cache and rebuild all shaders")
         print("-gencomm  : invoke GenerateShaderCommon.py script")
         print("-psout    : use PowerShell for printing colored output")
+        print("-pack     : pack all built shaders into one archive file")
+        print("-packzstd : same as \"-pack\", but compress shaders with zstd")
         print("-r        : same as \"-rebuild\"")
         print("-g        : same as \"-gencomm\"")
         print("-ps       : same as \"-psout\"")
@@ -101,6 +160,8 @@ def main():
 
     forceRebuild = False
     powerShellOutput = False
+    pack = "-pack" in sys.argv or "--pack" in sys.argv
+    packZstd = "-packzstd" in sys.argv or "--packzstd" in sys.argv
     if "-rebuild" in sys.argv or "--rebuild" in sys.argv or "-r" in sys.argv or "--r" in sys.argv:
         forceRebuild = True
     if "-gencomm" in sys.argv or "--gencomm" in sys.argv or "-g" in sys.argv or "--g" in sys.argv:
@@ -239,7 +300,7 @@ def main():
                 "glslc", "--target-env=vulkan1.2"
                 ] + getDependentFoldersProcArg() + [
                 filename, 
-                "-o", "../../Build/" + os.path.basename(filename) + ".spv"], 
+                "-o", OUTPUT_FOLDER_PATH + os.path.basename(filename) + ".spv"], 
                 stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
 
             if len(r.stdout) > 0:
@@ -267,6 +328,9 @@ def main():
     #if wereDependentModified:
     #    print()
 
+    if (pack or packZstd) and msgErrorCount == 0:
+        packShaders(packZstd)
+
     msg = ""
     color = ""
 
@@ -50,7 +50,7 @@ void main()
     // Z points from surface to outside
     const vec2 texCoord = localPosition.xy + 0.5;
 
-    const vec4 decalAlbedo = getTextureSample(decal.textureAlbedoAlpha, texCoord);
+    const vec4 decalAlbedo = getTextureSample(resolveAnimatedTexture(decal.textureAlbedoAlpha, MATERIAL_ALBEDO_ALPHA_INDEX), texCoord);
 
     outAlbedo = decalAlbedo;
 }
\ No newline at end of file
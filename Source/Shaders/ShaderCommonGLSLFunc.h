@@ -55,6 +55,27 @@ layout(
 {
     ShGlobalUniform globalUniform;
 };
+
+// Texture indices of an animated material reference its slot in the animated material table,
+// so frame changes don't require to update geometry instances.
+// "textureType" is MATERIAL_*_INDEX
+uint resolveAnimatedTexture(uint textureIndex, int textureType)
+{
+    if ((textureIndex & uint(MATERIAL_ANIMATED_SLOT_FLAG)) != 0)
+    {
+        return globalUniform.animatedMaterialTextures[textureIndex & ~uint(MATERIAL_ANIMATED_SLOT_FLAG)][textureType];
+    }
+
+    return textureIndex;
+}
+
+uvec3 resolveAnimatedMaterial(uvec3 m)
+{
+    return uvec3(
+        resolveAnimatedTexture(m[0], MATERIAL_ALBEDO_ALPHA_INDEX),
+        resolveAnimatedTexture(m[1], MATERIAL_ROUGHNESS_METALLIC_EMISSION_INDEX),
+        resolveAnimatedTexture(m[2], MATERIAL_NORMAL_INDEX));
+}
 #endif // DESC_SET_GLOBAL_UNIFORM
 
 
@@ -254,12 +275,19 @@ layout(set = DESC_SET_DECALS, binding = BINDING_DECAL_INSTANCES) buffer DecalIns
 
 #ifdef DESC_SET_GLOBAL_UNIFORM
 #ifdef DESC_SET_FRAMEBUFFERS
+// "pix" is a checkerboarded pixel, each of the checkerboard halves is reprojected
+// separately; render size of the previous frame can be different with a dynamic resolution
 vec2 getPrevScreenPos(const vec2 motionCurToPrev, const ivec2 pix)
 {
-    const vec2 screenSize = vec2(globalUniform.renderWidth / float(CHECKERBOARD_SEPARATOR_DIVISOR), globalUniform.renderHeight);
-    const vec2 invScreenSize = vec2(1.0 / screenSize.x, 1.0 / screenSize.y);
-   
-    return ((vec2(pix) + vec2(0.5)) * invScreenSize + motionCurToPrev) * screenSize;
+    const vec2 screenSize     = vec2(globalUniform.renderWidth     / float(CHECKERBOARD_SEPARATOR_DIVISOR), globalUniform.renderHeight);
+    const vec2 prevScreenSize = vec2(globalUniform.prevRenderWidth / float(CHECKERBOARD_SEPARATOR_DIVISOR), globalUniform.prevRenderHeight);
+
+    const float isOdd = float(pix.x >= int(screenSize.x));
+    const vec2 halfPix = vec2(pix) - vec2(isOdd * screenSize.x, 0.0);
+
+    const vec2 prevUV = (halfPix + vec2(0.5)) / screenSize + motionCurToPrev;
+
+    return prevUV * prevScreenSize + vec2(isOdd * prevScreenSize.x, 0.0);
 }
 
 vec2 getPrevScreenPos(sampler2D motionSampler, const ivec2 pix)
@@ -346,6 +374,21 @@ ivec3 getCheckerboardedRenderArea(const ivec2 checkerboardPix)
         CHECKERBOARD_FULL_HEIGHT
     );
 }
+
+#ifdef DESC_SET_GLOBAL_UNIFORM
+// Render area of the previous frame for a checkerboarded pixel of the current frame
+ivec3 getPrevCheckerboardedRenderArea(const ivec2 checkerboardPix)
+{
+    const int prevSep = int(globalUniform.prevRenderWidth) / CHECKERBOARD_SEPARATOR_DIVISOR;
+    const int isOdd = isCheckerboardPixOdd(checkerboardPix);
+
+    return ivec3(
+        (isOdd + 0) * prevSep,
+        (isOdd + 1) * prevSep,
+        int(globalUniform.prevRenderHeight)
+    );
+}
+#endif // DESC_SET_GLOBAL_UNIFORM
 #endif // CHECKERBOARD_FULL_HEIGHT
 #endif // CHECKERBOARD_FULL_WIDTH
 
@@ -543,6 +586,16 @@ vec4 texelFetchAlbedo(const ivec2 pix)
 #endif // CHECKERBOARD_FULL_HEIGHT
 #endif // CHECKERBOARD_FULL_WIDTH
 
+#ifdef DESC_SET_GLOBAL_UNIFORM
+// render-size framebufs can be larger than the rendered area,
+// so UV in [0..1] range of that area must be scaled for sampling
+vec2 getRenderFramebufUV(const vec2 uv)
+{
+    return uv * vec2(globalUniform.renderWidth  / globalUniform.renderAllocatedWidth,
+                     globalUniform.renderHeight / globalUniform.renderAllocatedHeight);
+}
+#endif
+
 #ifndef FRAMEBUF_IGNORE_ATTACHMENTS
 vec4 textureLodAlbedo(const vec2 uv)
 {
@@ -570,4 +623,52 @@ bool isSky(const vec4 albedo)
     return albedo.a < 0.0;
 }
 
+#ifdef DESC_SET_GLOBAL_UNIFORM
+// If indirect illumination is not traced for every pixel,
+// the pattern changes each frame, so temporal accumulation covers all pixels
+ivec2 getIndirectHalfPatternOffset()
+{
+    const ivec2 offsets[4] = { ivec2(0, 0), ivec2(1, 1), ivec2(1, 0), ivec2(0, 1) };
+    return offsets[globalUniform.frameId % 4];
+}
+
+ivec2 getIndirectPatternPix(const uvec2 patternPix)
+{
+    switch (globalUniform.indirectIlluminationMode)
+    {
+        case INDIRECT_ILLUMINATION_MODE_CHECKERBOARD:   return ivec2(patternPix.x * 2 + ((patternPix.y + globalUniform.frameId) & 1), patternPix.y);
+        case INDIRECT_ILLUMINATION_MODE_HALF:           return ivec2(patternPix * 2) + getIndirectHalfPatternOffset();
+        default:                                        return ivec2(patternPix);
+    }
+}
+
+bool isIndirectPatternPix(const ivec2 pix)
+{
+    switch (globalUniform.indirectIlluminationMode)
+    {
+        case INDIRECT_ILLUMINATION_MODE_CHECKERBOARD:   return ((pix.x + pix.y + int(globalUniform.frameId)) & 1) == 0;
+        case INDIRECT_ILLUMINATION_MODE_HALF:           return (pix & 1) == getIndirectHalfPatternOffset();
+        default:                                        return true;
+    }
+}
+
+bool isGradientSamplePix(const ivec2 pix)
+{
+#if GRADIENT_ESTIMATION_ENABLED
+    const uint grFB = texelFetch(framebufGradientSamples_Sampler, pix / COMPUTE_ASVGF_STRATA_SIZE, 0).x;
+
+    return (pix.x % COMPUTE_ASVGF_STRATA_SIZE) == (grFB % COMPUTE_ASVGF_STRATA_SIZE) &&
+           (pix.y % COMPUTE_ASVGF_STRATA_SIZE) == (grFB / COMPUTE_ASVGF_STRATA_SIZE);
+#else
+    return false;
+#endif
+}
+
+// Gradient samples are always traced, as they must be compared to the previous frame
+bool isIndirectTracedPix(const ivec2 pix)
+{
+    return isIndirectPatternPix(pix) || isGradientSamplePix(pix);
+}
+#endif // DESC_SET_GLOBAL_UNIFORM
+
 #endif // DESC_SET_FRAMEBUFFERS
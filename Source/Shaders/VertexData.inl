@@ -20,6 +20,9 @@
 
 #ifdef DESC_SET_GLOBAL_UNIFORM
 #ifdef DESC_SET_VERTEX_DATA
+// Vertex buffers are arrays of attribute arrays (positions, normals, tex coords),
+// their capacity is set at runtime, so attribute offsets (in floats) are in the global uniform.
+// Positions are always at the beginning.
 layout(
     set = DESC_SET_VERTEX_DATA,
     binding = BINDING_VERTEX_BUFFER_STATIC)
@@ -28,7 +31,7 @@ layout(
     #endif
     buffer VertexBufferStatic_BT
 {
-    ShVertexBufferStatic staticVertices;
+    float staticVertices[];
 };
 
 layout(
@@ -39,7 +42,7 @@ layout(
     #endif
     buffer VertexBufferDynamic_BT
 {
-    ShVertexBufferDynamic dynamicVertices;
+    float dynamicVertices[];
 };
 
 layout(
@@ -106,120 +109,168 @@ layout(
     readonly 
     buffer PerTriangleInfo_BT
 {
-    uint triangleSectorIndices[];
+    // for each geometry: run count, first primitive of each run, sector array index of each run
+    uint triangleSectorRuns[];
+};
+
+// Pool of resident meshes' vertex data; attribute arrays have constant capacity,
+// MAX_MESH_POOL_VERTEX_COUNT, and the same strides as in the vertex buffers above
+layout(
+    set = DESC_SET_VERTEX_DATA,
+    binding = BINDING_MESH_VERTEX_BUFFER)
+    readonly 
+    buffer MeshVertexBuffer_BT
+{
+    float meshVertices[];
+};
+
+layout(
+    set = DESC_SET_VERTEX_DATA,
+    binding = BINDING_MESH_INDEX_BUFFER)
+    readonly 
+    buffer MeshIndexBuffer_BT
+{
+    uint meshIndices[];
 };
 
 vec3 getStaticVerticesPositions(uint index)
 {
     return vec3(
-        staticVertices.positions[index * globalUniform.positionsStride + 0],
-        staticVertices.positions[index * globalUniform.positionsStride + 1],
-        staticVertices.positions[index * globalUniform.positionsStride + 2]);
+        staticVertices[index * globalUniform.positionsStride + 0],
+        staticVertices[index * globalUniform.positionsStride + 1],
+        staticVertices[index * globalUniform.positionsStride + 2]);
 }
 
 vec3 getStaticVerticesNormals(uint index)
 {
     return vec3(
-        staticVertices.normals[index * globalUniform.normalsStride + 0],
-        staticVertices.normals[index * globalUniform.normalsStride + 1],
-        staticVertices.normals[index * globalUniform.normalsStride + 2]);
+        staticVertices[globalUniform.staticNormalsOffset + index * globalUniform.normalsStride + 0],
+        staticVertices[globalUniform.staticNormalsOffset + index * globalUniform.normalsStride + 1],
+        staticVertices[globalUniform.staticNormalsOffset + index * globalUniform.normalsStride + 2]);
 }
 
 vec2 getStaticVerticesTexCoords(uint index)
 {
     return vec2(
-        staticVertices.texCoords[index * globalUniform.texCoordsStride + 0],
-        staticVertices.texCoords[index * globalUniform.texCoordsStride + 1]);
+        staticVertices[globalUniform.staticTexCoordsOffset + index * globalUniform.texCoordsStride + 0],
+        staticVertices[globalUniform.staticTexCoordsOffset + index * globalUniform.texCoordsStride + 1]);
 }
 
 vec2 getStaticVerticesTexCoordsLayer1(uint index)
 {
     return vec2(
-        staticVertices.texCoordsLayer1[index * globalUniform.texCoordsStride + 0],
-        staticVertices.texCoordsLayer1[index * globalUniform.texCoordsStride + 1]);
+        staticVertices[globalUniform.staticTexCoordsLayer1Offset + index * globalUniform.texCoordsStride + 0],
+        staticVertices[globalUniform.staticTexCoordsLayer1Offset + index * globalUniform.texCoordsStride + 1]);
 }
 
 vec2 getStaticVerticesTexCoordsLayer2(uint index)
 {
     return vec2(
-        staticVertices.texCoordsLayer2[index * globalUniform.texCoordsStride + 0],
-        staticVertices.texCoordsLayer2[index * globalUniform.texCoordsStride + 1]);
+        staticVertices[globalUniform.staticTexCoordsLayer2Offset + index * globalUniform.texCoordsStride + 0],
+        staticVertices[globalUniform.staticTexCoordsLayer2Offset + index * globalUniform.texCoordsStride + 1]);
 }
 
 vec3 getDynamicVerticesPositions(uint index)
 {
     return vec3(
-        dynamicVertices.positions[index * globalUniform.positionsStride + 0],
-        dynamicVertices.positions[index * globalUniform.positionsStride + 1],
-        dynamicVertices.positions[index * globalUniform.positionsStride + 2]);
+        dynamicVertices[index * globalUniform.positionsStride + 0],
+        dynamicVertices[index * globalUniform.positionsStride + 1],
+        dynamicVertices[index * globalUniform.positionsStride + 2]);
 }
 
 vec3 getDynamicVerticesNormals(uint index)
 {
     return vec3(
-        dynamicVertices.normals[index * globalUniform.normalsStride + 0],
-        dynamicVertices.normals[index * globalUniform.normalsStride + 1],
-        dynamicVertices.normals[index * globalUniform.normalsStride + 2]);
+        dynamicVertices[globalUniform.dynamicNormalsOffset + index * globalUniform.normalsStride + 0],
+        dynamicVertices[globalUniform.dynamicNormalsOffset + index * globalUniform.normalsStride + 1],
+        dynamicVertices[globalUniform.dynamicNormalsOffset + index * globalUniform.normalsStride + 2]);
 }
 
 vec2 getDynamicVerticesTexCoords(uint index)
 {
     return vec2(
-        dynamicVertices.texCoords[index * globalUniform.texCoordsStride + 0],
-        dynamicVertices.texCoords[index * globalUniform.texCoordsStride + 1]);
+        dynamicVertices[globalUniform.dynamicTexCoordsOffset + index * globalUniform.texCoordsStride + 0],
+        dynamicVertices[globalUniform.dynamicTexCoordsOffset + index * globalUniform.texCoordsStride + 1]);
+}
+
+vec3 getMeshVerticesPositions(uint index)
+{
+    return vec3(
+        meshVertices[index * globalUniform.positionsStride + 0],
+        meshVertices[index * globalUniform.positionsStride + 1],
+        meshVertices[index * globalUniform.positionsStride + 2]);
+}
+
+vec3 getMeshVerticesNormals(uint index)
+{
+    const uint normalsOffset = MAX_MESH_POOL_VERTEX_COUNT * globalUniform.positionsStride;
+
+    return vec3(
+        meshVertices[normalsOffset + index * globalUniform.normalsStride + 0],
+        meshVertices[normalsOffset + index * globalUniform.normalsStride + 1],
+        meshVertices[normalsOffset + index * globalUniform.normalsStride + 2]);
+}
+
+vec2 getMeshVerticesTexCoords(uint index)
+{
+    const uint texCoordsOffset = MAX_MESH_POOL_VERTEX_COUNT * (globalUniform.positionsStride + globalUniform.normalsStride);
+
+    return vec2(
+        meshVertices[texCoordsOffset + index * globalUniform.texCoordsStride + 0],
+        meshVertices[texCoordsOffset + index * globalUniform.texCoordsStride + 1]);
 }
 
 #ifdef VERTEX_BUFFER_WRITEABLE
 void setStaticVerticesPositions(uint index, vec3 value)
 {
-    staticVertices.positions[index * globalUniform.positionsStride + 0] = value[0];
-    staticVertices.positions[index * globalUniform.positionsStride + 1] = value[1];
-    staticVertices.positions[index * globalUniform.positionsStride + 2] = value[2];
+    staticVertices[index * globalUniform.positionsStride + 0] = value[0];
+    staticVertices[index * globalUniform.positionsStride + 1] = value[1];
+    staticVertices[index * globalUniform.positionsStride + 2] = value[2];
 }
 
 void setStaticVerticesNormals(uint index, vec3 value)
 {
-    staticVertices.normals[index * globalUniform.normalsStride + 0] = value[0];
-    staticVertices.normals[index * globalUniform.normalsStride + 1] = value[1];
-    staticVertices.normals[index * globalUniform.normalsStride + 2] = value[2];
+    staticVertices[globalUniform.staticNormalsOffset + index * globalUniform.normalsStride + 0] = value[0];
+    staticVertices[globalUniform.staticNormalsOffset + index * globalUniform.normalsStride + 1] = value[1];
+    staticVertices[globalUniform.staticNormalsOffset + index * globalUniform.normalsStride + 2] = value[2];
 }
 
 void setStaticVerticesTexCoords(uint index, vec2 value)
 {
-    staticVertices.texCoords[index * globalUniform.texCoordsStride + 0] = value[0];
-    staticVertices.texCoords[index * globalUniform.texCoordsStride + 1] = value[1];
+    staticVertices[globalUniform.staticTexCoordsOffset + index * globalUniform.texCoordsStride + 0] = value[0];
+    staticVertices[globalUniform.staticTexCoordsOffset + index * globalUniform.texCoordsStride + 1] = value[1];
 }
 
 void setStaticVerticesTexCoordsLayer1(uint index, vec2 value)
 {
-    staticVertices.texCoordsLayer1[index * globalUniform.texCoordsStride + 0] = value[0];
-    staticVertices.texCoordsLayer1[index * globalUniform.texCoordsStride + 1] = value[1];
+    staticVertices[globalUniform.staticTexCoordsLayer1Offset + index * globalUniform.texCoordsStride + 0] = value[0];
+    staticVertices[globalUniform.staticTexCoordsLayer1Offset + index * globalUniform.texCoordsStride + 1] = value[1];
 }
 
 void setStaticVerticesTexCoordsLayer2(uint index, vec2 value)
 {
-    staticVertices.texCoordsLayer2[index * globalUniform.texCoordsStride + 0] = value[0];
-    staticVertices.texCoordsLayer2[index * globalUniform.texCoordsStride + 1] = value[1];
+    staticVertices[globalUniform.staticTexCoordsLayer2Offset + index * globalUniform.texCoordsStride + 0] = value[0];
+    staticVertices[globalUniform.staticTexCoordsLayer2Offset + index * globalUniform.texCoordsStride + 1] = value[1];
 }
 
 void setDynamicVerticesPositions(uint index, vec3 value)
 {
-    dynamicVertices.positions[index * globalUniform.positionsStride + 0] = value[0];
-    dynamicVertices.positions[index * globalUniform.positionsStride + 1] = value[1];
-    dynamicVertices.positions[index * globalUniform.positionsStride + 2] = value[2];
+    dynamicVertices[index * globalUniform.positionsStride + 0] = value[0];
+    dynamicVertices[index * globalUniform.positionsStride + 1] = value[1];
+    dynamicVertices[index * globalUniform.positionsStride + 2] = value[2];
 }
 
 void setDynamicVerticesNormals(uint index, vec3 value)
 {
-    dynamicVertices.normals[index * globalUniform.normalsStride + 0] = value[0];
-    dynamicVertices.normals[index * globalUniform.normalsStride + 1] = value[1];
-    dynamicVertices.normals[index * globalUniform.normalsStride + 2] = value[2];
+    dynamicVertices[globalUniform.dynamicNormalsOffset + index * globalUniform.normalsStride + 0] = value[0];
+    dynamicVertices[globalUniform.dynamicNormalsOffset + index * globalUniform.normalsStride + 1] = value[1];
+    dynamicVertices[globalUniform.dynamicNormalsOffset + index * globalUniform.normalsStride + 2] = value[2];
 }
 
 void setDynamicVerticesTexCoords(uint index, vec2 value)
 {
-    dynamicVertices.texCoords[index * globalUniform.texCoordsStride + 0] = value[0];
-    dynamicVertices.texCoords[index * globalUniform.texCoordsStride + 1] = value[1];
+    dynamicVertices[globalUniform.dynamicTexCoordsOffset + index * globalUniform.texCoordsStride + 0] = value[0];
+    dynamicVertices[globalUniform.dynamicTexCoordsOffset + index * globalUniform.texCoordsStride + 1] = value[1];
 }
 #endif // VERTEX_BUFFER_WRITEABLE
 
@@ -262,6 +313,25 @@ uvec3 getVertIndicesDynamic(uint baseVertexIndex, uint baseIndexIndex, uint prim
     }
 }
 
+uvec3 getVertIndicesMesh(uint baseVertexIndex, uint baseIndexIndex, uint primitiveId)
+{
+    // if to use indices
+    if (baseIndexIndex != UINT32_MAX)
+    {
+        return uvec3(
+            baseVertexIndex + meshIndices[baseIndexIndex + primitiveId * 3 + 0],
+            baseVertexIndex + meshIndices[baseIndexIndex + primitiveId * 3 + 1],
+            baseVertexIndex + meshIndices[baseIndexIndex + primitiveId * 3 + 2]);
+    }
+    else
+    {
+        return uvec3(
+            baseVertexIndex + primitiveId * 3 + 0,
+            baseVertexIndex + primitiveId * 3 + 1,
+            baseVertexIndex + primitiveId * 3 + 2);
+    }
+}
+
 // Only for dynamic, static geom vertices are not changed.
 uvec3 getPrevVertIndicesDynamic(uint prevBaseVertexIndex, uint prevBaseIndexIndex, uint primitiveId)
 {
@@ -364,6 +434,28 @@ ShTriangle getTriangleDynamic(uvec3 vertIndices, uint baseVertexIndex, uint base
     return tr;
 }
 
+ShTriangle getTriangleMesh(uvec3 vertIndices)
+{
+    ShTriangle tr;
+
+    tr.positions[0] = getMeshVerticesPositions(vertIndices[0]);
+    tr.positions[1] = getMeshVerticesPositions(vertIndices[1]);
+    tr.positions[2] = getMeshVerticesPositions(vertIndices[2]);
+
+    tr.normals[0] = getMeshVerticesNormals(vertIndices[0]);
+    tr.normals[1] = getMeshVerticesNormals(vertIndices[1]);
+    tr.normals[2] = getMeshVerticesNormals(vertIndices[2]);
+
+    tr.layerTexCoord[0][0] = getMeshVerticesTexCoords(vertIndices[0]);
+    tr.layerTexCoord[0][1] = getMeshVerticesTexCoords(vertIndices[1]);
+    tr.layerTexCoord[0][2] = getMeshVerticesTexCoords(vertIndices[2]);
+
+    // get very coarse normal for triangle to determine bitangent's handedness
+    tr.tangent = getTangent(tr.positions, safeNormalize(tr.normals[0] + tr.normals[1] + tr.normals[2]), tr.layerTexCoord[0]);
+
+    return tr;
+}
+
 // Get geometry index in "geometryInstances" array by instanceID, localGeometryIndex.
 int getGeometryIndex(int instanceID, int localGeometryIndex)
 {
@@ -382,6 +474,34 @@ bool getCurrentGeometryIndexByPrev(int prevInstanceID, int prevLocalGeometryInde
     return curFrameGlobalGeomIndex != UINT32_MAX;
 }
 
+// Find a run that contains the primitive. Runs are sorted by their first primitive,
+// and the first one always starts at 0.
+uint getTriangleSectorArrayIndex(uint triangleArrayIndex, int primitiveId)
+{
+    const uint runCount = triangleSectorRuns[triangleArrayIndex];
+    const uint runStarts = triangleArrayIndex + 1;
+    const uint runSectors = runStarts + runCount;
+
+    uint lo = 0;
+    uint hi = runCount - 1;
+
+    while (lo < hi)
+    {
+        const uint mid = (lo + hi + 1) / 2;
+
+        if (triangleSectorRuns[runStarts + mid] <= uint(primitiveId))
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    return triangleSectorRuns[runSectors + lo];
+}
+
 /*#define GEOMETRY_INSTANCE_TEXTURE_SET_SIZE 3
 
 uvec3 getGeometryInstanceMaterialLayer(const ShGeometryInstance inst, int layer)
@@ -404,15 +524,57 @@ ShTriangle getTriangle(int instanceID, int instanceCustomIndex, int localGeometr
     const ShGeometryInstance inst = geometryInstances[globalGeometryIndex];
 
     const bool isDynamic = (instanceCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC) == INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC;
+    const bool isResidentMesh = (inst.flags & GEOM_INST_FLAG_RESIDENT_MESH) != 0;
+
+    if (isResidentMesh)
+    {
+        const uvec3 vertIndices = getVertIndicesMesh(inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
+
+        tr = getTriangleMesh(vertIndices);
+
+        // only one material, as for dynamic geometry
+        tr.materials[0] = resolveAnimatedMaterial(uvec3(inst.materials0A, inst.materials0B, inst.materials0C));
+        tr.materials[1] = uvec3(MATERIAL_NO_TEXTURE);
+        tr.materials[2] = uvec3(MATERIAL_NO_TEXTURE);
+        
+        tr.materialColors[0] = inst.materialColors[0];
+
+        const vec4 localPos[] =
+        {
+            vec4(tr.positions[0], 1.0),
+            vec4(tr.positions[1], 1.0),
+            vec4(tr.positions[2], 1.0),
+        };
+
+        // to world space
+        tr.positions[0] = (inst.model * localPos[0]).xyz;
+        tr.positions[1] = (inst.model * localPos[1]).xyz;
+        tr.positions[2] = (inst.model * localPos[2]).xyz;
+
+        const bool hasPrevInfo = inst.prevBaseVertexIndex != UINT32_MAX;
 
-    if (isDynamic)
+        // mesh's local positions are constant, only model matrices are changing
+        if (hasPrevInfo)
+        {
+            tr.prevPositions[0] = (inst.prevModel * localPos[0]).xyz;
+            tr.prevPositions[1] = (inst.prevModel * localPos[1]).xyz;
+            tr.prevPositions[2] = (inst.prevModel * localPos[2]).xyz;
+        }
+        else
+        {
+            tr.prevPositions[0] = tr.positions[0];
+            tr.prevPositions[1] = tr.positions[1];
+            tr.prevPositions[2] = tr.positions[2];
+        }
+    }
+    else if (isDynamic)
     {
         const uvec3 vertIndices = getVertIndicesDynamic(inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
 
         tr = getTriangleDynamic(vertIndices, inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
 
         // only one material for dynamic geometry
-        tr.materials[0] = uvec3(inst.materials0A, inst.materials0B, inst.materials0C);
+        tr.materials[0] = resolveAnimatedMaterial(uvec3(inst.materials0A, inst.materials0B, inst.materials0C));
         tr.materials[1] = uvec3(MATERIAL_NO_TEXTURE);
         tr.materials[2] = uvec3(MATERIAL_NO_TEXTURE);
         
@@ -454,9 +616,9 @@ ShTriangle getTriangle(int instanceID, int instanceCustomIndex, int localGeometr
 
         tr = getTriangleStatic(vertIndices, inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
 
-        tr.materials[0] = uvec3(inst.materials0A, inst.materials0B, inst.materials0C);
-        tr.materials[1] = uvec3(inst.materials1A, inst.materials1B, inst.materials1C);
-        tr.materials[2] = uvec3(inst.materials2A, inst.materials2B, MATERIAL_NO_TEXTURE);
+        tr.materials[0] = resolveAnimatedMaterial(uvec3(inst.materials0A, inst.materials0B, inst.materials0C));
+        tr.materials[1] = resolveAnimatedMaterial(uvec3(inst.materials1A, inst.materials1B, inst.materials1C));
+        tr.materials[2] = resolveAnimatedMaterial(uvec3(inst.materials2A, inst.materials2B, MATERIAL_NO_TEXTURE));
 
         tr.materialColors[0] = inst.materialColors[0];
         tr.materialColors[1] = inst.materialColors[1];
@@ -515,7 +677,7 @@ ShTriangle getTriangle(int instanceID, int instanceCustomIndex, int localGeometr
     // if should use per-triangle info
     if (inst.triangleArrayIndex != GEOM_INST_NO_TRIANGLE_INFO)
     {
-        tr.sectorArrayIndex = triangleSectorIndices[inst.triangleArrayIndex + primitiveId];
+        tr.sectorArrayIndex = getTriangleSectorArrayIndex(inst.triangleArrayIndex, primitiveId);
     }
     else
     {
@@ -540,8 +702,36 @@ void getTriangle_PositionAndNormal(
     const ShGeometryInstance inst = geometryInstances[globalGeometryIndex];
 
     const bool isDynamic = (instanceCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC) == INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC;
+    const bool isResidentMesh = (inst.flags & GEOM_INST_FLAG_RESIDENT_MESH) != 0;
+
+    if (isResidentMesh)
+    {
+        const uvec3 vertIndices = getVertIndicesMesh(inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
+
+        tr = getTriangleMesh(vertIndices);
+
+        // to local and then to world space
+        const vec3 localPosition = tr.positions * baryCoords;
+        const vec3 localNormal = tr.normals * baryCoords;
+        
+        position = (inst.model * vec4(localPosition, 1.0)).xyz;
+        normal = mat3(inst.model) * localNormal;
+
+        const bool hasPrevInfo = inst.prevBaseVertexIndex != UINT32_MAX;
 
-    if (isDynamic)
+        // mesh's local positions are constant, only model matrices are changing
+        if (hasPrevInfo)
+        {
+            position_Prev = (inst.prevModel * vec4(localPosition, 1.0)).xyz;
+            normal_Prev = mat3(inst.prevModel) * localNormal;
+        }
+        else
+        {
+            position_Prev = position;
+            normal_Prev = normal;
+        }
+    }
+    else if (isDynamic)
     {
         const uvec3 vertIndices = getVertIndicesDynamic(inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
 
@@ -619,8 +809,18 @@ mat3 getOnlyCurPositions(int globalGeometryIndex, int instanceCustomIndex, int p
     const ShGeometryInstance inst = geometryInstances[globalGeometryIndex];
 
     const bool isDynamic = (instanceCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC) == INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC;
+    const bool isResidentMesh = (inst.flags & GEOM_INST_FLAG_RESIDENT_MESH) != 0;
 
-    if (isDynamic)
+    if (isResidentMesh)
+    {
+        const uvec3 vertIndices = getVertIndicesMesh(inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
+
+        // to world space
+        positions[0] = (inst.model * vec4(getMeshVerticesPositions(vertIndices[0]), 1.0)).xyz;
+        positions[1] = (inst.model * vec4(getMeshVerticesPositions(vertIndices[1]), 1.0)).xyz;
+        positions[2] = (inst.model * vec4(getMeshVerticesPositions(vertIndices[2]), 1.0)).xyz;
+    }
+    else if (isDynamic)
     {
         const uvec3 vertIndices = getVertIndicesDynamic(inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
 
@@ -649,8 +849,36 @@ mat3 getOnlyPrevPositions(int globalGeometryIndex, int instanceCustomIndex, int
     const ShGeometryInstance inst = geometryInstances[globalGeometryIndex];
 
     const bool isDynamic = (instanceCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC) == INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC;
+    const bool isResidentMesh = (inst.flags & GEOM_INST_FLAG_RESIDENT_MESH) != 0;
+
+    if (isResidentMesh)
+    {
+        const uvec3 vertIndices = getVertIndicesMesh(inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
+
+        const vec4 localPos[] =
+        {
+            vec4(getMeshVerticesPositions(vertIndices[0]), 1.0),
+            vec4(getMeshVerticesPositions(vertIndices[1]), 1.0),
+            vec4(getMeshVerticesPositions(vertIndices[2]), 1.0),
+        };
+
+        const bool hasPrevInfo = inst.prevBaseVertexIndex != UINT32_MAX;
 
-    if (isDynamic)
+        // mesh's local positions are constant, only model matrices are changing
+        if (hasPrevInfo)
+        {
+            prevPositions[0] = (inst.prevModel * localPos[0]).xyz;
+            prevPositions[1] = (inst.prevModel * localPos[1]).xyz;
+            prevPositions[2] = (inst.prevModel * localPos[2]).xyz;
+        }
+        else
+        {
+            prevPositions[0] = (inst.model * localPos[0]).xyz;
+            prevPositions[1] = (inst.model * localPos[1]).xyz;
+            prevPositions[2] = (inst.model * localPos[2]).xyz;
+        }
+    }
+    else if (isDynamic)
     {
         // dynamic     -- use prev model matrix and prev positions if exist
         const bool hasPrevInfo = inst.prevBaseVertexIndex != UINT32_MAX;
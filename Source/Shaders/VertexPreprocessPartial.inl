@@ -29,7 +29,7 @@
     #define SET_TANGENTS setDynamicVerticesTangents
     #define INDICES dynamicIndices
 
-#elif defined(VERTEX_PREPROCESS_PARTIAL_STATIC_ALL) || defined(VERTEX_PREPROCESS_PARTIAL_STATIC_MOVABLE)
+#elif defined(VERTEX_PREPROCESS_PARTIAL_STATIC)
 
     #define GET_POSITIONS getStaticVerticesPositions
     #define SET_POSITIONS setStaticVerticesPositions
@@ -46,92 +46,84 @@
 
 
 
-// translate from local to global geom index
-const int geomIndexOffset = globalUniform.instanceGeomInfoOffset[tlasInstanceIndex / 4][tlasInstanceIndex % 4];
-const int geomCount = globalUniform.instanceGeomCount[tlasInstanceIndex / 4][tlasInstanceIndex % 4];
-
-for (uint localGeomIndex = gl_LocalInvocationID.x; localGeomIndex < geomCount; localGeomIndex += gl_WorkGroupSize.x)
+// Chunks contain only geometry that requires normals generation;
+// in accumulation pass, each thread processes one triangle of "chunk",
+// in resolve pass -- one vertex of "chunk"
 {
-    const ShGeometryInstance inst = geometryInstances[geomIndexOffset + localGeomIndex];
+    const ShGeometryInstance inst = geometryInstances[chunk.globalGeomIndex];
 
-#if defined(VERTEX_PREPROCESS_PARTIAL_STATIC_MOVABLE)
-    const bool isMovable = (inst.flags & GEOM_INST_FLAG_IS_MOVABLE) != 0;
-    
-    // ignore non-movable if preprocess mode allows only movable
-    if (!isMovable)
+    if (vertPreprocPass == VERT_PREPROC_PASS_ACCUMULATE)
     {
-        continue;
-    }
-#endif
-
-    const bool useIndices = inst.baseIndexIndex != UINT32_MAX;
-    const bool genNormals = (inst.flags & GEOM_INST_FLAG_GENERATE_NORMALS) != 0;
-    // -1 if normals should be inverted
-    const float normalSign = float((inst.flags & GEOM_INST_FLAG_INVERTED_NORMALS) == 0) * 2.0 - 1.0;
+        const uint tri = globalIndex - chunk.triangleOffset;
 
-    const mat4 model = inst.model;
-    const mat3 model3 = mat3(model);
+        const bool useIndices = inst.baseIndexIndex != UINT32_MAX;
+        // -1 if normals should be inverted
+        const float normalSign = float((inst.flags & GEOM_INST_FLAG_INVERTED_NORMALS) == 0) * 2.0 - 1.0;
 
+        uvec3 vertexIndices;
 
-    if (useIndices)
-    {
-        for (uint tri = 0; tri < inst.indexCount / 3; tri++)
+        if (useIndices)
         {
             const uint i = inst.baseIndexIndex + tri * 3;
 
-            const uvec3 vertexIndices = uvec3(
+            vertexIndices = uvec3(
                 inst.baseVertexIndex + INDICES[i + 0],
                 inst.baseVertexIndex + INDICES[i + 1],
                 inst.baseVertexIndex + INDICES[i + 2]);
-
-            const vec3 localPos[] = 
-            {
-                GET_POSITIONS(vertexIndices[0]),
-                GET_POSITIONS(vertexIndices[1]),
-                GET_POSITIONS(vertexIndices[2])
-            };
-
-            vec3 localNormal;
-            
-            if (genNormals)
-            {
-                localNormal = normalSign * normalize(cross(localPos[1] - localPos[0], localPos[2] - localPos[0]));
-                
-                SET_NORMALS(vertexIndices[0], localNormal);
-                SET_NORMALS(vertexIndices[1], localNormal);
-                SET_NORMALS(vertexIndices[2], localNormal);
-            }
         }
-    }
-    else
-    {
-        for (uint tri = 0; tri < inst.vertexCount / 3; tri++)
+        else
         {
             const uint v = inst.baseVertexIndex + tri * 3;
 
-            const uvec3 vertexIndices = uvec3(
+            vertexIndices = uvec3(
                 v + 0,
                 v + 1,
                 v + 2);
+        }
 
-            const vec3 localPos[] = 
-            {
-                GET_POSITIONS(vertexIndices[0]),
-                GET_POSITIONS(vertexIndices[1]),
-                GET_POSITIONS(vertexIndices[2])
-            };
+        const vec3 localPos[] = 
+        {
+            GET_POSITIONS(vertexIndices[0]),
+            GET_POSITIONS(vertexIndices[1]),
+            GET_POSITIONS(vertexIndices[2])
+        };
+
+        const vec3 faceNormal = cross(localPos[1] - localPos[0], localPos[2] - localPos[0]);
 
-            vec3 localNormal;
+        if (chunk.accumVertexCount == 0)
+        {
+            // vertices are not shared, so they can be written directly
+            const vec3 localNormal = normalSign * normalize(faceNormal);
 
-            if (genNormals)
+            SET_NORMALS(vertexIndices[0], localNormal);
+            SET_NORMALS(vertexIndices[1], localNormal);
+            SET_NORMALS(vertexIndices[2], localNormal);
+        }
+        else if (dot(faceNormal, faceNormal) > 0.0)
+        {
+            const vec3 localNormal = normalSign * normalize(faceNormal);
+
+            for (uint k = 0; k < 3; k++)
             {
-                localNormal = normalSign * normalize(cross(localPos[1] - localPos[0], localPos[2] - localPos[0]));
+                const uint localVertex = vertexIndices[k] - inst.baseVertexIndex;
 
-                SET_NORMALS(vertexIndices[0], localNormal);
-                SET_NORMALS(vertexIndices[1], localNormal);
-                SET_NORMALS(vertexIndices[2], localNormal);
+                if (localVertex < chunk.accumVertexCount)
+                {
+                    accumulateNormal(chunk.accumVertexOffset + localVertex, localNormal);
+                }
             }
-        } 
+        }
+    }
+    else
+    {
+        const uint localVertex = globalIndex - chunk.accumVertexOffset;
+        const vec3 sum = getAccumulatedNormal(globalIndex);
+
+        // ignore vertices that are not referenced by non-degenerate triangles
+        if (dot(sum, sum) > 0.0)
+        {
+            SET_NORMALS(inst.baseVertexIndex + localVertex, normalize(sum));
+        }
     }
 }
 
@@ -144,6 +136,5 @@ for (uint localGeomIndex = gl_LocalInvocationID.x; localGeomIndex < geomCount; l
 #undef SET_TANGENTS
 #undef INDICES
 
-#undef VERTEX_PREPROCESS_PARTIAL_STATIC_ALL
-#undef VERTEX_PREPROCESS_PARTIAL_STATIC_MOVABLE
+#undef VERTEX_PREPROCESS_PARTIAL_STATIC
 #undef VERTEX_PREPROCESS_PARTIAL_DYNAMIC
\ No newline at end of file
@@ -115,7 +115,15 @@ RTGL1::FramebufferImageIndex RTGL1::Sharpening::Apply(
 
 void RTGL1::Sharpening::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroyPipelines();
+    for (auto &t : simpleSharpPipelines)
+    {
+        shaderManager->DestroyWhenUnused(t);
+    }
+    for (auto &t : casPipelines)
+    {
+        shaderManager->DestroyWhenUnused(t);
+    }
+
     CreatePipelines(shaderManager);
 }
 
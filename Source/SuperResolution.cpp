@@ -86,11 +86,14 @@ RTGL1::FramebufferImageIndex RTGL1::SuperResolution::Apply(
 
     // EASU
     {
+        // render-size images can be larger than the viewport
+        const ResolutionState &allocated = framebuffers->GetAllocatedResolution();
+
         FsrPush easuCon;
         FsrEasuCon(
             easuCon.con0, easuCon.con1, easuCon.con2, easuCon.con3,
             (AF1)renderResolution.Width(),         (AF1)renderResolution.Height(),          // viewport size
-            (AF1)renderResolution.Width(),         (AF1)renderResolution.Height(),          // image resource size
+            (AF1)allocated.renderWidth,            (AF1)allocated.renderHeight,             // image resource size
             (AF1)renderResolution.UpscaledWidth(), (AF1)renderResolution.UpscaledHeight()   // upscaled size
         );
 
@@ -126,7 +129,9 @@ RTGL1::FramebufferImageIndex RTGL1::SuperResolution::Apply(
 
 void RTGL1::SuperResolution::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroyPipelines();
+    shaderManager->DestroyWhenUnused(pipelineEasu);
+    shaderManager->DestroyWhenUnused(pipelineRcas);
+
     CreatePipelines(shaderManager);
 }
 
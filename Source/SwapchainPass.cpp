@@ -43,69 +43,62 @@ RTGL1::SwapchainPass::SwapchainPass(
 RTGL1::SwapchainPass::~SwapchainPass()
 {
     vkDestroyRenderPass(device, swapchainRenderPass, nullptr);
-    DestroyFramebuffers();
-}
 
-void RTGL1::SwapchainPass::CreateFramebuffers(uint32_t newSwapchainWidth, uint32_t newSwapchainHeight, const std::shared_ptr<Framebuffers> &storageFramebuffers)
-{
     for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        assert(fbPing[i] == VK_NULL_HANDLE && fbPong[i] == VK_NULL_HANDLE);
+        DestroyFramebuffers(i);
+    }
+}
 
-        VkImageView v = VK_NULL_HANDLE;
+void RTGL1::SwapchainPass::CreateFramebuffers(uint32_t frameIndex, uint32_t newSwapchainWidth, uint32_t newSwapchainHeight, const std::shared_ptr<Framebuffers> &storageFramebuffers)
+{
+    assert(fbPing[frameIndex] == VK_NULL_HANDLE && fbPong[frameIndex] == VK_NULL_HANDLE);
 
-        VkFramebufferCreateInfo fbInfo = {};
-        fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        fbInfo.renderPass = swapchainRenderPass;
-        fbInfo.attachmentCount = 1;
-        fbInfo.pAttachments = &v;
-        fbInfo.width = newSwapchainWidth;
-        fbInfo.height = newSwapchainHeight;
-        fbInfo.layers = 1;
+    VkImageView v = VK_NULL_HANDLE;
 
-        {
-            v = storageFramebuffers->GetImageView(FramebufferImageIndex::FB_IMAGE_INDEX_UPSCALED_PING, 0);
+    VkFramebufferCreateInfo fbInfo = {};
+    fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbInfo.renderPass = swapchainRenderPass;
+    fbInfo.attachmentCount = 1;
+    fbInfo.pAttachments = &v;
+    fbInfo.width = newSwapchainWidth;
+    fbInfo.height = newSwapchainHeight;
+    fbInfo.layers = 1;
 
-            VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &fbPing[i]);
-            VK_CHECKERROR(r);
-        }
-        {
-            v = storageFramebuffers->GetImageView(FramebufferImageIndex::FB_IMAGE_INDEX_UPSCALED_PONG, 0);
+    {
+        v = storageFramebuffers->GetImageView(FramebufferImageIndex::FB_IMAGE_INDEX_UPSCALED_PING, 0);
 
-            VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &fbPong[i]);
-            VK_CHECKERROR(r);
-        }
-        SET_DEBUG_NAME(device, fbPing[i], VK_OBJECT_TYPE_FRAMEBUFFER, "Rasterizer swapchain ping framebuffer");
-        SET_DEBUG_NAME(device, fbPong[i], VK_OBJECT_TYPE_FRAMEBUFFER, "Rasterizer swapchain pong framebuffer");
+        VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &fbPing[frameIndex]);
+        VK_CHECKERROR(r);
+    }
+    {
+        v = storageFramebuffers->GetImageView(FramebufferImageIndex::FB_IMAGE_INDEX_UPSCALED_PONG, 0);
+
+        VkResult r = vkCreateFramebuffer(device, &fbInfo, nullptr, &fbPong[frameIndex]);
+        VK_CHECKERROR(r);
     }
+    SET_DEBUG_NAME(device, fbPing[frameIndex], VK_OBJECT_TYPE_FRAMEBUFFER, "Rasterizer swapchain ping framebuffer");
+    SET_DEBUG_NAME(device, fbPong[frameIndex], VK_OBJECT_TYPE_FRAMEBUFFER, "Rasterizer swapchain pong framebuffer");
 
     this->swapchainWidth = newSwapchainWidth;
     this->swapchainHeight = newSwapchainHeight;
 }
 
-void RTGL1::SwapchainPass::DestroyFramebuffers()
+void RTGL1::SwapchainPass::DestroyFramebuffers(uint32_t frameIndex)
 {
-    for (VkFramebuffer &fb : fbPing)
-    {
-        if (fb != VK_NULL_HANDLE)
-        {
-            vkDestroyFramebuffer(device, fb, nullptr);
-            fb = VK_NULL_HANDLE;
-        }
-    }
-    for (VkFramebuffer &fb : fbPong)
+    for (VkFramebuffer *fb : { &fbPing[frameIndex], &fbPong[frameIndex] })
     {
-        if (fb != VK_NULL_HANDLE)
+        if (*fb != VK_NULL_HANDLE)
         {
-            vkDestroyFramebuffer(device, fb, nullptr);
-            fb = VK_NULL_HANDLE;
+            vkDestroyFramebuffer(device, *fb, nullptr);
+            *fb = VK_NULL_HANDLE;
         }
     }
 }
 
 void RTGL1::SwapchainPass::OnShaderReload(const ShaderManager *shaderManager)
 {
-    swapchainPipelines->Clear();
+    swapchainPipelines->Clear(shaderManager);
     swapchainPipelines->SetShaders(shaderManager, "VertRasterizer", "FragRasterizer");
 }
 
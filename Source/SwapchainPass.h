@@ -41,8 +41,9 @@ public:
     SwapchainPass &operator=(const SwapchainPass &other) = delete;
     SwapchainPass &operator=(SwapchainPass &&other) noexcept = delete;
 
-    void CreateFramebuffers(uint32_t swapchainWidth, uint32_t swapchainHeight, const std::shared_ptr<Framebuffers> &storageFramebuffers);
-    void DestroyFramebuffers();
+    // Create framebuffers that are used by the frame with that index
+    void CreateFramebuffers(uint32_t frameIndex, uint32_t swapchainWidth, uint32_t swapchainHeight, const std::shared_ptr<Framebuffers> &storageFramebuffers);
+    void DestroyFramebuffers(uint32_t frameIndex);
 
     void OnShaderReload(const ShaderManager *shaderManager) override;
 
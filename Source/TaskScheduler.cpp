@@ -0,0 +1,322 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TaskScheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace RTGL1;
+
+namespace
+{
+
+constexpr uint32_t MAX_WORKER_THREAD_COUNT = 64;
+
+// Scheduler that owns the current thread, if it's a worker
+thread_local const TaskScheduler *tlsOwner = nullptr;
+thread_local uint32_t tlsWorkerIndex = 0;
+
+}
+
+
+void TaskScheduler::Batch::Execute(const std::function<void()> &func)
+{
+    if (failed.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    try
+    {
+        func();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+
+        if (!error)
+        {
+            error = std::current_exception();
+        }
+
+        failed.store(true, std::memory_order_relaxed);
+    }
+}
+
+void TaskScheduler::Batch::Done()
+{
+    remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void TaskScheduler::Batch::RethrowIfFailed()
+{
+    assert(remaining.load() == 0);
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+
+TaskScheduler::TaskScheduler(uint32_t workerThreadCount, PFN_rgParallelFor _pfnHostParallelFor, void *_pHostUserData)
+:
+    pfnHostParallelFor(_pfnHostParallelFor),
+    pHostUserData(_pHostUserData),
+    nextQueue(0),
+    queuedTaskCount(0),
+    stop(false)
+{
+    uint32_t workerCount = 0;
+
+    // if host's job system is used, don't create any threads
+    if (pfnHostParallelFor == nullptr)
+    {
+        workerCount = workerThreadCount > 0 
+            ? workerThreadCount 
+            : std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+        workerCount = std::min(workerCount, MAX_WORKER_THREAD_COUNT);
+    }
+
+    for (uint32_t i = 0; i < std::max(workerCount, 1u); i++)
+    {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stop = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+
+    assert(queuedTaskCount.load() == 0);
+}
+
+void TaskScheduler::ParallelFor(uint32_t count, uint32_t grainSize, const RangeFunction &func)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    grainSize = std::max(grainSize, 1u);
+    const uint32_t rangeCount = (count + grainSize - 1) / grainSize;
+
+    if (rangeCount == 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    auto processRange = [&func, count, grainSize] (uint32_t rangeIndex)
+    {
+        const uint32_t first = rangeIndex * grainSize;
+        const uint32_t end = std::min(count, first + grainSize);
+
+        func(first, end);
+    };
+
+    if (pfnHostParallelFor != nullptr)
+    {
+        HostParallelFor(rangeCount, processRange);
+        return;
+    }
+
+    Batch batch(rangeCount);
+
+    for (uint32_t r = 1; r < rangeCount; r++)
+    {
+        Submit([&batch, &processRange, r] ()
+        {
+            batch.Execute([&processRange, r] () { processRange(r); });
+            batch.Done();
+        });
+    }
+
+    // first range on the calling thread
+    batch.Execute([&processRange] () { processRange(0); });
+    batch.Done();
+
+    HelpUntilDone(batch);
+    batch.RethrowIfFailed();
+}
+
+uint32_t TaskScheduler::GetConcurrency() const
+{
+    if (pfnHostParallelFor != nullptr)
+    {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    return static_cast<uint32_t>(workers.size()) + 1;
+}
+
+void TaskScheduler::WorkerLoop(uint32_t workerIndex)
+{
+    tlsOwner = this;
+    tlsWorkerIndex = workerIndex;
+
+    while (true)
+    {
+        if (TryExecuteOne())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeCondition.wait(lock, [this] () { return stop || queuedTaskCount.load() > 0; });
+
+        if (stop)
+        {
+            return;
+        }
+    }
+}
+
+void TaskScheduler::Submit(std::function<void()> task)
+{
+    {
+        WorkerQueue &q = *queues[GetCurrentQueueIndex()];
+
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(std::move(task));
+    }
+
+    queuedTaskCount.fetch_add(1);
+
+    // lock to not lose the notification, if a worker is between its check and wait
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+bool TaskScheduler::TryExecuteOne()
+{
+    if (queuedTaskCount.load() == 0)
+    {
+        return false;
+    }
+
+    const uint32_t queueCount = static_cast<uint32_t>(queues.size());
+    const uint32_t own = GetCurrentQueueIndex();
+
+    std::function<void()> task;
+
+    for (uint32_t i = 0; i < queueCount; i++)
+    {
+        WorkerQueue &q = *queues[(own + i) % queueCount];
+
+        std::lock_guard<std::mutex> lock(q.mutex);
+
+        if (q.tasks.empty())
+        {
+            continue;
+        }
+
+        if (i == 0)
+        {
+            // own queue: the most recent task, its data is likely in cache
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+        else
+        {
+            // steal the oldest task from other queue
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+
+        break;
+    }
+
+    if (!task)
+    {
+        return false;
+    }
+
+    queuedTaskCount.fetch_sub(1);
+
+    task();
+    return true;
+}
+
+void TaskScheduler::HelpUntilDone(const Batch &batch)
+{
+    while (batch.remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!TryExecuteOne())
+        {
+            // the rest of the tasks are being executed by others
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TaskScheduler::HostParallelFor(uint32_t taskCount, const std::function<void(uint32_t)> &func)
+{
+    struct Context
+    {
+        const std::function<void(uint32_t)> *pFunc;
+        Batch *pBatch;
+    };
+
+    Batch batch(taskCount);
+    Context context = { &func, &batch };
+
+    // exceptions must not go through the host's code
+    PFN_rgTask pfnTask = [] (void *pTaskData, uint32_t taskIndex)
+    {
+        auto *c = static_cast<Context *>(pTaskData);
+
+        c->pBatch->Execute([c, taskIndex] () { (*c->pFunc)(taskIndex); });
+        c->pBatch->Done();
+    };
+
+    pfnHostParallelFor(pfnTask, &context, taskCount, pHostUserData);
+
+    batch.RethrowIfFailed();
+}
+
+uint32_t TaskScheduler::GetCurrentQueueIndex()
+{
+    if (tlsOwner == this)
+    {
+        return tlsWorkerIndex;
+    }
+
+    // distribute tasks of external threads between all queues
+    return nextQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(queues.size());
+}
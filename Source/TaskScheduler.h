@@ -0,0 +1,117 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RTGL1/RTGL1.h"
+
+namespace RTGL1
+{
+
+// Work-stealing job system for library-internal parallelism.
+// Each worker has its own deque: it pushes and pops tasks on one end,
+// while idle workers steal from the other end of the others' deques.
+// A thread that waits for its tasks doesn't block, but executes pending tasks too.
+// If the host provides PFN_rgParallelFor, no workers are created
+// and all the work is passed to the host's job system.
+class TaskScheduler
+{
+public:
+    // Called for a range [first, end)
+    using RangeFunction = std::function<void(uint32_t first, uint32_t end)>;
+
+public:
+    explicit TaskScheduler(uint32_t workerThreadCount, PFN_rgParallelFor pfnHostParallelFor, void *pHostUserData);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &other) = delete;
+    TaskScheduler(TaskScheduler &&other) noexcept = delete;
+    TaskScheduler &operator=(const TaskScheduler &other) = delete;
+    TaskScheduler &operator=(TaskScheduler &&other) noexcept = delete;
+
+    // Split [0, count) into ranges of grainSize elements and process them in parallel.
+    // Returns when all ranges are processed. If any call throws, the first exception is rethrown.
+    void ParallelFor(uint32_t count, uint32_t grainSize, const RangeFunction &func);
+
+    // How many threads can execute tasks simultaneously, including the calling thread.
+    uint32_t GetConcurrency() const;
+
+private:
+    // Tasks that are waited together
+    struct Batch
+    {
+        std::atomic<uint32_t> remaining;
+        std::atomic<bool> failed;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+
+        explicit Batch(uint32_t count) : remaining(count), failed(false), error(nullptr) {}
+        // Call func and save its exception. If some task already failed, func is skipped.
+        void Execute(const std::function<void()> &func);
+        // Must be the last access to the batch in a task, as the waiting thread can destroy it
+        void Done();
+        void RethrowIfFailed();
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+private:
+    void WorkerLoop(uint32_t workerIndex);
+
+    void Submit(std::function<void()> task);
+    bool TryExecuteOne();
+    // Execute pending tasks until all tasks of the batch are finished
+    void HelpUntilDone(const Batch &batch);
+
+    void HostParallelFor(uint32_t taskCount, const std::function<void(uint32_t)> &func);
+
+    // Index of the queue to push to and pop from for the current thread
+    uint32_t GetCurrentQueueIndex();
+
+private:
+    PFN_rgParallelFor pfnHostParallelFor;
+    void *pHostUserData;
+
+    std::vector<std::thread> workers;
+    // one queue per worker, and at least one for the case when there are no workers
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<uint32_t> nextQueue;
+
+    std::atomic<uint32_t> queuedTaskCount;
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+    bool stop;
+};
+
+}
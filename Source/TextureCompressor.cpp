@@ -0,0 +1,976 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+#include "Const.h"
+#include "Generated/ShaderCommonC.h"
+#include "Utils.h"
+
+using namespace RTGL1;
+
+namespace
+{
+
+constexpr uint32_t CACHE_MAGIC = 0x43425452; // 'RTBC'
+// must be incremented if encoders are changed
+constexpr uint32_t CACHE_VERSION = 1;
+
+// how many rows of 4x4 blocks are encoded in one task
+constexpr uint32_t BLOCK_ROWS_PER_TASK = 4;
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t dataSize;
+    uint32_t levelOffsets[MAX_PREGENERATED_MIPMAP_LEVELS];
+    uint32_t levelSizes[MAX_PREGENERATED_MIPMAP_LEVELS];
+};
+
+uint64_t HashBytes(const uint8_t *pData, size_t size, uint64_t seed)
+{
+    uint64_t h = seed ^ (size * 0x9E3779B97F4A7C15ull);
+
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t k;
+        memcpy(&k, pData + i, sizeof(k));
+
+        k *= 0x87C37B91114253D5ull;
+        k ^= k >> 31;
+        h = (h ^ k) * 0xFF51AFD7ED558CCDull;
+    }
+
+    for (; i < size; i++)
+    {
+        h = (h ^ pData[i]) * 0x100000001B3ull;
+    }
+
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+
+    return h;
+}
+
+float SRGBToLinear(uint8_t c)
+{
+    static const auto table = []
+    {
+        std::array<float, 256> t = {};
+
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            float f = i / 255.0f;
+            t[i] = f <= 0.04045f ? f / 12.92f : std::pow((f + 0.055f) / 1.055f, 2.4f);
+        }
+
+        return t;
+    }();
+
+    return table[c];
+}
+
+uint8_t LinearToSRGB(float f)
+{
+    f = f <= 0.0031308f ? f * 12.92f : 1.055f * std::pow(f, 1.0f / 2.4f) - 0.055f;
+    return (uint8_t)std::clamp(f * 255.0f + 0.5f, 0.0f, 255.0f);
+}
+
+
+// Get 4x4 block of texels, out of bounds texels are clamped to the edge
+void FetchBlock(const uint8_t *pRGBA, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t block[16][4])
+{
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        const uint32_t srcY = std::min(blockY * 4 + y, height - 1);
+
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            const uint32_t srcX = std::min(blockX * 4 + x, width - 1);
+
+            memcpy(block[y * 4 + x], &pRGBA[(srcY * width + srcX) * 4], 4);
+        }
+    }
+}
+
+uint32_t SquaredDistance(const uint8_t *a, const uint8_t *b, uint32_t channelCount)
+{
+    uint32_t d = 0;
+
+    for (uint32_t c = 0; c < channelCount; c++)
+    {
+        const int32_t diff = (int32_t)a[c] - (int32_t)b[c];
+        d += diff * diff;
+    }
+
+    return d;
+}
+
+
+uint16_t ToRGB565(const float rgb[3])
+{
+    const auto r = (uint16_t)std::clamp(rgb[0] * (31.0f / 255.0f) + 0.5f, 0.0f, 31.0f);
+    const auto g = (uint16_t)std::clamp(rgb[1] * (63.0f / 255.0f) + 0.5f, 0.0f, 63.0f);
+    const auto b = (uint16_t)std::clamp(rgb[2] * (31.0f / 255.0f) + 0.5f, 0.0f, 31.0f);
+
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+void FromRGB565(uint16_t c, uint8_t rgb[3])
+{
+    const uint32_t r = (c >> 11) & 31;
+    const uint32_t g = (c >> 5) & 63;
+    const uint32_t b = c & 31;
+
+    rgb[0] = (uint8_t)((r << 3) | (r >> 2));
+    rgb[1] = (uint8_t)((g << 2) | (g >> 4));
+    rgb[2] = (uint8_t)((b << 3) | (b >> 2));
+}
+
+// Bounding box of colors, its diagonal is selected by the covariance sign, then it's inset,
+// so the endpoints are closer to the most of the colors.
+void EncodeBC1Color(const uint8_t block[16][4], uint8_t *pDst)
+{
+    float minC[3] = { 255, 255, 255 };
+    float maxC[3] = { 0, 0, 0 };
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            minC[c] = std::min(minC[c], (float)block[i][c]);
+            maxC[c] = std::max(maxC[c], (float)block[i][c]);
+        }
+    }
+
+    // select diagonal
+    {
+        const float center[3] = 
+        { 
+            (minC[0] + maxC[0]) * 0.5f, 
+            (minC[1] + maxC[1]) * 0.5f, 
+            (minC[2] + maxC[2]) * 0.5f 
+        };
+
+        float covRG = 0, covRB = 0;
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const float r = block[i][0] - center[0];
+            covRG += r * (block[i][1] - center[1]);
+            covRB += r * (block[i][2] - center[2]);
+        }
+
+        if (covRG < 0)
+        {
+            std::swap(minC[1], maxC[1]);
+        }
+
+        if (covRB < 0)
+        {
+            std::swap(minC[2], maxC[2]);
+        }
+    }
+
+    // inset
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        const float inset = (maxC[c] - minC[c]) / 16.0f;
+
+        maxC[c] -= inset;
+        minC[c] += inset;
+    }
+
+    uint16_t c0 = ToRGB565(maxC);
+    uint16_t c1 = ToRGB565(minC);
+
+    // c0 > c1 for 4-color mode
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+    }
+
+    pDst[0] = (uint8_t)(c0 & 0xFF);
+    pDst[1] = (uint8_t)(c0 >> 8);
+    pDst[2] = (uint8_t)(c1 & 0xFF);
+    pDst[3] = (uint8_t)(c1 >> 8);
+
+    uint32_t indices = 0;
+
+    // if equal, it's 3-color mode, but all indices are 0 anyway
+    if (c0 != c1)
+    {
+        uint8_t palette[4][3];
+        FromRGB565(c0, palette[0]);
+        FromRGB565(c1, palette[1]);
+
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t best = 0;
+            uint32_t bestDist = UINT32_MAX;
+
+            for (uint32_t p = 0; p < 4; p++)
+            {
+                const uint32_t d = SquaredDistance(block[i], palette[p], 3);
+
+                if (d < bestDist)
+                {
+                    best = p;
+                    bestDist = d;
+                }
+            }
+
+            indices |= best << (i * 2);
+        }
+    }
+
+    pDst[4] = (uint8_t)(indices);
+    pDst[5] = (uint8_t)(indices >> 8);
+    pDst[6] = (uint8_t)(indices >> 16);
+    pDst[7] = (uint8_t)(indices >> 24);
+}
+
+// Single channel block, used for BC3 alpha and BC5 channels
+void EncodeBC4(const uint8_t values[16], uint8_t *pDst)
+{
+    uint8_t minV = 255, maxV = 0;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        minV = std::min(minV, values[i]);
+        maxV = std::max(maxV, values[i]);
+    }
+
+    // 8-value mode, as maxV > minV
+    pDst[0] = maxV;
+    pDst[1] = minV;
+
+    uint64_t indices = 0;
+
+    if (maxV != minV)
+    {
+        uint8_t palette[8];
+        palette[0] = maxV;
+        palette[1] = minV;
+
+        for (uint32_t p = 1; p <= 6; p++)
+        {
+            palette[p + 1] = (uint8_t)(((7 - p) * maxV + p * minV) / 7);
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t best = 0;
+            uint32_t bestDist = UINT32_MAX;
+
+            for (uint32_t p = 0; p < 8; p++)
+            {
+                const uint32_t d = SquaredDistance(&values[i], &palette[p], 1);
+
+                if (d < bestDist)
+                {
+                    best = p;
+                    bestDist = d;
+                }
+            }
+
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    for (uint32_t b = 0; b < 6; b++)
+    {
+        pDst[2 + b] = (uint8_t)(indices >> (b * 8));
+    }
+}
+
+void EncodeBC1Block(const uint8_t block[16][4], uint8_t *pDst)
+{
+    EncodeBC1Color(block, pDst);
+}
+
+void EncodeBC3Block(const uint8_t block[16][4], uint8_t *pDst)
+{
+    uint8_t alpha[16];
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        alpha[i] = block[i][3];
+    }
+
+    EncodeBC4(alpha, pDst);
+    EncodeBC1Color(block, pDst + 8);
+}
+
+void EncodeBC5Block(const uint8_t block[16][4], uint8_t *pDst)
+{
+    uint8_t red[16], green[16];
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        red[i] = block[i][0];
+        green[i] = block[i][1];
+    }
+
+    EncodeBC4(red, pDst);
+    EncodeBC4(green, pDst + 8);
+}
+
+
+// BC7 mode 6: one subset, RGBA endpoints with 7 bits and a unique p-bit, 4-bit indices
+constexpr uint32_t BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BC7Endpoint
+{
+    uint8_t q[4];   // 7-bit values
+    uint8_t p;      // p-bit
+};
+
+BC7Endpoint QuantizeBC7Endpoint(const float e[4])
+{
+    BC7Endpoint best = {};
+    float bestError = INFINITY;
+
+    for (uint8_t p = 0; p < 2; p++)
+    {
+        BC7Endpoint cur = {};
+        cur.p = p;
+
+        float error = 0;
+
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            const float q = std::clamp(std::round((e[c] - p) / 2.0f), 0.0f, 127.0f);
+            cur.q[c] = (uint8_t)q;
+
+            const float d = (float)((cur.q[c] << 1) | p) - e[c];
+            error += d * d;
+        }
+
+        if (error < bestError)
+        {
+            best = cur;
+            bestError = error;
+        }
+    }
+
+    return best;
+}
+
+// Choose indices for the quantized endpoints, returns total squared error
+uint32_t FindBC7Indices(const uint8_t block[16][4], const BC7Endpoint &e0, const BC7Endpoint &e1, uint8_t indices[16])
+{
+    uint8_t palette[16][4];
+
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        const uint32_t a = (e0.q[c] << 1) | e0.p;
+        const uint32_t b = (e1.q[c] << 1) | e1.p;
+
+        for (uint32_t w = 0; w < 16; w++)
+        {
+            palette[w][c] = (uint8_t)(((64 - BC7_WEIGHTS_4[w]) * a + BC7_WEIGHTS_4[w] * b + 32) >> 6);
+        }
+    }
+
+    uint32_t totalError = 0;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        uint32_t best = 0;
+        uint32_t bestDist = UINT32_MAX;
+
+        for (uint32_t w = 0; w < 16; w++)
+        {
+            const uint32_t d = SquaredDistance(block[i], palette[w], 4);
+
+            if (d < bestDist)
+            {
+                best = w;
+                bestDist = d;
+            }
+        }
+
+        indices[i] = (uint8_t)best;
+        totalError += bestDist;
+    }
+
+    return totalError;
+}
+
+// Least squares fit of endpoints for the given indices
+bool RefineBC7Endpoints(const uint8_t block[16][4], const uint8_t indices[16], float e0[4], float e1[4])
+{
+    float a = 0, b = 0, c = 0;
+    float x[4] = {}, y[4] = {};
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        const float w = BC7_WEIGHTS_4[indices[i]] / 64.0f;
+        const float iw = 1.0f - w;
+
+        a += iw * iw;
+        b += iw * w;
+        c += w * w;
+
+        for (uint32_t ch = 0; ch < 4; ch++)
+        {
+            x[ch] += iw * block[i][ch];
+            y[ch] += w * block[i][ch];
+        }
+    }
+
+    const float det = a * c - b * b;
+
+    if (std::abs(det) < 1e-6f)
+    {
+        return false;
+    }
+
+    for (uint32_t ch = 0; ch < 4; ch++)
+    {
+        e0[ch] = std::clamp((c * x[ch] - b * y[ch]) / det, 0.0f, 255.0f);
+        e1[ch] = std::clamp((a * y[ch] - b * x[ch]) / det, 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+struct BitWriter
+{
+    uint8_t *pDst;
+    uint32_t position;
+
+    void Write(uint32_t value, uint32_t bitCount)
+    {
+        for (uint32_t i = 0; i < bitCount; i++, position++)
+        {
+            if ((value >> i) & 1)
+            {
+                pDst[position >> 3] |= (uint8_t)(1 << (position & 7));
+            }
+        }
+    }
+};
+
+void EncodeBC7Block(const uint8_t block[16][4], uint8_t *pDst)
+{
+    float mean[4] = {};
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            mean[c] += block[i][c] / 16.0f;
+        }
+    }
+
+    float cov[4][4] = {};
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        float d[4];
+
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            d[c] = block[i][c] - mean[c];
+        }
+
+        for (uint32_t r = 0; r < 4; r++)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                cov[r][c] += d[r] * d[c];
+            }
+        }
+    }
+
+    // principal axis using power iteration
+    float axis[4] = { 1, 1, 1, 1 };
+
+    for (uint32_t iter = 0; iter < 8; iter++)
+    {
+        float next[4] = {};
+
+        for (uint32_t r = 0; r < 4; r++)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                next[r] += cov[r][c] * axis[c];
+            }
+        }
+
+        const float len = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+
+        if (len < 1e-6f)
+        {
+            break;
+        }
+
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            axis[c] = next[c] / len;
+        }
+    }
+
+    // project onto the axis to find the extent
+    float minT = INFINITY, maxT = -INFINITY;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        float t = 0;
+
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            t += (block[i][c] - mean[c]) * axis[c];
+        }
+
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float e0[4], e1[4];
+
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        e0[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+
+    BC7Endpoint q0 = QuantizeBC7Endpoint(e0);
+    BC7Endpoint q1 = QuantizeBC7Endpoint(e1);
+
+    uint8_t indices[16];
+    uint32_t error = FindBC7Indices(block, q0, q1, indices);
+
+    // one least squares iteration, keep it only if it's better
+    if (error > 0 && RefineBC7Endpoints(block, indices, e0, e1))
+    {
+        const BC7Endpoint r0 = QuantizeBC7Endpoint(e0);
+        const BC7Endpoint r1 = QuantizeBC7Endpoint(e1);
+
+        uint8_t refinedIndices[16];
+        const uint32_t refinedError = FindBC7Indices(block, r0, r1, refinedIndices);
+
+        if (refinedError < error)
+        {
+            q0 = r0;
+            q1 = r1;
+            memcpy(indices, refinedIndices, sizeof(indices));
+        }
+    }
+
+    // the most significant bit of the anchor index is implicitly 0
+    if (indices[0] & 8)
+    {
+        std::swap(q0, q1);
+
+        for (uint8_t &i : indices)
+        {
+            i = (uint8_t)(15 - i);
+        }
+    }
+
+    memset(pDst, 0, 16);
+    BitWriter writer = { pDst, 0 };
+
+    // mode 6
+    writer.Write(1 << 6, 7);
+
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        writer.Write(q0.q[c], 7);
+        writer.Write(q1.q[c], 7);
+    }
+
+    writer.Write(q0.p, 1);
+    writer.Write(q1.p, 1);
+
+    writer.Write(indices[0], 3);
+
+    for (uint32_t i = 1; i < 16; i++)
+    {
+        writer.Write(indices[i], 4);
+    }
+
+    assert(writer.position == 128);
+}
+
+}
+
+
+TextureCompressor::TextureCompressor(RgTextureCompression _compression, const char *_pCachePath, std::shared_ptr<TaskScheduler> _taskScheduler)
+:
+    compression(_compression),
+    cachePath(_pCachePath != nullptr ? _pCachePath : ""),
+    taskScheduler(std::move(_taskScheduler))
+{}
+
+bool TextureCompressor::Compress(const ImageLoader::ResultInfo &source, uint32_t materialTextureIndex, bool generateMipmaps, 
+                                 std::vector<uint8_t> &storage, ImageLoader::ResultInfo *pResult) const
+{
+    if (compression == RG_TEXTURE_COMPRESSION_NONE)
+    {
+        return false;
+    }
+
+    if (source.pData == nullptr || source.isPregenerated || source.levelCount != 1)
+    {
+        return false;
+    }
+
+    if (source.format != VK_FORMAT_R8G8B8A8_UNORM && source.format != VK_FORMAT_R8G8B8A8_SRGB)
+    {
+        return false;
+    }
+
+    const uint32_t width = source.baseSize.width;
+    const uint32_t height = source.baseSize.height;
+
+    // only the base level is required to consist of whole blocks
+    if (width == 0 || height == 0 || width % 4 != 0 || height % 4 != 0)
+    {
+        return false;
+    }
+
+    assert(source.dataSize >= width * height * 4);
+
+    const bool isSRGB = source.format == VK_FORMAT_R8G8B8A8_SRGB;
+    BlockFormat blockFormat;
+
+    switch (materialTextureIndex)
+    {
+        case MATERIAL_ALBEDO_ALPHA_INDEX:
+        {
+            if (compression == RG_TEXTURE_COMPRESSION_QUALITY)
+            {
+                blockFormat = BlockFormat::BC7;
+                break;
+            }
+
+            bool hasAlpha = false;
+
+            for (uint32_t i = 0; i < width * height && !hasAlpha; i++)
+            {
+                hasAlpha = source.pData[i * 4 + 3] != 255;
+            }
+
+            blockFormat = hasAlpha ? BlockFormat::BC3 : BlockFormat::BC1;
+            break;
+        }
+        case MATERIAL_ROUGHNESS_METALLIC_EMISSION_INDEX:
+        {
+            // channels are independent, BC1 would mix them too much
+            if (compression != RG_TEXTURE_COMPRESSION_QUALITY)
+            {
+                return false;
+            }
+
+            blockFormat = BlockFormat::BC7;
+            break;
+        }
+        case MATERIAL_NORMAL_INDEX:
+        {
+            // only XY are used by shaders, and BC5 has no sRGB variant
+            if (isSRGB)
+            {
+                return false;
+            }
+
+            blockFormat = BlockFormat::BC5;
+            break;
+        }
+        default:
+            assert(0);
+            return false;
+    }
+
+    VkFormat format;
+    uint32_t blockSize;
+
+    switch (blockFormat)
+    {
+        case BlockFormat::BC1: format = isSRGB ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;  blockSize = 8; break;
+        case BlockFormat::BC3: format = isSRGB ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;          blockSize = 16; break;
+        case BlockFormat::BC5: format = VK_FORMAT_BC5_UNORM_BLOCK;                                              blockSize = 16; break;
+        case BlockFormat::BC7: format = isSRGB ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;          blockSize = 16; break;
+        default: assert(0); return false;
+    }
+
+    // same count as TextureUploader would generate
+    const uint32_t levelCount = generateMipmaps 
+        ? std::min(MAX_PREGENERATED_MIPMAP_LEVELS, (uint32_t)std::log2(std::min(width, height)) + 1) 
+        : 1;
+
+
+    uint64_t key = HashBytes(source.pData, (size_t)width * height * 4, CACHE_VERSION);
+    {
+        const uint32_t params[] = { width, height, (uint32_t)format, levelCount };
+        key = HashBytes(reinterpret_cast<const uint8_t *>(params), sizeof(params), key);
+    }
+
+    if (LoadFromCache(key, format, width, height, levelCount, blockSize, storage, pResult))
+    {
+        return true;
+    }
+
+
+    ImageLoader::ResultInfo result = {};
+    result.levelCount = levelCount;
+    result.isPregenerated = true;
+    result.baseSize = source.baseSize;
+    result.format = format;
+
+    uint32_t dataSize = 0;
+
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        result.levelOffsets[level] = dataSize;
+        result.levelSizes[level] = (uint32_t)Utils::GetMipLevelSize(width, height, level, 4, 4, blockSize);
+
+        dataSize += result.levelSizes[level];
+    }
+
+    storage.resize(dataSize);
+    result.pData = storage.data();
+    result.dataSize = dataSize;
+
+
+    // base level is encoded directly from the source
+    EncodeLevel(source.pData, width, height, blockFormat, storage.data());
+
+    std::vector<uint8_t> prevLevel, curLevel;
+    const uint8_t *pPrev = source.pData;
+
+    for (uint32_t level = 1; level < levelCount; level++)
+    {
+        const uint32_t prevW = std::max(width >> (level - 1), 1u);
+        const uint32_t prevH = std::max(height >> (level - 1), 1u);
+        const uint32_t w = std::max(width >> level, 1u);
+        const uint32_t h = std::max(height >> level, 1u);
+
+        curLevel.resize((size_t)w * h * 4);
+        Downsample(pPrev, prevW, prevH, isSRGB && blockFormat != BlockFormat::BC5, curLevel.data());
+
+        EncodeLevel(curLevel.data(), w, h, blockFormat, storage.data() + result.levelOffsets[level]);
+
+        std::swap(prevLevel, curLevel);
+        pPrev = prevLevel.data();
+    }
+
+    SaveToCache(key, result);
+
+    *pResult = result;
+    return true;
+}
+
+void TextureCompressor::EncodeLevel(const uint8_t *pRGBA, uint32_t width, uint32_t height, BlockFormat blockFormat, uint8_t *pDst) const
+{
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const uint32_t blockSize = blockFormat == BlockFormat::BC1 ? 8 : 16;
+
+    taskScheduler->ParallelFor(blocksY, BLOCK_ROWS_PER_TASK, [=] (uint32_t firstRow, uint32_t endRow)
+    {
+        uint8_t block[16][4];
+
+        for (uint32_t by = firstRow; by < endRow; by++)
+        {
+            for (uint32_t bx = 0; bx < blocksX; bx++)
+            {
+                FetchBlock(pRGBA, width, height, bx, by, block);
+
+                uint8_t *pBlockDst = pDst + ((size_t)by * blocksX + bx) * blockSize;
+
+                switch (blockFormat)
+                {
+                    case BlockFormat::BC1: EncodeBC1Block(block, pBlockDst); break;
+                    case BlockFormat::BC3: EncodeBC3Block(block, pBlockDst); break;
+                    case BlockFormat::BC5: EncodeBC5Block(block, pBlockDst); break;
+                    case BlockFormat::BC7: EncodeBC7Block(block, pBlockDst); break;
+                    default: assert(0);
+                }
+            }
+        }
+    });
+}
+
+void TextureCompressor::Downsample(const uint8_t *pSrc, uint32_t srcWidth, uint32_t srcHeight, bool isSRGB, uint8_t *pDst) const
+{
+    const uint32_t dstWidth = std::max(srcWidth / 2, 1u);
+    const uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+
+    taskScheduler->ParallelFor(dstHeight, 64, [=] (uint32_t firstRow, uint32_t endRow)
+    {
+        for (uint32_t y = firstRow; y < endRow; y++)
+        {
+            const uint32_t y0 = std::min(y * 2, srcHeight - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+
+            for (uint32_t x = 0; x < dstWidth; x++)
+            {
+                const uint32_t x0 = std::min(x * 2, srcWidth - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+
+                const uint8_t *s[4] =
+                {
+                    &pSrc[(y0 * srcWidth + x0) * 4],
+                    &pSrc[(y0 * srcWidth + x1) * 4],
+                    &pSrc[(y1 * srcWidth + x0) * 4],
+                    &pSrc[(y1 * srcWidth + x1) * 4],
+                };
+
+                uint8_t *d = &pDst[(y * dstWidth + x) * 4];
+
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    // alpha is always linear
+                    if (isSRGB && c < 3)
+                    {
+                        const float sum = SRGBToLinear(s[0][c]) + SRGBToLinear(s[1][c]) + SRGBToLinear(s[2][c]) + SRGBToLinear(s[3][c]);
+                        d[c] = LinearToSRGB(sum * 0.25f);
+                    }
+                    else
+                    {
+                        d[c] = (uint8_t)((s[0][c] + s[1][c] + s[2][c] + s[3][c] + 2) / 4);
+                    }
+                }
+            }
+        }
+    });
+}
+
+bool TextureCompressor::LoadFromCache(uint64_t key, VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount, uint32_t blockSize,
+                                      std::vector<uint8_t> &storage, ImageLoader::ResultInfo *pResult) const
+{
+    if (cachePath.empty())
+    {
+        return false;
+    }
+
+    char path[TEXTURE_FILE_PATH_MAX_LENGTH];
+    snprintf(path, sizeof(path), "%s%016llx.bc", cachePath.c_str(), (unsigned long long)key);
+
+    FILE *file = fopen(path, "rb");
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    CacheHeader header = {};
+    bool valid = 
+        fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == CACHE_MAGIC &&
+        header.version == CACHE_VERSION &&
+        header.format == (uint32_t)format &&
+        header.width == width && header.height == height &&
+        header.levelCount == levelCount && levelCount <= MAX_PREGENERATED_MIPMAP_LEVELS &&
+        header.dataSize > 0;
+
+    // a corrupted or stale entry is a cache miss
+    for (uint32_t i = 0; valid && i < header.levelCount; i++)
+    {
+        valid = 
+            header.levelSizes[i] == Utils::GetMipLevelSize(width, height, i, 4, 4, blockSize) &&
+            (uint64_t)header.levelOffsets[i] + header.levelSizes[i] <= header.dataSize;
+    }
+
+    if (valid)
+    {
+        storage.resize(header.dataSize);
+        valid = fread(storage.data(), header.dataSize, 1, file) == 1;
+    }
+
+    fclose(file);
+
+    if (!valid)
+    {
+        return false;
+    }
+
+    *pResult = {};
+    pResult->levelCount = header.levelCount;
+    pResult->isPregenerated = true;
+    pResult->pData = storage.data();
+    pResult->dataSize = header.dataSize;
+    pResult->baseSize = { header.width, header.height };
+    pResult->format = (VkFormat)header.format;
+
+    memcpy(pResult->levelOffsets, header.levelOffsets, sizeof(header.levelOffsets));
+    memcpy(pResult->levelSizes, header.levelSizes, sizeof(header.levelSizes));
+
+    return true;
+}
+
+void TextureCompressor::SaveToCache(uint64_t key, const ImageLoader::ResultInfo &compressed) const
+{
+    if (cachePath.empty())
+    {
+        return;
+    }
+
+    char path[TEXTURE_FILE_PATH_MAX_LENGTH];
+    snprintf(path, sizeof(path), "%s%016llx.bc", cachePath.c_str(), (unsigned long long)key);
+
+    FILE *file = fopen(path, "wb");
+
+    // cache is optional, ignore failures
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    CacheHeader header = {};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.format = (uint32_t)compressed.format;
+    header.width = compressed.baseSize.width;
+    header.height = compressed.baseSize.height;
+    header.levelCount = compressed.levelCount;
+    header.dataSize = compressed.dataSize;
+
+    memcpy(header.levelOffsets, compressed.levelOffsets, sizeof(header.levelOffsets));
+    memcpy(header.levelSizes, compressed.levelSizes, sizeof(header.levelSizes));
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(compressed.pData, compressed.dataSize, 1, file);
+
+    fclose(file);
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "ImageLoader.h"
+#include "TaskScheduler.h"
+
+namespace RTGL1
+{
+
+// CPU block compression for uncompressed RGBA8 material textures.
+// Mip levels are generated on CPU, as block-compressed images can't be blitted.
+class TextureCompressor
+{
+public:
+    explicit TextureCompressor(RgTextureCompression compression, const char *pCachePath, std::shared_ptr<TaskScheduler> taskScheduler);
+    ~TextureCompressor() = default;
+
+    TextureCompressor(const TextureCompressor &other) = delete;
+    TextureCompressor(TextureCompressor &&other) noexcept = delete;
+    TextureCompressor &operator=(const TextureCompressor &other) = delete;
+    TextureCompressor &operator=(TextureCompressor &&other) noexcept = delete;
+
+    // Compress RGBA8 image, materialTextureIndex defines its usage, see MATERIAL_*_INDEX.
+    // Returns false, if the image should be uploaded as is. Otherwise, pResult contains
+    // block-compressed data with pregenerated mip levels, that is stored in 'storage'.
+    bool Compress(const ImageLoader::ResultInfo &source, uint32_t materialTextureIndex, bool generateMipmaps,
+                  std::vector<uint8_t> &storage, ImageLoader::ResultInfo *pResult) const;
+
+private:
+    enum class BlockFormat
+    {
+        BC1,
+        BC3,
+        BC5,
+        BC7,
+    };
+
+private:
+    void EncodeLevel(const uint8_t *pRGBA, uint32_t width, uint32_t height, BlockFormat blockFormat, uint8_t *pDst) const;
+    void Downsample(const uint8_t *pSrc, uint32_t srcWidth, uint32_t srcHeight, bool isSRGB, uint8_t *pDst) const;
+
+    // Cache entry is valid only if it has the expected format, size and the layout of levels
+    bool LoadFromCache(uint64_t key, VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount, uint32_t blockSize,
+                       std::vector<uint8_t> &storage, ImageLoader::ResultInfo *pResult) const;
+    void SaveToCache(uint64_t key, const ImageLoader::ResultInfo &compressed) const;
+
+private:
+    RgTextureCompression compression;
+    std::string cachePath;
+    std::shared_ptr<TaskScheduler> taskScheduler;
+};
+
+}
@@ -23,9 +23,10 @@
 
 using namespace RTGL1;
 
-TextureDescriptors::TextureDescriptors(VkDevice _device, std::shared_ptr<SamplerManager> _samplerManager, uint32_t _maxTextureCount, uint32_t _bindingIndex) :
+TextureDescriptors::TextureDescriptors(VkDevice _device, std::shared_ptr<SamplerManager> _samplerManager, uint32_t _maxTextureCount, uint32_t _bindingIndex, uint32_t _frameCount) :
     device(_device),
     samplerManager(std::move(_samplerManager)),
+    frameCount(_frameCount),
     bindingIndex(_bindingIndex),
     descPool(VK_NULL_HANDLE),
     descLayout(VK_NULL_HANDLE),
@@ -37,7 +38,7 @@ TextureDescriptors::TextureDescriptors(VkDevice _device, std::shared_ptr<Sampler
     writeImageInfos.resize(_maxTextureCount);
     writeInfos.resize(_maxTextureCount);
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         writeCache[i].resize(_maxTextureCount);
     }
@@ -88,11 +89,11 @@ void TextureDescriptors::CreateDescriptors(uint32_t maxTextureCount)
 
     VkDescriptorPoolSize poolSize = {};
     poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSize.descriptorCount = maxTextureCount * MAX_FRAMES_IN_FLIGHT;
+    poolSize.descriptorCount = maxTextureCount * frameCount;
 
     VkDescriptorPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+    poolInfo.maxSets = frameCount;
     poolInfo.poolSizeCount = 1;
     poolInfo.pPoolSizes = &poolSize;
 
@@ -107,7 +108,7 @@ void TextureDescriptors::CreateDescriptors(uint32_t maxTextureCount)
     setInfo.descriptorSetCount = 1;
     setInfo.pSetLayouts = &descLayout;
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         r = vkAllocateDescriptorSets(device, &setInfo, &descSets[i]);
         VK_CHECKERROR(r);
@@ -135,7 +136,7 @@ void TextureDescriptors::ResetCache(uint32_t frameIndex, uint32_t textureIndex)
 
 void RTGL1::TextureDescriptors::ResetAllCache(uint32_t frameIndex)
 {
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < frameCount; i++)
     {
         for (auto &f : writeCache[i])
         {
@@ -31,7 +31,7 @@ namespace RTGL1
 class TextureDescriptors
 {
 public:
-    explicit TextureDescriptors(VkDevice device, std::shared_ptr<SamplerManager> samplerManager, uint32_t maxTextureCount, uint32_t bindingIndex);
+    explicit TextureDescriptors(VkDevice device, std::shared_ptr<SamplerManager> samplerManager, uint32_t maxTextureCount, uint32_t bindingIndex, uint32_t frameCount);
     ~TextureDescriptors();
 
     TextureDescriptors(const TextureDescriptors &other) = delete;
@@ -70,6 +70,7 @@ private:
 private:
     VkDevice device;
     std::shared_ptr<SamplerManager> samplerManager;
+    uint32_t frameCount;
 
     uint32_t bindingIndex;
 
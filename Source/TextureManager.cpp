@@ -42,10 +42,12 @@ TextureManager::TextureManager(
     std::shared_ptr<MemoryAllocator> _memAllocator,
     std::shared_ptr<SamplerManager> _samplerMgr,
     const std::shared_ptr<CommandBufferManager> &_cmdManager,
+    std::shared_ptr<TaskScheduler> _taskScheduler,
     std::shared_ptr<UserFileLoad> _userFileLoad,
     const RgInstanceCreateInfo &_info)
 :
     device(_device),
+    memAllocator(_memAllocator),
     samplerMgr(std::move(_samplerMgr)),
     currentDynamicSamplerFilter(DefaultDynamicSamplerFilter)
 {
@@ -74,11 +76,16 @@ TextureManager::TextureManager(
     const uint32_t maxTextureCount = std::max<uint32_t>(TEXTURE_COUNT_MIN, std::min<uint32_t>(_info.maxTextureCount, TEXTURE_COUNT_MAX));
 
     imageLoader = std::make_shared<ImageLoader>(std::move(_userFileLoad));
-    textureDesc = std::make_shared<TextureDescriptors>(device, samplerMgr, maxTextureCount, BINDING_TEXTURES);
-    textureUploader = std::make_shared<TextureUploader>(device, std::move(_memAllocator));
+    textureDesc = std::make_shared<TextureDescriptors>(device, samplerMgr, maxTextureCount, BINDING_TEXTURES, _memAllocator->GetFrameCount());
+    textureUploader = std::make_shared<TextureUploader>(device, std::move(_memAllocator), _taskScheduler);
+    textureCompressor = std::make_shared<TextureCompressor>(_info.staticTextureCompression, _info.pCompressedTexturesCachePath, std::move(_taskScheduler));
+    residency = std::make_shared<TextureResidency>(maxTextureCount, _info.textureMemoryBudget, !!_info.textureMemoryBudgetUseDeviceBudget);
 
     textures.resize(maxTextureCount);
 
+    animatedMaterialTable.resize(MAX_ANIMATED_MATERIAL_SLOTS * 4, EMPTY_TEXTURE_INDEX);
+    animatedMaterialSlotsInUse.resize(MAX_ANIMATED_MATERIAL_SLOTS, false);
+
     // submit cmd to create empty texture
     VkCommandBuffer cmd = _cmdManager->StartGraphicsCmd();
     CreateEmptyTexture(cmd, 0);
@@ -131,6 +138,7 @@ void RTGL1::TextureManager::CreateWaterNormalTexture(VkCommandBuffer cmd, uint32
 
     TextureOverrides::OverrideInfo parseInfo = {};
     parseInfo.disableOverride = false;
+    parseInfo.keepSupercompressed = true;
     // use absolute path
     parseInfo.texturesPath = "";
     for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
@@ -177,6 +185,7 @@ void TextureManager::PrepareForFrame(uint32_t frameIndex)
         DestroyTexture(texture);
     }
     texturesToDestroy[frameIndex].clear();
+    residency->PrepareForFrame(frameIndex);
 
     // clear staging buffer that are not in use
     textureUploader->ClearStaging(frameIndex);
@@ -222,6 +231,39 @@ void TextureManager::SubmitDescriptors(uint32_t frameIndex,
     textureDesc->FlushDescWrites();
 }
 
+void TextureManager::UpdateResidency(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    uint64_t deviceAvailable = UINT64_MAX;
+
+    if (residency->UsesDeviceBudget())
+    {
+        VkDeviceSize usage, budget;
+        memAllocator->GetDeviceLocalBudget(&usage, &budget);
+
+        // textures can occupy the memory that is not used by other resources;
+        // images that wait for destruction are not counted, they'll be freed soon,
+        // otherwise each drop would make the budget look smaller
+        const uint64_t textureUsage = residency->GetResidentSize() + residency->GetPendingDestroySize();
+        const uint64_t otherUsage = usage - std::min<uint64_t>(usage, textureUsage);
+        deviceAvailable = budget > otherUsage ? budget - otherUsage : 0;
+    }
+
+    residency->Update(deviceAvailable, reloadRequests);
+
+    for (const auto &r : reloadRequests)
+    {
+        // dropped levels are already on the device, only restored ones need the file
+        bool wasReloaded = r.isDrop ? 
+            DropTextureLevels(cmd, frameIndex, r) : 
+            ReloadTexture(cmd, frameIndex, r);
+
+        if (!wasReloaded)
+        {
+            residency->OnReloadFailed(r.textureIndex);
+        }
+    }
+}
+
 uint32_t TextureManager::CreateStaticMaterial(VkCommandBuffer cmd, uint32_t frameIndex, const RgStaticMaterialCreateInfo &createInfo)
 {
     if (createInfo.pRelativePath == nullptr && 
@@ -236,6 +278,8 @@ uint32_t TextureManager::CreateStaticMaterial(VkCommandBuffer cmd, uint32_t fram
 
     TextureOverrides::OverrideInfo parseInfo = {};
     parseInfo.disableOverride = createInfo.flags & RG_MATERIAL_CREATE_DISABLE_OVERRIDE_BIT;
+    // level data is inflated directly to the staging buffer
+    parseInfo.keepSupercompressed = true;
     parseInfo.texturesPath = defaultTexturesPath.c_str();
     for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
     {
@@ -247,12 +291,22 @@ uint32_t TextureManager::CreateStaticMaterial(VkCommandBuffer cmd, uint32_t fram
     TextureOverrides ovrd(createInfo.pRelativePath, createInfo.textures, createInfo.size, parseInfo, imageLoader);
 
 
+    const bool useMipmaps = !(createInfo.flags & RG_MATERIAL_CREATE_DONT_GENERATE_MIPMAPS_BIT);
+
     MaterialTextures mtextures = {};
 
     for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
     {
-        mtextures.indices[i] = PrepareStaticTexture(cmd, frameIndex, ovrd.GetResult(i), samplerHandle,
-                                                   !(createInfo.flags & RG_MATERIAL_CREATE_DONT_GENERATE_MIPMAPS_BIT), ovrd.GetDebugName());
+        // if there's no overriding file, user's uncompressed data can be compressed
+        std::vector<uint8_t> compressedData;
+        ImageLoader::ResultInfo compressed = {};
+
+        const bool wasCompressed = 
+            ovrd.IsUserData(i) && 
+            textureCompressor->Compress(ovrd.GetResult(i), i, useMipmaps, compressedData, &compressed);
+
+        mtextures.indices[i] = PrepareStaticTexture(cmd, frameIndex, wasCompressed ? compressed : ovrd.GetResult(i), samplerHandle,
+                                                   useMipmaps, ovrd.GetDebugName(), ovrd.GetFilePath(i));
     }
 
 
@@ -348,7 +402,7 @@ uint32_t TextureManager::PrepareStaticTexture(
     VkCommandBuffer cmd, uint32_t frameIndex, 
     const ImageLoader::ResultInfo &imageInfo,
     SamplerManager::Handle samplerHandle, bool useMipmaps,
-    const char *debugName)
+    const char *debugName, const char *pFilePath)
 {
     // only dynamic textures can have null data
     if (imageInfo.pData == nullptr)
@@ -369,6 +423,50 @@ uint32_t TextureManager::PrepareStaticTexture(
     assert(imageInfo.dataSize > 0);
     assert(imageInfo.levelCount > 0 && imageInfo.levelSizes[0] > 0);
 
+    auto result = UploadStaticImage(cmd, frameIndex, imageInfo, useMipmaps, debugName);
+
+    if (!result.wasUploaded)
+    {
+        return EMPTY_TEXTURE_INDEX;
+    }
+
+    uint32_t textureIndex = InsertTexture(frameIndex, result.image, result.view, samplerHandle);
+
+    if (textureIndex == EMPTY_TEXTURE_INDEX)
+    {
+        return EMPTY_TEXTURE_INDEX;
+    }
+
+    // only files with pregenerated mip levels can be reloaded with fewer levels
+    if (pFilePath != nullptr && imageInfo.isPregenerated && useMipmaps && imageInfo.levelCount > 1)
+    {
+        residency->AddReloadable(textureIndex, imageInfo, pFilePath);
+    }
+    else if (imageInfo.isPregenerated)
+    {
+        uint64_t size = 0;
+
+        for (uint32_t i = 0; i < (useMipmaps ? imageInfo.levelCount : 1); i++)
+        {
+            size += imageInfo.levelSizes[i];
+        }
+
+        residency->AddFixed(textureIndex, size);
+    }
+    else
+    {
+        // approximately, with generated mip levels
+        residency->AddFixed(textureIndex, useMipmaps ? imageInfo.dataSize * 4ull / 3 : imageInfo.dataSize);
+    }
+
+    return textureIndex;
+}
+
+TextureUploader::UploadResult TextureManager::UploadStaticImage(
+    VkCommandBuffer cmd, uint32_t frameIndex,
+    const ImageLoader::ResultInfo &imageInfo,
+    bool useMipmaps, const char *debugName)
+{
     TextureUploader::UploadInfo info = {};
     info.cmd = cmd;
     info.frameIndex = frameIndex;
@@ -383,15 +481,113 @@ uint32_t TextureManager::PrepareStaticTexture(
     info.pregeneratedLevelCount = imageInfo.isPregenerated ? imageInfo.levelCount : 0;
     info.pLevelDataOffsets = imageInfo.levelOffsets;
     info.pLevelDataSizes = imageInfo.levelSizes;
+    info.isSupercompressed = imageInfo.isSupercompressed;
+    info.pLevelSupercompressedOffsets = imageInfo.levelSupercompressedOffsets;
+    info.pLevelSupercompressedSizes = imageInfo.levelSupercompressedSizes;
 
-    auto result = textureUploader->UploadImage(info);
+    return textureUploader->UploadImage(info);
+}
+
+bool TextureManager::ReloadTexture(VkCommandBuffer cmd, uint32_t frameIndex, const TextureResidency::ReloadRequest &request)
+{
+    Texture &texture = textures[request.textureIndex];
+    assert(texture.image != VK_NULL_HANDLE && texture.view != VK_NULL_HANDLE);
+
+    const char *pFilePath = residency->GetFilePath(request.textureIndex);
+    const uint32_t baseLevel = request.baseLevel;
+
+    ImageLoader::ResultInfo loaded = {};
+    bool wasLoaded = imageLoader->Load(pFilePath, &loaded, true);
+
+    // the file could be changed or removed since the texture was created
+    if (!wasLoaded || !loaded.isPregenerated || baseLevel >= loaded.levelCount)
+    {
+        imageLoader->FreeLoaded();
+        return false;
+    }
+
+    // take only the levels starting from the base one;
+    // level data can be stored in any order, so find its range
+    uint32_t dataBegin = UINT32_MAX;
+    uint32_t dataEnd = 0;
+
+    for (uint32_t i = baseLevel; i < loaded.levelCount; i++)
+    {
+        dataBegin = std::min(dataBegin, loaded.levelOffsets[i]);
+        dataEnd = std::max(dataEnd, loaded.levelOffsets[i] + loaded.levelSizes[i]);
+    }
+
+    ImageLoader::ResultInfo levels = {};
+    levels.levelCount = loaded.levelCount - baseLevel;
+    levels.isPregenerated = true;
+    levels.isSupercompressed = loaded.isSupercompressed;
+    // supercompressed levels are inflated to the offsets, so the source data is not shifted
+    levels.pData = loaded.isSupercompressed ? loaded.pData : loaded.pData + dataBegin;
+    levels.dataSize = dataEnd - dataBegin;
+    levels.baseSize = { std::max(loaded.baseSize.width >> baseLevel, 1u), std::max(loaded.baseSize.height >> baseLevel, 1u) };
+    // with the same sRGB fix as on creation
+    levels.format = residency->GetFormat(request.textureIndex);
+
+    for (uint32_t i = 0; i < levels.levelCount; i++)
+    {
+        levels.levelOffsets[i] = loaded.levelOffsets[baseLevel + i] - dataBegin;
+        levels.levelSizes[i] = loaded.levelSizes[baseLevel + i];
+        levels.levelSupercompressedOffsets[i] = loaded.levelSupercompressedOffsets[baseLevel + i];
+        levels.levelSupercompressedSizes[i] = loaded.levelSupercompressedSizes[baseLevel + i];
+    }
+
+    auto result = UploadStaticImage(cmd, frameIndex, levels, true, pFilePath);
+
+    imageLoader->FreeLoaded();
 
     if (!result.wasUploaded)
     {
-        return EMPTY_TEXTURE_INDEX;
+        return false;
+    }
+
+    // previous image can still be in use by other frames;
+    // the descriptor is rewritten in SubmitDescriptors
+    AddToBeDestroyed(frameIndex, texture);
+
+    texture.image = result.image;
+    texture.view = result.view;
+
+    residency->OnReloaded(request.textureIndex, baseLevel, frameIndex);
+    return true;
+}
+
+bool TextureManager::DropTextureLevels(VkCommandBuffer cmd, uint32_t frameIndex, const TextureResidency::ReloadRequest &request)
+{
+    Texture &texture = textures[request.textureIndex];
+    assert(texture.image != VK_NULL_HANDLE && texture.view != VK_NULL_HANDLE);
+
+    const uint32_t curBaseLevel = residency->GetBaseLevel(request.textureIndex);
+    const uint32_t fileLevelCount = residency->GetLevelCount(request.textureIndex);
+    const RgExtent2D fileBaseSize = residency->GetBaseSize(request.textureIndex);
+
+    assert(request.baseLevel > curBaseLevel && request.baseLevel < fileLevelCount);
+
+    const RgExtent2D curSize = { std::max(fileBaseSize.width >> curBaseLevel, 1u), std::max(fileBaseSize.height >> curBaseLevel, 1u) };
+
+    auto result = textureUploader->CopyImageLevels(
+        cmd, texture.image, curSize, fileLevelCount - curBaseLevel,
+        request.baseLevel - curBaseLevel, residency->GetFormat(request.textureIndex),
+        residency->GetFilePath(request.textureIndex));
+
+    if (!result.wasUploaded)
+    {
+        return false;
     }
 
-    return InsertTexture(frameIndex, result.image, result.view, samplerHandle);
+    // previous image can still be in use by other frames;
+    // the descriptor is rewritten in SubmitDescriptors
+    AddToBeDestroyed(frameIndex, texture);
+
+    texture.image = result.image;
+    texture.view = result.view;
+
+    residency->OnReloaded(request.textureIndex, request.baseLevel, frameIndex);
+    return true;
 }
 
 uint32_t TextureManager::PrepareDynamicTexture(
@@ -426,7 +622,14 @@ uint32_t TextureManager::PrepareDynamicTexture(
         return EMPTY_TEXTURE_INDEX;
     }
 
-    return InsertTexture(frameIndex, result.image, result.view, samplerHandle);
+    uint32_t textureIndex = InsertTexture(frameIndex, result.image, result.view, samplerHandle);
+
+    if (textureIndex != EMPTY_TEXTURE_INDEX)
+    {
+        residency->AddFixed(textureIndex, generateMipmaps ? dataSize * 4ull / 3 : dataSize);
+    }
+
+    return textureIndex;
 }
 
 uint32_t TextureManager::CreateAnimatedMaterial(VkCommandBuffer cmd, uint32_t frameIndex, const RgAnimatedMaterialCreateInfo &createInfo)
@@ -466,6 +669,13 @@ bool TextureManager::ChangeAnimatedMaterialFrame(uint32_t animMaterial, uint32_t
 
         anim.currentFrame = materialFrame;
 
+        // geometries reference the slot, so only one table entry should be changed
+        if (anim.slot != NO_ANIMATED_MATERIAL_SLOT)
+        {
+            WriteAnimatedMaterialSlot(anim);
+            return true;
+        }
+
         // notify subscribers
         for (auto &ws : subscribers)
         {
@@ -572,10 +782,44 @@ uint32_t TextureManager::InsertAnimatedMaterial(std::vector<uint32_t> &materialI
     AnimatedMaterial &animMat = animatedMaterials[animMatIndex];
     animMat.currentFrame = 0;
     animMat.materialIndices = std::move(materialIndices);
+    animMat.slot = AllocateAnimatedMaterialSlot();
+
+    if (animMat.slot != NO_ANIMATED_MATERIAL_SLOT)
+    {
+        WriteAnimatedMaterialSlot(animMat);
+    }
 
     return animMatIndex;
 }
 
+uint32_t TextureManager::AllocateAnimatedMaterialSlot()
+{
+    for (uint32_t i = 0; i < MAX_ANIMATED_MATERIAL_SLOTS; i++)
+    {
+        if (!animatedMaterialSlotsInUse[i])
+        {
+            animatedMaterialSlotsInUse[i] = true;
+            return i;
+        }
+    }
+
+    // if there are no free slots, geometries will be updated
+    // through subscribers on each frame change
+    return NO_ANIMATED_MATERIAL_SLOT;
+}
+
+void TextureManager::WriteAnimatedMaterialSlot(const AnimatedMaterial &anim)
+{
+    assert(anim.slot < MAX_ANIMATED_MATERIAL_SLOTS);
+
+    const MaterialTextures frameTextures = GetMaterialTextures(anim.materialIndices[anim.currentFrame]);
+
+    for (uint32_t t = 0; t < TEXTURES_PER_MATERIAL_COUNT; t++)
+    {
+        animatedMaterialTable[anim.slot * 4 + t] = frameTextures.indices[t];
+    }
+}
+
 void TextureManager::DestroyMaterialTextures(uint32_t frameIndex, uint32_t materialIndex)
 {
     auto it = materials.find(materialIndex);
@@ -595,6 +839,7 @@ void TextureManager::DestroyMaterialTextures(uint32_t frameIndex, const Material
             Texture &texture = textures[t];
 
             AddToBeDestroyed(frameIndex, texture);
+            residency->Remove(t, frameIndex);
 
             // null data
             texture.image = VK_NULL_HANDLE;
@@ -624,6 +869,16 @@ void TextureManager::DestroyMaterial(uint32_t currentFrameIndex, uint32_t materi
             DestroyMaterialTextures(currentFrameIndex, mat);
         }
 
+        if (anim.slot != NO_ANIMATED_MATERIAL_SLOT)
+        {
+            for (uint32_t t = 0; t < TEXTURES_PER_MATERIAL_COUNT; t++)
+            {
+                animatedMaterialTable[anim.slot * 4 + t] = EMPTY_TEXTURE_INDEX;
+            }
+
+            animatedMaterialSlotsInUse[anim.slot] = false;
+        }
+
         animatedMaterials.erase(animIt);
     }
     else
@@ -690,6 +945,17 @@ void TextureManager::AddToBeDestroyed(uint32_t frameIndex, const Texture &textur
     texturesToDestroy[frameIndex].push_back(texture);
 }
 
+void TextureManager::MarkUsed(const MaterialTextures &materialTextures) const
+{
+    for (uint32_t t : materialTextures.indices)
+    {
+        if (t != EMPTY_TEXTURE_INDEX)
+        {
+            residency->MarkUsed(t);
+        }
+    }
+}
+
 MaterialTextures TextureManager::GetMaterialTextures(uint32_t materialIndex) const
 {
     if (materialIndex == RG_NO_MATERIAL)
@@ -714,9 +980,77 @@ MaterialTextures TextureManager::GetMaterialTextures(uint32_t materialIndex) con
         return EmptyMaterialTextures;
     }
 
+    MarkUsed(it->second.textures);
     return it->second.textures;
 }
 
+MaterialTextures TextureManager::GetGeometryMaterialTextures(uint32_t materialIndex) const
+{
+    const auto animIt = animatedMaterials.find(materialIndex);
+
+    if (animIt != animatedMaterials.end() && animIt->second.slot != NO_ANIMATED_MATERIAL_SLOT)
+    {
+        const uint32_t slotRef = animIt->second.slot | MATERIAL_ANIMATED_SLOT_FLAG;
+
+        // any frame can be used, until the geometry is uploaded again
+        for (uint32_t m : animIt->second.materialIndices)
+        {
+            GetMaterialTextures(m);
+        }
+
+        // shaders will fetch actual texture indices from the table
+        return { slotRef, slotRef, slotRef };
+    }
+
+    return GetMaterialTextures(materialIndex);
+}
+
+void TextureManager::MarkUsedByStaticGeometry(uint32_t materialIndex)
+{
+    const auto markMaterial = [this] (uint32_t m)
+    {
+        const auto it = materials.find(m);
+
+        if (it != materials.end())
+        {
+            for (uint32_t t : it->second.textures.indices)
+            {
+                if (t != EMPTY_TEXTURE_INDEX)
+                {
+                    residency->MarkUsedByStaticGeometry(t);
+                }
+            }
+        }
+    };
+
+    const auto animIt = animatedMaterials.find(materialIndex);
+
+    if (animIt != animatedMaterials.end())
+    {
+        for (uint32_t m : animIt->second.materialIndices)
+        {
+            markMaterial(m);
+        }
+    }
+    else
+    {
+        markMaterial(materialIndex);
+    }
+}
+
+void TextureManager::ResetStaticGeometryUsage()
+{
+    residency->ResetStaticGeometryUsage();
+}
+
+void TextureManager::FillAnimatedMaterialTable(ShGlobalUniform *gu) const
+{
+    static_assert(sizeof(gu->animatedMaterialTextures) == MAX_ANIMATED_MATERIAL_SLOTS * 4 * sizeof(uint32_t), "");
+    assert(animatedMaterialTable.size() == MAX_ANIMATED_MATERIAL_SLOTS * 4);
+
+    memcpy(gu->animatedMaterialTextures, animatedMaterialTable.data(), sizeof(gu->animatedMaterialTextures));
+}
+
 VkDescriptorSet TextureManager::GetDescSet(uint32_t frameIndex) const
 {
     return textureDesc->GetDescSet(frameIndex);
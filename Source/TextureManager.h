@@ -30,12 +30,17 @@
 #include "IMaterialDependency.h"
 #include "MemoryAllocator.h"
 #include "SamplerManager.h"
+#include "TaskScheduler.h"
+#include "TextureCompressor.h"
 #include "TextureDescriptors.h"
+#include "TextureResidency.h"
 #include "TextureUploader.h"
 
 namespace RTGL1
 {
 
+struct ShGlobalUniform;
+
 class TextureManager
 {
 public:
@@ -44,6 +49,7 @@ public:
         std::shared_ptr<MemoryAllocator> memAllocator,
         std::shared_ptr<SamplerManager> samplerManager,
         const std::shared_ptr<CommandBufferManager> &cmdManager,
+        std::shared_ptr<TaskScheduler> taskScheduler,
         std::shared_ptr<UserFileLoad> userFileLoad,
         const RgInstanceCreateInfo &info);
     ~TextureManager();
@@ -57,6 +63,9 @@ public:
     void SubmitDescriptors(uint32_t frameIndex,
                            const RgDrawFrameTexturesParams *pTexturesParams,
                            bool forceUpdateAllDescriptors = false); // true, if mip lod bias was changed, for example
+    // Drop or restore mip levels of textures to keep them in the memory budget.
+    // Must be called once per frame, before submitting descriptors.
+    void UpdateResidency(VkCommandBuffer cmd, uint32_t frameIndex);
 
     uint32_t CreateStaticMaterial(VkCommandBuffer cmd, uint32_t frameIndex, const RgStaticMaterialCreateInfo &createInfo);
 
@@ -69,6 +78,16 @@ public:
     void DestroyMaterial(uint32_t currentFrameIndex, uint32_t materialIndex);
 
     MaterialTextures GetMaterialTextures(uint32_t materialIndex) const;
+    // Same as GetMaterialTextures, but for animated materials that have a slot
+    // in the animated material table, texture indices reference that slot,
+    // so geometry doesn't need to be updated when an animation frame is changed.
+    MaterialTextures GetGeometryMaterialTextures(uint32_t materialIndex) const;
+    // Textures of static geometry are considered in use until static geometry is reset,
+    // as the geometry is not uploaded each frame
+    void MarkUsedByStaticGeometry(uint32_t materialIndex);
+    void ResetStaticGeometryUsage();
+    // Copy animated material table to the global uniform
+    void FillAnimatedMaterialTable(ShGlobalUniform *gu) const;
 
     static constexpr uint32_t GetEmptyTextureIndex();
     uint32_t GetWaterNormalTextureIndex() const;
@@ -87,7 +106,13 @@ private:
 
     uint32_t PrepareStaticTexture(
         VkCommandBuffer cmd, uint32_t frameIndex, const ImageLoader::ResultInfo &info,
-        SamplerManager::Handle samplerHandle, bool useMipmaps, const char *debugName);
+        SamplerManager::Handle samplerHandle, bool useMipmaps, const char *debugName,
+        const char *pFilePath = nullptr);
+    TextureUploader::UploadResult UploadStaticImage(
+        VkCommandBuffer cmd, uint32_t frameIndex, const ImageLoader::ResultInfo &info,
+        bool useMipmaps, const char *debugName);
+    bool ReloadTexture(VkCommandBuffer cmd, uint32_t frameIndex, const TextureResidency::ReloadRequest &request);
+    bool DropTextureLevels(VkCommandBuffer cmd, uint32_t frameIndex, const TextureResidency::ReloadRequest &request);
 
     uint32_t PrepareDynamicTexture(
         VkCommandBuffer cmd, uint32_t frameIndex, const void *data, uint32_t dataSize, const RgExtent2D &size,
@@ -96,6 +121,7 @@ private:
     uint32_t InsertTexture(uint32_t frameIndex, VkImage image, VkImageView view, SamplerManager::Handle samplerHandle);
     void DestroyTexture(const Texture &texture);
     void AddToBeDestroyed(uint32_t frameIndex, const Texture &texture);
+    void MarkUsed(const MaterialTextures &materialTextures) const;
 
     uint32_t GenerateMaterialIndex(const MaterialTextures &materialTextures);
     uint32_t GenerateMaterialIndex(const std::vector<uint32_t> &materialIndices);
@@ -106,14 +132,21 @@ private:
     void DestroyMaterialTextures(uint32_t frameIndex, uint32_t materialIndex);
     void DestroyMaterialTextures(uint32_t frameIndex, const Material &material);
 
+    uint32_t AllocateAnimatedMaterialSlot();
+    void WriteAnimatedMaterialSlot(const AnimatedMaterial &anim);
+
 private:
     VkDevice device;
 
+    std::shared_ptr<MemoryAllocator> memAllocator;
     std::shared_ptr<ImageLoader> imageLoader;
 
     std::shared_ptr<SamplerManager> samplerMgr;
     std::shared_ptr<TextureDescriptors> textureDesc;
     std::shared_ptr<TextureUploader> textureUploader;
+    std::shared_ptr<TextureCompressor> textureCompressor;
+    std::shared_ptr<TextureResidency> residency;
+    std::vector<TextureResidency::ReloadRequest> reloadRequests;
 
     std::vector<Texture> textures;
     // Textures are not destroyed immediately, but when
@@ -123,6 +156,11 @@ private:
     rgl::unordered_map<uint32_t, AnimatedMaterial> animatedMaterials;
     rgl::unordered_map<uint32_t, Material> materials;
 
+    // Current frame texture indices of animated materials, indexed by slot;
+    // uploaded each frame to the global uniform
+    std::vector<uint32_t> animatedMaterialTable;
+    std::vector<bool> animatedMaterialSlotsInUse;
+
     uint32_t waterNormalTextureIndex;
 
     RgSamplerFilter currentDynamicSamplerFilter;
@@ -87,6 +87,8 @@ TextureOverrides::TextureOverrides(
     std::shared_ptr<ImageLoader> _imageLoader) 
 :
     results{},
+    isUserData{},
+    filePaths{},
     debugName{},
     imageLoader(_imageLoader)
 {
@@ -111,7 +113,10 @@ TextureOverrides::TextureOverrides(
         {
             for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
             {
-                _imageLoader->Load(paths[i], &results[i]);
+                if (_imageLoader->Load(paths[i], &results[i], _overrideInfo.keepSupercompressed))
+                {
+                    memcpy(filePaths[i], paths[i], TEXTURE_FILE_PATH_MAX_LENGTH);
+                }
 
                 // fix format, if needed
                 results[i].format = _overrideInfo.overridenIsSRGB[i] ?
@@ -139,6 +144,8 @@ TextureOverrides::TextureOverrides(
             results[i].levelSizes[0] = defaultDataSize;
             results[i].baseSize = _defaultSize;
             results[i].format = defaultData[i]->isSRGB ? defaultSRGBFormat : defaultLinearFormat;
+
+            isUserData[i] = true;
         }
     }
 }
@@ -235,6 +242,18 @@ const ImageLoader::ResultInfo &RTGL1::TextureOverrides::GetResult(uint32_t index
     return results[index];
 }
 
+bool RTGL1::TextureOverrides::IsUserData(uint32_t index) const
+{
+    assert(index < TEXTURES_PER_MATERIAL_COUNT);
+    return isUserData[index];
+}
+
+const char *RTGL1::TextureOverrides::GetFilePath(uint32_t index) const
+{
+    assert(index < TEXTURES_PER_MATERIAL_COUNT);
+    return filePaths[index][0] != '\0' ? filePaths[index] : nullptr;
+}
+
 const char *RTGL1::TextureOverrides::GetDebugName() const
 {
     return debugName;
@@ -43,6 +43,9 @@ public:
         // isn't overriden, RgTextureData::isSRGB value is used
         // instead of one of these params.
         bool overridenIsSRGB[TEXTURES_PER_MATERIAL_COUNT] = {};
+        // If true, zstd-supercompressed files are not inflated on loading,
+        // see ImageLoader::ResultInfo::isSupercompressed
+        bool keepSupercompressed = false;
     };
 
 public:
@@ -67,6 +70,10 @@ public:
     TextureOverrides &operator=(TextureOverrides &&other) noexcept = delete;
 
     const ImageLoader::ResultInfo &GetResult(uint32_t index) const;
+    // True, if the result is the default data, i.e. the texture wasn't overriden
+    bool IsUserData(uint32_t index) const;
+    // Path of the file that the result was loaded from, or null
+    const char *GetFilePath(uint32_t index) const;
     const char *GetDebugName() const;
 
 private:
@@ -77,6 +84,8 @@ private:
 
 private:
     ImageLoader::ResultInfo results[TEXTURES_PER_MATERIAL_COUNT];
+    bool isUserData[TEXTURES_PER_MATERIAL_COUNT];
+    char filePaths[TEXTURES_PER_MATERIAL_COUNT][TEXTURE_FILE_PATH_MAX_LENGTH];
     char debugName[TEXTURE_DEBUG_NAME_MAX_LENGTH];
 
     std::weak_ptr<ImageLoader> imageLoader;
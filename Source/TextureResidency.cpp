@@ -0,0 +1,354 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TextureResidency.h"
+
+#include <algorithm>
+
+using namespace RTGL1;
+
+// Levels are restored only if the total size stays below this fraction
+// of the budget, so the same levels are not dropped and restored each frame
+constexpr double RESTORE_BUDGET_FRACTION = 0.9;
+// Textures that were used during this count of last frames can restore their levels
+constexpr uint64_t RECENTLY_USED_FRAME_COUNT = 2;
+// Dropping a level is a copy on the device, so many of them can be done in a frame
+constexpr uint32_t MAX_DROP_REQUESTS_PER_FRAME = 32;
+// Restoring a level reloads a file, so it's amortized over frames to avoid long stalls
+constexpr uint32_t MAX_RESTORE_REQUESTS_PER_FRAME = 2;
+// Don't drop a level, if the next one would be smaller than this
+constexpr uint32_t MIN_RESIDENT_BASE_SIZE = 64;
+
+
+TextureResidency::TextureResidency(uint32_t _maxTextureCount, uint64_t _budget, bool _useDeviceBudget)
+:
+    residentSize(0),
+    pendingDestroySize{},
+    budget(_budget),
+    useDeviceBudget(_useDeviceBudget),
+    currentFrame(0)
+{
+    entries.resize(_maxTextureCount);
+}
+
+void TextureResidency::AddFixed(uint32_t textureIndex, uint64_t size)
+{
+    assert(textureIndex < entries.size());
+    assert(!entries[textureIndex].isValid);
+
+    Entry &e = entries[textureIndex];
+    e = {};
+    e.isValid = true;
+    e.isReloadable = false;
+    e.lastUsedFrame = currentFrame;
+    e.baseLevel = 0;
+    e.levelCount = 1;
+    e.levelSizes[0] = size;
+
+    residentSize += GetResidentSize(e);
+}
+
+void TextureResidency::AddReloadable(uint32_t textureIndex, const ImageLoader::ResultInfo &info, const char *pFilePath)
+{
+    assert(textureIndex < entries.size());
+    assert(!entries[textureIndex].isValid);
+    assert(info.isPregenerated && pFilePath != nullptr);
+
+    Entry &e = entries[textureIndex];
+    e = {};
+    e.isValid = true;
+    e.isReloadable = true;
+    e.lastUsedFrame = currentFrame;
+    e.baseLevel = 0;
+    e.levelCount = std::min(info.levelCount, MAX_PREGENERATED_MIPMAP_LEVELS);
+    for (uint32_t i = 0; i < e.levelCount; i++)
+    {
+        e.levelSizes[i] = info.levelSizes[i];
+    }
+    e.size = info.baseSize;
+    e.format = info.format;
+    e.filePath = pFilePath;
+
+    residentSize += GetResidentSize(e);
+}
+
+void TextureResidency::Remove(uint32_t textureIndex, uint32_t frameIndex)
+{
+    assert(textureIndex < entries.size());
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    Entry &e = entries[textureIndex];
+
+    if (e.isValid)
+    {
+        assert(residentSize >= GetResidentSize(e));
+        residentSize -= GetResidentSize(e);
+        pendingDestroySize[frameIndex] += GetResidentSize(e);
+
+        e = {};
+    }
+}
+
+void TextureResidency::PrepareForFrame(uint32_t frameIndex)
+{
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+    pendingDestroySize[frameIndex] = 0;
+}
+
+void TextureResidency::MarkUsed(uint32_t textureIndex)
+{
+    if (textureIndex < entries.size())
+    {
+        entries[textureIndex].lastUsedFrame = currentFrame;
+    }
+}
+
+void TextureResidency::MarkUsedByStaticGeometry(uint32_t textureIndex)
+{
+    if (textureIndex < entries.size())
+    {
+        entries[textureIndex].isUsedByStaticGeometry = true;
+    }
+}
+
+void TextureResidency::ResetStaticGeometryUsage()
+{
+    for (Entry &e : entries)
+    {
+        if (e.isUsedByStaticGeometry)
+        {
+            e.isUsedByStaticGeometry = false;
+            e.lastUsedFrame = currentFrame;
+        }
+    }
+}
+
+void TextureResidency::Update(uint64_t deviceAvailable, std::vector<ReloadRequest> &outRequests)
+{
+    outRequests.clear();
+
+    uint64_t limit = budget > 0 ? budget : UINT64_MAX;
+
+    if (useDeviceBudget)
+    {
+        limit = std::min(limit, deviceAvailable);
+    }
+
+    const auto getLastUsedFrame = [this] (const Entry &e)
+    {
+        return e.isUsedByStaticGeometry ? currentFrame : e.lastUsedFrame;
+    };
+
+    std::vector<uint32_t> candidates;
+
+    if (limit == UINT64_MAX)
+    {
+        // no limits
+    }
+    else if (residentSize > limit)
+    {
+        for (uint32_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].isValid && CanDropLevel(entries[i]))
+            {
+                candidates.push_back(i);
+            }
+        }
+
+        // least recently used first, and the biggest of them
+        std::sort(candidates.begin(), candidates.end(), [&] (uint32_t a, uint32_t b)
+        {
+            const Entry &ea = entries[a];
+            const Entry &eb = entries[b];
+
+            if (getLastUsedFrame(ea) != getLastUsedFrame(eb))
+            {
+                return getLastUsedFrame(ea) < getLastUsedFrame(eb);
+            }
+
+            return GetResidentSize(ea) > GetResidentSize(eb);
+        });
+
+        uint64_t newSize = residentSize;
+
+        for (uint32_t i : candidates)
+        {
+            if (newSize <= limit || outRequests.size() >= MAX_DROP_REQUESTS_PER_FRAME)
+            {
+                break;
+            }
+
+            const Entry &e = entries[i];
+
+            newSize -= e.levelSizes[e.baseLevel];
+            outRequests.push_back({ i, e.baseLevel + 1, true });
+        }
+    }
+    else
+    {
+        const uint64_t restoreLimit = static_cast<uint64_t>(static_cast<double>(limit) * RESTORE_BUDGET_FRACTION);
+
+        for (uint32_t i = 0; i < entries.size(); i++)
+        {
+            const Entry &e = entries[i];
+
+            if (e.isValid && e.isReloadable && e.baseLevel > 0 && 
+                getLastUsedFrame(e) + RECENTLY_USED_FRAME_COUNT > currentFrame)
+            {
+                candidates.push_back(i);
+            }
+        }
+
+        // most recently used first, and the smallest of them
+        std::sort(candidates.begin(), candidates.end(), [&] (uint32_t a, uint32_t b)
+        {
+            const Entry &ea = entries[a];
+            const Entry &eb = entries[b];
+
+            if (getLastUsedFrame(ea) != getLastUsedFrame(eb))
+            {
+                return getLastUsedFrame(ea) > getLastUsedFrame(eb);
+            }
+
+            return GetResidentSize(ea) < GetResidentSize(eb);
+        });
+
+        uint64_t newSize = residentSize;
+
+        for (uint32_t i : candidates)
+        {
+            if (outRequests.size() >= MAX_RESTORE_REQUESTS_PER_FRAME)
+            {
+                break;
+            }
+
+            const Entry &e = entries[i];
+            const uint64_t extra = e.levelSizes[e.baseLevel - 1];
+
+            if (newSize + extra > restoreLimit)
+            {
+                continue;
+            }
+
+            newSize += extra;
+            outRequests.push_back({ i, e.baseLevel - 1, false });
+        }
+    }
+
+    currentFrame++;
+}
+
+void TextureResidency::OnReloaded(uint32_t textureIndex, uint32_t baseLevel, uint32_t frameIndex)
+{
+    assert(textureIndex < entries.size());
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    Entry &e = entries[textureIndex];
+    assert(e.isValid && e.isReloadable && baseLevel < e.levelCount);
+
+    residentSize -= GetResidentSize(e);
+    pendingDestroySize[frameIndex] += GetResidentSize(e);
+
+    e.baseLevel = baseLevel;
+    residentSize += GetResidentSize(e);
+}
+
+void TextureResidency::OnReloadFailed(uint32_t textureIndex)
+{
+    assert(textureIndex < entries.size());
+
+    // keep the current levels, so the same file is not loaded on each frame
+    entries[textureIndex].isReloadable = false;
+}
+
+bool TextureResidency::UsesDeviceBudget() const
+{
+    return useDeviceBudget;
+}
+
+uint64_t TextureResidency::GetResidentSize() const
+{
+    return residentSize;
+}
+
+uint64_t TextureResidency::GetPendingDestroySize() const
+{
+    uint64_t size = 0;
+
+    for (uint64_t s : pendingDestroySize)
+    {
+        size += s;
+    }
+
+    return size;
+}
+
+const char *TextureResidency::GetFilePath(uint32_t textureIndex) const
+{
+    assert(textureIndex < entries.size() && entries[textureIndex].isReloadable);
+    return entries[textureIndex].filePath.c_str();
+}
+
+VkFormat TextureResidency::GetFormat(uint32_t textureIndex) const
+{
+    assert(textureIndex < entries.size() && entries[textureIndex].isReloadable);
+    return entries[textureIndex].format;
+}
+
+uint32_t TextureResidency::GetBaseLevel(uint32_t textureIndex) const
+{
+    assert(textureIndex < entries.size() && entries[textureIndex].isReloadable);
+    return entries[textureIndex].baseLevel;
+}
+
+uint32_t TextureResidency::GetLevelCount(uint32_t textureIndex) const
+{
+    assert(textureIndex < entries.size() && entries[textureIndex].isReloadable);
+    return entries[textureIndex].levelCount;
+}
+
+RgExtent2D TextureResidency::GetBaseSize(uint32_t textureIndex) const
+{
+    assert(textureIndex < entries.size() && entries[textureIndex].isReloadable);
+    return entries[textureIndex].size;
+}
+
+uint64_t TextureResidency::GetResidentSize(const Entry &e) const
+{
+    uint64_t size = 0;
+
+    for (uint32_t i = e.baseLevel; i < e.levelCount; i++)
+    {
+        size += e.levelSizes[i];
+    }
+
+    return size;
+}
+
+bool TextureResidency::CanDropLevel(const Entry &e) const
+{
+    const uint32_t nextLevel = e.baseLevel + 1;
+
+    return 
+        e.isReloadable && 
+        nextLevel < e.levelCount &&
+        (e.size.width >> nextLevel) >= MIN_RESIDENT_BASE_SIZE &&
+        (e.size.height >> nextLevel) >= MIN_RESIDENT_BASE_SIZE;
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "Const.h"
+#include "ImageLoader.h"
+
+namespace RTGL1
+{
+
+// Tracks the size and the last usage frame of each material texture. If the total
+// size exceeds the budget, the most detailed mip levels of the least recently used
+// textures should be dropped; and restored, when they're used again and there is enough memory.
+// Only textures that were loaded from files with pregenerated mip levels can change
+// their resident levels: dropped levels are copied from the current image on the device,
+// restored levels are reloaded from the same file.
+class TextureResidency
+{
+public:
+    struct ReloadRequest
+    {
+        uint32_t    textureIndex;
+        // mip level of the file that should become the first level of the image
+        uint32_t    baseLevel;
+        // if true, the levels can be copied from the current image
+        bool        isDrop;
+    };
+
+public:
+    explicit TextureResidency(uint32_t maxTextureCount, uint64_t budget, bool useDeviceBudget);
+    ~TextureResidency() = default;
+
+    TextureResidency(const TextureResidency &other) = delete;
+    TextureResidency(TextureResidency &&other) noexcept = delete;
+    TextureResidency &operator=(const TextureResidency &other) = delete;
+    TextureResidency &operator=(TextureResidency &&other) noexcept = delete;
+
+    // Texture which resident levels can't be changed
+    void AddFixed(uint32_t textureIndex, uint64_t size);
+    // Texture that was loaded from the file with pregenerated mip levels
+    void AddReloadable(uint32_t textureIndex, const ImageLoader::ResultInfo &info, const char *pFilePath);
+    // Image of the texture is destroyed when frameIndex comes again
+    void Remove(uint32_t textureIndex, uint32_t frameIndex);
+    // Images of removed or reloaded textures with this frame index are destroyed
+    void PrepareForFrame(uint32_t frameIndex);
+
+    void MarkUsed(uint32_t textureIndex);
+    // Textures of static geometry are considered used on each frame,
+    // until static geometry is reset
+    void MarkUsedByStaticGeometry(uint32_t textureIndex);
+    void ResetStaticGeometryUsage();
+
+    // Must be called once per frame. 'deviceAvailable' is the amount of device memory
+    // that textures can occupy, according to the device budget; ignored if device budget is not used.
+    // Textures in 'outRequests' must be reloaded, and OnReloaded must be called for each successful one.
+    void Update(uint64_t deviceAvailable, std::vector<ReloadRequest> &outRequests);
+    // Previous image of the texture is destroyed when frameIndex comes again
+    void OnReloaded(uint32_t textureIndex, uint32_t baseLevel, uint32_t frameIndex);
+    // Texture won't be reloaded anymore, e.g. if its file was removed
+    void OnReloadFailed(uint32_t textureIndex);
+
+    bool UsesDeviceBudget() const;
+    uint64_t GetResidentSize() const;
+    // Size of images that are not used anymore, but are waiting for destruction
+    uint64_t GetPendingDestroySize() const;
+    const char *GetFilePath(uint32_t textureIndex) const;
+    VkFormat GetFormat(uint32_t textureIndex) const;
+    // Mip level of the file that is the first level of the current image
+    uint32_t GetBaseLevel(uint32_t textureIndex) const;
+    uint32_t GetLevelCount(uint32_t textureIndex) const;
+    RgExtent2D GetBaseSize(uint32_t textureIndex) const;
+
+private:
+    struct Entry
+    {
+        bool            isValid;
+        bool            isReloadable;
+        bool            isUsedByStaticGeometry;
+        uint64_t        lastUsedFrame;
+        uint32_t        baseLevel;
+        uint32_t        levelCount;
+        uint64_t        levelSizes[MAX_PREGENERATED_MIPMAP_LEVELS];
+        RgExtent2D      size;
+        VkFormat        format;
+        std::string     filePath;
+    };
+
+private:
+    uint64_t GetResidentSize(const Entry &e) const;
+    bool CanDropLevel(const Entry &e) const;
+
+private:
+    std::vector<Entry> entries;
+    uint64_t residentSize;
+    uint64_t pendingDestroySize[MAX_FRAMES_IN_FLIGHT];
+
+    uint64_t budget;
+    bool useDeviceBudget;
+
+    uint64_t currentFrame;
+};
+
+}
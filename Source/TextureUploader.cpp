@@ -21,15 +21,18 @@
 #include "TextureUploader.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
+#include <zstd.h>
+
 #include "Const.h"
 #include "Utils.h"
 
 using namespace RTGL1;
 
-TextureUploader::TextureUploader(VkDevice _device, std::shared_ptr<MemoryAllocator> _memAllocator)
-    : device(_device), memAllocator(std::move(_memAllocator))
+TextureUploader::TextureUploader(VkDevice _device, std::shared_ptr<MemoryAllocator> _memAllocator, std::shared_ptr<TaskScheduler> _taskScheduler)
+    : device(_device), memAllocator(std::move(_memAllocator)), taskScheduler(std::move(_taskScheduler))
 {}
 
 TextureUploader::~TextureUploader()
@@ -454,7 +457,21 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
     else
     {
         // copy image data to buffer
-        memcpy(mappedData, data, dataSize);
+        if (info.isSupercompressed)
+        {
+            bool wasInflated = InflateToStaging(info, mappedData);
+
+            if (!wasInflated)
+            {
+                memAllocator->DestroyTextureImage(image);
+                memAllocator->DestroyStagingSrcTextureBuffer(stagingBuffer);
+                return result;
+            }
+        }
+        else
+        {
+            memcpy(mappedData, data, dataSize);
+        }
 
         // and copy it to image
         PrepareImage(image, &stagingBuffer, info, ImagePrepareType::INIT);
@@ -493,6 +510,38 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
     return result;
 }
 
+bool TextureUploader::InflateToStaging(const UploadInfo &info, void *pMappedData) const
+{
+    assert(info.isSupercompressed && AreMipmapsPregenerated(info));
+    assert(taskScheduler);
+
+    const auto *pSrc = static_cast<const uint8_t *>(info.pData);
+    auto *pDst = static_cast<uint8_t *>(pMappedData);
+
+    // only the levels that will be copied to the image
+    const uint32_t levelCount = GetMipmapCount(info.baseSize, info);
+
+    std::atomic<bool> failed(false);
+
+    // each level is a separate zstd frame
+    taskScheduler->ParallelFor(levelCount, 1, [&] (uint32_t first, uint32_t end)
+    {
+        for (uint32_t level = first; level < end; level++)
+        {
+            const size_t inflatedSize = ZSTD_decompress(
+                pDst + info.pLevelDataOffsets[level], info.pLevelDataSizes[level],
+                pSrc + info.pLevelSupercompressedOffsets[level], info.pLevelSupercompressedSizes[level]);
+
+            if (ZSTD_isError(inflatedSize) || inflatedSize != info.pLevelDataSizes[level])
+            {
+                failed = true;
+            }
+        }
+    });
+
+    return !failed;
+}
+
 void TextureUploader::UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicImage, const void *data)
 {
     assert(dynamicImage != VK_NULL_HANDLE);
@@ -516,6 +565,105 @@ void TextureUploader::UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicIma
     }
 }
 
+TextureUploader::UploadResult TextureUploader::CopyImageLevels(
+    VkCommandBuffer cmd, VkImage srcImage, const RgExtent2D &srcBaseSize, uint32_t srcLevelCount,
+    uint32_t firstLevel, VkFormat format, const char *pDebugName)
+{
+    assert(firstLevel < srcLevelCount && srcLevelCount <= MAX_PREGENERATED_MIPMAP_LEVELS);
+
+    UploadResult result = {};
+    result.wasUploaded = false;
+
+    UploadInfo info = {};
+    info.cmd = cmd;
+    info.baseSize = { std::max(srcBaseSize.width >> firstLevel, 1u), std::max(srcBaseSize.height >> firstLevel, 1u) };
+    info.format = format;
+    info.useMipmaps = true;
+    info.pregeneratedLevelCount = srcLevelCount - firstLevel;
+    info.pDebugName = pDebugName;
+    info.isCubemap = false;
+
+    const uint32_t levelCount = GetMipmapCount(info.baseSize, info);
+
+    VkImage image;
+    bool wasCreated = CreateImage(info, &image);
+    if (!wasCreated)
+    {
+        return result;
+    }
+
+    VkImageSubresourceRange srcLevels = {};
+    srcLevels.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    srcLevels.baseMipLevel = firstLevel;
+    srcLevels.levelCount = levelCount;
+    srcLevels.baseArrayLayer = 0;
+    srcLevels.layerCount = 1;
+
+    VkImageSubresourceRange dstLevels = srcLevels;
+    dstLevels.baseMipLevel = 0;
+
+    Utils::BarrierImage(
+        cmd, srcImage,
+        VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        srcLevels);
+
+    Utils::BarrierImage(
+        cmd, image,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        dstLevels);
+
+    VkImageCopy copyRegions[MAX_PREGENERATED_MIPMAP_LEVELS];
+
+    for (uint32_t i = 0; i < levelCount; i++)
+    {
+        auto &cr = copyRegions[i];
+
+        cr = {};
+        cr.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        cr.srcSubresource.mipLevel = firstLevel + i;
+        cr.srcSubresource.baseArrayLayer = 0;
+        cr.srcSubresource.layerCount = 1;
+        cr.dstSubresource = cr.srcSubresource;
+        cr.dstSubresource.mipLevel = i;
+        // whole level, so block-compressed formats don't need the extent alignment
+        cr.extent = { std::max(info.baseSize.width >> i, 1u), std::max(info.baseSize.height >> i, 1u), 1 };
+    }
+
+    vkCmdCopyImage(
+        cmd,
+        srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        levelCount, copyRegions);
+
+    // source image can be still used by other frames
+    Utils::BarrierImage(
+        cmd, srcImage,
+        VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        srcLevels);
+
+    Utils::BarrierImage(
+        cmd, image,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        dstLevels);
+
+    VkImageView imageView = CreateImageView(image, format, false, levelCount);
+
+    SET_DEBUG_NAME(device, imageView, VK_OBJECT_TYPE_IMAGE_VIEW, pDebugName);
+
+    result.wasUploaded = true;
+    result.image = image;
+    result.view = imageView;
+    return result;
+}
+
 void TextureUploader::DestroyImage(VkImage image, VkImageView view)
 {
     auto it = dynamicImageInfos.find(image);
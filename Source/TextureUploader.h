@@ -25,6 +25,7 @@
 #include "Common.h"
 #include "MemoryAllocator.h"
 #include "RTGL1/RTGL1.h"
+#include "TaskScheduler.h"
 
 namespace RTGL1
 {
@@ -58,13 +59,19 @@ public:
         uint32_t            pregeneratedLevelCount;
         const uint32_t      *pLevelDataOffsets;
         const uint32_t      *pLevelDataSizes;
+        // if true, pData contains zstd-supercompressed pregenerated levels,
+        // they're inflated to pLevelDataOffsets of the staging buffer
+        bool                isSupercompressed;
+        const uint32_t      *pLevelSupercompressedOffsets;
+        const uint32_t      *pLevelSupercompressedSizes;
         bool                isDynamic;
         const char          *pDebugName;
         bool                isCubemap;
     };
 
 public:
-    TextureUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator);
+    // taskScheduler is required only for supercompressed data
+    TextureUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator, std::shared_ptr<TaskScheduler> taskScheduler);
     virtual ~TextureUploader();
 
     TextureUploader(const TextureUploader &other) = delete;
@@ -76,6 +83,11 @@ public:
     void ClearStaging(uint32_t frameIndex);
 
     virtual UploadResult UploadImage(const UploadInfo &info);
+    // Create an image from the levels [firstLevel, srcLevelCount) of a static image,
+    // the data is copied on the device. Source image must be prepared for usage in shaders.
+    UploadResult CopyImageLevels(
+        VkCommandBuffer cmd, VkImage srcImage, const RgExtent2D &srcBaseSize, uint32_t srcLevelCount,
+        uint32_t firstLevel, VkFormat format, const char *pDebugName);
     void UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicImage, const void *data);
     void DestroyImage(VkImage image, VkImageView view);
 
@@ -108,6 +120,8 @@ protected:
     // Create mipmaps and prepare image for usage in shaders
     void PrepareImage(VkImage image, VkBuffer staging[], const UploadInfo &info, ImagePrepareType prepareType);
     VkImageView CreateImageView(VkImage image, VkFormat format, bool isCubemap, uint32_t mipmapCount);
+    // Inflate each level on worker threads directly to the staging buffer
+    bool InflateToStaging(const UploadInfo &info, void *pMappedData) const;
 
 private:
     struct DynamicImageInfo
@@ -123,6 +137,7 @@ protected:
     VkDevice device;
 
     std::shared_ptr<MemoryAllocator> memAllocator;
+    std::shared_ptr<TaskScheduler> taskScheduler;
 
     // Staging buffers that were used for uploading must be destroyed
     // on the frame with same index when it'll be certainly not in use
@@ -156,7 +156,9 @@ VkDescriptorSet RTGL1::Tonemapping::GetDescSet() const
 
 void RTGL1::Tonemapping::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroyPipelines();
+    shaderManager->DestroyWhenUnused(histogramPipeline);
+    shaderManager->DestroyWhenUnused(avgLuminancePipeline);
+
     CreatePipelines(shaderManager);
 }
 
@@ -22,6 +22,8 @@
 #include "Generated/ShaderCommonC.h"
 
 constexpr VkDeviceSize TRIANGLE_INFO_SIZE = sizeof(uint32_t);
+// in uint32 elements; sector IDs are stored as runs, so it's much less than a max triangle count
+constexpr VkDeviceSize MAX_TRIANGLE_INFO_COUNT = 1 << 18;
 
 RTGL1::TriangleInfoManager::TriangleInfoManager(
     VkDevice _device,
@@ -34,10 +36,10 @@ RTGL1::TriangleInfoManager::TriangleInfoManager(
     dynamicGeometryRange(0),
     copyStaticRange(false)
 {
-    triangleSectorIndicesBuffer = std::make_unique<AutoBuffer>(device, _allocator);
-    triangleSectorIndicesBuffer->Create(MAX_INDEXED_PRIMITIVE_COUNT * TRIANGLE_INFO_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Triangle info");
+    triangleSectorRunsBuffer = std::make_unique<AutoBuffer>(device, _allocator);
+    triangleSectorRunsBuffer->Create(MAX_TRIANGLE_INFO_COUNT * TRIANGLE_INFO_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Triangle info");
 
-    static_assert(sizeof(decltype(tempValues)::value_type) == TRIANGLE_INFO_SIZE, "");
+    static_assert(sizeof(SectorArrayIndex::index_t) == TRIANGLE_INFO_SIZE, "");
 }
 
 RTGL1::TriangleInfoManager::~TriangleInfoManager()
@@ -61,12 +63,26 @@ uint32_t RTGL1::TriangleInfoManager::UploadAndGetArrayIndex(uint32_t frameIndex,
     }
 
 
-    auto &indices = TransformIdsToIndices(pTriangleSectorIDs, count);
+    const bool isDynamic = geomType == RG_GEOMETRY_TYPE_DYNAMIC;
+    const uint32_t runCount = CountRuns(pTriangleSectorIDs, count);
+    const uint32_t encodedSize = GetEncodedSize(runCount);
 
+    {
+        uint32_t firstFree = isDynamic ?
+            dynamicGeometryRange.GetFirstIndexAfterRange() :
+            staticGeometryRange.GetFirstIndexAfterRange();
+
+        // vertex collector doesn't limit primitive count, so check it here
+        if ((VkDeviceSize)firstFree + encodedSize > MAX_TRIANGLE_INFO_COUNT)
+        {
+            assert(0 && "Triangle info buffer is too small");
+            return GEOM_INST_NO_TRIANGLE_INFO;
+        }
+    }
 
     uint32_t startIndexInArray;
 
-    if (geomType == RG_GEOMETRY_TYPE_DYNAMIC)
+    if (isDynamic)
     {
         // trying to add first dynamic, lock static
         if (dynamicGeometryRange.GetCount() == 0)
@@ -79,23 +95,20 @@ uint32_t RTGL1::TriangleInfoManager::UploadAndGetArrayIndex(uint32_t frameIndex,
 
         startIndexInArray = dynamicGeometryRange.GetFirstIndexAfterRange();
 
-        uint32_t *pDst = (uint32_t *)triangleSectorIndicesBuffer->GetMapped(frameIndex);
-        memcpy(&pDst[startIndexInArray], indices.data(), indices.size() * TRIANGLE_INFO_SIZE);
+        auto *pDst = (uint32_t *)triangleSectorRunsBuffer->GetMapped(frameIndex);
+        EncodeRuns(pTriangleSectorIDs, count, runCount, &pDst[startIndexInArray]);
 
-        dynamicGeometryRange.Add(indices.size());
+        dynamicGeometryRange.Add(encodedSize);
     }
     else
     {
         startIndexInArray = staticGeometryRange.GetFirstIndexAfterRange();
 
-        // need to copy static geom data to both staging buffers, to be able to upload it in any frameIndex
-        for (uint32_t f = 0; f < MAX_FRAMES_IN_FLIGHT; f++)
-        {
-            uint32_t *pDst = (uint32_t *)triangleSectorIndicesBuffer->GetMapped(f);
-            memcpy(&pDst[startIndexInArray], indices.data(), indices.size() * TRIANGLE_INFO_SIZE);
-        }
+        // static data is always copied from the first staging buffer, see CopyFromStaging
+        auto *pDst = (uint32_t *)triangleSectorRunsBuffer->GetMapped(0);
+        EncodeRuns(pTriangleSectorIDs, count, runCount, &pDst[startIndexInArray]);
 
-        staticGeometryRange.Add(indices.size());
+        staticGeometryRange.Add(encodedSize);
 
 
         // update dynamic, as it should start right after static
@@ -103,7 +116,6 @@ uint32_t RTGL1::TriangleInfoManager::UploadAndGetArrayIndex(uint32_t frameIndex,
     }
 
 
-    indices.clear();
     return startIndexInArray;
 }
 
@@ -121,85 +133,102 @@ void RTGL1::TriangleInfoManager::Reset()
     copyStaticRange = true;
 }
 
-std::vector<RTGL1::SectorArrayIndex::index_t> &RTGL1::TriangleInfoManager::TransformIdsToIndices(const uint32_t *pTriangleSectorIDs, uint32_t count)
+uint32_t RTGL1::TriangleInfoManager::CountRuns(const uint32_t *pTriangleSectorIDs, uint32_t count)
+{
+    assert(count > 0);
+    uint32_t runCount = 1;
+
+    for (uint32_t i = 1; i < count; i++)
+    {
+        if (pTriangleSectorIDs[i] != pTriangleSectorIDs[i - 1])
+        {
+            runCount++;
+        }
+    }
+
+    return runCount;
+}
+
+uint32_t RTGL1::TriangleInfoManager::GetEncodedSize(uint32_t runCount)
+{
+    // run count, then run starts, then sector array indices
+    return 1 + runCount * 2;
+}
+
+void RTGL1::TriangleInfoManager::EncodeRuns(const uint32_t *pTriangleSectorIDs, uint32_t count, uint32_t runCount, uint32_t *pDst) const
 {
-    assert(tempValues.empty());
-    tempValues.reserve(count);
+    uint32_t *pRunStarts = pDst + 1;
+    auto *pRunSectors = (SectorArrayIndex::index_t *)(pDst + 1 + runCount);
+
+    // write directly to the mapped memory, without a temporary array
+    pDst[0] = runCount;
+    uint32_t r = 0;
 
     for (uint32_t i = 0; i < count; i++)
     {
+        if (i > 0 && pTriangleSectorIDs[i] == pTriangleSectorIDs[i - 1])
+        {
+            continue;
+        }
+
+        // translate only once per run
         SectorID id = SectorID{ pTriangleSectorIDs[i] };
 
-        tempValues.push_back(sectorVisibility->SectorIDToArrayIndex(id).GetArrayIndex());
+        pRunStarts[r] = i;
+        pRunSectors[r] = sectorVisibility->SectorIDToArrayIndex(id).GetArrayIndex();
+        r++;
     }
 
-    return tempValues;
+    assert(r == runCount);
 }
 
 
 bool RTGL1::TriangleInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, bool insertBarrier)
 {
-    VkBufferCopy copyInfos[2] = {};
-    uint32_t cc = 0;
+    VkBufferMemoryBarrier bs[2];
+    uint32_t barrierCount = 0;
 
+    // static data is stored only in the first staging buffer
     if (staticGeometryRange.GetCount() > 0 && copyStaticRange)
     {
-        copyInfos[cc].srcOffset = copyInfos[cc].dstOffset = staticGeometryRange.GetStartIndex() * TRIANGLE_INFO_SIZE;
-        copyInfos[cc].size = staticGeometryRange.GetCount() * TRIANGLE_INFO_SIZE;
-        cc++;
+        triangleSectorRunsBuffer->MarkDirty(
+            0,
+            staticGeometryRange.GetStartIndex() * TRIANGLE_INFO_SIZE,
+            staticGeometryRange.GetCount() * TRIANGLE_INFO_SIZE);
+
+        if (triangleSectorRunsBuffer->CopyDirtyFromStaging(cmd, 0, &bs[barrierCount]))
+        {
+            barrierCount++;
+        }
     }
+
     if (dynamicGeometryRange.GetCount() > 0)
     {
-        copyInfos[cc].srcOffset = copyInfos[cc].dstOffset = dynamicGeometryRange.GetStartIndex() * TRIANGLE_INFO_SIZE;
-        copyInfos[cc].size = dynamicGeometryRange.GetCount() * TRIANGLE_INFO_SIZE;
-        cc++;
+        triangleSectorRunsBuffer->MarkDirty(
+            frameIndex,
+            dynamicGeometryRange.GetStartIndex() * TRIANGLE_INFO_SIZE,
+            dynamicGeometryRange.GetCount() * TRIANGLE_INFO_SIZE);
+
+        if (triangleSectorRunsBuffer->CopyDirtyFromStaging(cmd, frameIndex, &bs[barrierCount]))
+        {
+            barrierCount++;
+        }
     }
-    triangleSectorIndicesBuffer->CopyFromStaging(cmd, frameIndex, copyInfos, cc);
 
 
-    if (insertBarrier)
+    if (insertBarrier && barrierCount > 0)
     {
-        VkBufferMemoryBarrier barriers[2] = {};
-        uint32_t bc = 0;
-        
-        if (staticGeometryRange.GetCount() > 0 && copyStaticRange)
+        for (uint32_t i = 0; i < barrierCount; i++)
         {
-            auto &b = barriers[bc];
-
-            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            b.buffer = triangleSectorIndicesBuffer->GetDeviceLocal();
-            b.offset = staticGeometryRange.GetStartIndex() * TRIANGLE_INFO_SIZE;
-            b.size   = staticGeometryRange.GetCount() * TRIANGLE_INFO_SIZE;
-
-            bc++;
+            bs[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
         }
-        if (dynamicGeometryRange.GetCount() > 0)
-        {
-            auto &b = barriers[bc];
-
-            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-            b.buffer = triangleSectorIndicesBuffer->GetDeviceLocal();
-            b.offset = dynamicGeometryRange.GetStartIndex() * TRIANGLE_INFO_SIZE;
-            b.size   = dynamicGeometryRange.GetCount() * TRIANGLE_INFO_SIZE;
-
-            bc++;
-        }
         vkCmdPipelineBarrier(
             cmd,
             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
             0,
             0, nullptr,
-            bc, barriers,
+            barrierCount, bs,
             0, nullptr);
     }
 
@@ -210,5 +239,5 @@ bool RTGL1::TriangleInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t f
 
 VkBuffer RTGL1::TriangleInfoManager::GetBuffer() const
 {
-    return triangleSectorIndicesBuffer->GetDeviceLocal();
+    return triangleSectorRunsBuffer->GetDeviceLocal();
 }
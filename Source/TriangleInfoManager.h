@@ -49,7 +49,11 @@ public:
     VkBuffer GetBuffer() const;
 
 private:
-    std::vector<SectorArrayIndex::index_t> &TransformIdsToIndices(const uint32_t *pTriangleSectorIDs, uint32_t count);
+    static uint32_t CountRuns(const uint32_t *pTriangleSectorIDs, uint32_t count);
+    static uint32_t GetEncodedSize(uint32_t runCount);
+    // Write runs of equal sector IDs: run count, first triangle index of each run,
+    // sector array index of each run. Shaders find a triangle's run with a binary search.
+    void EncodeRuns(const uint32_t *pTriangleSectorIDs, uint32_t count, uint32_t runCount, uint32_t *pDst) const;
 
 private:
     struct Range
@@ -83,13 +87,10 @@ private:
 
     std::shared_ptr<SectorVisibility> sectorVisibility;
 
-    std::unique_ptr<AutoBuffer> triangleSectorIndicesBuffer;
+    std::unique_ptr<AutoBuffer> triangleSectorRunsBuffer;
     Range staticGeometryRange;
     Range dynamicGeometryRange;
     bool copyStaticRange;
-
-
-    std::vector<SectorArrayIndex::index_t> tempValues;
 };
 
 }
\ No newline at end of file
@@ -20,6 +20,7 @@
 
 #include "Utils.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace RTGL1;
@@ -162,6 +163,11 @@ uint32_t Utils::Align(uint32_t value, uint32_t alignment)
     return (value + alignment - 1) & ~(alignment - 1);
 }
 
+uint64_t Utils::Align(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
 bool Utils::AreViewportsSame(const VkViewport &a, const VkViewport &b)
 {
     // special epsilons for viewports
@@ -247,3 +253,17 @@ uint32_t RTGL1::Utils::GetWorkGroupCount(uint32_t size, uint32_t groupSize)
 
     return 1 + (size + (groupSize - 1)) / groupSize;
 }
+
+uint64_t RTGL1::Utils::GetMipLevelSize(uint32_t baseWidth, uint32_t baseHeight, uint32_t level,
+                                       uint32_t blockWidth, uint32_t blockHeight, uint32_t blockSize)
+{
+    assert(blockWidth > 0 && blockHeight > 0);
+
+    const uint32_t w = std::max(baseWidth >> level, 1u);
+    const uint32_t h = std::max(baseHeight >> level, 1u);
+
+    const uint64_t blockCountX = (w + blockWidth - 1) / blockWidth;
+    const uint64_t blockCountY = (h + blockHeight - 1) / blockHeight;
+
+    return blockCountX * blockCountY * blockSize;
+}
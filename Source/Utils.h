@@ -62,6 +62,7 @@ namespace Utils
     void WaitAndResetFences(VkDevice device, VkFence fence_A, VkFence fence_B);
 
     uint32_t Align(uint32_t value, uint32_t alignment);
+    uint64_t Align(uint64_t value, uint64_t alignment);
 
     bool AreViewportsSame(const VkViewport &a, const VkViewport &b);
 
@@ -75,6 +76,11 @@ namespace Utils
     
     uint32_t GetWorkGroupCount(float size, uint32_t groupSize);
     uint32_t GetWorkGroupCount(uint32_t size, uint32_t groupSize);
+
+    // Size in bytes of a mip level, if the format consists of
+    // blocks of blockWidth x blockHeight texels, each is blockSize bytes
+    uint64_t GetMipLevelSize(uint32_t baseWidth, uint32_t baseHeight, uint32_t level,
+                             uint32_t blockWidth, uint32_t blockHeight, uint32_t blockSize);
 };
 
 template<typename T>
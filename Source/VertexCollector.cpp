@@ -25,85 +25,64 @@
 
 #include "Generated/ShaderCommonC.h"
 #include "Matrix.h"
+#include "MeshManager.h"
 
 using namespace RTGL1;
 
-constexpr uint32_t INDEX_BUFFER_SIZE        = MAX_INDEXED_PRIMITIVE_COUNT * 3 * sizeof(uint32_t);
-constexpr uint32_t TRANSFORM_BUFFER_SIZE    = MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT * sizeof(VkTransformMatrixKHR);
-
-constexpr uint64_t OFFSET_TEX_COORDS_STATIC[] =
-{
-    offsetof(ShVertexBufferStatic, texCoords),
-    offsetof(ShVertexBufferStatic, texCoordsLayer1),
-    offsetof(ShVertexBufferStatic, texCoordsLayer2),
-};
+// buffers are created with these capacities and grow on demand
+constexpr uint32_t INITIAL_VERTEX_CAPACITY  = 1 << 14;
+constexpr uint32_t INITIAL_INDEX_CAPACITY   = 1 << 15;
+constexpr uint32_t MIN_STATIC_CAPACITY      = 3;
 
-constexpr uint64_t OFFSET_TEX_COORDS_DYNAMIC[] =
-{
-    offsetof(ShVertexBufferDynamic, texCoords),
-};
+constexpr uint32_t TRANSFORM_BUFFER_SIZE    = MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT * sizeof(VkTransformMatrixKHR);
 
-constexpr uint32_t TEXCOORD_LAYER_COUNT_STATIC = sizeof(OFFSET_TEX_COORDS_STATIC) / sizeof(OFFSET_TEX_COORDS_STATIC[0]);
-constexpr uint32_t TEXCOORD_LAYER_COUNT_DYNAMIC = sizeof(OFFSET_TEX_COORDS_DYNAMIC) / sizeof(OFFSET_TEX_COORDS_DYNAMIC[0]);
+constexpr uint32_t TEXCOORD_LAYER_COUNT_STATIC  = 3;
+constexpr uint32_t TEXCOORD_LAYER_COUNT_DYNAMIC = 1;
 
 
 VertexCollector::VertexCollector(
     VkDevice _device, 
     const std::shared_ptr<MemoryAllocator> &_allocator,
+    std::shared_ptr<FrameAllocator> _frameAllocator,
     std::shared_ptr<GeomInfoManager> _geomInfoManager,
     std::shared_ptr<TriangleInfoManager> _triangleInfoMgr,
     std::shared_ptr<SectorVisibility> _sectorVisibility,
-    VkDeviceSize _bufferSize,
     const VertexBufferProperties &_properties,
     VertexCollectorFilterTypeFlags _filters) 
 :
     device(_device),
     properties(_properties),
     filtersFlags(_filters),
+    allocator(_allocator),
+    stagingVertLayout{},
+    frameAllocator(std::move(_frameAllocator)),
     geomInfoMgr(std::move(_geomInfoManager)),
     triangleInfoMgr(std::move(_triangleInfoMgr)),
     sectorVisibility(std::move(_sectorVisibility)),
     curVertexCount(0), curIndexCount(0), curPrimitiveCount(0), curTransformCount(0),
-    mappedVertexData(nullptr), mappedIndexData(nullptr), mappedTransformData(nullptr), 
-    texCoordsToCopyLowerBound(UINT64_MAX),
-    texCoordsToCopyUpperBound(0)
+    mappedVertexData(nullptr), mappedIndexData(nullptr), mappedTransformData(nullptr)
 {
     assert(filtersFlags != 0);
 
-    bool isDynamic = filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC;
-
-    vertBuffer = std::make_shared<Buffer>();
-    indexBuffer = std::make_shared<Buffer>();
-    transformsBuffer = std::make_shared<Buffer>();
+    bool isDynamic = !IsStatic();
 
-    // dynamic vertices need also be copied to previous frame buffer
-    VkBufferUsageFlags transferUsage = isDynamic ?
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT :
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-
-    // vertex buffers
-    vertBuffer->Init(
-        _allocator, _bufferSize,
-        transferUsage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        isDynamic ? "Dynamic Vertices data buffer" : "Static Vertices data buffer");
+    deviceLocal = std::make_shared<DeviceLocalBuffers>();
+    deviceLocal->verticesLayout = MakeLayout(INITIAL_VERTEX_CAPACITY);
+    deviceLocal->generation = 0;
 
-    // index buffers
-    indexBuffer->Init(
-        _allocator, INDEX_BUFFER_SIZE,
-        transferUsage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        isDynamic ? "Dynamic Index data buffer" : "Static Index data buffer");
+    // vertex and index buffers
+    RecreateDeviceLocalVertices(0);
+    RecreateDeviceLocalIndices(0, INITIAL_INDEX_CAPACITY);
 
     // transforms buffer
-    transformsBuffer->Init(
-        _allocator, TRANSFORM_BUFFER_SIZE,
-        transferUsage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+    deviceLocal->transforms = std::make_shared<Buffer>();
+    deviceLocal->transforms->Init(
+        allocator, TRANSFORM_BUFFER_SIZE,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         isDynamic ? "Dynamic BLAS transforms buffer" : "Static BLAS transforms buffer");
 
-    // device local buffers are 
-    InitStagingBuffers(_allocator);
+    InitStagingBuffers();
     InitFilters(filtersFlags);
 }
 
@@ -114,62 +93,255 @@ VertexCollector::VertexCollector(
     device(_src->device),
     properties(_src->properties),
     filtersFlags(_src->filtersFlags),
-    vertBuffer(_src->vertBuffer),
-    indexBuffer(_src->indexBuffer),
-    transformsBuffer(_src->transformsBuffer),
+    allocator(_allocator),
+    stagingVertLayout{},
+    deviceLocal(_src->deviceLocal),
+    frameAllocator(_src->frameAllocator),
     geomInfoMgr(_src->geomInfoMgr),
     triangleInfoMgr(_src->triangleInfoMgr),
     sectorVisibility(_src->sectorVisibility),
     curVertexCount(0), curIndexCount(0), curPrimitiveCount(0), curTransformCount(0),
-    mappedVertexData(nullptr), mappedIndexData(nullptr), mappedTransformData(nullptr),
-    texCoordsToCopyLowerBound(UINT64_MAX),
-    texCoordsToCopyUpperBound(0)
+    mappedVertexData(nullptr), mappedIndexData(nullptr), mappedTransformData(nullptr)
 {
     // device local buffers are shared with the "src" vertex collector
-    InitStagingBuffers(_allocator);
+    InitStagingBuffers();
     InitFilters(filtersFlags);
 }
 
-void VertexCollector::InitStagingBuffers(const std::shared_ptr<MemoryAllocator> &allocator)
+void VertexCollector::InitStagingBuffers()
 {
     // device local buffers must not be empty
-    assert(vertBuffer       && vertBuffer->GetSize() > 0);
-    assert(indexBuffer      && indexBuffer->GetSize() > 0);
-    assert(transformsBuffer && transformsBuffer->GetSize() > 0);
-    assert(geomInfoMgr && triangleInfoMgr);
-
-    // vertex buffers
-    stagingVertBuffer.Init(
-        allocator, vertBuffer->GetSize(),
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC ? "Dynamic Vertices data staging buffer" : "Static Vertices data staging buffer");
+    assert(deviceLocal);
+    assert(deviceLocal->vertices   && deviceLocal->vertices->GetSize() > 0);
+    assert(deviceLocal->indices    && deviceLocal->indices->GetSize() > 0);
+    assert(deviceLocal->transforms && deviceLocal->transforms->GetSize() > 0);
+    assert(frameAllocator && geomInfoMgr && triangleInfoMgr);
 
-    // index buffers
-    stagingIndexBuffer.Init(
-        allocator, indexBuffer->GetSize(),
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC ? "Dynamic Index data staging buffer" : "Static Index data staging buffer");
+    // staging vertex and index buffers have the same layout as device local ones
+    RelayoutStagingVertices(0, deviceLocal->verticesLayout.capacity, true);
+    ResizeStagingIndices(0, (uint32_t)(deviceLocal->indices->GetSize() / sizeof(uint32_t)));
 
     // transforms buffer
-    stagingTransformsBuffer.Init(
-        allocator, transformsBuffer->GetSize(),
+    stagingTransformsBuffer = std::make_shared<Buffer>();
+    stagingTransformsBuffer->Init(
+        allocator, deviceLocal->transforms->GetSize(),
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC ? "Dynamic BLAS transforms staging buffer" : "Static BLAS transforms staging buffer");
+        IsStatic() ? "Static BLAS transforms staging buffer" : "Dynamic BLAS transforms staging buffer");
 
-    mappedVertexData = static_cast<uint8_t *>(stagingVertBuffer.Map());
-    mappedIndexData = static_cast<uint32_t *>(stagingIndexBuffer.Map());
-    mappedTransformData = static_cast<VkTransformMatrixKHR *>(stagingTransformsBuffer.Map());
+    mappedTransformData = static_cast<VkTransformMatrixKHR *>(stagingTransformsBuffer->Map());
 }
 
 VertexCollector::~VertexCollector()
 {
     // unmap buffers to destroy them 
-    stagingVertBuffer.TryUnmap();
-    stagingIndexBuffer.TryUnmap();
-    stagingTransformsBuffer.TryUnmap();
+    stagingVertBuffer->TryUnmap();
+    stagingIndexBuffer->TryUnmap();
+    stagingTransformsBuffer->TryUnmap();
+}
+
+bool VertexCollector::IsStatic() const
+{
+    return !(filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC);
+}
+
+VertexBufferLayout VertexCollector::MakeLayout(uint32_t vertexCapacity) const
+{
+    VertexBufferLayout l = {};
+    l.capacity = vertexCapacity;
+    l.texCoordLayerCount = IsStatic() ? TEXCOORD_LAYER_COUNT_STATIC : TEXCOORD_LAYER_COUNT_DYNAMIC;
+
+    // attribute arrays go one after another
+    l.positions = 0;
+    l.normals = l.positions + (VkDeviceSize)vertexCapacity * properties.positionStride;
+
+    VkDeviceSize end = l.normals + (VkDeviceSize)vertexCapacity * properties.normalStride;
+
+    for (uint32_t i = 0; i < l.texCoordLayerCount; i++)
+    {
+        l.texCoords[i] = end;
+        end += (VkDeviceSize)vertexCapacity * properties.texCoordStride;
+    }
+
+    l.size = end;
+
+    // shaders access attributes with uint indices to float arrays
+    assert(l.size / sizeof(float) <= UINT32_MAX);
+
+    return l;
+}
+
+void VertexCollector::RelayoutStagingVertices(uint32_t frameIndex, uint32_t vertexCapacity, bool exactSize)
+{
+    assert(vertexCapacity >= curVertexCount);
+
+    const VertexBufferLayout oldLayout = stagingVertLayout;
+    const VertexBufferLayout newLayout = MakeLayout(vertexCapacity);
+
+    const bool hasData = stagingVertBuffer && curVertexCount > 0;
+
+    // attribute arrays: offsets in old and new layouts, and size of data to move
+    const uint32_t attribCount = 2 + newLayout.texCoordLayerCount;
+    VkDeviceSize oldOffsets[5], newOffsets[5], sizes[5];
+
+    oldOffsets[0] = oldLayout.positions;  newOffsets[0] = newLayout.positions;  sizes[0] = (VkDeviceSize)curVertexCount * properties.positionStride;
+    oldOffsets[1] = oldLayout.normals;    newOffsets[1] = newLayout.normals;    sizes[1] = (VkDeviceSize)curVertexCount * properties.normalStride;
+
+    for (uint32_t i = 0; i < newLayout.texCoordLayerCount; i++)
+    {
+        oldOffsets[2 + i] = oldLayout.texCoords[i];
+        newOffsets[2 + i] = newLayout.texCoords[i];
+        sizes[2 + i] = (VkDeviceSize)curVertexCount * properties.texCoordStride;
+    }
+
+    const bool toRealloc = 
+        !stagingVertBuffer ||
+        stagingVertBuffer->GetSize() < newLayout.size ||
+        (exactSize && stagingVertBuffer->GetSize() != newLayout.size);
+
+    if (toRealloc)
+    {
+        auto newBuffer = std::make_shared<Buffer>();
+        newBuffer->Init(
+            allocator, newLayout.size,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            IsStatic() ? "Static Vertices data staging buffer" : "Dynamic Vertices data staging buffer");
+
+        auto *newMapped = static_cast<uint8_t *>(newBuffer->Map());
+
+        if (hasData)
+        {
+            for (uint32_t i = 0; i < attribCount; i++)
+            {
+                memcpy(newMapped + newOffsets[i], mappedVertexData + oldOffsets[i], sizes[i]);
+            }
+        }
+
+        if (stagingVertBuffer)
+        {
+            // old staging can be still in use by copy commands
+            stagingVertBuffer->TryUnmap();
+            buffersToDestroy[frameIndex].push_back(std::move(stagingVertBuffer));
+        }
+
+        stagingVertBuffer = std::move(newBuffer);
+        mappedVertexData = newMapped;
+    }
+    else if (hasData)
+    {
+        // all offsets are proportional to the capacity, so if they're moved
+        // to the end, start from the last array, otherwise start from the first one
+        const bool toEnd = newLayout.capacity > oldLayout.capacity;
+
+        for (uint32_t k = 0; k < attribCount; k++)
+        {
+            uint32_t i = toEnd ? attribCount - 1 - k : k;
+            memmove(mappedVertexData + newOffsets[i], mappedVertexData + oldOffsets[i], sizes[i]);
+        }
+    }
+
+    stagingVertLayout = newLayout;
+
+    // offsets of the pending copy regions are not valid anymore,
+    // the whole staging buffer must be copied after this
+    texCoordsToCopy.Clear();
+}
+
+void VertexCollector::ResizeStagingIndices(uint32_t frameIndex, uint32_t indexCapacity)
+{
+    assert(indexCapacity >= curIndexCount && indexCapacity > 0);
+
+    auto newBuffer = std::make_shared<Buffer>();
+    newBuffer->Init(
+        allocator, (VkDeviceSize)indexCapacity * sizeof(uint32_t),
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        IsStatic() ? "Static Index data staging buffer" : "Dynamic Index data staging buffer");
+
+    auto *newMapped = static_cast<uint32_t *>(newBuffer->Map());
+
+    if (stagingIndexBuffer)
+    {
+        memcpy(newMapped, mappedIndexData, (size_t)curIndexCount * sizeof(uint32_t));
+
+        stagingIndexBuffer->TryUnmap();
+        buffersToDestroy[frameIndex].push_back(std::move(stagingIndexBuffer));
+    }
+
+    stagingIndexBuffer = std::move(newBuffer);
+    mappedIndexData = newMapped;
+}
+
+void VertexCollector::ReserveStaging(uint32_t frameIndex, uint32_t vertexCount, uint32_t indexCount)
+{
+    // geometric growth, to not reallocate on each new geometry
+    if (vertexCount > stagingVertLayout.capacity)
+    {
+        uint32_t newCapacity = std::max(vertexCount, stagingVertLayout.capacity * 2);
+        RelayoutStagingVertices(frameIndex, newCapacity, false);
+    }
+
+    const uint32_t indexCapacity = (uint32_t)(stagingIndexBuffer->GetSize() / sizeof(uint32_t));
+
+    if (indexCount > indexCapacity)
+    {
+        uint32_t newCapacity = std::max(indexCount, indexCapacity * 2);
+        ResizeStagingIndices(frameIndex, newCapacity);
+    }
+}
+
+void VertexCollector::RecreateDeviceLocalVertices(uint32_t frameIndex)
+{
+    const bool isDynamic = !IsStatic();
+
+    // dynamic vertices need also be copied to previous frame buffer
+    VkBufferUsageFlags transferUsage = isDynamic ?
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT :
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    if (deviceLocal->vertices)
+    {
+        // can be still in use by the previous frames
+        buffersToDestroy[frameIndex].push_back(std::move(deviceLocal->vertices));
+    }
+
+    deviceLocal->vertices = std::make_shared<Buffer>();
+    deviceLocal->vertices->Init(
+        allocator, deviceLocal->verticesLayout.size,
+        transferUsage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        isDynamic ? "Dynamic Vertices data buffer" : "Static Vertices data buffer");
+
+    deviceLocal->generation++;
+}
+
+void VertexCollector::RecreateDeviceLocalIndices(uint32_t frameIndex, uint32_t indexCapacity)
+{
+    const bool isDynamic = !IsStatic();
+
+    VkBufferUsageFlags transferUsage = isDynamic ?
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT :
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    if (deviceLocal->indices)
+    {
+        buffersToDestroy[frameIndex].push_back(std::move(deviceLocal->indices));
+    }
+
+    deviceLocal->indices = std::make_shared<Buffer>();
+    deviceLocal->indices->Init(
+        allocator, (VkDeviceSize)indexCapacity * sizeof(uint32_t),
+        transferUsage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        isDynamic ? "Dynamic Index data buffer" : "Static Index data buffer");
+
+    deviceLocal->generation++;
+}
+
+void VertexCollector::PrepareForFrame(uint32_t frameIndex)
+{
+    buffersToDestroy[frameIndex].clear();
 }
 
 static uint32_t GetMaterialsBlendFlags(const RgGeometryMaterialBlendType blendingTypes[], uint32_t count)
@@ -207,14 +379,15 @@ static uint32_t AlignUpBy3(uint32_t x)
     return ((x + 2) / 3) * 3;
 }
 
-uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT])
+uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+                                      const ResidentMeshData *pMesh)
 {
     typedef VertexCollectorFilterTypeFlagBits FT;
     const VertexCollectorFilterTypeFlags geomFlags = VertexCollectorFilterTypeFlags_GetForGeometry(info);
 
 
     // if exceeds a limit of geometries in a group with specified geomFlags
-    if (GetGeometryCount(geomFlags) + 1 >= VertexCollectorFilterTypeFlags_GetAmountInGlobalArray(geomFlags))
+    if (GetGeometryCount(geomFlags) + GetMeshInstanceCount(geomFlags) + 1 >= VertexCollectorFilterTypeFlags_GetAmountInGlobalArray(geomFlags))
     {
         assert(false && "Too many geometries in a group");
         return UINT32_MAX;
@@ -223,52 +396,98 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
 
     const bool collectStatic = geomFlags & (FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE);
 
-    const uint32_t maxVertexCount = collectStatic ? MAX_STATIC_VERTEX_COUNT : MAX_DYNAMIC_VERTEX_COUNT;
-
-
     const uint32_t vertIndex = AlignUpBy3(curVertexCount);
     const uint32_t indIndex = AlignUpBy3(curIndexCount);
     const uint32_t transformIndex = curTransformCount;
 
-    const bool useIndices = info.indexCount != 0 && info.pIndexData != nullptr;
-    const uint32_t primitiveCount = useIndices ? info.indexCount / 3 : info.vertexCount / 3;
+    // mesh instances take vertex data from the mesh
+    const uint32_t vertexCount = pMesh != nullptr ? pMesh->vertexCount : info.vertexCount;
+    const uint32_t indexCount = pMesh != nullptr ? pMesh->indexCount : info.indexCount;
+    const bool hasNormals = pMesh != nullptr ? pMesh->normals != ResidentMeshData::NO_ATTRIBUTE : info.pNormalData != nullptr;
 
+    const bool useIndices = pMesh != nullptr ? pMesh->indexCount != 0 : info.indexCount != 0 && info.pIndexData != nullptr;
+    const uint32_t primitiveCount = useIndices ? indexCount / 3 : vertexCount / 3;
 
-    curVertexCount = vertIndex + info.vertexCount;
-    curIndexCount = indIndex + (useIndices ? info.indexCount : 0);
-    curPrimitiveCount += primitiveCount;
-    curTransformCount += 1;
+    assert(pMesh == nullptr || !collectStatic);
 
 
     // check bounds
-    if (curVertexCount >= maxVertexCount ||
-        curIndexCount >= MAX_INDEXED_PRIMITIVE_COUNT * 3 ||
-        (geomInfoMgr->GetCount() + 1) >= MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT)
+    if ((geomInfoMgr->GetCount() + meshInstances.size() + 1) >= MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT)
     {
         assert(0);
         return UINT32_MAX;
     }
 
-    // copy data to buffer
-    assert(stagingVertBuffer.IsMapped());
-    CopyDataToStaging(info, vertIndex, collectStatic);
+    // vertex and index staging buffers grow, if there's not enough space;
+    // reserved for mesh instances too, as staging and device local layouts must match
+    ReserveStaging(frameIndex, vertIndex + vertexCount, indIndex + (useIndices ? indexCount : 0));
 
-    if (useIndices)
+
+    const uint32_t prevVertexCount = curVertexCount;
+    const uint32_t prevIndexCount = curIndexCount;
+
+    curVertexCount = vertIndex + vertexCount;
+    curIndexCount = indIndex + (useIndices ? indexCount : 0);
+    curPrimitiveCount += primitiveCount;
+    curTransformCount += 1;
+
+
+    if (pMesh != nullptr)
     {
-        assert(stagingIndexBuffer.IsMapped());
-        memcpy(mappedIndexData + indIndex, info.pIndexData, info.indexCount * sizeof(uint32_t));
+        // copied on GPU from the mesh buffer
+        MeshInstanceCopy cp = {};
+        cp.srcVertexBuffer = pMesh->vertexBuffer;
+        cp.srcIndexBuffer = pMesh->indexBuffer;
+        cp.srcPositions = pMesh->positions;
+        cp.srcNormals = pMesh->normals;
+        cp.srcTexCoords = pMesh->texCoords;
+        cp.srcIndices = pMesh->indices;
+        cp.vertexCount = vertexCount;
+        cp.indexCount = useIndices ? indexCount : 0;
+        cp.dstVertIndex = vertIndex;
+        cp.dstIndIndex = indIndex;
+
+        meshInstanceCopies.push_back(cp);
+    }
+    else
+    {
+        // copy data to buffer
+        assert(stagingVertBuffer->IsMapped());
+        CopyDataToStaging(info, vertIndex, collectStatic);
+
+        // extend the last range, if nothing was added between
+        if (!stagedVertexRanges.empty() && stagedVertexRanges.back().end == prevVertexCount)
+        {
+            stagedVertexRanges.back().end = curVertexCount;
+        }
+        else
+        {
+            stagedVertexRanges.push_back({ vertIndex, curVertexCount });
+        }
+
+        if (useIndices)
+        {
+            assert(stagingIndexBuffer->IsMapped());
+            memcpy(mappedIndexData + indIndex, info.pIndexData, info.indexCount * sizeof(uint32_t));
+
+            if (!stagedIndexRanges.empty() && stagedIndexRanges.back().end == prevIndexCount)
+            {
+                stagedIndexRanges.back().end = curIndexCount;
+            }
+            else
+            {
+                stagedIndexRanges.push_back({ indIndex, curIndexCount });
+            }
+        }
     }
 
     static_assert(sizeof(RgTransform) == sizeof(VkTransformMatrixKHR), "RgTransform and VkTransformMatrixKHR must have the same structure to be used in AS building");
     memcpy(mappedTransformData + transformIndex, &info.transform, sizeof(VkTransformMatrixKHR));
 
-    const uint32_t offsetPositions = collectStatic ?
-        offsetof(ShVertexBufferStatic, positions) :
-        offsetof(ShVertexBufferDynamic, positions);
-
-    // use positions and index data in the device local buffers: AS shouldn't be built using staging buffers
-    const VkDeviceAddress vertexDataDeviceAddress =
-        vertBuffer->GetAddress() + offsetPositions + vertIndex * static_cast<uint64_t>(properties.positionStride);
+    // use positions and index data in the device local buffers: AS shouldn't be built using staging buffers;
+    // device local buffers can be recreated until EndCollecting, so only offsets are stored here
+    const VkDeviceAddress vertexDataOffset =
+        stagingVertLayout.positions + vertIndex * static_cast<uint64_t>(properties.positionStride);
 
     // geometry info
     VkAccelerationStructureGeometryKHR geom = {};
@@ -282,18 +501,15 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
     VkAccelerationStructureGeometryTrianglesDataKHR &trData = geom.geometry.triangles;
     trData.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
     trData.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
-    trData.maxVertex = info.vertexCount;
-    trData.vertexData.deviceAddress = vertexDataDeviceAddress;
+    trData.maxVertex = vertexCount;
+    trData.vertexData.deviceAddress = vertexDataOffset;
     trData.vertexStride = properties.positionStride;
-    trData.transformData.deviceAddress = transformsBuffer->GetAddress() + transformIndex * sizeof(VkTransformMatrixKHR);
+    trData.transformData.deviceAddress = transformIndex * sizeof(VkTransformMatrixKHR);
 
     if (useIndices)
     {
-        const VkDeviceAddress indexDataDeviceAddress =
-            indexBuffer->GetAddress() + indIndex * sizeof(uint32_t);
-
         trData.indexType = VK_INDEX_TYPE_UINT32;
-        trData.indexData.deviceAddress = indexDataDeviceAddress;
+        trData.indexData.deviceAddress = indIndex * sizeof(uint32_t);
     }
     else
     {
@@ -319,8 +535,104 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
     ShGeometryInstance geomInfo = {};
     geomInfo.baseVertexIndex = vertIndex;
     geomInfo.baseIndexIndex = useIndices ? indIndex : UINT32_MAX;
-    geomInfo.vertexCount = info.vertexCount;
-    geomInfo.indexCount = useIndices ? info.indexCount : UINT32_MAX;
+    geomInfo.vertexCount = vertexCount;
+    geomInfo.indexCount = useIndices ? indexCount : UINT32_MAX;
+    FillGeomInfo(frameIndex, info, materials, geomFlags, primitiveCount, hasNormals, geomInfo);
+
+
+    // simple index -- calculated as (global cur static count + global cur dynamic count)
+    // global geometry index -- for indexing in geom infos buffer
+    // local geometry index -- index of geometry in BLAS
+    uint32_t simpleIndex = geomInfoMgr->WriteGeomInfo(frameIndex, info.uniqueID, localIndex, geomFlags, geomInfo);
+
+
+    if (collectStatic)
+    {
+        // add material dependency but only for static geometry,
+        // dynamic is updated each frame, so their materials will be updated anyway
+        for (uint32_t layer = 0; layer < MATERIALS_MAX_LAYER_COUNT; layer++)
+        {
+            const uint32_t materialIndex = info.geomMaterial.layerMaterials[layer];
+
+            for (uint32_t t = 0; t < TEXTURES_PER_MATERIAL_COUNT; t++)
+            {
+                // if at least one texture is not empty on this layer, add dependency 
+                if (materials[layer].indices[t] != EMPTY_TEXTURE_INDEX)
+                {
+                    AddMaterialDependency(simpleIndex, layer, materialIndex);
+
+                    break;
+                }               
+            }
+        }
+
+        // also, save transform index for updating static movable's transforms
+        simpleIndexToTransformIndex[simpleIndex] = transformIndex;
+    }
+
+
+    return simpleIndex;
+}
+
+bool VertexCollector::AddMeshInstance(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+                                      RgMesh mesh, const ResidentMeshData &meshData)
+{
+    const VertexCollectorFilterTypeFlags geomFlags = VertexCollectorFilterTypeFlags_GetForGeometry(info);
+
+    assert(!IsStatic());
+    assert(meshData.blas != nullptr && meshData.normals != ResidentMeshData::NO_ATTRIBUTE);
+
+    if (GetGeometryCount(geomFlags) + GetMeshInstanceCount(geomFlags) + 1 >= VertexCollectorFilterTypeFlags_GetAmountInGlobalArray(geomFlags))
+    {
+        assert(false && "Too many geometries in a group");
+        return false;
+    }
+
+    if ((geomInfoMgr->GetCount() + meshInstances.size() + 1) >= MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT)
+    {
+        assert(0);
+        return false;
+    }
+
+    const bool useIndices = meshData.indexCount != 0;
+    const uint32_t primitiveCount = useIndices ? meshData.indexCount / 3 : meshData.vertexCount / 3;
+
+
+    // vertices are not copied, shaders read them from the mesh pool
+    ShGeometryInstance geomInfo = {};
+    geomInfo.baseVertexIndex = meshData.baseVertexIndex;
+    geomInfo.baseIndexIndex = useIndices ? meshData.baseIndexIndex : UINT32_MAX;
+    geomInfo.vertexCount = meshData.vertexCount;
+    geomInfo.indexCount = useIndices ? meshData.indexCount : UINT32_MAX;
+
+    FillGeomInfo(frameIndex, info, materials, geomFlags, primitiveCount, true, geomInfo);
+
+    geomInfo.flags |= GEOM_INST_FLAG_RESIDENT_MESH;
+
+
+    MeshInstanceInfo inst = {};
+    inst.mesh = mesh;
+    inst.uniqueID = info.uniqueID;
+    inst.geomFlags = geomFlags;
+    inst.globalGeomIndex = UINT32_MAX;
+
+    static_assert(sizeof(RgTransform) == sizeof(VkTransformMatrixKHR), "RgTransform and VkTransformMatrixKHR must have the same structure to be used in AS building");
+    memcpy(&inst.transform, &info.transform, sizeof(VkTransformMatrixKHR));
+
+    // geom info is written on EndCollecting, as its local index
+    // must be after all the geometries of the group's BLAS
+    meshInstances.push_back(inst);
+    meshInstanceGeomInfos.push_back(geomInfo);
+    meshInstanceCountPerGroup[geomFlags]++;
+
+    return true;
+}
+
+void VertexCollector::FillGeomInfo(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+                                   VertexCollectorFilterTypeFlags geomFlags, uint32_t primitiveCount, bool hasNormals, ShGeometryInstance &geomInfo)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
     geomInfo.defaultRoughness = info.defaultRoughness;
     geomInfo.defaultMetallicity = info.defaultMetallicity;
     geomInfo.defaultEmission = info.defaultEmission;
@@ -332,7 +644,7 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
 
     geomInfo.flags = GetMaterialsBlendFlags(info.layerBlendingTypes, MATERIALS_MAX_LAYER_COUNT);
 
-    if (info.pNormalData == nullptr)
+    if (!hasNormals)
     {
         geomInfo.flags |= GEOM_INST_FLAG_GENERATE_NORMALS;
     }
@@ -411,67 +723,22 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
 
     geomInfo.triangleArrayIndex = triangleInfoMgr->UploadAndGetArrayIndex(frameIndex, info.pTriangleSectorIDs, primitiveCount, info.geomType);
     geomInfo.sectorArrayIndex = sectorVisibility->SectorIDToArrayIndex(SectorID{ info.sectorID }).GetArrayIndex();
-
-
-    // simple index -- calculated as (global cur static count + global cur dynamic count)
-    // global geometry index -- for indexing in geom infos buffer
-    // local geometry index -- index of geometry in BLAS
-    uint32_t simpleIndex = geomInfoMgr->WriteGeomInfo(frameIndex, info.uniqueID, localIndex, geomFlags, geomInfo);
-
-
-    if (collectStatic)
-    {
-        // add material dependency but only for static geometry,
-        // dynamic is updated each frame, so their materials will be updated anyway
-        for (uint32_t layer = 0; layer < MATERIALS_MAX_LAYER_COUNT; layer++)
-        {
-            const uint32_t materialIndex = info.geomMaterial.layerMaterials[layer];
-
-            for (uint32_t t = 0; t < TEXTURES_PER_MATERIAL_COUNT; t++)
-            {
-                // if at least one texture is not empty on this layer, add dependency 
-                if (materials[layer].indices[t] != EMPTY_TEXTURE_INDEX)
-                {
-                    AddMaterialDependency(simpleIndex, layer, materialIndex);
-
-                    break;
-                }               
-            }
-        }
-
-        // also, save transform index for updating static movable's transforms
-        simpleIndexToTransformIndex[simpleIndex] = transformIndex;
-    }
-
-
-    return simpleIndex;
 }
 
 void VertexCollector::CopyDataToStaging(const RgGeometryUploadInfo &info, uint32_t vertIndex, bool isStatic)
 {
-    const uint64_t wholeBufferSize = isStatic ?
-        sizeof(ShVertexBufferStatic) :
-        sizeof(ShVertexBufferDynamic);
-
-    const uint64_t offsetPositions = isStatic ?
-        offsetof(ShVertexBufferStatic, positions) :
-        offsetof(ShVertexBufferDynamic, positions);
-    const uint64_t offsetNormals = isStatic ?
-        offsetof(ShVertexBufferStatic, normals) :
-        offsetof(ShVertexBufferDynamic, normals);
+    assert(isStatic == IsStatic());
+    assert(vertIndex + info.vertexCount <= stagingVertLayout.capacity);
 
     const uint64_t positionStride = properties.positionStride;
     const uint64_t normalStride = properties.normalStride;
 
     // positions
-    void *positionsDst = mappedVertexData + offsetPositions + vertIndex * positionStride;
-    assert(offsetPositions + (vertIndex + info.vertexCount) * positionStride < wholeBufferSize);
-
+    void *positionsDst = mappedVertexData + stagingVertLayout.positions + vertIndex * positionStride;
     memcpy(positionsDst, info.pVertexData, info.vertexCount * positionStride);
 
     // normals
-    void *normalsDst = mappedVertexData + offsetNormals + vertIndex * normalStride;
-    assert(offsetNormals + (vertIndex + info.vertexCount) * normalStride < wholeBufferSize);
+    void *normalsDst = mappedVertexData + stagingVertLayout.normals + vertIndex * normalStride;
 
     if (info.pNormalData != nullptr)
     {
@@ -487,52 +754,110 @@ void VertexCollector::CopyDataToStaging(const RgGeometryUploadInfo &info, uint32
 void RTGL1::VertexCollector::CopyTexCoordsToStaging(bool isStatic, uint32_t globalVertIndex, uint32_t vertexCount, const void *const texCoordLayerData[3], bool addToCopy)
 {
     assert(mappedVertexData != nullptr);
+    assert(isStatic == IsStatic());
+    assert(globalVertIndex + vertexCount <= stagingVertLayout.capacity);
 
     const uint64_t texCoordStride = properties.texCoordStride;
-    const uint64_t wholeBufferSize = isStatic ?
-        sizeof(ShVertexBufferStatic) :
-        sizeof(ShVertexBufferDynamic);
-
     const uint64_t texCoordDataSize = vertexCount * texCoordStride;
 
 
     // additional tex coords for static geometry
-    const uint64_t *offsetTexCoords = isStatic ? OFFSET_TEX_COORDS_STATIC : OFFSET_TEX_COORDS_DYNAMIC;
-    uint32_t        offsetCount     = isStatic ? TEXCOORD_LAYER_COUNT_STATIC : TEXCOORD_LAYER_COUNT_DYNAMIC;
-
-
-    for (uint32_t i = 0; i < offsetCount; i++)
+    for (uint32_t i = 0; i < stagingVertLayout.texCoordLayerCount; i++)
     {
         if (texCoordLayerData[i] != nullptr)
         {
-            uint64_t dstOffsetBegin = offsetTexCoords[i] + globalVertIndex * texCoordStride;
-            uint64_t dstOffsetEnd = dstOffsetBegin + texCoordDataSize;
+            uint64_t dstOffsetBegin = stagingVertLayout.texCoords[i] + globalVertIndex * texCoordStride;
 
             void *texCoordDst = mappedVertexData + dstOffsetBegin;
-            assert(dstOffsetEnd < wholeBufferSize);
-
             memcpy(texCoordDst, texCoordLayerData[i], texCoordDataSize);
 
 
             if (addToCopy)
             {
-                texCoordsToCopyLowerBound = std::min(dstOffsetBegin, texCoordsToCopyLowerBound);
-                texCoordsToCopyUpperBound = std::max(dstOffsetEnd, texCoordsToCopyUpperBound);
-
-                VkBufferCopy cp = {};
-                cp.srcOffset = dstOffsetBegin;
-                cp.dstOffset = dstOffsetBegin;
-                cp.size = texCoordDataSize;
-
-                texCoordsToCopy.push_back(cp);
+                texCoordsToCopy.Add(dstOffsetBegin, texCoordDataSize);
             }
         }
     }
 }
 
 
-void VertexCollector::EndCollecting()
-{}
+void VertexCollector::EndCollecting(uint32_t frameIndex)
+{
+    const VertexBufferLayout &deviceLayout = deviceLocal->verticesLayout;
+    const uint32_t deviceIndexCapacity = (uint32_t)(deviceLocal->indices->GetSize() / sizeof(uint32_t));
+
+    if (IsStatic())
+    {
+        // static geometry is uploaded rarely, so device local buffers are sized exactly
+        const uint32_t vertexCapacity = std::max(curVertexCount, MIN_STATIC_CAPACITY);
+        const uint32_t indexCapacity = std::max(curIndexCount, MIN_STATIC_CAPACITY);
+
+        if (stagingVertLayout.capacity != vertexCapacity)
+        {
+            RelayoutStagingVertices(frameIndex, vertexCapacity, true);
+        }
+
+        if (deviceLayout.capacity != vertexCapacity)
+        {
+            deviceLocal->verticesLayout = stagingVertLayout;
+            RecreateDeviceLocalVertices(frameIndex);
+        }
+
+        if (deviceIndexCapacity != indexCapacity)
+        {
+            RecreateDeviceLocalIndices(frameIndex, indexCapacity);
+        }
+    }
+    else
+    {
+        // dynamic device local buffers are shared between frames and only grow,
+        // staging must have the same layout for copying
+        const uint32_t vertexCapacity = std::max(deviceLayout.capacity, stagingVertLayout.capacity);
+        const uint32_t stagingIndexCapacity = (uint32_t)(stagingIndexBuffer->GetSize() / sizeof(uint32_t));
+
+        if (stagingVertLayout.capacity != vertexCapacity)
+        {
+            RelayoutStagingVertices(frameIndex, vertexCapacity, false);
+        }
+
+        if (deviceLayout.capacity != vertexCapacity)
+        {
+            deviceLocal->verticesLayout = stagingVertLayout;
+            RecreateDeviceLocalVertices(frameIndex);
+        }
+
+        if (deviceIndexCapacity < curIndexCount)
+        {
+            RecreateDeviceLocalIndices(frameIndex, stagingIndexCapacity);
+        }
+    }
+
+    assert(stagingVertLayout.capacity == deviceLocal->verticesLayout.capacity);
+
+    // buffers won't be changed until the next collecting, so set actual addresses to AS geometries
+    for (auto &f : filters)
+    {
+        f.second->ApplyBufferAddresses(
+            deviceLocal->vertices->GetAddress(), 
+            deviceLocal->indices->GetAddress(), 
+            deviceLocal->transforms->GetAddress());
+    }
+
+
+    // mesh instances are not in the groups' BLAS, their geom infos
+    // are placed after the group's geometries
+    rgl::unordered_map<VertexCollectorFilterTypeFlags, uint32_t> meshInstancesInGroup;
+
+    for (size_t i = 0; i < meshInstances.size(); i++)
+    {
+        MeshInstanceInfo &inst = meshInstances[i];
+
+        const uint32_t localIndex = GetGeometryCount(inst.geomFlags) + meshInstancesInGroup[inst.geomFlags]++;
+
+        geomInfoMgr->WriteGeomInfo(frameIndex, inst.uniqueID, localIndex, inst.geomFlags, meshInstanceGeomInfos[i]);
+        inst.globalGeomIndex = VertexCollectorFilterTypeFlags_GetOffsetInGlobalArray(inst.geomFlags) + localIndex;
+    }
+}
 
 void VertexCollector::Reset()
 {
@@ -545,15 +870,22 @@ void VertexCollector::Reset()
 
     materialDependencies.clear();
 
+    stagedVertexRanges.clear();
+    stagedIndexRanges.clear();
+    meshInstanceCopies.clear();
+    meshInstances.clear();
+    meshInstanceGeomInfos.clear();
+    meshInstanceCountPerGroup.clear();
+
     for (auto &f : filters)
     {
         f.second->Reset();
     }
 }
 
-std::vector<VkBufferCopy> VertexCollector::CopyVertexDataFromStaging(VkCommandBuffer cmd, bool isStatic)
+rgl::frame_vector<VkBufferCopy> VertexCollector::CopyVertexDataFromStaging(VkCommandBuffer cmd, bool isStatic)
 {
-    std::vector<VkBufferCopy> vertCopyInfos;
+    rgl::frame_vector<VkBufferCopy> vertCopyInfos(FrameStlAllocator<VkBufferCopy>(frameAllocator.get()));
 
     if (!GetVertBufferCopyInfos(isStatic, vertCopyInfos))
     {
@@ -562,7 +894,7 @@ std::vector<VkBufferCopy> VertexCollector::CopyVertexDataFromStaging(VkCommandBu
 
     vkCmdCopyBuffer(
         cmd,
-        stagingVertBuffer.GetBuffer(), vertBuffer->GetBuffer(),
+        stagingVertBuffer->GetBuffer(), deviceLocal->vertices->GetBuffer(),
         vertCopyInfos.size(), vertCopyInfos.data());
 
     return vertCopyInfos;
@@ -570,20 +902,73 @@ std::vector<VkBufferCopy> VertexCollector::CopyVertexDataFromStaging(VkCommandBu
 
 bool VertexCollector::CopyIndexDataFromStaging(VkCommandBuffer cmd)
 {
-    if (curIndexCount == 0)
+    if (curIndexCount == 0 || stagedIndexRanges.empty())
     {
         return false;
     }
 
-    VkBufferCopy info = {};
-    info.srcOffset = 0;
-    info.dstOffset = 0;
-    info.size = curIndexCount * sizeof(uint32_t);
+    rgl::frame_vector<VkBufferCopy> infos(FrameStlAllocator<VkBufferCopy>(frameAllocator.get()));
+    infos.reserve(stagedIndexRanges.size());
+
+    for (const StagedRange &r : stagedIndexRanges)
+    {
+        VkDeviceSize offset = r.begin * sizeof(uint32_t);
+        infos.push_back({ offset, offset, (r.end - r.begin) * sizeof(uint32_t) });
+    }
 
     vkCmdCopyBuffer(
         cmd,
-        stagingIndexBuffer.GetBuffer(), indexBuffer->GetBuffer(),
-        1, &info);
+        stagingIndexBuffer->GetBuffer(), deviceLocal->indices->GetBuffer(),
+        infos.size(), infos.data());
+
+    return true;
+}
+
+bool VertexCollector::CopyMeshInstances(VkCommandBuffer cmd)
+{
+    if (meshInstanceCopies.empty())
+    {
+        return false;
+    }
+
+    const VertexBufferLayout &l = deviceLocal->verticesLayout;
+
+    const uint64_t positionStride = properties.positionStride;
+    const uint64_t normalStride = properties.normalStride;
+    const uint64_t texCoordStride = properties.texCoordStride;
+
+    for (const MeshInstanceCopy &cp : meshInstanceCopies)
+    {
+        VkBufferCopy vertInfos[3];
+        uint32_t vertInfoCount = 0;
+
+        vertInfos[vertInfoCount++] = { cp.srcPositions, l.positions + cp.dstVertIndex * positionStride, cp.vertexCount * positionStride };
+
+        if (cp.srcNormals != ResidentMeshData::NO_ATTRIBUTE)
+        {
+            vertInfos[vertInfoCount++] = { cp.srcNormals, l.normals + cp.dstVertIndex * normalStride, cp.vertexCount * normalStride };
+        }
+
+        if (l.texCoordLayerCount > 0)
+        {
+            vertInfos[vertInfoCount++] = { cp.srcTexCoords, l.texCoords[0] + cp.dstVertIndex * texCoordStride, cp.vertexCount * texCoordStride };
+        }
+
+        vkCmdCopyBuffer(
+            cmd,
+            cp.srcVertexBuffer, deviceLocal->vertices->GetBuffer(),
+            vertInfoCount, vertInfos);
+
+        if (cp.indexCount > 0)
+        {
+            VkBufferCopy indInfo = { cp.srcIndices, cp.dstIndIndex * sizeof(uint32_t), cp.indexCount * sizeof(uint32_t) };
+
+            vkCmdCopyBuffer(
+                cmd,
+                cp.srcIndexBuffer, deviceLocal->indices->GetBuffer(),
+                1, &indInfo);
+        }
+    }
 
     return true;
 }
@@ -602,7 +987,7 @@ bool VertexCollector::CopyTransformsFromStaging(VkCommandBuffer cmd, bool insert
 
     vkCmdCopyBuffer(
         cmd,
-        stagingTransformsBuffer.GetBuffer(), transformsBuffer->GetBuffer(),
+        stagingTransformsBuffer->GetBuffer(), deviceLocal->transforms->GetBuffer(),
         1, &info);
 
     if (insertMemBarrier)
@@ -613,7 +998,7 @@ bool VertexCollector::CopyTransformsFromStaging(VkCommandBuffer cmd, bool insert
         trnBr.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         trnBr.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         trnBr.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-        trnBr.buffer = transformsBuffer->GetBuffer();
+        trnBr.buffer = deviceLocal->transforms->GetBuffer();
         trnBr.size = curTransformCount * sizeof(VkTransformMatrixKHR);
 
         vkCmdPipelineBarrier(
@@ -635,15 +1020,17 @@ bool VertexCollector::RecopyTransformsFromStaging(VkCommandBuffer cmd)
 
 bool RTGL1::VertexCollector::RecopyTexCoordsFromStaging(VkCommandBuffer cmd)
 {
-    if (curTransformCount == 0 || texCoordsToCopy.empty())
+    if (curTransformCount == 0 || texCoordsToCopy.IsEmpty())
     {
         return false;
     }
 
+    const auto &copyInfos = texCoordsToCopy.GetCopyInfos();
+
     vkCmdCopyBuffer(
         cmd,
-        stagingVertBuffer.GetBuffer(), vertBuffer->GetBuffer(),
-        texCoordsToCopy.size(), texCoordsToCopy.data());
+        stagingVertBuffer->GetBuffer(), deviceLocal->vertices->GetBuffer(),
+        copyInfos.size(), copyInfos.data());
 
     VkBufferMemoryBarrier txcBr = {};
     txcBr.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
@@ -651,9 +1038,9 @@ bool RTGL1::VertexCollector::RecopyTexCoordsFromStaging(VkCommandBuffer cmd)
     txcBr.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     txcBr.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     txcBr.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    txcBr.buffer = vertBuffer->GetBuffer();
-    txcBr.offset = texCoordsToCopyLowerBound;
-    txcBr.size = texCoordsToCopyUpperBound - texCoordsToCopyLowerBound;
+    txcBr.buffer = deviceLocal->vertices->GetBuffer();
+    txcBr.offset = texCoordsToCopy.GetLowerBound();
+    txcBr.size = texCoordsToCopy.GetUpperBound() - texCoordsToCopy.GetLowerBound();
 
     vkCmdPipelineBarrier(
         cmd,
@@ -663,9 +1050,7 @@ bool RTGL1::VertexCollector::RecopyTexCoordsFromStaging(VkCommandBuffer cmd)
         1, &txcBr,
         0, nullptr);
 
-    texCoordsToCopy.clear();
-    texCoordsToCopyLowerBound = UINT64_MAX;
-    texCoordsToCopyUpperBound = 0;
+    texCoordsToCopy.Clear();
 
     return true;
 }
@@ -674,32 +1059,23 @@ bool VertexCollector::CopyFromStaging(VkCommandBuffer cmd, bool isStaticVertexDa
 {
     const auto vrtCopied = CopyVertexDataFromStaging(cmd, isStaticVertexData);
     bool indCopied = CopyIndexDataFromStaging(cmd);
+    bool meshCopied = CopyMeshInstances(cmd);
     bool trnCopied = CopyTransformsFromStaging(cmd, false);
 
     VkBufferMemoryBarrier barriers[9];
     uint32_t barrierCount = 0;
 
-    assert(vrtCopied.size() + 1 < sizeof(barriers) / sizeof(barriers[0]));
-
-    // prepare for preprocessing
-    for (const auto &cp : vrtCopied)
+    // prepare for preprocessing; staged ranges and mesh instances
+    // are interleaved, so whole attribute arrays are covered
+    if (!vrtCopied.empty() || meshCopied)
     {
-        VkBufferMemoryBarrier &vrtBr = barriers[barrierCount];
-        barrierCount++;
-
-        vrtBr = {};
-        vrtBr.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-        vrtBr.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        vrtBr.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        vrtBr.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        vrtBr.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-        vrtBr.buffer = vertBuffer->GetBuffer();
-        vrtBr.offset = cp.dstOffset;
-        vrtBr.size = cp.size;
+        barrierCount += GetVertexAttributeBarriers(
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            barriers, std::size(barriers) - 1);
     }
 
     // prepare for preprocessing
-    if (indCopied)
+    if ((indCopied || meshCopied) && curIndexCount > 0)
     {
         VkBufferMemoryBarrier &indBr = barriers[barrierCount];
         barrierCount++;
@@ -710,7 +1086,7 @@ bool VertexCollector::CopyFromStaging(VkCommandBuffer cmd, bool isStaticVertexDa
         indBr.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         indBr.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         indBr.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-        indBr.buffer = indexBuffer->GetBuffer();
+        indBr.buffer = deviceLocal->indices->GetBuffer();
         indBr.size = curIndexCount * sizeof(uint32_t);
     }
 
@@ -734,7 +1110,7 @@ bool VertexCollector::CopyFromStaging(VkCommandBuffer cmd, bool isStaticVertexDa
         trnBr.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         trnBr.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         trnBr.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-        trnBr.buffer = transformsBuffer->GetBuffer();
+        trnBr.buffer = deviceLocal->transforms->GetBuffer();
         trnBr.size = curTransformCount * sizeof(VkTransformMatrixKHR);
 
         vkCmdPipelineBarrier(
@@ -747,42 +1123,94 @@ bool VertexCollector::CopyFromStaging(VkCommandBuffer cmd, bool isStaticVertexDa
     }
 
 
-    return !vrtCopied.empty() || indCopied || trnCopied;
+    return !vrtCopied.empty() || indCopied || meshCopied || trnCopied;
 }
 
-bool VertexCollector::GetVertBufferCopyInfos(bool isStatic, std::vector<VkBufferCopy> &outInfos) const
+bool VertexCollector::GetVertBufferCopyInfos(bool isStatic, rgl::frame_vector<VkBufferCopy> &outInfos) const
 {
     if (curVertexCount == 0 || curPrimitiveCount == 0)
     {
         return false;
     }
 
-    const uint32_t offsetPositions = isStatic ?
-        offsetof(ShVertexBufferStatic, positions) :
-        offsetof(ShVertexBufferDynamic, positions);
-
-    const uint32_t offsetNormals = isStatic ?
-        offsetof(ShVertexBufferStatic, normals) :
-        offsetof(ShVertexBufferDynamic, normals);
+    assert(isStatic == IsStatic());
 
-    const uint64_t *offsetTexCoords = isStatic ? OFFSET_TEX_COORDS_STATIC : OFFSET_TEX_COORDS_DYNAMIC;
-    uint32_t        offsetCount     = isStatic ? TEXCOORD_LAYER_COUNT_STATIC : TEXCOORD_LAYER_COUNT_DYNAMIC;
+    // staging and device local buffers have the same layout after EndCollecting
+    const VertexBufferLayout &l = stagingVertLayout;
+    assert(l.capacity == deviceLocal->verticesLayout.capacity);
     
-    // positions, normals + texCoords
-    uint32_t count = 2 + offsetCount;
-    outInfos.reserve(count);
+    if (stagedVertexRanges.empty())
+    {
+        return false;
+    }
 
-    outInfos.push_back({ offsetPositions,    offsetPositions,    (uint64_t)curVertexCount * properties.positionStride });
-    outInfos.push_back({ offsetNormals,      offsetNormals,      (uint64_t)curVertexCount * properties.normalStride   });
+    // positions, normals + texCoords for each range
+    uint32_t count = (2 + l.texCoordLayerCount) * (uint32_t)stagedVertexRanges.size();
+    outInfos.reserve(count);
 
-    for (uint32_t i = 0; i < offsetCount; i++)
+    for (const StagedRange &r : stagedVertexRanges)
     {
-        outInfos.push_back({ offsetTexCoords[i], offsetTexCoords[i], (uint64_t)curVertexCount * properties.texCoordStride });
+        const uint64_t first = r.begin;
+        const uint64_t vertCount = r.end - r.begin;
+
+        const uint64_t positions = l.positions + first * properties.positionStride;
+        const uint64_t normals = l.normals + first * properties.normalStride;
+
+        outInfos.push_back({ positions, positions, vertCount * properties.positionStride });
+        outInfos.push_back({ normals,   normals,   vertCount * properties.normalStride   });
+
+        for (uint32_t i = 0; i < l.texCoordLayerCount; i++)
+        {
+            const uint64_t texCoords = l.texCoords[i] + first * properties.texCoordStride;
+
+            outInfos.push_back({ texCoords, texCoords, vertCount * properties.texCoordStride });
+        }
     }
 
     return true;
 }
 
+uint32_t VertexCollector::GetVertexAttributeBarriers(VkAccessFlags srcAccess, VkAccessFlags dstAccess, 
+                                                     VkBufferMemoryBarrier *pDst, uint32_t maxCount) const
+{
+    if (curVertexCount == 0)
+    {
+        return 0;
+    }
+
+    const VertexBufferLayout &l = deviceLocal->verticesLayout;
+
+    const VkDeviceSize attribs[][2] =
+    {
+        { l.positions,      properties.positionStride },
+        { l.normals,        properties.normalStride   },
+        { l.texCoords[0],   properties.texCoordStride },
+        { l.texCoords[1],   properties.texCoordStride },
+        { l.texCoords[2],   properties.texCoordStride },
+    };
+
+    // positions, normals + texCoords
+    const uint32_t attribCount = 2 + l.texCoordLayerCount;
+    assert(attribCount <= maxCount);
+
+    for (uint32_t i = 0; i < attribCount; i++)
+    {
+        VkBufferMemoryBarrier &vrtBr = pDst[i];
+
+        vrtBr = {};
+        vrtBr.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        vrtBr.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vrtBr.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vrtBr.srcAccessMask = srcAccess;
+        vrtBr.dstAccessMask = dstAccess;
+        vrtBr.buffer = deviceLocal->vertices->GetBuffer();
+        vrtBr.offset = attribs[i][0];
+        vrtBr.size = (VkDeviceSize)curVertexCount * attribs[i][1];
+    }
+
+    return attribCount;
+}
+
 void VertexCollector::UpdateTransform(uint32_t simpleIndex, const RgUpdateTransformInfo &updateInfo)
 {
     if (simpleIndex >= MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT)
@@ -802,13 +1230,12 @@ void VertexCollector::UpdateTransform(uint32_t simpleIndex, const RgUpdateTransf
 void RTGL1::VertexCollector::UpdateTexCoords(uint32_t simpleIndex, const RgUpdateTexCoordsInfo &texCoordsInfo)
 {
     const bool isStatic = true;
-    const uint32_t maxVertexCount = isStatic ? MAX_STATIC_VERTEX_COUNT : MAX_DYNAMIC_VERTEX_COUNT;
 
     // base vertex index is saved in geometry instance info
     uint32_t globalVertIndex = geomInfoMgr->GetStaticGeomBaseVertexIndex(simpleIndex);
     uint32_t dstVertIndex = globalVertIndex + texCoordsInfo.vertexOffset;
 
-    if (dstVertIndex + texCoordsInfo.vertexCount >= maxVertexCount)
+    if (dstVertIndex + texCoordsInfo.vertexCount > curVertexCount)
     {
         assert(0);
         return;
@@ -845,12 +1272,38 @@ void VertexCollector::OnMaterialChange(uint32_t materialIndex, const MaterialTex
 
 VkBuffer VertexCollector::GetVertexBuffer() const
 {
-    return vertBuffer->GetBuffer();
+    return deviceLocal->vertices->GetBuffer();
 }
 
 VkBuffer VertexCollector::GetIndexBuffer() const
 {
-    return indexBuffer->GetBuffer();
+    return deviceLocal->indices->GetBuffer();
+}
+
+const VertexBufferLayout &VertexCollector::GetVertexBufferLayout() const
+{
+    return deviceLocal->verticesLayout;
+}
+
+uint32_t VertexCollector::GetDeviceLocalGeneration() const
+{
+    return deviceLocal->generation;
+}
+
+VkDeviceSize VertexCollector::GetDeviceLocalSize() const
+{
+    return 
+        deviceLocal->vertices->GetSize() + 
+        deviceLocal->indices->GetSize() + 
+        deviceLocal->transforms->GetSize();
+}
+
+VkDeviceSize VertexCollector::GetStagingSize() const
+{
+    return 
+        stagingVertBuffer->GetSize() + 
+        stagingIndexBuffer->GetSize() + 
+        stagingTransformsBuffer->GetSize();
 }
 
 const std::vector<uint32_t> &VertexCollector::GetPrimitiveCounts(
@@ -909,29 +1362,14 @@ void VertexCollector::InsertVertexPreprocessBeginBarrier(VkCommandBuffer cmd)
 
 void VertexCollector::InsertVertexPreprocessFinishBarrier(VkCommandBuffer cmd)
 {
-    std::vector<VkBufferCopy> vertCopyInfos;
-    bool isDynamic = filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC;
-    GetVertBufferCopyInfos(!isDynamic, vertCopyInfos);
-
-
     VkBufferMemoryBarrier barriers[10];
-    assert(std::size(barriers) >= vertCopyInfos.size() + 1);
     uint32_t barrierCount = 0;
 
-    for (const auto &cp : vertCopyInfos)
+    if (curPrimitiveCount > 0)
     {
-        VkBufferMemoryBarrier &vrtBr = barriers[barrierCount];
-        barrierCount++;
-
-        vrtBr = {};
-        vrtBr.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-        vrtBr.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        vrtBr.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        vrtBr.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-        vrtBr.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT;
-        vrtBr.buffer = GetVertexBuffer();
-        vrtBr.offset = cp.dstOffset;
-        vrtBr.size = cp.size;
+        barrierCount += GetVertexAttributeBarriers(
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT,
+            barriers, std::size(barriers) - 1);
     }
 
     if (curIndexCount > 0)
@@ -945,7 +1383,7 @@ void VertexCollector::InsertVertexPreprocessFinishBarrier(VkCommandBuffer cmd)
         indBr.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         indBr.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
         indBr.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT;
-        indBr.buffer = indexBuffer->GetBuffer();
+        indBr.buffer = deviceLocal->indices->GetBuffer();
         indBr.size = curIndexCount * sizeof(uint32_t);
     }
 
@@ -994,6 +1432,17 @@ uint32_t RTGL1::VertexCollector::GetGeometryCount(VertexCollectorFilterTypeFlags
     return filters[type]->GetGeometryCount();
 }
 
+uint32_t VertexCollector::GetMeshInstanceCount(VertexCollectorFilterTypeFlags type) const
+{
+    auto f = meshInstanceCountPerGroup.find(type);
+    return f != meshInstanceCountPerGroup.end() ? f->second : 0;
+}
+
+const std::vector<MeshInstanceInfo> &VertexCollector::GetMeshInstances() const
+{
+    return meshInstances;
+}
+
 uint32_t VertexCollector::GetAllGeometryCount() const
 {
     uint32_t count = 0;
@@ -24,6 +24,8 @@
 
 #include "Buffer.h"
 #include "Common.h"
+#include "Containers.h"
+#include "DirtyRegions.h"
 #include "GeomInfoManager.h"
 #include "IMaterialDependency.h"
 #include "Material.h"
@@ -36,6 +38,30 @@ namespace RTGL1
 {
 
 struct ShGeometryInstance;
+struct ResidentMeshData;
+
+// Byte offsets of vertex attribute arrays in a vertex buffer that can hold "capacity" vertices.
+// Positions are always at the beginning, so AS geometry data doesn't depend on the capacity.
+struct VertexBufferLayout
+{
+    uint32_t capacity;
+    uint32_t texCoordLayerCount;
+    VkDeviceSize positions;
+    VkDeviceSize normals;
+    VkDeviceSize texCoords[3];
+    VkDeviceSize size;
+};
+
+// Instance of a resident mesh that is traced through the mesh's BLAS
+struct MeshInstanceInfo
+{
+    RgMesh mesh;
+    uint64_t uniqueID;
+    VertexCollectorFilterTypeFlags geomFlags;
+    VkTransformMatrixKHR transform;
+    // set on EndCollecting
+    uint32_t globalGeomIndex;
+};
 
 // The class collects vertex data to buffers with shader struct types.
 // Geometries are passed to the class by chunks and the result of collecting
@@ -46,10 +72,10 @@ public:
     explicit VertexCollector(
         VkDevice device, 
         const std::shared_ptr<MemoryAllocator> &allocator,
+        std::shared_ptr<FrameAllocator> frameAllocator,
         std::shared_ptr<GeomInfoManager> geomInfoManager,
         std::shared_ptr<TriangleInfoManager> triangleInfoMgr,
         std::shared_ptr<SectorVisibility> sectorVisibility,
-        VkDeviceSize bufferSize, 
         const VertexBufferProperties &properties,
         VertexCollectorFilterTypeFlags filters);
 
@@ -67,8 +93,21 @@ public:
 
 
     void BeginCollecting(bool isStatic);
-    uint32_t AddGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT]);
-    void EndCollecting();
+    // If pMesh is not null, vertex and index data of the geometry are copied
+    // from the mesh's device-local buffer, instead of the upload info's arrays
+    uint32_t AddGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+                         const ResidentMeshData *pMesh = nullptr);
+    // Add an instance of a resident mesh without copying its vertex data: the instance
+    // is traced through the mesh's BLAS, and shaders read vertices from the mesh pool.
+    // Only for dynamic geometry. Returns false, if limits are exceeded.
+    bool AddMeshInstance(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+                         RgMesh mesh, const ResidentMeshData &meshData);
+    // Size device-local buffers for the collected data: exactly for static,
+    // with a geometric growth for dynamic. AS geometries are valid only after this call.
+    void EndCollecting(uint32_t frameIndex);
+
+    // Destroy buffers that were replaced by larger ones and are not in use anymore
+    void PrepareForFrame(uint32_t frameIndex);
 
 
     // Clear data that was generated while collecting.
@@ -98,6 +137,12 @@ public:
     uint32_t GetCurrentVertexCount() const;
     uint32_t GetCurrentIndexCount() const;
 
+    const VertexBufferLayout &GetVertexBufferLayout() const;
+    // Incremented each time when device-local buffers are reallocated
+    uint32_t GetDeviceLocalGeneration() const;
+    VkDeviceSize GetDeviceLocalSize() const;
+    VkDeviceSize GetStagingSize() const;
+
 
     // Get primitive counts from filters. Null if corresponding filter wasn't found.
     const std::vector<uint32_t> &GetPrimitiveCounts(VertexCollectorFilterTypeFlags filter) const;
@@ -108,6 +153,9 @@ public:
     // Get AS build range infos from filters. Null if corresponding filter wasn't found.
     const std::vector<VkAccelerationStructureBuildRangeInfoKHR> &GetASBuildRangeInfos(VertexCollectorFilterTypeFlags filter) const;
 
+    // Mesh instances that were added since the last Reset; global geometry indices are valid after EndCollecting
+    const std::vector<MeshInstanceInfo> &GetMeshInstances() const;
+
 
     // Are all geometries for each filter type in "flags" empty?
     bool AreGeometriesEmpty(VertexCollectorFilterTypeFlags flags) const;
@@ -121,17 +169,34 @@ public:
     void InsertVertexPreprocessFinishBarrier(VkCommandBuffer cmd);
 
 private:
-    void InitStagingBuffers(const std::shared_ptr<MemoryAllocator> &allocator);
-
+    void InitStagingBuffers();
+
+    bool IsStatic() const;
+    VertexBufferLayout MakeLayout(uint32_t vertexCapacity) const;
+    // Move already collected vertex data to match the layout with the specified capacity.
+    // Staging buffer is reallocated, if it's too small or if "exactSize" is true.
+    void RelayoutStagingVertices(uint32_t frameIndex, uint32_t vertexCapacity, bool exactSize);
+    void ResizeStagingIndices(uint32_t frameIndex, uint32_t indexCapacity);
+    void ReserveStaging(uint32_t frameIndex, uint32_t vertexCount, uint32_t indexCount);
+    void RecreateDeviceLocalVertices(uint32_t frameIndex);
+    void RecreateDeviceLocalIndices(uint32_t frameIndex, uint32_t indexCapacity);
+
+    // Fill material, flag and per-triangle info fields of geomInfo
+    void FillGeomInfo(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+                      VertexCollectorFilterTypeFlags geomFlags, uint32_t primitiveCount, bool hasNormals, ShGeometryInstance &geomInfo);
     void CopyDataToStaging(const RgGeometryUploadInfo &info, uint32_t vertIndex, bool isStatic);
     void CopyTexCoordsToStaging(
         bool isStatic, uint32_t globalVertIndex, uint32_t vertexCount, 
         const void *const texCoordLayerData[3], bool addToCopy = false);
 
-    bool GetVertBufferCopyInfos(bool isStatic, std::vector<VkBufferCopy> &outInfos) const;
+    bool GetVertBufferCopyInfos(bool isStatic, rgl::frame_vector<VkBufferCopy> &outInfos) const;
+    // Barriers for whole vertex attribute arrays in the device-local buffer, returns barrier count
+    uint32_t GetVertexAttributeBarriers(VkAccessFlags srcAccess, VkAccessFlags dstAccess, 
+                                        VkBufferMemoryBarrier *pDst, uint32_t maxCount) const;
     
-    std::vector<VkBufferCopy> CopyVertexDataFromStaging(VkCommandBuffer cmd, bool isStatic);
+    rgl::frame_vector<VkBufferCopy> CopyVertexDataFromStaging(VkCommandBuffer cmd, bool isStatic);
     bool CopyIndexDataFromStaging(VkCommandBuffer cmd);
+    bool CopyMeshInstances(VkCommandBuffer cmd);
     bool CopyTransformsFromStaging(VkCommandBuffer cmd, bool insertMemBarrier);
 
     void AddMaterialDependency(uint32_t simpleIndex, uint32_t layer, uint32_t materialIndex);
@@ -147,6 +212,7 @@ private:
     void PushRangeInfo(VertexCollectorFilterTypeFlags type, const VkAccelerationStructureBuildRangeInfoKHR &rangeInfo);
    
     uint32_t GetGeometryCount(VertexCollectorFilterTypeFlags type);
+    uint32_t GetMeshInstanceCount(VertexCollectorFilterTypeFlags type) const;
     uint32_t GetAllGeometryCount() const;
 
 private:
@@ -156,20 +222,57 @@ private:
         uint32_t layer;
     };
 
+    // Range of vertices or indices [begin, end) that were written to the staging buffer
+    struct StagedRange
+    {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // Instance of a resident mesh, which data is copied to the device-local buffers
+    // directly; destination offsets are calculated on copying, as the layout can change
+    struct MeshInstanceCopy
+    {
+        VkBuffer srcVertexBuffer;
+        VkBuffer srcIndexBuffer;
+        VkDeviceSize srcPositions;
+        VkDeviceSize srcNormals;
+        VkDeviceSize srcTexCoords;
+        VkDeviceSize srcIndices;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t dstVertIndex;
+        uint32_t dstIndIndex;
+    };
+
+    // Device local buffers, dynamic collectors for different frames share them
+    struct DeviceLocalBuffers
+    {
+        std::shared_ptr<Buffer> vertices;
+        std::shared_ptr<Buffer> indices;
+        std::shared_ptr<Buffer> transforms;
+        VertexBufferLayout verticesLayout;
+        uint32_t generation;
+    };
+
 private:
     VkDevice device;
     VertexBufferProperties properties;
     VertexCollectorFilterTypeFlags filtersFlags;
 
-    Buffer stagingVertBuffer;
-    std::shared_ptr<Buffer> vertBuffer;
+    std::shared_ptr<MemoryAllocator> allocator;
+
+    std::shared_ptr<Buffer> stagingVertBuffer;
+    std::shared_ptr<Buffer> stagingIndexBuffer;
+    std::shared_ptr<Buffer> stagingTransformsBuffer;
+    VertexBufferLayout stagingVertLayout;
 
-    Buffer stagingIndexBuffer;
-    std::shared_ptr<Buffer> indexBuffer;
+    std::shared_ptr<DeviceLocalBuffers> deviceLocal;
 
-    Buffer stagingTransformsBuffer;
-    std::shared_ptr<Buffer> transformsBuffer;
+    // replaced buffers that can be still in use by the frame with that index
+    std::vector<std::shared_ptr<Buffer>> buffersToDestroy[MAX_FRAMES_IN_FLIGHT];
 
+    std::shared_ptr<FrameAllocator> frameAllocator;
     std::shared_ptr<GeomInfoManager> geomInfoMgr;
     std::shared_ptr<TriangleInfoManager> triangleInfoMgr;
     std::shared_ptr<SectorVisibility> sectorVisibility;
@@ -188,12 +291,20 @@ private:
     rgl::unordered_map<VertexCollectorFilterTypeFlags, std::shared_ptr<VertexCollectorFilter>> filters;
 
     // if some static geometries changed their tex coords, then they should be copied 
-    // from staging to device-local; this array holds copy ranges; freed after vkCmdCopy call
-    std::vector<VkBufferCopy> texCoordsToCopy;
-    VkDeviceSize texCoordsToCopyLowerBound;
-    VkDeviceSize texCoordsToCopyUpperBound;
+    // from staging to device-local; this set holds copy ranges; cleared after vkCmdCopy call
+    DirtyRegions texCoordsToCopy;
 
     rgl::unordered_map<uint32_t, uint32_t> simpleIndexToTransformIndex;
+
+    // only these ranges are copied from staging, as mesh instances are not there
+    std::vector<StagedRange> stagedVertexRanges;
+    std::vector<StagedRange> stagedIndexRanges;
+    std::vector<MeshInstanceCopy> meshInstanceCopies;
+
+    std::vector<MeshInstanceInfo> meshInstances;
+    // geom infos of meshInstances, written on EndCollecting
+    std::vector<ShGeometryInstance> meshInstanceGeomInfos;
+    rgl::unordered_map<VertexCollectorFilterTypeFlags, uint32_t> meshInstanceCountPerGroup;
 };
 
 }
\ No newline at end of file
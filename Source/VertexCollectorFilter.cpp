@@ -76,6 +76,22 @@ void VertexCollectorFilter::PushRangeInfo(VertexCollectorFilterTypeFlags type, c
     asBuildRangeInfos.push_back(rangeInfo);
 }
 
+void VertexCollectorFilter::ApplyBufferAddresses(VkDeviceAddress vertexBufferAddress, VkDeviceAddress indexBufferAddress, VkDeviceAddress transformBufferAddress)
+{
+    for (auto &geom : asGeometries)
+    {
+        VkAccelerationStructureGeometryTrianglesDataKHR &trData = geom.geometry.triangles;
+
+        trData.vertexData.deviceAddress += vertexBufferAddress;
+        trData.transformData.deviceAddress += transformBufferAddress;
+
+        if (trData.indexType != VK_INDEX_TYPE_NONE_KHR)
+        {
+            trData.indexData.deviceAddress += indexBufferAddress;
+        }
+    }
+}
+
 VertexCollectorFilterTypeFlags VertexCollectorFilter::GetFilter() const
 {
     return filter;
@@ -54,6 +54,10 @@ public:
     void PushPrimitiveCount(VertexCollectorFilterTypeFlags type, uint32_t primCount);
     void PushRangeInfo(VertexCollectorFilterTypeFlags type, const VkAccelerationStructureBuildRangeInfoKHR &rangeInfo);
 
+    // Geometries are pushed with addresses relative to the beginning of the buffers,
+    // as the buffers can be reallocated while collecting. Add actual base addresses.
+    void ApplyBufferAddresses(VkDeviceAddress vertexBufferAddress, VkDeviceAddress indexBufferAddress, VkDeviceAddress transformBufferAddress);
+
     VertexCollectorFilterTypeFlags GetFilter() const;
     uint32_t GetGeometryCount() const;
 
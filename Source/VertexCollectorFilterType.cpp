@@ -30,7 +30,7 @@ static_assert(
     sizeof(RTGL1::VertexCollectorFilterGroup_ChangeFrequency)   / sizeof(RTGL1::VertexCollectorFilterGroup_ChangeFrequency[0]) * 
     sizeof(RTGL1::VertexCollectorFilterGroup_PassThrough)       / sizeof(RTGL1::VertexCollectorFilterGroup_PassThrough[0]) *
     sizeof(RTGL1::VertexCollectorFilterGroup_PrimaryVisibility) / sizeof(RTGL1::VertexCollectorFilterGroup_PrimaryVisibility[0])
-    == MAX_TOP_LEVEL_INSTANCE_COUNT, "It's recommended for MAX_TOP_LEVEL_INSTANCE_COUNT to be such value");
+    <= MAX_TOP_LEVEL_INSTANCE_COUNT, "Each filter group must have its own TLAS instance, the rest are for mesh instances");
 
 typedef uint8_t FlagToIndexType;
 // 8 bits per byte
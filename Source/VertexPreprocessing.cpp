@@ -22,30 +22,84 @@
 
 #include <vector>
 #include <cmath>
+#include <cstring>
 #include "Generated/ShaderCommonC.h"
 #include "CmdLabel.h"
+#include "Utils.h"
+#include "VertexCollectorFilterType.h"
+
+static_assert(sizeof(RTGL1::ShVertPreprocessChunk) % 16 == 0, "Std430 structs must be aligned by 16 bytes");
+static_assert(sizeof(RTGL1::ShSkinningChunk) % 16 == 0, "Std430 structs must be aligned by 16 bytes");
+static_assert(sizeof(RgTransform) == 3 * 4 * sizeof(float), "RgTransform must be a row-major 3x4 matrix");
 
 RTGL1::VertexPreprocessing::VertexPreprocessing(
     VkDevice _device,
+    std::shared_ptr<MemoryAllocator> &_allocator,
     const std::shared_ptr<const GlobalUniform> &_uniform,
     const std::shared_ptr<const ASManager> &_asManager,
-    const std::shared_ptr<const ShaderManager> &_shaderManager)
+    const std::shared_ptr<const ShaderManager> &_shaderManager,
+    const VertexBufferProperties &_properties)
 :
-    device(_device)
+    device(_device),
+    properties(_properties),
+    maxChunkCount(VertexCollectorFilterTypeFlags_GetAllBottomLevelGeomsCount()),
+    descPool(VK_NULL_HANDLE),
+    descSetLayout(VK_NULL_HANDLE),
+    descSet(VK_NULL_HANDLE),
+    pipelineLayout(VK_NULL_HANDLE),
+    pipeline(VK_NULL_HANDLE),
+    resolvePipeline(VK_NULL_HANDLE),
+    skinChunkCount(0),
+    skinVertexCount(0),
+    skinJointCount(0),
+    skinDescSetLayout(VK_NULL_HANDLE),
+    skinDescSet(VK_NULL_HANDLE),
+    skinPipelineLayout(VK_NULL_HANDLE),
+    skinPipeline(VK_NULL_HANDLE)
 {
+    // each geometry is one chunk at most
+    chunkBuffer = std::make_unique<AutoBuffer>(_allocator);
+    chunkBuffer->Create(
+        maxChunkCount * sizeof(ShVertPreprocessChunk),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Vertex preprocessing chunks buffer");
+
+    normalsAccum = std::make_shared<Buffer>();
+    normalsAccum->Init(
+        _allocator, MAX_VERT_PREPROC_ACCUM_VERTEX_COUNT * 3 * sizeof(int32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        "Vertex preprocessing normals accumulation buffer");
+
+    CreateSkinningBuffers(_allocator);
+
+    CreateDescriptors();
+    CreateSkinningDescriptors();
+
     std::vector<VkDescriptorSetLayout> setLayouts =
     {
         _uniform->GetDescSetLayout(),
-        _asManager->GetBuffersDescSetLayout()
+        _asManager->GetBuffersDescSetLayout(),
+        descSetLayout,
+    };
+
+    std::vector<VkDescriptorSetLayout> skinSetLayouts =
+    {
+        _uniform->GetDescSetLayout(),
+        _asManager->GetBuffersDescSetLayout(),
+        skinDescSetLayout,
     };
 
-    CreatePipelineLayout(setLayouts.data(), setLayouts.size());
+    CreatePipelineLayout(setLayouts.data(), setLayouts.size(), skinSetLayouts.data(), skinSetLayouts.size());
     CreatePipelines(_shaderManager.get());
 }
 
 RTGL1::VertexPreprocessing::~VertexPreprocessing()
 {
     vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyPipelineLayout(device, skinPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, descSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, skinDescSetLayout, nullptr);
+    vkDestroyDescriptorPool(device, descPool, nullptr);
     DestroyPipelines();
 }
 
@@ -53,75 +107,484 @@ void RTGL1::VertexPreprocessing::Preprocess(
     VkCommandBuffer cmd, uint32_t frameIndex, uint32_t preprocMode,
     const std::shared_ptr<const GlobalUniform> &uniform,
     const std::shared_ptr<ASManager> &asManager,
-    const ShVertPreprocessing &push)
+    const std::shared_ptr<GeomInfoManager> &geomInfoManager)
 {
     CmdLabel label(cmd, "Vertex preprocessing");
 
+    const bool onlyDynamic = preprocMode == VERT_PREPROC_MODE_ONLY_DYNAMIC;
+
+
+    // build the work list
+    uint32_t chunkCount = 0;
+    auto *chunks = static_cast<ShVertPreprocessChunk *>(chunkBuffer->GetMapped(frameIndex));
+
+    batches.clear();
+    batches.push_back({});
+
+    auto addChunks = [&chunkCount, chunks, this] (const std::vector<GeomPreprocessInfo> &infos, bool isDynamic)
+    {
+        for (const GeomPreprocessInfo &info : infos)
+        {
+            assert(chunkCount < maxChunkCount);
+
+            if (info.accumVertexCount > MAX_VERT_PREPROC_ACCUM_VERTEX_COUNT)
+            {
+                assert(0 && "Too many vertices in a geometry with generated normals");
+                continue;
+            }
+
+            Batch *batch = &batches.back();
+
+            // offsets are relative to the batch
+            if (batch->accumVertexCount + info.accumVertexCount > MAX_VERT_PREPROC_ACCUM_VERTEX_COUNT)
+            {
+                batches.push_back({ chunkCount, 0, 0, 0 });
+                batch = &batches.back();
+            }
+
+            ShVertPreprocessChunk &dst = chunks[chunkCount];
+            dst.globalGeomIndex = info.globalGeomIndex;
+            dst.triangleOffset = batch->triangleCount;
+            dst.triangleCount = info.triangleCount;
+            dst.isDynamic = isDynamic ? 1 : 0;
+            dst.accumVertexOffset = batch->accumVertexCount;
+            dst.accumVertexCount = info.accumVertexCount;
+
+            chunkCount++;
+
+            batch->chunkCount++;
+            batch->triangleCount += info.triangleCount;
+            batch->accumVertexCount += info.accumVertexCount;
+        }
+    };
+
+    // static geometry is not changed after its upload,
+    // so it's processed only once
+    if (!onlyDynamic)
+    {
+        addChunks(geomInfoManager->GetStaticToPreprocess(), false);
+        geomInfoManager->OnStaticPreprocessed();
+    }
+
+    addChunks(geomInfoManager->GetDynamicToPreprocess(), true);
 
-    asManager->OnVertexPreprocessingBegin(cmd, frameIndex, preprocMode == VERT_PREPROC_MODE_ONLY_DYNAMIC);
 
+    asManager->OnVertexPreprocessingBegin(cmd, frameIndex, onlyDynamic);
 
-    VkPipeline pl = 
-        preprocMode == VERT_PREPROC_MODE_ALL ? pipelineAll :
-        preprocMode == VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE ? pipelineDynamicAndMovable :
-        pipelineOnlyDynamic;
-   
+    if (chunkCount > 0)
+    {
+        chunkBuffer->CopyFromStaging(cmd, frameIndex, chunkCount * sizeof(ShVertPreprocessChunk));
+
+        VkBufferMemoryBarrier b = {};
+        b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.buffer = chunkBuffer->GetDeviceLocal();
+        b.offset = 0;
+        b.size = chunkCount * sizeof(ShVertPreprocessChunk);
+
+        // also, the accumulation buffer is shared between frames,
+        // previous frame's resolve pass can still read it
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            0, nullptr,
+            1, &b,
+            0, nullptr);
+
+
+        VkDescriptorSet sets[] =
+        {
+            uniform->GetDescSet(frameIndex),
+            asManager->GetBuffersDescSet(frameIndex),
+            descSet,
+        };
+        const uint32_t setCount = sizeof(sets) / sizeof(VkDescriptorSet);
+        
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                pipelineLayout,
+                                0, setCount, sets,
+                                0, nullptr);
+
+        for (const Batch &batch : batches)
+        {
+            if (batch.chunkCount == 0)
+            {
+                continue;
+            }
+
+            ShVertPreprocessing push = {};
+            push.chunkOffset = batch.firstChunk;
+            push.chunkCount = batch.chunkCount;
+            push.totalTriangleCount = batch.triangleCount;
+            push.totalAccumVertexCount = batch.accumVertexCount;
+
+            const VkDeviceSize accumSize = (VkDeviceSize)batch.accumVertexCount * 3 * sizeof(int32_t);
+
+            if (accumSize > 0)
+            {
+                vkCmdFillBuffer(cmd, normalsAccum->GetBuffer(), 0, accumSize, 0);
+
+                VkMemoryBarrier mb = {};
+                mb.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                mb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                mb.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+                vkCmdPipelineBarrier(
+                    cmd,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    0,
+                    1, &mb,
+                    0, nullptr,
+                    0, nullptr);
+            }
+
+            Dispatch(cmd, pipeline, push, batch.triangleCount);
+
+            if (accumSize > 0)
+            {
+                // sums must be complete before resolving;
+                // then, the buffer can be cleared for the next batch
+                VkMemoryBarrier mb = {};
+                mb.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                mb.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                mb.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+                vkCmdPipelineBarrier(
+                    cmd,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    0,
+                    1, &mb,
+                    0, nullptr,
+                    0, nullptr);
+
+                Dispatch(cmd, resolvePipeline, push, batch.accumVertexCount);
+
+                vkCmdPipelineBarrier(
+                    cmd,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    0,
+                    0, nullptr,
+                    0, nullptr,
+                    0, nullptr);
+            }
+        }
+    }
+
+    asManager->OnVertexPreprocessingFinish(cmd, frameIndex, onlyDynamic);
+}
+
+void RTGL1::VertexPreprocessing::Dispatch(VkCommandBuffer cmd, VkPipeline pl, const ShVertPreprocessing &push, uint32_t threadCount)
+{
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pl);
+    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ShVertPreprocessing), &push);
+    vkCmdDispatch(cmd, Utils::GetWorkGroupCount(threadCount, COMPUTE_VERT_PREPROC_GROUP_SIZE_X), 1, 1);
+}
 
+bool RTGL1::VertexPreprocessing::CanSkin(uint32_t vertexCount, uint32_t jointCount) const
+{
+    return 
+        skinChunkCount + 1 <= maxChunkCount &&
+        skinVertexCount + vertexCount <= MAX_SKINNED_VERTEX_COUNT &&
+        skinJointCount + jointCount <= MAX_SKINNING_JOINT_COUNT;
+}
+
+void RTGL1::VertexPreprocessing::AddSkinnedInstance(uint32_t frameIndex, uint32_t baseVertexIndex, 
+                                                    const ResidentMeshData &mesh, const RgMeshSkinningInfo &skinning)
+{
+    assert(CanSkin(mesh.vertexCount, skinning.jointCount));
+    assert(mesh.jointIndices != ResidentMeshData::NO_ATTRIBUTE && mesh.jointWeights != ResidentMeshData::NO_ATTRIBUTE);
+    assert(skinning.jointCount > 0 && skinning.pJointTransforms != nullptr);
+
+    auto *chunks = static_cast<ShSkinningChunk *>(skinChunkBuffer->GetMapped(frameIndex));
+    auto *transforms = static_cast<RgTransform *>(skinJointTransforms->GetMapped(frameIndex));
+
+    ShSkinningChunk &dst = chunks[skinChunkCount];
+    dst.baseVertexIndex = baseVertexIndex;
+    dst.vertexOffset = skinVertexCount;
+    dst.vertexCount = mesh.vertexCount;
+    dst.jointOffset = skinJointCount;
+    dst.jointCount = skinning.jointCount;
+    dst.skinNormals = mesh.normals != ResidentMeshData::NO_ATTRIBUTE ? 1 : 0;
+
+    memcpy(transforms + skinJointCount, skinning.pJointTransforms, skinning.jointCount * sizeof(RgTransform));
+
+    skinCopies.push_back({ mesh.jointBuffer, mesh.jointIndices, mesh.jointWeights, skinVertexCount, mesh.vertexCount });
+
+    skinChunkCount++;
+    skinVertexCount += mesh.vertexCount;
+    skinJointCount += skinning.jointCount;
+}
+
+void RTGL1::VertexPreprocessing::Skin(
+    VkCommandBuffer cmd, uint32_t frameIndex,
+    const std::shared_ptr<const GlobalUniform> &uniform,
+    const std::shared_ptr<ASManager> &asManager)
+{
+    if (skinChunkCount == 0)
+    {
+        return;
+    }
+
+    CmdLabel label(cmd, "Skinning");
+
+    CopySkinningData(cmd, frameIndex);
+
+
+    const VertexBufferLayout &layout = asManager->GetDynamicVertexBufferLayout(frameIndex);
+
+    ShSkinning push = {};
+    push.chunkCount = skinChunkCount;
+    push.totalVertexCount = skinVertexCount;
+    push.positionsStride = properties.positionStride / sizeof(float);
+    push.normalsStride = properties.normalStride / sizeof(float);
+    push.normalsOffset = (uint32_t)(layout.normals / sizeof(float));
+
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, skinPipeline);
 
     VkDescriptorSet sets[] =
     {
         uniform->GetDescSet(frameIndex),
-        asManager->GetBuffersDescSet(frameIndex)
+        asManager->GetBuffersDescSet(frameIndex),
+        skinDescSet,
     };
     const uint32_t setCount = sizeof(sets) / sizeof(VkDescriptorSet);
-    
+
     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
-                            pipelineLayout,
+                            skinPipelineLayout,
                             0, setCount, sets,
                             0, nullptr);
 
+    vkCmdPushConstants(cmd, skinPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ShSkinning), &push);
+
+    vkCmdDispatch(cmd, Utils::GetWorkGroupCount(skinVertexCount, COMPUTE_SKINNING_GROUP_SIZE_X), 1, 1);
 
-    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ShVertPreprocessing), &push);
 
+    // skinned positions are used in BLAS building and in normals generation
+    VkMemoryBarrier br = {};
+    br.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    br.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    br.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 
-    vkCmdDispatch(cmd, push.tlasInstanceCount, 1, 1);
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &br,
+        0, nullptr,
+        0, nullptr);
 
 
-    asManager->OnVertexPreprocessingFinish(cmd, frameIndex, preprocMode == VERT_PREPROC_MODE_ONLY_DYNAMIC);
+    skinChunkCount = 0;
+    skinVertexCount = 0;
+    skinJointCount = 0;
+    skinCopies.clear();
+}
+
+void RTGL1::VertexPreprocessing::CopySkinningData(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    // skinning buffers are shared between frames, previous frame's skinning can still read them
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        0, nullptr);
+
+    for (const SkinningCopy &cp : skinCopies)
+    {
+        VkBufferCopy indInfo = {};
+        indInfo.srcOffset = cp.srcJointIndices;
+        indInfo.dstOffset = cp.vertexOffset * 4 * sizeof(uint8_t);
+        indInfo.size = cp.vertexCount * 4 * sizeof(uint8_t);
+
+        VkBufferCopy wghInfo = {};
+        wghInfo.srcOffset = cp.srcJointWeights;
+        wghInfo.dstOffset = cp.vertexOffset * 4 * sizeof(float);
+        wghInfo.size = cp.vertexCount * 4 * sizeof(float);
+
+        vkCmdCopyBuffer(cmd, cp.srcBuffer, skinJointIndices->GetBuffer(), 1, &indInfo);
+        vkCmdCopyBuffer(cmd, cp.srcBuffer, skinJointWeights->GetBuffer(), 1, &wghInfo);
+    }
+
+    skinChunkBuffer->CopyFromStaging(cmd, frameIndex, skinChunkCount * sizeof(ShSkinningChunk));
+    skinJointTransforms->CopyFromStaging(cmd, frameIndex, skinJointCount * sizeof(RgTransform));
+
+
+    VkBufferMemoryBarrier barriers[4] = {};
+
+    barriers[0].buffer = skinChunkBuffer->GetDeviceLocal();
+    barriers[0].size = skinChunkCount * sizeof(ShSkinningChunk);
+
+    barriers[1].buffer = skinJointTransforms->GetDeviceLocal();
+    barriers[1].size = skinJointCount * sizeof(RgTransform);
+
+    barriers[2].buffer = skinJointIndices->GetBuffer();
+    barriers[2].size = skinVertexCount * 4 * sizeof(uint8_t);
+
+    barriers[3].buffer = skinJointWeights->GetBuffer();
+    barriers[3].size = skinVertexCount * 4 * sizeof(float);
+
+    for (VkBufferMemoryBarrier &b : barriers)
+    {
+        b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.offset = 0;
+    }
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0, nullptr,
+        std::size(barriers), barriers,
+        0, nullptr);
 }
 
 void RTGL1::VertexPreprocessing::OnShaderReload(const ShaderManager *shaderManager)
 {
-    DestroyPipelines();
+    shaderManager->DestroyWhenUnused(pipeline);
+    shaderManager->DestroyWhenUnused(resolvePipeline);
+    shaderManager->DestroyWhenUnused(skinPipeline);
+
     CreatePipelines(shaderManager);
 }
 
-void RTGL1::VertexPreprocessing::CreatePipelineLayout(VkDescriptorSetLayout*pSetLayouts, uint32_t setLayoutCount)
+void RTGL1::VertexPreprocessing::CreateDescriptors()
 {
-    VkPushConstantRange pc = {};
-    pc.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    pc.offset = 0;
-    pc.size = sizeof(ShVertPreprocessing);
-
-    VkPipelineLayoutCreateInfo plLayoutInfo = {};
-    plLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    plLayoutInfo.setLayoutCount = setLayoutCount;
-    plLayoutInfo.pSetLayouts = pSetLayouts;
-    plLayoutInfo.pushConstantRangeCount = 1;
-    plLayoutInfo.pPushConstantRanges = &pc;
-
-    VkResult r = vkCreatePipelineLayout(device, &plLayoutInfo, nullptr, &pipelineLayout);
-    VK_CHECKERROR(r);
+    {
+        // chunks, normals accumulation; skinning chunks, joint indices, weights, transforms
+        VkDescriptorPoolSize poolSize = {};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = 2 + 4;
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        poolInfo.maxSets = 2;
+
+        VkResult r = vkCreateDescriptorPool(device, &poolInfo, nullptr, &descPool);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, descPool, VK_OBJECT_TYPE_DESCRIPTOR_POOL, "Vertex preprocessing desc pool");
+    }
+    {
+        VkDescriptorSetLayoutBinding bindings[2] = {};
+
+        bindings[0].binding = BINDING_VERT_PREPROC_CHUNKS;
+        bindings[1].binding = BINDING_VERT_PREPROC_NORMALS_ACCUM;
+
+        for (VkDescriptorSetLayoutBinding &binding : bindings)
+        {
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            binding.descriptorCount = 1;
+            binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        info.bindingCount = std::size(bindings);
+        info.pBindings = bindings;
+
+        VkResult r = vkCreateDescriptorSetLayout(device, &info, nullptr, &descSetLayout);
+        VK_CHECKERROR(r);
 
-    SET_DEBUG_NAME(device, pipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Vertex preprocessing pipeline layout");
+        SET_DEBUG_NAME(device, descSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Vertex preprocessing desc set layout");
+    }
+    {
+        VkDescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &descSetLayout;
+
+        VkResult r = vkAllocateDescriptorSets(device, &allocInfo, &descSet);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, descSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Vertex preprocessing desc set");
+    }
+    {
+        VkDescriptorBufferInfo b[2] = {};
+        b[0].buffer = chunkBuffer->GetDeviceLocal();
+        b[0].offset = 0;
+        b[0].range = VK_WHOLE_SIZE;
+
+        b[1].buffer = normalsAccum->GetBuffer();
+        b[1].offset = 0;
+        b[1].range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet w[2] = {};
+
+        for (uint32_t i = 0; i < std::size(w); i++)
+        {
+            w[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w[i].dstSet = descSet;
+            w[i].dstArrayElement = 0;
+            w[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            w[i].descriptorCount = 1;
+            w[i].pBufferInfo = &b[i];
+        }
+
+        w[0].dstBinding = BINDING_VERT_PREPROC_CHUNKS;
+        w[1].dstBinding = BINDING_VERT_PREPROC_NORMALS_ACCUM;
+
+        vkUpdateDescriptorSets(device, std::size(w), w, 0, nullptr);
+    }
 }
 
-void RTGL1::VertexPreprocessing::CreatePipelines(const ShaderManager *shaderManager)
+void RTGL1::VertexPreprocessing::CreatePipelineLayout(VkDescriptorSetLayout *pSetLayouts, uint32_t setLayoutCount,
+                                                      VkDescriptorSetLayout *pSkinSetLayouts, uint32_t skinSetLayoutCount)
 {
-    VkResult r;
+    {
+        VkPushConstantRange pc = {};
+        pc.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pc.offset = 0;
+        pc.size = sizeof(ShVertPreprocessing);
+
+        VkPipelineLayoutCreateInfo plLayoutInfo = {};
+        plLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plLayoutInfo.setLayoutCount = setLayoutCount;
+        plLayoutInfo.pSetLayouts = pSetLayouts;
+        plLayoutInfo.pushConstantRangeCount = 1;
+        plLayoutInfo.pPushConstantRanges = &pc;
+
+        VkResult r = vkCreatePipelineLayout(device, &plLayoutInfo, nullptr, &pipelineLayout);
+        VK_CHECKERROR(r);
 
-    uint32_t specInfoDataOnlyDynamic = 0;
+        SET_DEBUG_NAME(device, pipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Vertex preprocessing pipeline layout");
+    }
+    {
+        VkPushConstantRange pc = {};
+        pc.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pc.offset = 0;
+        pc.size = sizeof(ShSkinning);
+
+        VkPipelineLayoutCreateInfo plLayoutInfo = {};
+        plLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plLayoutInfo.setLayoutCount = skinSetLayoutCount;
+        plLayoutInfo.pSetLayouts = pSkinSetLayouts;
+        plLayoutInfo.pushConstantRangeCount = 1;
+        plLayoutInfo.pPushConstantRanges = &pc;
+
+        VkResult r = vkCreatePipelineLayout(device, &plLayoutInfo, nullptr, &skinPipelineLayout);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, skinPipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Skinning pipeline layout");
+    }
+}
+
+void RTGL1::VertexPreprocessing::CreatePipelines(const ShaderManager *shaderManager)
+{
+    uint32_t vertPreprocPass = VERT_PREPROC_PASS_ACCUMULATE;
 
     VkSpecializationMapEntry specEntry = {};
     specEntry.constantID = 0;
@@ -132,49 +595,148 @@ void RTGL1::VertexPreprocessing::CreatePipelines(const ShaderManager *shaderMana
     specInfo.mapEntryCount = 1;
     specInfo.pMapEntries = &specEntry;
     specInfo.dataSize = sizeof(uint32_t);
-    specInfo.pData = &specInfoDataOnlyDynamic;
+    specInfo.pData = &vertPreprocPass;
 
     VkComputePipelineCreateInfo plInfo = {};
     plInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     plInfo.layout = pipelineLayout;
     plInfo.stage = shaderManager->GetStageInfo("CVertexPreprocess");
     plInfo.stage.pSpecializationInfo = &specInfo;
-    
-    {
-        specInfoDataOnlyDynamic = VERT_PREPROC_MODE_ONLY_DYNAMIC;
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelineOnlyDynamic);
-        VK_CHECKERROR(r);
+    VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipeline);
+    VK_CHECKERROR(r);
 
-        SET_DEBUG_NAME(device, pipelineOnlyDynamic, VK_OBJECT_TYPE_PIPELINE, "Vertex only dynamic preprocessing pipeline");
-    }
-    
-    {
-        specInfoDataOnlyDynamic = VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE;
+    SET_DEBUG_NAME(device, pipeline, VK_OBJECT_TYPE_PIPELINE, "Vertex preprocessing pipeline");
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelineDynamicAndMovable);
-        VK_CHECKERROR(r);
 
-        SET_DEBUG_NAME(device, pipelineDynamicAndMovable, VK_OBJECT_TYPE_PIPELINE, "Vertex movable/dynamic preprocessing pipeline");
-    }
+    vertPreprocPass = VERT_PREPROC_PASS_RESOLVE;
 
-    {
-        specInfoDataOnlyDynamic = VERT_PREPROC_MODE_ALL;
+    r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &resolvePipeline);
+    VK_CHECKERROR(r);
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelineAll);
-        VK_CHECKERROR(r);
+    SET_DEBUG_NAME(device, resolvePipeline, VK_OBJECT_TYPE_PIPELINE, "Vertex preprocessing resolve pipeline");
 
-        SET_DEBUG_NAME(device, pipelineAll, VK_OBJECT_TYPE_PIPELINE, "Vertex static/movable/dynamic preprocessing pipeline");
-    }
+
+    plInfo.layout = skinPipelineLayout;
+    plInfo.stage = shaderManager->GetStageInfo("CSkinning");
+
+    r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &skinPipeline);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, skinPipeline, VK_OBJECT_TYPE_PIPELINE, "Skinning pipeline");
 }
 
 void RTGL1::VertexPreprocessing::DestroyPipelines()
 {
-    vkDestroyPipeline(device, pipelineOnlyDynamic, nullptr);
-    vkDestroyPipeline(device, pipelineDynamicAndMovable, nullptr);
-    vkDestroyPipeline(device, pipelineAll, nullptr);
+    vkDestroyPipeline(device, pipeline, nullptr);
+    pipeline = VK_NULL_HANDLE;
+
+    vkDestroyPipeline(device, resolvePipeline, nullptr);
+    resolvePipeline = VK_NULL_HANDLE;
+
+    vkDestroyPipeline(device, skinPipeline, nullptr);
+    skinPipeline = VK_NULL_HANDLE;
+}
+
+void RTGL1::VertexPreprocessing::CreateSkinningBuffers(const std::shared_ptr<MemoryAllocator> &allocator)
+{
+    skinChunkBuffer = std::make_unique<AutoBuffer>(allocator);
+    skinChunkBuffer->Create(
+        maxChunkCount * sizeof(ShSkinningChunk),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Skinning chunks buffer");
+
+    skinJointTransforms = std::make_unique<AutoBuffer>(allocator);
+    skinJointTransforms->Create(
+        MAX_SKINNING_JOINT_COUNT * sizeof(RgTransform),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Skinning joint transforms buffer");
+
+    skinJointIndices = std::make_shared<Buffer>();
+    skinJointIndices->Init(
+        allocator, MAX_SKINNED_VERTEX_COUNT * 4 * sizeof(uint8_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        "Skinning joint indices buffer");
+
+    skinJointWeights = std::make_shared<Buffer>();
+    skinJointWeights->Init(
+        allocator, MAX_SKINNED_VERTEX_COUNT * 4 * sizeof(float),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        "Skinning joint weights buffer");
+}
+
+void RTGL1::VertexPreprocessing::CreateSkinningDescriptors()
+{
+    const uint32_t bindingCount = 4;
 
-    pipelineOnlyDynamic = VK_NULL_HANDLE;
-    pipelineDynamicAndMovable = VK_NULL_HANDLE;
-    pipelineAll = VK_NULL_HANDLE;
+    const uint32_t bindingIndices[bindingCount] =
+    {
+        BINDING_SKINNING_CHUNKS,
+        BINDING_SKINNING_JOINT_INDICES,
+        BINDING_SKINNING_JOINT_WEIGHTS,
+        BINDING_SKINNING_JOINT_TRANSFORMS,
+    };
+
+    const VkBuffer buffers[bindingCount] =
+    {
+        skinChunkBuffer->GetDeviceLocal(),
+        skinJointIndices->GetBuffer(),
+        skinJointWeights->GetBuffer(),
+        skinJointTransforms->GetDeviceLocal(),
+    };
+
+    {
+        VkDescriptorSetLayoutBinding bindings[bindingCount] = {};
+
+        for (uint32_t i = 0; i < bindingCount; i++)
+        {
+            bindings[i].binding = bindingIndices[i];
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        info.bindingCount = bindingCount;
+        info.pBindings = bindings;
+
+        VkResult r = vkCreateDescriptorSetLayout(device, &info, nullptr, &skinDescSetLayout);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, skinDescSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Skinning desc set layout");
+    }
+    {
+        VkDescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &skinDescSetLayout;
+
+        VkResult r = vkAllocateDescriptorSets(device, &allocInfo, &skinDescSet);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, skinDescSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Skinning desc set");
+    }
+    {
+        VkDescriptorBufferInfo bufInfos[bindingCount] = {};
+        VkWriteDescriptorSet writes[bindingCount] = {};
+
+        for (uint32_t i = 0; i < bindingCount; i++)
+        {
+            bufInfos[i].buffer = buffers[i];
+            bufInfos[i].offset = 0;
+            bufInfos[i].range = VK_WHOLE_SIZE;
+
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = skinDescSet;
+            writes[i].dstBinding = bindingIndices[i];
+            writes[i].dstArrayElement = 0;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].descriptorCount = 1;
+            writes[i].pBufferInfo = &bufInfos[i];
+        }
+
+        vkUpdateDescriptorSets(device, bindingCount, writes, 0, nullptr);
+    }
 }
@@ -22,7 +22,10 @@
 
 #include "Common.h"
 #include "ASManager.h"
+#include "AutoBuffer.h"
+#include "GeomInfoManager.h"
 #include "GlobalUniform.h"
+#include "MeshManager.h"
 #include "ShaderManager.h"
 
 namespace RTGL1
@@ -30,14 +33,22 @@ namespace RTGL1
 
 struct ShVertPreprocessing;
 
+// Dispatches one thread per triangle of the geometries that require
+// vertex preprocessing, see GeomInfoManager::GetDynamicToPreprocess.
+// Normals of indexed geometry are accumulated per vertex and resolved
+// in a second dispatch, so shared vertices don't depend on thread order.
+// Skinned mesh instances are processed before that, one thread per vertex,
+// as their positions must be ready for building dynamic BLAS.
 class VertexPreprocessing : public IShaderDependency
 {
 public:
     explicit VertexPreprocessing(
         VkDevice device, 
+        std::shared_ptr<MemoryAllocator> &allocator,
         const std::shared_ptr<const GlobalUniform> &uniform,
         const std::shared_ptr<const ASManager> &asManager,
-        const std::shared_ptr<const ShaderManager> &shaderManager);
+        const std::shared_ptr<const ShaderManager> &shaderManager,
+        const VertexBufferProperties &properties);
 
     ~VertexPreprocessing();
 
@@ -50,21 +61,93 @@ public:
         VkCommandBuffer cmd, uint32_t frameIndex, uint32_t preprocMode,
         const std::shared_ptr<const GlobalUniform> &uniform,
         const std::shared_ptr<ASManager> &asManager,
-        const ShVertPreprocessing &push);
+        const std::shared_ptr<GeomInfoManager> &geomInfoManager);
+
+    // Returns false, if the instance can't fit into the current frame's skinning buffers
+    bool CanSkin(uint32_t vertexCount, uint32_t jointCount) const;
+    // Vertices of the instance must be already added to the dynamic vertex buffer
+    // at "baseVertexIndex", they are skinned in-place
+    void AddSkinnedInstance(uint32_t frameIndex, uint32_t baseVertexIndex, 
+                            const ResidentMeshData &mesh, const RgMeshSkinningInfo &skinning);
+    // Must be called after copying dynamic vertex data, but before building dynamic BLAS
+    void Skin(
+        VkCommandBuffer cmd, uint32_t frameIndex,
+        const std::shared_ptr<const GlobalUniform> &uniform,
+        const std::shared_ptr<ASManager> &asManager);
     
     void OnShaderReload(const ShaderManager *shaderManager) override;
 
 private:
-    void CreatePipelineLayout(VkDescriptorSetLayout *pSetLayouts, uint32_t setLayoutCount);
+    void CreateDescriptors();
+    void CreatePipelineLayout(VkDescriptorSetLayout *pSetLayouts, uint32_t setLayoutCount,
+                              VkDescriptorSetLayout *pSkinSetLayouts, uint32_t skinSetLayoutCount);
     void CreatePipelines(const ShaderManager *shaderManager);
     void DestroyPipelines();
 
+    void Dispatch(VkCommandBuffer cmd, VkPipeline pl, const ShVertPreprocessing &push, uint32_t threadCount);
+
+    void CreateSkinningBuffers(const std::shared_ptr<MemoryAllocator> &allocator);
+    void CreateSkinningDescriptors();
+    void CopySkinningData(VkCommandBuffer cmd, uint32_t frameIndex);
+
+private:
+    // chunks that are processed at once, their accumulated
+    // vertex count is limited by the accumulation buffer size
+    struct Batch
+    {
+        uint32_t firstChunk;
+        uint32_t chunkCount;
+        uint32_t triangleCount;
+        uint32_t accumVertexCount;
+    };
+
+    // joint data is copied from the mesh to the skinning buffers at "vertexOffset"
+    struct SkinningCopy
+    {
+        VkBuffer srcBuffer;
+        VkDeviceSize srcJointIndices;
+        VkDeviceSize srcJointWeights;
+        uint32_t vertexOffset;
+        uint32_t vertexCount;
+    };
+
 private:
     VkDevice device;
+    VertexBufferProperties properties;
+
+    // work list: geometries with prefix sums of their triangle counts
+    std::unique_ptr<AutoBuffer> chunkBuffer;
+    uint32_t maxChunkCount;
+    std::vector<Batch> batches;
+
+    // fixed point sums of face normals for each vertex of indexed geometry
+    std::shared_ptr<Buffer> normalsAccum;
+
+    VkDescriptorPool descPool;
+    VkDescriptorSetLayout descSetLayout;
+    VkDescriptorSet descSet;
+
     VkPipelineLayout pipelineLayout;
-    VkPipeline pipelineOnlyDynamic;
-    VkPipeline pipelineDynamicAndMovable;
-    VkPipeline pipelineAll;
+    VkPipeline pipeline;
+    VkPipeline resolvePipeline;
+
+    // skinning work list and joint transforms are uploaded each frame,
+    // joint indices and weights are copied from the meshes
+    std::unique_ptr<AutoBuffer> skinChunkBuffer;
+    std::unique_ptr<AutoBuffer> skinJointTransforms;
+    std::shared_ptr<Buffer> skinJointIndices;
+    std::shared_ptr<Buffer> skinJointWeights;
+
+    uint32_t skinChunkCount;
+    uint32_t skinVertexCount;
+    uint32_t skinJointCount;
+    std::vector<SkinningCopy> skinCopies;
+
+    VkDescriptorSetLayout skinDescSetLayout;
+    VkDescriptorSet skinDescSet;
+
+    VkPipelineLayout skinPipelineLayout;
+    VkPipeline skinPipeline;
 };
 
 }
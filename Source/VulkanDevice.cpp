@@ -35,11 +35,21 @@
 
 using namespace RTGL1;
 
+// Framebuffers with history are swapped by the parity of a frame index,
+// so the count of frame indices is even. If there are more frame indices
+// than frames in flight, a frame additionally waits for a more recent one.
+static uint32_t FramesInFlightToFrameCount(uint32_t framesInFlight)
+{
+    return std::max(2u, framesInFlight + framesInFlight % 2);
+}
+
 VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     instance(VK_NULL_HANDLE),
     device(VK_NULL_HANDLE),
     surface(VK_NULL_HANDLE),
-    currentFrameState(),
+    memoryBudgetExtEnabled(false),
+    framesInFlight(info->framesInFlight == 0 ? 2 : info->framesInFlight),
+    currentFrameState(FramesInFlightToFrameCount(framesInFlight)),
     frameId(1),
     waitForOutOfFrameFence(false),
     enableValidationLayer(info->enableValidationLayer == RG_TRUE),
@@ -49,6 +59,7 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     rayCullBackFacingTriangles(info->rayCullBackFacingTriangles),
     allowGeometryWithSkyFlag(info->allowGeometryWithSkyFlag),
     lensFlareVerticesInScreenSpace(info->lensFlareVerticesInScreenSpace),
+    dynamicResolutionScales{},
     previousFrameTime(-1.0 / 60.0),
     currentFrameTime(0)
 {
@@ -85,9 +96,15 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     queues->SetDevice(device);
 
 
-    memAllocator        = std::make_shared<MemoryAllocator>(instance, device, physDevice);
+    memAllocator        = std::make_shared<MemoryAllocator>(instance, device, physDevice, currentFrameState.GetFrameCount(), memoryBudgetExtEnabled);
+
+    frameAllocator      = std::make_shared<FrameAllocator>();
+
+    cmdManager          = std::make_shared<CommandBufferManager>(device, queues, currentFrameState.GetFrameCount());
+
+    taskScheduler       = std::make_shared<TaskScheduler>(info->workerThreadCount, info->pfnParallelFor, info->pUserParallelForData);
 
-    cmdManager          = std::make_shared<CommandBufferManager>(device, queues);
+    gpuTimestamps       = std::make_shared<GpuTimestamps>(device, physDevice, currentFrameState.GetFrameCount());
 
     uniform             = std::make_shared<GlobalUniform>(device, memAllocator);
 
@@ -114,6 +131,7 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         memAllocator,
         worldSamplerManager,
         cmdManager,
+        taskScheduler,
         userFileLoad,
         *info);
 
@@ -134,6 +152,8 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     scene               = std::make_shared<Scene>(
         device,
         memAllocator,
+        physDevice,
+        frameAllocator,
         cmdManager,
         textureManager,
         uniform,
@@ -150,6 +170,7 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         memAllocator,
         framebuffers,
         cmdManager,
+        taskScheduler,
         *info);
 
     decalManager        = std::make_shared<DecalManager>(
@@ -158,7 +179,8 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         shaderManager,
         uniform,
         framebuffers,
-        textureManager);
+        textureManager,
+        scene->GetSectorVisibility());
 
     rtPipeline          = std::make_shared<RayTracingPipeline>(
         device, 
@@ -228,13 +250,15 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         blueNoise,
         shaderManager);
 
+    effectRadialBlur            = std::make_shared<EffectRadialBlur>();
+    effectChromaticAberration   = std::make_shared<EffectChromaticAberration>();
+    effectInverseBW             = std::make_shared<EffectInverseBW>();
+    effectHueShift              = std::make_shared<EffectHueShift>();
+    effectDistortedSides        = std::make_shared<EffectDistortedSides>();
+    effectColorTint             = std::make_shared<EffectColorTint>();
+    effectSimpleChain           = std::make_shared<EffectSimpleChain>(device, framebuffers, uniform, shaderManager);
+
 #define CONSTRUCT_SIMPLE_EFFECT(T) std::make_shared<T>(device, framebuffers, uniform, shaderManager)
-    effectRadialBlur            = CONSTRUCT_SIMPLE_EFFECT(EffectRadialBlur);
-    effectChromaticAberration   = CONSTRUCT_SIMPLE_EFFECT(EffectChromaticAberration);
-    effectInverseBW             = CONSTRUCT_SIMPLE_EFFECT(EffectInverseBW);
-    effectHueShift              = CONSTRUCT_SIMPLE_EFFECT(EffectHueShift);
-    effectDistortedSides        = CONSTRUCT_SIMPLE_EFFECT(EffectDistortedSides);
-    effectColorTint             = CONSTRUCT_SIMPLE_EFFECT(EffectColorTint);
     effectCrtDemodulateEncode   = CONSTRUCT_SIMPLE_EFFECT(EffectCrtDemodulateEncode);
     effectCrtDecode             = CONSTRUCT_SIMPLE_EFFECT(EffectCrtDecode);
 #undef SIMPLE_EFFECT_CONSTRUCTOR_PARAMS
@@ -251,17 +275,14 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     shaderManager->Subscribe(amdFsr);
     shaderManager->Subscribe(sharpening);
     shaderManager->Subscribe(effectWipe);
-    shaderManager->Subscribe(effectRadialBlur);
-    shaderManager->Subscribe(effectChromaticAberration);
-    shaderManager->Subscribe(effectInverseBW);
-    shaderManager->Subscribe(effectHueShift);
-    shaderManager->Subscribe(effectDistortedSides);
-    shaderManager->Subscribe(effectColorTint);
+    shaderManager->Subscribe(effectSimpleChain);
     shaderManager->Subscribe(effectCrtDemodulateEncode);
     shaderManager->Subscribe(effectCrtDecode);
 
     framebuffers->Subscribe(rasterizer);
     framebuffers->Subscribe(decalManager);
+
+    textureManager->Subscribe(decalManager);
 }
 
 VulkanDevice::~VulkanDevice()
@@ -272,6 +293,7 @@ VulkanDevice::~VulkanDevice()
     queues.reset();
     swapchain.reset();
     cmdManager.reset();
+    gpuTimestamps.reset();
     framebuffers.reset();
     tonemapping.reset();
     imageComposition.reset();
@@ -286,6 +308,7 @@ VulkanDevice::~VulkanDevice()
     effectHueShift.reset();
     effectDistortedSides.reset();
     effectColorTint.reset();
+    effectSimpleChain.reset();
     effectCrtDemodulateEncode.reset();
     effectCrtDecode.reset();
     denoiser.reset();
@@ -302,6 +325,7 @@ VulkanDevice::~VulkanDevice()
     textureManager.reset();
     cubemapManager.reset();
     memAllocator.reset();
+    frameAllocator.reset();
 
     vkDestroySurfaceKHR(instance, surface, nullptr);
     DestroySyncPrimitives();
@@ -313,6 +337,14 @@ VulkanDevice::~VulkanDevice()
 VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
 {
     uint32_t frameIndex = currentFrameState.IncrementFrameIndexAndGet();
+    const uint32_t frameCount = currentFrameState.GetFrameCount();
+
+    if (framesInFlight < frameCount)
+    {
+        // wait for the frame that was started 'framesInFlight' frames ago,
+        // its fence will be reset when its frame index is used again
+        Utils::WaitForFence(device, frameFences[(frameIndex + frameCount - framesInFlight) % frameCount]);
+    }
 
     if (!waitForOutOfFrameFence)
     {
@@ -324,6 +356,17 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
         Utils::WaitAndResetFences(device, frameFences[frameIndex], outOfFrameFences[frameIndex]);
     }
 
+    // transient CPU data of the previous frame is not needed anymore
+    frameAllocator->Reset();
+
+    if (frameAllocator->GetPrevFrameHeapAllocationCount() > 0)
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf) / sizeof(buf[0]), "Frame allocator grew to %zu bytes\n", frameAllocator->GetCapacity());
+
+        userPrint->Print(buf);
+    }
+
     swapchain->RequestNewSize(startInfo.surfaceSize.width, startInfo.surfaceSize.height);
     swapchain->RequestVsync(startInfo.requestVSync);
     swapchain->AcquireImage(imageAvailableSemaphores[frameIndex]);
@@ -343,7 +386,7 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
             cmdManager->Submit(preFrameCmd,
                                semaphoreToWaitOnSubmit, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
                                inFrameSemaphores[frameIndex],
-                               outOfFrameFences[(frameIndex + 1) % MAX_FRAMES_IN_FLIGHT]);
+                               outOfFrameFences[(frameIndex + 1) % frameCount]);
 
             // should wait other semaphore in this case
             semaphoreToWaitOnSubmit = inFrameSemaphores[frameIndex];
@@ -358,16 +401,20 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
     currentFrameState.SetSemaphore(semaphoreToWaitOnSubmit);
 
 
+    // pipelines replaced by a reload, when this frame index was used last time, are not in use now
+    shaderManager->PrepareForFrame(frameIndex);
+
     if (startInfo.requestShaderReload)
     {
-        shaderManager->ReloadShaders();
+        shaderManager->ReloadShaders(frameIndex);
     }
 
 
     // reset cmds for current frame index
     cmdManager->PrepareForFrame(frameIndex);
 
-    // clear the data that were created MAX_FRAMES_IN_FLIGHT ago
+    // clear the data that were created frameCount frames ago
+    framebuffers->PrepareForFrame(frameIndex);
     worldSamplerManager->PrepareForFrame(frameIndex);
     genericSamplerManager->PrepareForFrame(frameIndex);
     textureManager->PrepareForFrame(frameIndex);
@@ -379,12 +426,50 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
 
     BeginCmdLabel(cmd, "Prepare for frame");
 
+    // get results of the frame with the same index
+    gpuTimestamps->PrepareForFrame(cmd, frameIndex);
+
     // start dynamic geometry recording to current frame
     scene->PrepareForFrame(cmd, frameIndex);
 
     return cmd;
 }
 
+float VulkanDevice::UpdateDynamicResolution(uint32_t frameIndex, const RgDrawFrameRenderResolutionParams &params, float *pOutMaxScale)
+{
+    if (params.dynamicTargetTimeMs <= 0.0f)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "RgDrawFrameRenderResolutionParams::dynamicTargetTimeMs must be positive");
+    }
+
+    float minScale = params.dynamicMinScale;
+    float maxScale = params.dynamicMaxScale;
+
+    if (minScale == 0.0f && maxScale == 0.0f)
+    {
+        minScale = 0.33f;
+        maxScale = 1.0f;
+    }
+
+    float scale;
+    float gpuTimeMs;
+
+    // measured on the previous frame with the same index
+    if (gpuTimestamps->GetDurationMs(frameIndex, &gpuTimeMs))
+    {
+        scale = dynamicResolution.Update(gpuTimeMs, dynamicResolutionScales[frameIndex], params.dynamicTargetTimeMs, minScale, maxScale);
+    }
+    else
+    {
+        scale = dynamicResolution.GetScale(minScale, maxScale);
+    }
+
+    dynamicResolutionScales[frameIndex] = scale;
+    *pOutMaxScale = dynamicResolution.GetMaxScale(minScale, maxScale);
+
+    return scale;
+}
+
 void VulkanDevice::FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawInfo) const
 {
     const float IdentityMat4x4[16] =
@@ -429,6 +514,11 @@ void VulkanDevice::FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawI
     }
 
     {
+        // render size can be changed with a dynamic resolution,
+        // so reprojection to the previous frame must use the previous size
+        gu->prevRenderWidth = gu->renderWidth;
+        gu->prevRenderHeight = gu->renderHeight;
+
         gu->renderWidth = (float)renderResolution.Width();
         gu->renderHeight = (float)renderResolution.Height();
         // render width must be always even for checkerboarding!
@@ -437,6 +527,10 @@ void VulkanDevice::FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawI
         gu->upscaledRenderWidth = (float)renderResolution.UpscaledWidth();
         gu->upscaledRenderHeight = (float)renderResolution.UpscaledHeight();
 
+        // render-size framebuffers can be larger than the area that is rendered to
+        gu->renderAllocatedWidth = (float)framebuffers->GetAllocatedResolution().renderWidth;
+        gu->renderAllocatedHeight = (float)framebuffers->GetAllocatedResolution().renderHeight;
+
         if (renderResolution.IsNvDlssEnabled())
         {
             RgFloat2D jitter = HaltonSequence::GetJitter_Halton23(frameId);
@@ -743,6 +837,7 @@ void VulkanDevice::FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawI
     }
 
     gu->waterNormalTextureIndex = textureManager->GetWaterNormalTextureIndex();
+    textureManager->FillAnimatedMaterialTable(gu);
 
     gu->cameraRayConeSpreadAngle = atanf((2.0f * tanf(drawInfo.fovYRadians * 0.5f)) / (float)renderResolution.Height());
 
@@ -761,6 +856,13 @@ void VulkanDevice::FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawI
 
     gu->useSqrtRoughnessForIndirect = !!drawInfo.useSqrtRoughnessForIndirect;
 
+    switch (drawInfo.indirectIlluminationMode)
+    {
+        case RG_INDIRECT_ILLUMINATION_MODE_CHECKERBOARD:    gu->indirectIlluminationMode = INDIRECT_ILLUMINATION_MODE_CHECKERBOARD; break;
+        case RG_INDIRECT_ILLUMINATION_MODE_HALF:            gu->indirectIlluminationMode = INDIRECT_ILLUMINATION_MODE_HALF; break;
+        default:                                            gu->indirectIlluminationMode = INDIRECT_ILLUMINATION_MODE_FULL; break;
+    }
+
     gu->lensFlareCullingInputCount = rasterizer->GetLensFlareCullingInputCount();
     gu->applyViewProjToLensFlares = !lensFlareVerticesInScreenSpace;
 }
@@ -777,6 +879,8 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
     bool mipLodBiasUpdated = worldSamplerManager->TryChangeMipLodBias(frameIndex, renderResolution.GetMipLodBias());
     const RgFloat2D jitter = renderResolution.IsNvDlssEnabled() ? HaltonSequence::GetJitter_Halton23(frameId) : RgFloat2D{ 0, 0 };
 
+    // reload textures with other mip levels, if they exceed the memory budget
+    textureManager->UpdateResidency(cmd, frameIndex);
     textureManager->SubmitDescriptors(frameIndex, drawInfo.pTexturesParams, mipLodBiasUpdated);
     cubemapManager->SubmitDescriptors(frameIndex);
 
@@ -789,9 +893,6 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
                                                        drawInfo.disableRayTracing);
 
 
-    framebuffers->PrepareForSize(renderResolution.GetResolutionState());
-    
-
     if (!drawInfo.disableRasterization)
     {
         rasterizer->SubmitForFrame(cmd, frameIndex);
@@ -810,7 +911,12 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     if (raysCanBeTraced)
     {
-        decalManager->SubmitForFrame(cmd, frameIndex);
+        decalManager->SubmitForFrame(cmd, frameIndex, uniform, drawInfo.pCameraSectorID);
+
+        // these passes depend on the render resolution, measure them for the dynamic resolution
+        gpuTimestamps->WriteBegin(cmd, frameIndex);
+
+        framebuffers->BeginPass(cmd, FB_PASS_PRIMARY);
 
         pathTracer->Bind(
             cmd, frameIndex, 
@@ -832,10 +938,16 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
         // update the illumination
         pathTracer->TraceDirectllumination(  cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
-        pathTracer->TraceIndirectllumination(cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
+        pathTracer->TraceIndirectllumination(cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), uniform, framebuffers);
+
+        // fill the pixels that were not traced, if indirect illumination mode is not full
+        denoiser->ReconstructIndirect(cmd, frameIndex, uniform);
 
+        framebuffers->BeginPass(cmd, FB_PASS_DENOISE);
         denoiser->Denoise(cmd, frameIndex, uniform);
 
+        gpuTimestamps->WriteEnd(cmd, frameIndex);
+
         // tonemapping
         tonemapping->Tonemap(cmd, frameIndex, uniform);
     }
@@ -845,11 +957,13 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     if (enableBloom)
     {
+        framebuffers->BeginPass(cmd, FB_PASS_BLOOM);
         bloom->Prepare(cmd, frameIndex, uniform, tonemapping);
     }
 
 
     // final image composition
+    framebuffers->BeginPass(cmd, FB_PASS_COMPOSITION);
     imageComposition->Compose(cmd, frameIndex, uniform, tonemapping);
 
     if (!drawInfo.disableRasterization)
@@ -861,6 +975,8 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
     }
 
 
+    framebuffers->BeginPass(cmd, FB_PASS_POSTPROCESS);
+
     FramebufferImageIndex currentResultImage = FramebufferImageIndex::FB_IMAGE_INDEX_FINAL;
     {
         VkExtent2D extent = { renderResolution.Width(), renderResolution.Height() };
@@ -900,28 +1016,31 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
     {
         if (effectColorTint->Setup(args, drawInfo.postEffectParams.pColorTint))
         {
-            currentResultImage = effectColorTint->Apply(args, currentResultImage);
+            effectSimpleChain->Add(*effectColorTint);
         }
         if (effectInverseBW->Setup(args, drawInfo.postEffectParams.pInverseBlackAndWhite))
         {
-            currentResultImage = effectInverseBW->Apply(args, currentResultImage);
+            effectSimpleChain->Add(*effectInverseBW);
         }
         if (effectHueShift->Setup(args, drawInfo.postEffectParams.pHueShift))
         {
-            currentResultImage = effectHueShift->Apply(args, currentResultImage);
+            effectSimpleChain->Add(*effectHueShift);
         }
         if (effectChromaticAberration->Setup(args, drawInfo.postEffectParams.pChromaticAberration))
         {
-            currentResultImage = effectChromaticAberration->Apply(args, currentResultImage);
+            effectSimpleChain->Add(*effectChromaticAberration);
         }
         if (effectDistortedSides->Setup(args, drawInfo.postEffectParams.pDistortedSides))
         {
-            currentResultImage = effectDistortedSides->Apply(args, currentResultImage);
+            effectSimpleChain->Add(*effectDistortedSides);
         }
         if (effectRadialBlur->Setup(args, drawInfo.postEffectParams.pRadialBlur))
         {
-            currentResultImage = effectRadialBlur->Apply(args, currentResultImage);
+            effectSimpleChain->Add(*effectRadialBlur);
         }
+
+        // all of the above in one pass
+        currentResultImage = effectSimpleChain->Apply(args, currentResultImage);
     }
 
     // draw geometry such as HUD directly into the swapchain image
@@ -1014,11 +1133,28 @@ void VulkanDevice::DrawFrame(const RgDrawFrameInfo *drawInfo)
     previousFrameTime = currentFrameTime;
     currentFrameTime = drawInfo->currentTime;
 
+    float dynamicScale = 1.0f;
+    float dynamicMaxScale = 1.0f;
+
+    if (drawInfo->pRenderResolutionParams != nullptr &&
+        drawInfo->pRenderResolutionParams->resolutionMode == RG_RENDER_RESOLUTION_MODE_DYNAMIC)
+    {
+        dynamicScale = UpdateDynamicResolution(currentFrameState.GetFrameIndex(), *drawInfo->pRenderResolutionParams, &dynamicMaxScale);
+    }
+    else
+    {
+        dynamicResolution.Reset();
+        dynamicResolutionScales[currentFrameState.GetFrameIndex()] = 0.0f;
+    }
+
     renderResolution.Setup(drawInfo->pRenderResolutionParams,
-                           swapchain->GetWidth(), swapchain->GetHeight(), nvDlss);
+                           swapchain->GetWidth(), swapchain->GetHeight(), nvDlss, dynamicScale, dynamicMaxScale);
 
     if (renderResolution.Width() > 0 && renderResolution.Height() > 0)
     {
+        framebuffers->PrepareForSize(cmd, currentFrameState.GetFrameIndex(),
+                                     renderResolution.GetResolutionState(), renderResolution.GetMaxResolutionState());
+
         FillUniform(uniform->GetData(), *drawInfo);
         Render(cmd, *drawInfo);
     }
@@ -1042,6 +1178,36 @@ bool RTGL1::VulkanDevice::IsRenderUpscaleTechniqueAvailable(RgRenderUpscaleTechn
     }
 }
 
+void VulkanDevice::GetGeometryBuffersStats(RgGeometryBuffersStats *pResult) const
+{
+    if (pResult == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    scene->GetASManager()->GetBuffersStats(pResult);
+}
+
+void VulkanDevice::GetFramebuffersStats(RgFramebuffersStats *pResult) const
+{
+    if (pResult == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    framebuffers->GetStats(pResult);
+}
+
+void VulkanDevice::GetBufferMemoryStats(RgBufferMemoryStats *pResult) const
+{
+    if (pResult == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    memAllocator->GetBufferStats(pResult);
+}
+
 void VulkanDevice::Print(const char *pMessage) const
 {
     userPrint->Print(pMessage);
@@ -1050,8 +1216,6 @@ void VulkanDevice::Print(const char *pMessage) const
 
 void VulkanDevice::UploadGeometry(const RgGeometryUploadInfo *uploadInfo)
 {
-    using namespace std::string_literals;
-
     if (uploadInfo == nullptr)
     {
         throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
@@ -1068,6 +1232,15 @@ void VulkanDevice::UploadGeometry(const RgGeometryUploadInfo *uploadInfo)
         throw RgException(RG_WRONG_ARGUMENT, "Incorrect index data");
     }
 
+    ValidateGeometryUploadInfo(uploadInfo);
+
+    scene->Upload(currentFrameState.GetFrameIndex(), *uploadInfo);
+}
+
+void VulkanDevice::ValidateGeometryUploadInfo(const RgGeometryUploadInfo *uploadInfo)
+{
+    using namespace std::string_literals;
+
     if (uploadInfo->geomType != RG_GEOMETRY_TYPE_STATIC &&
         uploadInfo->geomType != RG_GEOMETRY_TYPE_STATIC_MOVABLE &&
         uploadInfo->geomType != RG_GEOMETRY_TYPE_DYNAMIC &&
@@ -1115,8 +1288,73 @@ void VulkanDevice::UploadGeometry(const RgGeometryUploadInfo *uploadInfo)
     {
         throw RgException(RG_WRONG_ARGUMENT, "Geometry with ID="s + std::to_string(uploadInfo->uniqueID) + " already exists");
     }
+}
 
-    scene->Upload(currentFrameState.GetFrameIndex(), *uploadInfo);
+void VulkanDevice::CreateMesh(const RgMeshCreateInfo *pCreateInfo, RgMesh *pResult)
+{
+    if (pCreateInfo == nullptr || pResult == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    if (pCreateInfo->pVertexData == nullptr || pCreateInfo->vertexCount == 0)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Incorrect vertex data");
+    }
+
+    if ((pCreateInfo->pIndexData == nullptr && pCreateInfo->indexCount != 0) ||
+        (pCreateInfo->pIndexData != nullptr && pCreateInfo->indexCount == 0))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Incorrect index data");
+    }
+
+    if ((pCreateInfo->pJointIndexData == nullptr) != (pCreateInfo->pJointWeightData == nullptr))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Joint indices and weights must be set together");
+    }
+
+    *pResult = scene->CreateMesh(*pCreateInfo);
+}
+
+void VulkanDevice::DestroyMesh(RgMesh mesh)
+{
+    if (mesh == RG_NO_MESH)
+    {
+        return;
+    }
+
+    scene->DestroyMesh(currentFrameState.GetFrameIndex(), mesh);
+}
+
+void VulkanDevice::UploadMeshInstance(RgMesh mesh, const RgGeometryUploadInfo *uploadInfo, const RgMeshSkinningInfo *pSkinningInfo)
+{
+    if (uploadInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    if (pSkinningInfo != nullptr)
+    {
+        if (pSkinningInfo->pJointTransforms == nullptr || pSkinningInfo->jointCount == 0)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Incorrect joint transforms");
+        }
+
+        // joint indices are uint8
+        if (pSkinningInfo->jointCount > 256)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Joint count must not exceed 256");
+        }
+    }
+
+    if (uploadInfo->geomType != RG_GEOMETRY_TYPE_DYNAMIC)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Mesh instance must have RG_GEOMETRY_TYPE_DYNAMIC geometry type");
+    }
+
+    ValidateGeometryUploadInfo(uploadInfo);
+
+    scene->UploadMeshInstance(currentFrameState.GetFrameIndex(), mesh, *uploadInfo, pSkinningInfo);
 }
 
 void VulkanDevice::UpdateGeometryTransform(const RgUpdateTransformInfo *updateInfo)
@@ -1199,9 +1437,24 @@ void RTGL1::VulkanDevice::UploadDecal(const RgDecalUploadInfo *pUploadInfo)
     decalManager->Upload(currentFrameState.GetFrameIndex(), *pUploadInfo, textureManager);
 }
 
+void RTGL1::VulkanDevice::UploadStaticDecal(const RgStaticDecalUploadInfo *pUploadInfo)
+{
+    if (pUploadInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    decalManager->UploadStatic(*pUploadInfo, textureManager);
+}
+
+void RTGL1::VulkanDevice::RemoveStaticDecal(uint64_t uniqueID)
+{
+    decalManager->RemoveStatic(uniqueID);
+}
+
 void VulkanDevice::SubmitStaticGeometries()
 {
-    scene->SubmitStatic();
+    scene->SubmitStatic(currentFrameState.GetFrameIndex());
 }
 
 void VulkanDevice::StartNewStaticScene()
@@ -1249,6 +1502,26 @@ void RTGL1::VulkanDevice::UploadLight(const RgPolygonalLightUploadInfo *pLightIn
     scene->UploadLight(currentFrameState.GetFrameIndex(), *pLightInfo);
 }
 
+void VulkanDevice::UploadLights(const RgSphericalLightUploadInfo *pLightInfos, uint32_t lightCount)
+{
+    if (pLightInfos == nullptr && lightCount > 0)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    scene->UploadLights(currentFrameState.GetFrameIndex(), pLightInfos, lightCount);
+}
+
+void VulkanDevice::UploadLights(const RgPolygonalLightUploadInfo *pLightInfos, uint32_t lightCount)
+{
+    if (pLightInfos == nullptr && lightCount > 0)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    scene->UploadLights(currentFrameState.GetFrameIndex(), pLightInfos, lightCount);
+}
+
 void RTGL1::VulkanDevice::SetPotentialVisibility(SectorID sectorID_A, SectorID sectorID_B)
 {
     scene->SetPotentialVisibility(sectorID_A, sectorID_B);
@@ -1505,7 +1778,7 @@ void VulkanDevice::CreateDevice()
     features.samplerAnisotropy = 1;
     features.textureCompressionETC2 = 0;
     features.textureCompressionASTC_LDR = 0;
-    features.textureCompressionBC = 0;
+    features.textureCompressionBC = 1;
     features.occlusionQueryPrecise = 0;
     features.pipelineStatisticsQuery = 1;
     features.vertexPipelineStoresAndAtomics = 1;
@@ -1595,6 +1868,14 @@ void VulkanDevice::CreateDevice()
         deviceExtensions.push_back(n);
     }
 
+    // optional, for the actual device memory budget
+    memoryBudgetExtEnabled = physDevice->IsExtensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    if (memoryBudgetExtEnabled)
+    {
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     queues->GetDeviceQueueCreateInfos(queueCreateInfos);
@@ -1633,7 +1914,7 @@ void VulkanDevice::CreateSyncPrimitives()
     VkFenceCreateInfo nonSignaledFenceInfo = {};
     nonSignaledFenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < currentFrameState.GetFrameCount(); i++)
     {
         r = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]);
         VK_CHECKERROR(r);
@@ -1819,6 +2100,16 @@ void RTGL1::VulkanDevice::ValidateCreateInfo(const RgInstanceCreateInfo *pInfo)
         }
     }
 
+    if (pInfo->framesInFlight > 3)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "framesInFlight must be <=3");
+    }
+
+    if (pInfo->staticTextureCompression > RG_TEXTURE_COMPRESSION_QUALITY)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "staticTextureCompression has an incorrect value");
+    }
+
     if (pInfo->rasterizedSkyCubemapSize == 0)
     {
         throw RgException(RG_WRONG_ARGUMENT, "rasterizedSkyCubemapSize must be non-zero");
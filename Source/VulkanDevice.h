@@ -27,6 +27,7 @@
 #include "Common.h"
 
 #include "CommandBufferManager.h"
+#include "TaskScheduler.h"
 #include "PhysicalDevice.h"
 #include "Scene.h"
 #include "Swapchain.h"
@@ -34,6 +35,9 @@
 #include "GlobalUniform.h"
 #include "PathTracer.h"
 #include "Rasterizer.h"
+#include "FrameAllocator.h"
+#include "GpuTimestamps.h"
+#include "DynamicResolutionController.h"
 #include "Framebuffers.h"
 #include "MemoryAllocator.h"
 #include "TextureManager.h"
@@ -51,6 +55,7 @@
 #include "DecalManager.h"
 #include "EffectWipe.h"
 #include "EffectSimple_Instances.h"
+#include "EffectSimpleChain.h"
 
 namespace RTGL1
 {
@@ -70,10 +75,16 @@ public:
     void UpdateGeometryTransform(const RgUpdateTransformInfo *pUpdateInfo);
     void UpdateGeometryTexCoords(const RgUpdateTexCoordsInfo *pUpdateInfo);
 
+    void CreateMesh(const RgMeshCreateInfo *pCreateInfo, RgMesh *pResult);
+    void DestroyMesh(RgMesh mesh);
+    void UploadMeshInstance(RgMesh mesh, const RgGeometryUploadInfo *pUploadInfo, const RgMeshSkinningInfo *pSkinningInfo = nullptr);
+
     void UploadRasterizedGeometry(const RgRasterizedGeometryUploadInfo *pUploadInfo,
                                   const float *pViewProjection, const RgViewport *pViewport);
     void UploadLensFlare(const RgLensFlareUploadInfo *pUploadInfo);
     void UploadDecal(const RgDecalUploadInfo *pUploadInfo);
+    void UploadStaticDecal(const RgStaticDecalUploadInfo *pUploadInfo);
+    void RemoveStaticDecal(uint64_t uniqueID);
 
     void SubmitStaticGeometries();
     void StartNewStaticScene();
@@ -82,6 +93,8 @@ public:
     void UploadLight(const RgSphericalLightUploadInfo *pLightInfo);
     void UploadLight(const RgSpotlightUploadInfo *pLightInfo);
     void UploadLight(const RgPolygonalLightUploadInfo *pLightInfo);
+    void UploadLights(const RgSphericalLightUploadInfo *pLightInfos, uint32_t lightCount);
+    void UploadLights(const RgPolygonalLightUploadInfo *pLightInfos, uint32_t lightCount);
 
     void SetPotentialVisibility(SectorID sectorID_A, SectorID sectorID_B);
 
@@ -101,6 +114,9 @@ public:
 
 
     bool IsRenderUpscaleTechniqueAvailable(RgRenderUpscaleTechnique technique) const;
+    void GetGeometryBuffersStats(RgGeometryBuffersStats *pResult) const;
+    void GetFramebuffersStats(RgFramebuffersStats *pResult) const;
+    void GetBufferMemoryStats(RgBufferMemoryStats *pResult) const;
 
 
     void Print(const char *pMessage) const;
@@ -111,11 +127,13 @@ private:
     void CreateSyncPrimitives();
     static VkSurfaceKHR GetSurfaceFromUser(VkInstance instance, const RgInstanceCreateInfo &info);
     void ValidateCreateInfo(const RgInstanceCreateInfo *pInfo);
+    void ValidateGeometryUploadInfo(const RgGeometryUploadInfo *pUploadInfo);
 
     void DestroyInstance();
     void DestroyDevice();
     void DestroySyncPrimitives();
 
+    float UpdateDynamicResolution(uint32_t frameIndex, const RgDrawFrameRenderResolutionParams &params, float *pOutMaxScale);
     void FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawInfo) const;
 
     VkCommandBuffer BeginFrame(const RgStartFrameInfo &startInfo);
@@ -126,8 +144,9 @@ private:
     struct FrameState
     {
     private:
-        // [0..MAX_FRAMES_IN_FLIGHT-1]
+        // [0..frameCount-1]
         uint32_t            frameIndex;
+        uint32_t            frameCount;
         VkCommandBuffer     frameCmd;
         VkSemaphore         semaphoreToWait;
         // This cmd buffer is used for materials that 
@@ -136,8 +155,9 @@ private:
         VkCommandBuffer     preFrameCmd;
 
     public:
-        FrameState() : 
-            frameIndex(MAX_FRAMES_IN_FLIGHT - 1), 
+        explicit FrameState(uint32_t _frameCount) : 
+            frameIndex(_frameCount - 1), 
+            frameCount(_frameCount),
             frameCmd(VK_NULL_HANDLE), 
             semaphoreToWait(VK_NULL_HANDLE),
             preFrameCmd(VK_NULL_HANDLE)
@@ -150,20 +170,19 @@ private:
 
         uint32_t IncrementFrameIndexAndGet()
         {
-            frameIndex = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+            frameIndex = (frameIndex + 1) % frameCount;
             return frameIndex;
         }
 
         uint32_t GetFrameIndex() const
         {
-            assert(frameIndex >= 0 && frameIndex < MAX_FRAMES_IN_FLIGHT);
+            assert(frameIndex >= 0 && frameIndex < frameCount);
             return frameIndex;
         }
 
-        static uint32_t GetPrevFrameIndex(uint32_t frameIndex)
+        uint32_t GetFrameCount() const
         {
-            assert(frameIndex >= 0 && frameIndex < MAX_FRAMES_IN_FLIGHT);
-            return (frameIndex + (MAX_FRAMES_IN_FLIGHT - 1)) % MAX_FRAMES_IN_FLIGHT;
+            return frameCount;
         }
 
         void OnBeginFrame(VkCommandBuffer cmd)
@@ -236,7 +255,11 @@ private:
     VkInstance          instance;
     VkDevice            device;
     VkSurfaceKHR        surface;
+    // true, if VK_EXT_memory_budget is enabled
+    bool                memoryBudgetExtEnabled;
 
+    // how many frames can be processed by GPU, while the current one is recorded
+    uint32_t            framesInFlight;
     FrameState          currentFrameState;
 
     // incremented every frame
@@ -255,8 +278,11 @@ private:
     std::shared_ptr<Swapchain>              swapchain;
 
     std::shared_ptr<MemoryAllocator>        memAllocator;
+    std::shared_ptr<FrameAllocator>         frameAllocator;
+    std::shared_ptr<GpuTimestamps>          gpuTimestamps;
 
     std::shared_ptr<CommandBufferManager>   cmdManager;
+    std::shared_ptr<TaskScheduler>          taskScheduler;
 
     std::shared_ptr<Framebuffers>           framebuffers;
 
@@ -282,6 +308,7 @@ private:
     std::shared_ptr<EffectHueShift>             effectHueShift;
     std::shared_ptr<EffectDistortedSides>       effectDistortedSides;
     std::shared_ptr<EffectColorTint>            effectColorTint;
+    std::shared_ptr<EffectSimpleChain>          effectSimpleChain;
     std::shared_ptr<EffectCrtDemodulateEncode>  effectCrtDemodulateEncode;
     std::shared_ptr<EffectCrtDecode>            effectCrtDecode;
 
@@ -302,6 +329,9 @@ private:
     bool                                    lensFlareVerticesInScreenSpace;
 
     RenderResolutionHelper                  renderResolution;
+    DynamicResolutionController             dynamicResolution;
+    // scale that was used for the frame with such index, 0 if dynamic resolution was disabled
+    float                                   dynamicResolutionScales[MAX_FRAMES_IN_FLIGHT];
 
     double                                  previousFrameTime;
     double                                  currentFrameTime;
@@ -0,0 +1,218 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Standalone checks of DirtyRegions interval logic, no device is required.
+
+#include <cstdio>
+#include <vector>
+
+#include "../Source/DirtyRegions.h"
+
+using namespace RTGL1;
+
+namespace
+{
+
+int failedCount = 0;
+
+#define CHECK(x) \
+    do { if (!(x)) { std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #x); failedCount++; } } while (0)
+
+bool Equals(const VkBufferCopy &r, VkDeviceSize offset, VkDeviceSize size)
+{
+    return r.srcOffset == offset && r.dstOffset == offset && r.size == size;
+}
+
+void TestEmpty()
+{
+    DirtyRegions d;
+
+    CHECK(d.IsEmpty());
+    CHECK(d.GetCopyInfos().empty());
+    CHECK(d.GetUpperBound() == 0);
+
+    // zero sized ranges are ignored
+    d.Add(100, 0);
+    CHECK(d.IsEmpty());
+    CHECK(d.GetCopyInfos().empty());
+}
+
+void TestSequentialMerge()
+{
+    DirtyRegions d(0);
+
+    d.Add(0, 16);
+    d.Add(16, 16);
+    d.Add(32, 32);
+
+    const auto &r = d.GetCopyInfos();
+    CHECK(r.size() == 1);
+    CHECK(Equals(r[0], 0, 64));
+    CHECK(d.GetLowerBound() == 0);
+    CHECK(d.GetUpperBound() == 64);
+}
+
+void TestAdjacency()
+{
+    // gap exactly at the threshold is merged
+    {
+        DirtyRegions d(8);
+
+        d.Add(0, 16);
+        d.Add(24, 8);
+
+        const auto &r = d.GetCopyInfos();
+        CHECK(r.size() == 1);
+        CHECK(Equals(r[0], 0, 32));
+    }
+
+    // gap beyond the threshold is kept as a separate region
+    {
+        DirtyRegions d(8);
+
+        d.Add(0, 16);
+        d.Add(25, 8);
+
+        const auto &r = d.GetCopyInfos();
+        CHECK(r.size() == 2);
+        CHECK(Equals(r[0], 0, 16));
+        CHECK(Equals(r[1], 25, 8));
+        CHECK(d.GetLowerBound() == 0);
+        CHECK(d.GetUpperBound() == 33);
+    }
+
+    // out of order, but touching ranges
+    {
+        DirtyRegions d(0);
+
+        d.Add(64, 64);
+        d.Add(0, 64);
+
+        const auto &r = d.GetCopyInfos();
+        CHECK(r.size() == 1);
+        CHECK(Equals(r[0], 0, 128));
+    }
+}
+
+void TestOverlap()
+{
+    DirtyRegions d(0);
+
+    // contained in the previous one
+    d.Add(100, 100);
+    d.Add(120, 10);
+    // partially overlapping, out of order
+    d.Add(50, 60);
+    // disjoint, before everything
+    d.Add(0, 10);
+    // covers the second half of the first region and extends it
+    d.Add(150, 100);
+
+    const auto &r = d.GetCopyInfos();
+    CHECK(r.size() == 2);
+    CHECK(Equals(r[0], 0, 10));
+    CHECK(Equals(r[1], 50, 200));
+    CHECK(d.GetLowerBound() == 0);
+    CHECK(d.GetUpperBound() == 250);
+
+    // result must be sorted and non-overlapping
+    for (size_t i = 1; i < r.size(); i++)
+    {
+        CHECK(r[i - 1].srcOffset + r[i - 1].size < r[i].srcOffset);
+    }
+}
+
+void TestUnsortedMergeChain()
+{
+    DirtyRegions d(4);
+
+    // each range bridges the previous ones only after sorting
+    d.Add(300, 10);
+    d.Add(100, 10);
+    d.Add(200, 10);
+    d.Add(110, 92);
+    d.Add(208, 90);
+
+    const auto &r = d.GetCopyInfos();
+    CHECK(r.size() == 1);
+    CHECK(Equals(r[0], 100, 210));
+}
+
+void TestAddAfterGet()
+{
+    DirtyRegions d(0);
+
+    d.Add(0, 8);
+    d.Add(64, 8);
+    CHECK(d.GetCopyInfos().size() == 2);
+
+    // copy infos must be recomputed after new ranges
+    d.Add(8, 56);
+
+    const auto &r = d.GetCopyInfos();
+    CHECK(r.size() == 1);
+    CHECK(Equals(r[0], 0, 72));
+}
+
+void TestClear()
+{
+    DirtyRegions d(0);
+
+    d.Add(500, 10);
+    d.Add(0, 10);
+    d.Clear();
+
+    CHECK(d.IsEmpty());
+    CHECK(d.GetCopyInfos().empty());
+    CHECK(d.GetUpperBound() == 0);
+
+    // state after clear must not affect new ranges
+    d.Add(1000, 10);
+    d.Add(2000, 10);
+
+    const auto &r = d.GetCopyInfos();
+    CHECK(r.size() == 2);
+    CHECK(Equals(r[0], 1000, 10));
+    CHECK(Equals(r[1], 2000, 10));
+    CHECK(d.GetLowerBound() == 1000);
+    CHECK(d.GetUpperBound() == 2010);
+}
+
+}
+
+int main()
+{
+    TestEmpty();
+    TestSequentialMerge();
+    TestAdjacency();
+    TestOverlap();
+    TestUnsortedMergeChain();
+    TestAddAfterGet();
+    TestClear();
+
+    if (failedCount > 0)
+    {
+        std::printf("DirtyRegionsTest: %d check(s) failed\n", failedCount);
+        return 1;
+    }
+
+    std::printf("DirtyRegionsTest: OK\n");
+    return 0;
+}
@@ -0,0 +1,301 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Standalone checks of DynamicResolutionController on synthetic GPU time traces,
+// no device is required.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include "../Source/DynamicResolutionController.h"
+
+using namespace RTGL1;
+
+namespace
+{
+
+int failedCount = 0;
+
+#define CHECK(x) \
+    do { if (!(x)) { std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #x); failedCount++; } } while (0)
+
+constexpr float TARGET_MS = 16.0f;
+// measurements are available after the frames in flight
+constexpr uint32_t MEASUREMENT_LATENCY = 2;
+
+struct Trace
+{
+    std::vector<float> scales;
+    uint32_t changeCount;
+    // how many times a change was in the opposite direction to the previous one
+    uint32_t reversalCount;
+};
+
+// "costAtFullMs(frame)" is a GPU time of the scaled passes at scale 1.0,
+// the time of a frame is proportional to the pixel count
+Trace Simulate(DynamicResolutionController &c, uint32_t frameCount, float minScale, float maxScale,
+               const std::function<float(uint32_t)> &costAtFullMs)
+{
+    Trace t = {};
+
+    std::vector<float> renderedScales;
+    float scale = c.GetScale(minScale, maxScale);
+    float prevDelta = 0.0f;
+
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        renderedScales.push_back(scale);
+
+        if (frame >= MEASUREMENT_LATENCY)
+        {
+            const float measuredScale = renderedScales[frame - MEASUREMENT_LATENCY];
+            const float gpuTimeMs = costAtFullMs(frame - MEASUREMENT_LATENCY) * measuredScale * measuredScale;
+
+            const float newScale = c.Update(gpuTimeMs, measuredScale, TARGET_MS, minScale, maxScale);
+
+            if (newScale != scale)
+            {
+                const float delta = newScale - scale;
+
+                t.changeCount++;
+                t.reversalCount += delta * prevDelta < 0.0f ? 1 : 0;
+
+                prevDelta = delta;
+            }
+
+            scale = newScale;
+        }
+
+        t.scales.push_back(scale);
+    }
+
+    return t;
+}
+
+uint32_t CountChanges(const Trace &t, uint32_t fromFrame)
+{
+    uint32_t count = 0;
+
+    for (size_t i = fromFrame + 1; i < t.scales.size(); i++)
+    {
+        count += t.scales[i] != t.scales[i - 1] ? 1 : 0;
+    }
+
+    return count;
+}
+
+bool AllWithin(const Trace &t, float minScale, float maxScale)
+{
+    for (float s : t.scales)
+    {
+        if (s < minScale || s > maxScale)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void TestSteadyOverBudget()
+{
+    DynamicResolutionController c;
+
+    // twice the budget at full resolution, so the pixel count must be halved
+    const Trace t = Simulate(c, 600, 0.25f, 1.0f, [] (uint32_t) { return TARGET_MS * 2.0f; });
+
+    const float expected = std::sqrt(0.5f);
+
+    CHECK(std::abs(t.scales.back() - expected) < 0.05f);
+    // reached in a reasonable time and stays there
+    CHECK(std::abs(t.scales[300] - expected) < 0.05f);
+    CHECK(CountChanges(t, 300) == 0);
+    CHECK(AllWithin(t, 0.25f, 1.0f));
+}
+
+void TestUnderBudget()
+{
+    DynamicResolutionController c;
+
+    // headroom at full resolution: the scale is clamped to the upper bound
+    {
+        const Trace t = Simulate(c, 300, 0.25f, 1.0f, [] (uint32_t) { return TARGET_MS * 0.5f; });
+
+        CHECK(t.scales.back() == 1.0f);
+        CHECK(t.changeCount == 0);
+    }
+
+    // upper bound lower than 1.0
+    {
+        c.Reset();
+        const Trace t = Simulate(c, 300, 0.25f, 0.8f, [] (uint32_t) { return TARGET_MS * 0.5f; });
+
+        CHECK(t.scales.back() == 0.8f);
+        CHECK(AllWithin(t, 0.25f, 0.8f));
+    }
+
+    // after a heavy load is gone, the scale returns to the upper bound
+    {
+        c.Reset();
+        const Trace t = Simulate(c, 1000, 0.25f, 1.0f, [] (uint32_t frame) { return frame < 300 ? TARGET_MS * 3.0f : TARGET_MS * 0.5f; });
+
+        CHECK(t.scales[299] < 0.7f);
+        CHECK(t.scales.back() == 1.0f);
+    }
+}
+
+void TestClampToMin()
+{
+    DynamicResolutionController c;
+
+    // even the lowest scale can't reach the target
+    const Trace t = Simulate(c, 600, 0.5f, 1.0f, [] (uint32_t) { return TARGET_MS * 20.0f; });
+
+    CHECK(t.scales.back() == 0.5f);
+    CHECK(AllWithin(t, 0.5f, 1.0f));
+
+    // the integral term must not wind up while clamped,
+    // so the scale grows soon after the load is gone
+    c.Reset();
+    const Trace r = Simulate(c, 800, 0.5f, 1.0f, [] (uint32_t frame) { return frame < 400 ? TARGET_MS * 20.0f : TARGET_MS * 0.5f; });
+
+    CHECK(r.scales[399] == 0.5f);
+    CHECK(r.scales[400 + 100] > 0.5f);
+    CHECK(r.scales.back() == 1.0f);
+}
+
+void TestSpikes()
+{
+    DynamicResolutionController c;
+
+    // at the target, with a rare single-frame spike
+    auto cost = [] (uint32_t frame)
+    {
+        const float base = TARGET_MS / (0.75f * 0.75f);
+        return frame % 60 == 59 ? base * 4.0f : base;
+    };
+
+    const Trace t = Simulate(c, 1200, 0.25f, 1.0f, cost);
+
+    // spikes are filtered, so they don't cause a resize each time
+    CHECK(CountChanges(t, 600) <= 2);
+
+    bool nearTarget = true;
+
+    for (size_t i = 600; i < t.scales.size(); i++)
+    {
+        nearTarget = nearTarget && std::abs(t.scales[i] - 0.75f) < 0.1f;
+    }
+
+    CHECK(nearTarget);
+}
+
+void TestHysteresis()
+{
+    DynamicResolutionController c;
+
+    // small deterministic noise around the target
+    auto cost = [] (uint32_t frame)
+    {
+        const float base = TARGET_MS / (0.8f * 0.8f);
+        const float noise = 0.03f * std::sin((float)frame * 0.7f);
+
+        return base * (1.0f + noise);
+    };
+
+    const Trace t = Simulate(c, 1000, 0.25f, 1.0f, cost);
+
+    // after the convergence, the noise must not cause resizes
+    CHECK(CountChanges(t, 400) == 0);
+    CHECK(std::abs(t.scales.back() - 0.8f) < 0.05f);
+}
+
+void TestNoOscillation()
+{
+    DynamicResolutionController c;
+
+    // load alternates every frame between two levels around the target
+    auto cost = [] (uint32_t frame)
+    {
+        const float base = TARGET_MS / (0.7f * 0.7f);
+        return frame % 2 == 0 ? base * 0.75f : base * 1.25f;
+    };
+
+    const Trace t = Simulate(c, 1200, 0.25f, 1.0f, cost);
+
+    // doesn't follow the alternation, and doesn't ring around the mean
+    CHECK(t.reversalCount <= 2);
+    CHECK(CountChanges(t, 600) <= 1);
+    CHECK(std::abs(t.scales.back() - 0.7f) < 0.07f);
+
+    // also with a slow sinusoidal load, the scale follows without overshooting into a ring
+    c.Reset();
+    auto slow = [] (uint32_t frame)
+    {
+        const float base = TARGET_MS / (0.7f * 0.7f);
+        return base * (1.0f + 0.3f * std::sin((float)frame * 0.01f));
+    };
+
+    const Trace s = Simulate(c, 1300, 0.25f, 1.0f, slow);
+
+    // a period is ~628 frames, so about 4 reversals are expected in 2 periods
+    CHECK(s.reversalCount <= 6);
+    CHECK(AllWithin(s, 0.25f, 1.0f));
+}
+
+void TestInvalidInput()
+{
+    DynamicResolutionController c;
+
+    const float before = c.GetScale(0.25f, 1.0f);
+
+    CHECK(c.Update(-1.0f, 1.0f, TARGET_MS, 0.25f, 1.0f) == before);
+    CHECK(c.Update(TARGET_MS, 0.0f, TARGET_MS, 0.25f, 1.0f) == before);
+
+    // bounds are sanitized
+    CHECK(c.GetMaxScale(0.5f, 2.0f) == 1.0f);
+    CHECK(c.GetMaxScale(0.8f, 0.5f) == 0.8f);
+    CHECK(c.GetScale(0.8f, 0.5f) == 0.8f);
+}
+
+}
+
+int main()
+{
+    TestSteadyOverBudget();
+    TestUnderBudget();
+    TestClampToMin();
+    TestSpikes();
+    TestHysteresis();
+    TestNoOscillation();
+    TestInvalidInput();
+
+    if (failedCount > 0)
+    {
+        std::printf("DynamicResolutionControllerTest: %d check(s) failed\n", failedCount);
+        return 1;
+    }
+
+    std::printf("DynamicResolutionControllerTest: OK\n");
+    return 0;
+}
@@ -0,0 +1,264 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Standalone checks of TaskScheduler, with its own workers and with a host job system,
+// no device is required.
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../Source/TaskScheduler.h"
+
+using namespace RTGL1;
+
+namespace
+{
+
+int failedCount = 0;
+
+#define CHECK(x) \
+    do { if (!(x)) { std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #x); failedCount++; } } while (0)
+
+
+// Host job system: executes tasks on its own threads and counts the calls
+struct HostJobSystem
+{
+    std::atomic<uint32_t> callCount{ 0 };
+    std::atomic<uint32_t> taskCount{ 0 };
+
+    static void ParallelFor(PFN_rgTask pfnTask, void *pTaskData, uint32_t count, void *pUserData)
+    {
+        auto *host = static_cast<HostJobSystem *>(pUserData);
+
+        host->callCount++;
+        host->taskCount += count;
+
+        std::vector<std::thread> threads;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            threads.emplace_back(pfnTask, pTaskData, i);
+        }
+
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
+};
+
+
+// Every index of [0, count) must be visited exactly once,
+// and each range must be at most grainSize long
+void CheckCoverage(TaskScheduler &scheduler, uint32_t count, uint32_t grainSize)
+{
+    std::vector<std::atomic<uint32_t>> visits(count);
+    std::mutex rangesMutex;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+
+    scheduler.ParallelFor(count, grainSize, [&] (uint32_t first, uint32_t end)
+    {
+        for (uint32_t i = first; i < end; i++)
+        {
+            visits[i]++;
+        }
+
+        std::lock_guard<std::mutex> lock(rangesMutex);
+        ranges.emplace_back(first, end);
+    });
+
+    bool allOnce = true;
+
+    for (const auto &v : visits)
+    {
+        allOnce = allOnce && v.load() == 1;
+    }
+
+    CHECK(allOnce);
+
+    const uint32_t grain = grainSize > 0 ? grainSize : 1;
+    CHECK(ranges.size() == (count + grain - 1) / grain);
+
+    bool grainRespected = true;
+
+    for (const auto &r : ranges)
+    {
+        grainRespected = grainRespected &&
+            r.first < r.second &&
+            r.second - r.first <= grain &&
+            r.first % grain == 0;
+    }
+
+    CHECK(grainRespected);
+}
+
+void TestZeroCount(TaskScheduler &scheduler)
+{
+    bool called = false;
+    scheduler.ParallelFor(0, 16, [&called] (uint32_t, uint32_t) { called = true; });
+
+    CHECK(!called);
+}
+
+void TestRangeCoverage(TaskScheduler &scheduler)
+{
+    CheckCoverage(scheduler, 1, 1);
+    CheckCoverage(scheduler, 1000, 1);
+    CheckCoverage(scheduler, 1000, 7);
+    CheckCoverage(scheduler, 1000, 1000);
+    CheckCoverage(scheduler, 1000, 5000);
+    // zero grain size is treated as 1
+    CheckCoverage(scheduler, 100, 0);
+}
+
+void TestExceptionPropagation(TaskScheduler &scheduler)
+{
+    // thrown in several ranges, on workers and on the calling thread
+    bool caught = false;
+
+    try
+    {
+        scheduler.ParallelFor(256, 1, [] (uint32_t first, uint32_t)
+        {
+            if (first % 16 == 3)
+            {
+                throw std::runtime_error("range failed");
+            }
+        });
+    }
+    catch (const std::runtime_error &)
+    {
+        caught = true;
+    }
+
+    CHECK(caught);
+
+    // in a single range, it's called directly
+    caught = false;
+
+    try
+    {
+        scheduler.ParallelFor(4, 8, [] (uint32_t, uint32_t) { throw std::runtime_error("range failed"); });
+    }
+    catch (const std::runtime_error &)
+    {
+        caught = true;
+    }
+
+    CHECK(caught);
+
+    // the scheduler is still usable after a failure
+    CheckCoverage(scheduler, 500, 3);
+}
+
+void TestNested(TaskScheduler &scheduler)
+{
+    // a waiting thread executes pending tasks, so nested calls don't deadlock
+    std::atomic<uint32_t> sum{ 0 };
+
+    scheduler.ParallelFor(16, 1, [&] (uint32_t, uint32_t)
+    {
+        scheduler.ParallelFor(64, 4, [&] (uint32_t first, uint32_t end)
+        {
+            sum += end - first;
+        });
+    });
+
+    CHECK(sum.load() == 16 * 64);
+}
+
+void TestOwnWorkers()
+{
+    for (uint32_t workerCount : { 1u, 3u, 8u })
+    {
+        TaskScheduler scheduler(workerCount, nullptr, nullptr);
+
+        CHECK(scheduler.GetConcurrency() == workerCount + 1);
+
+        TestZeroCount(scheduler);
+        TestRangeCoverage(scheduler);
+        TestExceptionPropagation(scheduler);
+        TestNested(scheduler);
+    }
+}
+
+void TestHostDelegation()
+{
+    HostJobSystem host;
+    TaskScheduler scheduler(0, &HostJobSystem::ParallelFor, &host);
+
+    TestZeroCount(scheduler);
+    CHECK(host.callCount.load() == 0);
+
+    // one range is executed on the calling thread
+    CheckCoverage(scheduler, 10, 10);
+    CHECK(host.callCount.load() == 0);
+
+    // all ranges are passed to the host in one call
+    CheckCoverage(scheduler, 100, 10);
+    CHECK(host.callCount.load() == 1);
+    CHECK(host.taskCount.load() == 10);
+
+    CheckCoverage(scheduler, 1000, 7);
+    CHECK(host.callCount.load() == 2);
+
+    // exceptions don't go through the host's code, but are rethrown after it returns
+    bool caught = false;
+
+    try
+    {
+        scheduler.ParallelFor(8, 1, [] (uint32_t first, uint32_t)
+        {
+            if (first == 5)
+            {
+                throw std::runtime_error("range failed");
+            }
+        });
+    }
+    catch (const std::runtime_error &)
+    {
+        caught = true;
+    }
+
+    CHECK(caught);
+    CHECK(host.callCount.load() == 3);
+}
+
+}
+
+int main()
+{
+    TestOwnWorkers();
+    TestHostDelegation();
+
+    if (failedCount > 0)
+    {
+        std::printf("TaskSchedulerTest: %d check(s) failed\n", failedCount);
+        return 1;
+    }
+
+    std::printf("TaskSchedulerTest: OK\n");
+    return 0;
+}
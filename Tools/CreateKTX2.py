@@ -32,6 +32,9 @@ OUTPUT_EXTENSION = ".ktx2"
 
 CACHE_FILE_NAME = "CreateKTX2Cache.txt"
 
+# zstd level for supercompression, inflating speed doesn't depend on it
+ZSTD_LEVEL = 18
+
 
 def printInPowerShell(msg, color):
     p = subprocess.run([
@@ -44,7 +47,7 @@ def printInPowerShell(msg, color):
 
 def main():
     if "--help" in sys.argv or "--h" in sys.argv or "-help" in sys.argv or "-h" in sys.argv:
-        print("Usage: CreateKTX2.py")
+        print("Usage: CreateKTX2.py [--zstd]")
         print("")
         print("  CreateKTX2 compresses PNG files from input folder to KTX2 files with")
         print("  BC7/BC5 format to output folder. Folders of the files are preserved the")
@@ -53,10 +56,16 @@ def main():
         print("  If image file name without extension ends with \"_n\", it's assumed that")
         print("  it's a normal map image and will be compressed with BC5 format.")
         print("")
+        print("  --zstd  Supercompress KTX2 files with zstd. Files are smaller on disk,")
+        print("          but BC7/BC5 data on GPU is the same. Requires ktxsc from KTX-Software:")
+        print("          https://github.com/KhronosGroup/KTX-Software")
+        print("")
         print("  Requires compressonatorcli:")
         print("  https://github.com/GPUOpen-Tools/compressonator")
         return
 
+    useZstd = "--zstd" in sys.argv
+
     if not os.path.exists(CACHE_FILE_NAME):
         try:
             with open(CACHE_FILE_NAME, "w"):
@@ -125,11 +134,24 @@ def main():
                     outputFile],
                     stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
 
-                # if success, save to cache
-                if "Done Processing" in r.stdout:
-                    cache[filename] = lastModifTime
-                else:
+                if "Done Processing" not in r.stdout:
                     print(r.stdout)
+                    continue
+
+                if useZstd:
+                    # supercompress in place
+                    r = subprocess.run([
+                        "ktxsc",
+                        "--zcmp", str(ZSTD_LEVEL),
+                        outputFile],
+                        stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+
+                    if r.returncode != 0:
+                        print(r.stdout)
+                        continue
+
+                # if success, save to cache
+                cache[filename] = lastModifTime
 
     with open(CACHE_FILE_NAME, "w") as cacheFile:
         for name, tm in cache.items():